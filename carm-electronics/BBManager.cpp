@@ -13,10 +13,32 @@
 #include "BBManager.h"
 #include "def.h"
 #include "utils.h"
+#include "movingstats.h"
 
 static const unsigned MAX_ATTEMPTS = 20;
 static const unsigned DECIMAL_COUNT = 4;
 static const unsigned GPS_DECIMAL_COUNT = 6;
+static const uint16_t BARO_ZERO_WINDOW = 100;
+static const int BARO_ZERO_MAX_READINGS = 500;
+// twice SIGMA_BARO, readings any noisier than that are still drifting
+static const float BARO_ZERO_MAX_STDDEV = 2 * SIGMA_BARO;
+
+// Print has no 64-bit overload, so the value goes out in two pieces of at
+// most 9 digits
+static void print_micros(File &stream, uint64_t time)
+{
+    uint32_t high = time / 1000000000ULL;
+    uint32_t low = time % 1000000000ULL;
+    if (high == 0)
+    {
+        stream.print(low);
+        return;
+    }
+    char digits[10];
+    snprintf(digits, sizeof(digits), "%09lu", static_cast<unsigned long>(low));
+    stream.print(high);
+    stream.print(digits);
+}
 
 /*
  * setupSensorIMU
@@ -35,15 +57,28 @@ static const unsigned GPS_DECIMAL_COUNT = 6;
  * Notes: Writes to disk which sensors were successfully set up and which ones weren't
  *
  */
-BBManager::BBManager()
+BBManager::BBManager() : pressure_altitude(SEALEVELPRESSURE_HPA)
 {
     // set up the class vars
     curr_state = state::POWER_ON;
     failure_flags = 0;
     curr_launch_time = 0;
+    timestamp = 0;
     temperature_engbay = 0;
     external_temp = 0;
     temperature_avbay = 0;
+    k_tilt = 0;
+    k_roll_rate = 0;
+    k_apogee_altitude = 0;
+    k_time_to_apogee = 0;
+    guard_pending_ticks = 0;
+    fused_confidence = 0;
+    baro_confidence = 0;
+    imu_confidence = 0;
+    detector_votes = 0;
+    accel_counts = {0, 0, 0};
+    mag_counts = {0, 0, 0};
+    gyro_counts = {0, 0, 0};
 }
 
 void BBManager::initDatalog(File &file_stream)
@@ -55,6 +90,8 @@ void BBManager::initDatalog(File &file_stream)
         file_stream.print(",");
         file_stream.print("time (ms)");
         file_stream.print(",");
+        file_stream.print("time (us)");
+        file_stream.print(",");
         file_stream.print("external temperature (C)"); // in Celcius
         file_stream.print(",");
         file_stream.print("engine bay temperature (C)"); // in Celcius
@@ -75,6 +112,24 @@ void BBManager::initDatalog(File &file_stream)
         file_stream.print(",");
         file_stream.print("kf altitude (m)"); // in m
         file_stream.print(",");
+        file_stream.print("tilt (deg)"); // in degrees
+        file_stream.print(",");
+        file_stream.print("roll rate (rad/s)"); // in rad/s
+        file_stream.print(",");
+        file_stream.print("predicted apogee (m)"); // in m
+        file_stream.print(",");
+        file_stream.print("time to apogee (s)"); // in s
+        file_stream.print(",");
+        file_stream.print("guard pending (ticks)");
+        file_stream.print(",");
+        file_stream.print("fused confidence");
+        file_stream.print(",");
+        file_stream.print("baro confidence");
+        file_stream.print(",");
+        file_stream.print("imu confidence");
+        file_stream.print(",");
+        file_stream.print("detector votes");
+        file_stream.print(",");
         file_stream.print("x acceleration (m/s^2)"); // in m/s^2
         file_stream.print(",");
         file_stream.print("y acceleration (m/s^2)"); // in m/s^2
@@ -149,12 +204,24 @@ void BBManager::readSensorData()
 {
     // imu reading
     lsm->read();
+#if IMU_RAW_COUNTS
+    // getEvent would read the sensor again to scale the counts in float; the
+    // driver holds the register counts as floats, whole and within int16_t
+    accel_counts = {static_cast<int16_t>(lsm->accelData.x), static_cast<int16_t>(lsm->accelData.y),
+                    static_cast<int16_t>(lsm->accelData.z)};
+    mag_counts = {static_cast<int16_t>(lsm->magData.x), static_cast<int16_t>(lsm->magData.y),
+                  static_cast<int16_t>(lsm->magData.z)};
+    gyro_counts = {static_cast<int16_t>(lsm->gyroData.x), static_cast<int16_t>(lsm->gyroData.y),
+                   static_cast<int16_t>(lsm->gyroData.z)};
+#else
     sensors_event_t a, m, g, temp;
     lsm->getEvent(&a, &m, &g, &temp);
+#endif
 
     // use this when we have to care about zeroing the data
     // curr_launch_time = millis() - launch_start_time;
-    curr_launch_time = millis();
+    timestamp = flight_clock.now();
+    curr_launch_time = FlightClock::toMillis(timestamp);
 
     // bmp reading
     if (!bmp->performReading())
@@ -167,15 +234,29 @@ void BBManager::readSensorData()
     else
     {
         pressure = bmp->pressure / 100.0;
-        altitude = bmp->readAltitude(SEALEVELPRESSURE_HPA) - baro_offset;
+        // readAltitude would take two more readings and a pow() each, the
+        // altitude comes from the pressure just read instead
+        raw_altitude = pressure_altitude.altitude(pressure);
+        altitude = raw_altitude - baro_offset;
         // altitude = (altitude < 0) ? 0 : altitude;
-        raw_altitude = bmp->readAltitude(SEALEVELPRESSURE_HPA);
         barometer_temp = bmp->temperature;
         failure_flags = flip_bit(failure_flags, 10, 0);
     }
 
     temperature_avbay = tempsensor_avbay->readTempC();
     external_temp = tempsensor_external->readTempC();
+#if IMU_RAW_COUNTS
+    // floats for the estimator and the datalog only
+    accel_x = accel_counts.x * ACCEL_COUNT_SCALE;
+    accel_y = accel_counts.y * ACCEL_COUNT_SCALE;
+    accel_z = accel_counts.z * ACCEL_COUNT_SCALE;
+    mag_x = mag_counts.x * MAG_COUNT_SCALE;
+    mag_y = mag_counts.y * MAG_COUNT_SCALE;
+    mag_z = mag_counts.z * MAG_COUNT_SCALE;
+    gyro_x = gyro_counts.x * GYRO_COUNT_SCALE;
+    gyro_y = gyro_counts.y * GYRO_COUNT_SCALE;
+    gyro_z = gyro_counts.z * GYRO_COUNT_SCALE;
+#else
     accel_x = a.acceleration.x;
     accel_y = a.acceleration.y;
     accel_z = a.acceleration.z;
@@ -185,6 +266,7 @@ void BBManager::readSensorData()
     gyro_x = g.gyro.x;
     gyro_y = g.gyro.y;
     gyro_z = g.gyro.z;
+#endif
 }
 
 /*
@@ -204,6 +286,8 @@ void BBManager::writeSensorData(File &data_stream, File &error_stream)
         data_stream.print(",");
         data_stream.print(curr_launch_time);
         data_stream.print(",");
+        print_micros(data_stream, timestamp);
+        data_stream.print(",");
         data_stream.print(external_temp, DECIMAL_COUNT);
         data_stream.print(",");
         data_stream.print(temperature_engbay, DECIMAL_COUNT);
@@ -224,6 +308,24 @@ void BBManager::writeSensorData(File &data_stream, File &error_stream)
         data_stream.print(",");
         data_stream.print(k_altitude, DECIMAL_COUNT);
         data_stream.print(",");
+        data_stream.print(k_tilt, DECIMAL_COUNT);
+        data_stream.print(",");
+        data_stream.print(k_roll_rate, DECIMAL_COUNT);
+        data_stream.print(",");
+        data_stream.print(k_apogee_altitude, DECIMAL_COUNT);
+        data_stream.print(",");
+        data_stream.print(k_time_to_apogee, DECIMAL_COUNT);
+        data_stream.print(",");
+        data_stream.print(guard_pending_ticks);
+        data_stream.print(",");
+        data_stream.print(fused_confidence, DECIMAL_COUNT);
+        data_stream.print(",");
+        data_stream.print(baro_confidence, DECIMAL_COUNT);
+        data_stream.print(",");
+        data_stream.print(imu_confidence, DECIMAL_COUNT);
+        data_stream.print(",");
+        data_stream.print(detector_votes);
+        data_stream.print(",");
         data_stream.print(accel_x, DECIMAL_COUNT);
         data_stream.print(",");
         data_stream.print(accel_y, DECIMAL_COUNT);
@@ -274,7 +376,8 @@ void BBManager::writeSensorData(File &data_stream, File &error_stream)
 
 void BBManager::setBaroOffset()
 {
-    float altitude_readings_sum;
+    // window the offset is averaged over, 5 s at one reading every 50 ms
+    MovingStats<float, BARO_ZERO_WINDOW> altitude_readings;
 
     Serial.println("Calculating barometer offset...");
 
@@ -282,17 +385,24 @@ void BBManager::setBaroOffset()
     // so ignore those first values
     for (int i = 0; i < 100; i++)
     {
-        bmp->readAltitude(SEALEVELPRESSURE_HPA);
+        bmp->performReading();
     }
-    for (int i = 0; i < 500; i++)
+    // keep reading until the window has settled down to the sensor noise,
+    // giving up after the 500 readings the offset used to be averaged over
+    for (int i = 0; i < BARO_ZERO_MAX_READINGS; i++)
     {
-        altitude_readings_sum += bmp->readAltitude(SEALEVELPRESSURE_HPA);
+        bmp->performReading();
+        altitude_readings.push(pressure_altitude.altitude(bmp->pressure / 100.0));
+        if (altitude_readings.full() && altitude_readings.stddev() < BARO_ZERO_MAX_STDDEV)
+        {
+            break;
+        }
         delay(50);
     }
-    Serial.print("Readings sum: ");
-    Serial.println(altitude_readings_sum, DECIMAL_COUNT);
+    Serial.print("Readings std dev: ");
+    Serial.println(altitude_readings.stddev(), DECIMAL_COUNT);
 
-    baro_offset = (altitude_readings_sum / 500.0);
+    baro_offset = altitude_readings.mean();
 
     Serial.print("Barometer offset: ");
     Serial.println(baro_offset, DECIMAL_COUNT);
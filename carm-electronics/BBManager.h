@@ -22,6 +22,9 @@
 #include "Adafruit_MCP9808.h" // Temp sensor module
 #include <Adafruit_GPS.h>     // GPS module
 #include "def.h"
+#include "barometer.h"
+#include "rawimu.h"
+#include "flightclock.h"
 
 #include "StateDetermination.h"
 
@@ -38,7 +41,10 @@ public:
     void setBaroOffset();
     // we dont care about this right now
     // unsigned launch_start_time;
-    unsigned long curr_launch_time;
+    unsigned long curr_launch_time; // ms, timestamp rounded down
+    // us, FlightClock reading taken with the IMU sample, the time every
+    // estimate, transition and log record of the tick refers to
+    uint64_t timestamp;
     float temperature_avbay;
     float temperature_engbay;
     float external_temp;
@@ -51,6 +57,20 @@ public:
     float k_vert_velocity;
     float k_vert_acceleration;
     float k_altitude;
+    // attitude estimate
+    float k_tilt;      // degrees from the pad axis
+    float k_roll_rate; // rad/s about the pad axis
+    // apogee prediction
+    float k_apogee_altitude;
+    float k_time_to_apogee;
+    // ticks the guard of the last state transition was pending before it fired
+    uint16_t guard_pending_ticks;
+    // confidence of each event detector in the next event to be declared,
+    // and bit 4 * detector + event for every event a detector has latched
+    float fused_confidence;
+    float baro_confidence;
+    float imu_confidence;
+    uint16_t detector_votes;
 
     float accel_x;
     float accel_y;
@@ -61,6 +81,14 @@ public:
     float gyro_x;
     float gyro_y;
     float gyro_z;
+    // raw LSM9DS1 counts behind the readings above, with IMU_RAW_COUNTS
+    RawAxes accel_counts;
+    RawAxes mag_counts;
+    RawAxes gyro_counts;
+    // flight units per count for the ranges in def.h
+    static constexpr float ACCEL_COUNT_SCALE = accel_count_scale(IMU_ACCEL_RANGE_G);
+    static constexpr float MAG_COUNT_SCALE = mag_count_scale(IMU_MAG_RANGE_GAUSS);
+    static constexpr float GYRO_COUNT_SCALE = gyro_count_scale(IMU_GYRO_RANGE_DPS);
     float gps_lat;
     float gps_long;
     float gps_speed;
@@ -83,6 +111,7 @@ private:
     Adafruit_MCP9808 *tempsensor_avbay;    // avionics bay temp sens
     Adafruit_MCP9808 *tempsensor_engbay;   // engine bay temp sens
     Adafruit_MCP9808 *tempsensor_external; // external temp sens
+    PressureAltitude pressure_altitude;    // bmp pressure to altitude
     // Adafruit_GPS *gps;                   // gps module
 };
 
@@ -5,8 +5,10 @@
  *     Author(s):  Daniel Opara
  *     Date:       3/20/2024
  *
- *     Overview: Transforms sensor readings into DLT values based on a
- *                  predetermined range, allocated bit count, and spacing
+ *     Overview: Gathers BBManager's sensor readings into the Telemetry
+ *                  the packet codecs in dlt.h transform, pack and unpack,
+ *                  and encodes them as the packet for the flight state,
+ *                  with the error correction for it
  *
  *
  **************************************************************/
@@ -16,24 +18,15 @@
 
 #include <inttypes.h>
 #include "BBManager.h"
-#include "untransformed.h"
+#include "dlt.h"
+#include "dltdelta.h"
+#include "fec.h"
 
-unsigned int *transform_poweron(BBManager bbman);
+typedef DltDeltaEncoder<TELEMETRY_KEYFRAME_PERIOD> TelemetryEncoder;
 
-unsigned int *transform_launchready(BBManager bbman);
+Telemetry read_telemetry(const BBManager &bbman);
+DltSchema schema_for(state s);
+uint8_t fec_parity_for(state s);
+size_t encode_telemetry(const BBManager &bbman, TelemetryEncoder &encoder, uint8_t bytes[]);
 
-unsigned int *transform_launchmode(BBManager bbman);
-
-unsigned int *transform_recovery(BBManager bbman);
-
-powerondata untransform_poweron(unsigned int *data);
-
-launchreadydata untransform_launchready(unsigned int *data);
-
-launchmodedata untransform_launchmode(unsigned int *data);
-
-recoverydata untransform_recovery(unsigned int *data);
-
-launchmodedata untransform_noschema(unsigned int *data);
-
-#endif
\ No newline at end of file
+#endif
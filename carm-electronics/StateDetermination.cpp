@@ -10,155 +10,222 @@
  *
  **************************************************************/
 
+#include <math.h>
+
 #include "StateDetermination.h"
+#ifdef ARDUINO
 #include "BBManager.h"
+#endif
+
+// launch, burnout, apogee and main are voted on by the redundant detectors
+// (detectors.h), which confirm them over DEBOUNCE_N ticks themselves; the
+// other guards run on the raw estimates and the table debounces them
 
-StateDeterminer::StateDeterminer() : estimator(SIGMA_GYRO, SIGMA_ACCEL, SIGMA_BARO, CA, ACCEL_THRESHOLD)
+static bool voted(const FlightEstimates &e, FlightEvent event)
 {
-    main_attempted = false;
-    curr_state = state::POWER_ON;
+    return e.events & (1 << static_cast<uint8_t>(event));
 }
 
-StateDeterminer::~StateDeterminer()
+static bool launched(const FlightEstimates &e)
 {
+    return voted(e, FlightEvent::LAUNCH);
 }
 
-// TODO: Complete this func, takes in bbman and modifies its curr_state attribute
-void StateDeterminer::determineState(BBManager &manager)
+static bool thrustEnded(const FlightEstimates &e)
 {
-    // if (first_step == false)
-    // {
-    //     estimator.setInitTime(millis());
-    //     first_step = true;
-    // }
+    return voted(e, FlightEvent::BURNOUT);
+}
 
-    float accel_data[3] = {static_cast<float>(manager.accel_x / 9.81), static_cast<float>(manager.accel_y / 9.81), static_cast<float>(manager.accel_z / 9.81)};
-    float gyro_data[3] = {manager.gyro_x, manager.gyro_y, manager.gyro_z};
-    estimator.estimate(accel_data, gyro_data, manager.altitude, manager.curr_launch_time);
+static bool coasting(const FlightEstimates &e)
+{
+    return e.accel < -COAST_DECEL;
+}
 
-    float curr_alt = estimator.getAltitude();
-    float curr_velo = estimator.getVerticalVelocity();
-    float curr_accel = estimator.getVerticalAcceleration();
+static bool apogeeReached(const FlightEstimates &e)
+{
+    return voted(e, FlightEvent::APOGEE);
+}
 
-    manager.k_altitude = curr_alt;
-    manager.k_vert_velocity = curr_velo;
-    manager.k_vert_acceleration = curr_accel;
+// if it deploys at apogee, there shouldnt be much happening
+static bool always(const FlightEstimates &)
+{
+    return true;
+}
 
-    if (manager.curr_state == state::LAUNCH_READY)
-    {
-        if ((curr_accel > prev_accel) && (curr_velo > 0.1))
-        {
-            manager.curr_state = state::POWERED_FLIGHT_PHASE;
-            // manager.launch_start_time = millis();
-        }
-        updatePrevEstimates(curr_alt, curr_accel, curr_velo);
-        return;
-    }
+static bool belowMain(const FlightEstimates &e)
+{
+    return voted(e, FlightEvent::MAIN);
+}
 
-    if (manager.curr_state == state::LAUNCH_READY || manager.curr_state == state::POWER_ON)
-    {
-        if ((curr_accel > prev_accel) && (curr_velo > 0.1))
-        {
-            manager.curr_state = state::POWERED_FLIGHT_PHASE;
-            // manager.launch_start_time = millis();
-            // estimator.resetPriors();
-            // curr_alt = 0;
-            // curr_accel = 0;
-            // curr_velo = 0;
-        }
-        updatePrevEstimates(curr_alt, curr_accel, curr_velo);
-        return;
-    }
+// the jerk of the main opening happens in a small window of time
+static bool mainOpened(const FlightEstimates &e)
+{
+    return e.accel > MAIN_OPEN_ACCEL;
+}
 
-    // TODO: what if I don't detect the burnout phase. I think I solved it with the next conditional
-    if (manager.curr_state == state::POWERED_FLIGHT_PHASE)
-    {
-        if (curr_accel < prev_accel)
-        {
-            manager.curr_state = state::BURNOUT_PHASE;
-        }
-        updatePrevEstimates(curr_alt, curr_accel, curr_velo);
-        return;
-    }
+static bool landing(const FlightEstimates &e)
+{
+    return e.altitude < RECOVERY_ALTITUDE;
+}
 
-    if (manager.curr_state == state::BURNOUT_PHASE || manager.curr_state == state::POWERED_FLIGHT_PHASE)
-    {
+#define S(name) static_cast<uint8_t>(state::name)
+
+// from, to, guard, n of m ticks, min dwell (us), lockout state, lockout (us)
+const TransitionRule FLIGHT_RULES[] = {
+    {S(POWER_ON), S(POWERED_FLIGHT_PHASE), launched, 1, 1, 0, 0, 0},
+    {S(LAUNCH_READY), S(POWERED_FLIGHT_PHASE), launched, 1, 1, 0, 0, 0},
+    {S(POWERED_FLIGHT_PHASE), S(BURNOUT_PHASE), thrustEnded, 1, 1, 0, 0, 0},
+    {S(BURNOUT_PHASE), S(COAST_PHASE), coasting, DEBOUNCE_N, DEBOUNCE_M, BURNOUT_DWELL * 1000UL, 0, 0},
+    {S(COAST_PHASE), S(APOGEE_PHASE), apogeeReached, 1, 1, 0, S(POWERED_FLIGHT_PHASE), APOGEE_LOCKOUT * 1000UL},
+    {S(APOGEE_PHASE), S(DROGUE_DEPLOYED), always, 1, 1, 0, 0, 0},
+    {S(DROGUE_DEPLOYED), S(MAIN_DEPLOY_ATTEMPT), belowMain, 1, 1, 0, 0, 0},
+    {S(MAIN_DEPLOY_ATTEMPT), S(MAIN_DEPLOYED), mainOpened, 2, DEBOUNCE_M, 0, 0, 0},
+    {S(MAIN_DEPLOY_ATTEMPT), S(RECOVERY), landing, DEBOUNCE_N, DEBOUNCE_M, 0, 0, 0},
+    {S(MAIN_DEPLOYED), S(RECOVERY), landing, DEBOUNCE_N, DEBOUNCE_M, 0, 0, 0},
+};
+
+#undef S
+
+const uint8_t FLIGHT_RULE_COUNT = sizeof(FLIGHT_RULES) / sizeof(FLIGHT_RULES[0]);
+
+const DetectorConfig FLIGHT_DETECTORS = {
+    LAUNCH_ACCEL,
+    LAUNCH_VELOCITY,
+    BARO_LAUNCH_ALTITUDE,
+    APOGEE_LEAD_TIME,
+    MAIN_DEPLOY_ALTITUDE,
+    IMU_ACCEL_RANGE_G * 9.80665f,
+    DEBOUNCE_N,
+    {1, 1, 1}, // fused, baro, imu
+    VOTER_QUORUM,
+    FUSED_DIVERGENCE,
+    BARO_FIT_NOISE,
+    IMU_CLIPPED_CONFIDENCE,
+};
+
+StateDeterminer::StateDeterminer() : estimator(SIGMA_ACCEL, SIGMA_GYRO, SIGMA_BARO, CA, ACCEL_THRESHOLD, SIGMA_GPS, ATTITUDE_ENGINE),
+                                       apogee_predictor(APOGEE_DRAG_SMOOTHING, APOGEE_MIN_DRAG_VELOCITY),
+                                       voter(FLIGHT_DETECTORS),
+                                       transitions(FLIGHT_RULES, FLIGHT_RULE_COUNT, static_cast<uint8_t>(state::POWER_ON))
+{
+    estimates.time = 0;
+    estimates.altitude = 0;
+    estimates.velocity = 0;
+    estimates.accel = 0;
+    estimates.timeToApogee = NAN;
+    estimates.events = 0;
+}
 
-        manager.curr_state = state::COAST_PHASE;
-        updatePrevEstimates(curr_alt, curr_accel, curr_velo);
-        return;
-    }
+StateDeterminer::~StateDeterminer()
+{
+}
 
-    if (manager.curr_state == state::COAST_PHASE)
+int StateDeterminer::update(const SensorFrame &frame)
+{
+    float accel_data[3] = {static_cast<float>(frame.accel[0] / 9.81), static_cast<float>(frame.accel[1] / 9.81), static_cast<float>(frame.accel[2] / 9.81)};
+    float gyro_data[3] = {frame.gyro[0], frame.gyro[1], frame.gyro[2]};
+    float mag_data[3] = {frame.mag[0], frame.mag[1], frame.mag[2]};
+    // the filters only look at the gaps between samples
+    uint32_t time = static_cast<uint32_t>(frame.time);
+    estimator.predict(accel_data, gyro_data, mag_data, time);
+    if (frame.baro_valid)
     {
-        if ((curr_velo >= 0) && (curr_velo <= 1))
-        {
-            manager.curr_state = state::APOGEE_PHASE;
-        }
-        updatePrevEstimates(curr_alt, curr_accel, curr_velo);
-        return;
+        estimator.updateBaro(frame.altitude, time);
     }
 
-    if (manager.curr_state == state::APOGEE_PHASE)
-    {
-        // should i check for continuity or what
-        // if it deploys at apogee, there shouldnt be much happening
-        manager.curr_state = state::DROGUE_DEPLOYED;
-        updatePrevEstimates(curr_alt, curr_accel, curr_velo);
-        return;
-    }
+    estimates.time = frame.time;
+    estimates.altitude = estimator.getAltitude();
+    estimates.velocity = estimator.getVerticalVelocity();
+    estimates.accel = estimator.getVerticalAcceleration();
 
-    //! TODO: add the below
-    // fall back if we are unable to deploy the drogue, we skip the drogue deployment
-    // and move on to deploy the main parachute
+    // runs on the raw estimates, the prediction already smooths the drag
+    apogee_predictor.update(estimates.altitude, estimates.velocity, estimates.accel, time);
+    estimates.timeToApogee = apogee_predictor.valid(APOGEE_MIN_DRAG_SAMPLES) ? apogee_predictor.getTimeToApogee() : NAN;
 
-    if (manager.curr_state == state::DROGUE_DEPLOYED)
+    DetectorInput input;
+    input.time = frame.time;
+    for (int k = 0; k < 3; k++)
     {
-        // check if altitude and if it is less than some altitude at which we say fuck it,
-        // we switch to the states to the main deployment attempt phase
-        if (curr_alt <= MAIN_DEPLOY_ALTITUDE)
-        {
-            manager.curr_state = state::MAIN_DEPLOY_ATTEMPT;
-            // do something from actions.h here
-            main_attempted = true;
-        }
-        updatePrevEstimates(curr_alt, curr_accel, curr_velo);
+        input.accel[k] = frame.accel[k];
     }
+    input.baroAltitude = frame.altitude;
+    input.baroValid = frame.baro_valid;
+    input.fused = estimates;
+    voter.update(input);
+    estimates.events = voter.getDecisions();
+
+    return transitions.tick(estimates);
+}
+
+state StateDeterminer::getState() const
+{
+    return static_cast<state>(transitions.getState());
+}
+
+void StateDeterminer::setState(state new_state, uint64_t time)
+{
+    transitions.setState(static_cast<uint8_t>(new_state), time);
+}
 
-    if (manager.curr_state == state::MAIN_DEPLOY_ATTEMPT)
+const FlightEstimates &StateDeterminer::getEstimates() const
+{
+    return estimates;
+}
+
+const TransitionTable &StateDeterminer::getTransitions() const
+{
+    return transitions;
+}
+
+const EventVoter &StateDeterminer::getVoter() const
+{
+    return voter;
+}
+
+#ifdef ARDUINO
+void StateDeterminer::determineState(BBManager &manager)
+{
+    // the state may have been set from elsewhere since the last tick
+    if (manager.curr_state != getState())
     {
-        if (main_attempted)
-        {
-            // probably safer to implement a moving average here since the difference between
-            // curr and prev will be so great and takes place in a small window of time
-            if (curr_velo > prev_velo)
-            {
-                manager.curr_state = state::MAIN_DEPLOYED;
-            }
-            main_attempted = false;
-        }
-        else
-        {
-            // do something from actions.h here
-            main_attempted = true;
-        }
-
-        if (curr_alt < 50)
-        {
-            manager.curr_state = state::RECOVERY;
-        }
-        updatePrevEstimates(curr_alt, curr_accel, curr_velo);
-        return;
+        setState(manager.curr_state, manager.timestamp);
     }
 
-    if (manager.curr_state == state::MAIN_DEPLOYED)
+    SensorFrame frame;
+    frame.time = manager.timestamp;
+    frame.accel[0] = manager.accel_x;
+    frame.accel[1] = manager.accel_y;
+    frame.accel[2] = manager.accel_z;
+    frame.gyro[0] = manager.gyro_x;
+    frame.gyro[1] = manager.gyro_y;
+    frame.gyro[2] = manager.gyro_z;
+    // the LSM9DS1 magnetometer axes are not the accel/gyro axes on every
+    // mounting, check the board orientation before trusting the heading
+    frame.mag[0] = manager.mag_x;
+    frame.mag[1] = manager.mag_y;
+    frame.mag[2] = manager.mag_z;
+    frame.altitude = manager.altitude;
+    // bit 10 of the failure flags is set when the BMP reading failed, in which
+    // case altitude holds a placeholder 0 that must not be fused
+    frame.baro_valid = !(manager.failure_flags & (1 << 10));
+    int fired = update(frame);
+
+    manager.k_altitude = estimates.altitude;
+    manager.k_vert_velocity = estimates.velocity;
+    manager.k_vert_acceleration = estimates.accel;
+    manager.k_tilt = estimator.getTilt();
+    manager.k_roll_rate = estimator.getRollRate();
+    manager.k_apogee_altitude = apogee_predictor.getApogeeAltitude();
+    manager.k_time_to_apogee = apogee_predictor.getTimeToApogee();
+    FlightEvent pending = voter.pendingEvent();
+    manager.fused_confidence = voter.getConfidence(Detector::FUSED, pending);
+    manager.baro_confidence = voter.getConfidence(Detector::BARO, pending);
+    manager.imu_confidence = voter.getConfidence(Detector::IMU, pending);
+    manager.detector_votes = voter.getVotes();
+    if (fired >= 0)
     {
-        if (curr_alt < 50)
-        {
-            manager.curr_state = state::RECOVERY;
-        }
-        updatePrevEstimates(curr_alt, curr_accel, curr_velo);
-        return;
+        manager.curr_state = getState();
+        manager.guard_pending_ticks = transitions.getStats(fired).pendingTicks;
     }
 }
 
@@ -177,10 +244,4 @@ void StateDeterminer::switchGroundState(BBManager &manager, uint64_t packet)
         return;
     }
 }
-
-void StateDeterminer::updatePrevEstimates(float altitude, float acceleration, float velocity)
-{
-    prev_alt = altitude;
-    prev_velo = velocity;
-    prev_accel = acceleration;
-}
\ No newline at end of file
+#endif
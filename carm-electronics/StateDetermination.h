@@ -16,11 +16,17 @@
 
 #include <inttypes.h>
 #include "altitude.h"
+#include "apogee.h"
+#include "transitions.h"
+#include "detectors.h"
+#include "def.h"
 
 // standard noise deviation, calculated by Daniel
 #define SIGMA_GYRO 0.337
 #define SIGMA_ACCEL 0.640
 #define SIGMA_BARO 0.488
+// GPS altitude is far noisier than the barometer, only used for slow corrections
+#define SIGMA_GPS 5.0
 
 // KF concept: how closely calculated future values are to prev values
 // we set this to 0.5 to err on the side of safety
@@ -29,8 +35,52 @@
 // something for complementary filtering for the zero-velocity update feature
 #define ACCEL_THRESHOLD 0.3
 
+// attitude filter behind the vertical acceleration estimate, KALMAN or MAHONY
+// (see tests/filter-tests/attitude_bench.cpp for how the two compare)
+#define ATTITUDE_ENGINE AttitudeEngine::KALMAN
+
+// transition guards must hold on DEBOUNCE_N of the last DEBOUNCE_M ticks, so
+// a single noisy estimate cannot trigger a state change on its own
+#define DEBOUNCE_N 3
+#define DEBOUNCE_M 5
+
+// liftoff: vertical acceleration (m/s^2, gravity removed) and velocity (m/s)
+#define LAUNCH_ACCEL 20
+#define LAUNCH_VELOCITY 5
+// coast: decelerating by more than half of g, drag included, which the motor
+// tail-off right after burnout does not
+#define COAST_DECEL 4.9
+// main opening: the deceleration of the descent under the main
+#define MAIN_OPEN_ACCEL 5
+#define RECOVERY_ALTITUDE 50
+// ms after liftoff before apogee may be called, covers the boost and any
+// transonic barometer error; ms in burnout before coast
+#define APOGEE_LOCKOUT 2000
+#define BURNOUT_DWELL 100
+
+// apogee prediction: weight of each new drag sample, speed below which drag
+// is not measured (m/s), drag samples needed before the prediction is trusted,
+// and how early (s) apogee is called ahead of the predicted time, one loop
+// period at 20 Hz
+#define APOGEE_DRAG_SMOOTHING 0.1
+#define APOGEE_MIN_DRAG_VELOCITY 15
+#define APOGEE_MIN_DRAG_SAMPLES 10
+#define APOGEE_LEAD_TIME 0.05
+
 #define MAIN_DEPLOY_ALTITUDE 213.36 // meters, bode set it to 700 feet
 
+// redundant event detectors (detectors.h): the barometer calls launch above
+// BARO_LAUNCH_ALTITUDE (m); an event is declared once the detectors that see
+// it hold VOTER_QUORUM of the confidence of those that can judge it. Fused
+// confidence halves at FUSED_DIVERGENCE m between the filter and the
+// barometer, baro confidence at BARO_FIT_NOISE m of residual, and a clipped
+// accelerometer leaves the IMU IMU_CLIPPED_CONFIDENCE on apogee
+#define BARO_LAUNCH_ALTITUDE 20
+#define VOTER_QUORUM 0.6
+#define FUSED_DIVERGENCE 30
+#define BARO_FIT_NOISE 3
+#define IMU_CLIPPED_CONFIDENCE 0.25
+
 // forward declaration
 class BBManager;
 
@@ -48,27 +98,47 @@ enum class state
     RECOVERY
 };
 
+// the flight's transition table, see StateDetermination.cpp
+extern const TransitionRule FLIGHT_RULES[];
+extern const uint8_t FLIGHT_RULE_COUNT;
+extern const DetectorConfig FLIGHT_DETECTORS;
+
+// one loop's worth of the readings determineState takes from BBManager, so
+// the same code can be replayed on the host
+struct SensorFrame
+{
+    uint64_t time;  // us, FlightClock (flightclock.h)
+    float accel[3]; // m/s^2
+    float gyro[3];  // rad/s
+    float mag[3];
+    float altitude; // m above the pad
+    bool baro_valid;
+};
+
 class StateDeterminer
 {
 public:
     StateDeterminer();
     ~StateDeterminer();
+#ifdef ARDUINO
     void determineState(BBManager &manager);
     void switchGroundState(BBManager &manager, uint64_t packet);
+#endif
+    // runs the estimator and the transition table on one frame, returns the
+    // index of the rule that fired or -1
+    int update(const SensorFrame &frame);
+    state getState() const;
+    void setState(state new_state, uint64_t time);
+    const FlightEstimates &getEstimates() const;
+    const TransitionTable &getTransitions() const;
+    const EventVoter &getVoter() const;
 
 private:
     AltitudeEstimator estimator;
-
-    // prev values
-    float prev_alt;
-    float prev_accel;
-    float prev_velo;
-
-    bool main_attempted;
-    float launch_start_time;
-    state curr_state;
-
-    void updatePrevEstimates(float altitude, float acceleration, float velocity);
+    ApogeePredictor apogee_predictor;
+    EventVoter voter;
+    TransitionTable transitions;
+    FlightEstimates estimates;
 };
 
 #endif
\ No newline at end of file
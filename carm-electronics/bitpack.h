@@ -1,32 +1,230 @@
+/**************************************************************
+ *
+ *                     bitpack.h
+ *
+ *     Overview: Packs and extracts fields of 64-bit words. Header-only and
+ *                  constexpr so calls inline and fold: with a constant width
+ *                  and lsb a field is one shift and one mask. Every function
+ *                  is branch-free; a width of 64 or an lsb of 64 (with a
+ *                  width of 0) is handled by masking the shift count.
+ *
+ *                  Bitpack_getu<WIDTH, LSB>(word) and
+ *                  Bitpack_newu<WIDTH, LSB>(word, value) take the field as
+ *                  template arguments and reject a field outside the word
+ *                  at compile time.
+ *
+ *                  The Checked Runtime Errors below are asserted only in
+ *                  checked builds: host builds without NDEBUG, never the
+ *                  flight computer. Define BITPACK_CHECKED to choose.
+ *
+ **************************************************************/
+
 #ifndef BITPACK_H
 #define BITPACK_H
 
+#include <assert.h>
 #include <inttypes.h>
 #include <stdbool.h>
 
-static uint64_t
-shift_left(uint64_t word, unsigned bits);
+#ifndef BITPACK_CHECKED
+#if !defined(NDEBUG) && !defined(ARDUINO)
+#define BITPACK_CHECKED 1
+#else
+#define BITPACK_CHECKED 0
+#endif
+#endif
+
+#if BITPACK_CHECKED
+#define BITPACK_CHECK(condition, result) ((condition) ? (result) : (assert(!#condition), (result)))
+#else
+#define BITPACK_CHECK(condition, result) (result)
+#endif
+
+constexpr unsigned BITPACK_MAX_BITS = 64;
+
+/**************************** Bitpack_mask() ************************
+ *
+ *  Purpose: The low width bits set, width up to and including BITPACK_MAX_BITS
+ *
+ ****************************************************************************/
+constexpr uint64_t Bitpack_mask(unsigned width)
+{
+    return ((1ULL << (width & 63)) - 1) | (0 - static_cast<uint64_t>(width >> 6));
+}
+
+/**************************** Bitpack_signbit() ************************
+ *
+ *  Purpose: The top bit of a width bit field, 0 for a width of 0
+ *
+ ****************************************************************************/
+constexpr uint64_t Bitpack_signbit(unsigned width)
+{
+    return Bitpack_mask(width) ^ (Bitpack_mask(width) >> 1);
+}
+
+/**************************** Bitpack_fitsu() ************************
+ *
+ *  Purpose:  Determines if an unsigned integer value can fit into a given bit
+ *            width without overflow
+ *
+ *  Parameters:
+ *      1. n -- An unsigned 64-bit integer value to check if it can fit into the
+ *             given bit width.
+ *      2. width -- An unsigned integer value representing the bit width to
+ *                  check if the given value can fit into.
+ *
+ *  Returns: A boolean value indicating whether the given value can fit into the
+ *           given bit width without overflow.
+ *
+ *  Effects: It is a Checked Runtime Error if the width value exceeds BITPACK_MAX_BITS
+ *
+ ****************************************************************************/
+constexpr bool Bitpack_fitsu(uint64_t n, unsigned width)
+{
+    return BITPACK_CHECK(width <= BITPACK_MAX_BITS, (n & ~Bitpack_mask(width)) == 0);
+}
 
-static uint64_t
-shift_right_logical(uint64_t word, unsigned bits);
+/**************************** Bitpack_fitss() ************************
+ *
+ *  Purpose: Determines whether a signed integer value can be represented in
+ *           width bits using two's complement encoding: it can if adding
+ *           2^(width - 1) brings it into [0, 2^width).
+ *
+ *  Parameters:
+ *      1. n -- An signed integer value to check if it can fit into the
+ *             given bit width.
+ *      2. width -- An unsigned integer indicating the number of bits available
+ *                  for encoding n in two's complement.
+ *
+ *  Returns: true if n can be represented and false otherwise. Only 0 fits
+ *           in 0 bits.
+ *
+ *  Effects: It is a Checked Runtime Error if width exceeds BITPACK_MAX_BITS
+ *
+ ****************************************************************************/
+constexpr bool Bitpack_fitss(int64_t n, unsigned width)
+{
+    return BITPACK_CHECK(width <= BITPACK_MAX_BITS,
+                         Bitpack_fitsu(static_cast<uint64_t>(n) + Bitpack_signbit(width), width));
+}
 
-static int64_t
-shift_right_arith(uint64_t word, unsigned bits);
+/**************************** Bitpack_getu() ************************
+ *
+ *  Purpose: Extracts an unsigned integer of a specified width from a given
+ *           word, starting from a specified least significant bit (lsb).
+ *
+ *  Parameters:
+ *      1. word -- an unsigned 64-bit integer from which bits will be extracted
+ *      2. width -- an unsigned integer representing the width (in bits) of the
+ *                  unsigned integer to be extracted.
+ *      3. lsb -- an unsigned integer representing the index of the least
+ *                significant bit of the unsigned integer to be extracted
+ *
+ *  Returns: An unsigned 64-bit integer representing the extracted unsigned
+ *           integer.
+ *
+ *  Effects: It is a Checked Runtime Error if width or the sum of width and lsb
+ *           exceeds BITPACK_MAX_BITS
+ *
+ ****************************************************************************/
+constexpr uint64_t Bitpack_getu(uint64_t word, unsigned width, unsigned lsb)
+{
+    return BITPACK_CHECK(width <= BITPACK_MAX_BITS && lsb + width <= BITPACK_MAX_BITS,
+                         (word >> (lsb & 63)) & Bitpack_mask(width));
+}
 
-bool Bitpack_fitsu(uint64_t n, unsigned width);
+/**************************** Bitpack_gets() ************************
+ *
+ *  Purpose: Extracts a signed integer of a specified width from a given
+ *           word, starting from a specified least significant bit (lsb).
+ *           The field is sign-extended by flipping its sign bit and
+ *           subtracting it back out.
+ *
+ *  Parameters:
+ *      1. word -- the bit-packed word from which to extract the signed value
+ *      2. width -- the number of bits to extract
+ *      3. lsb --  the index of the least significant bit of the value to be
+ *                 extracted in the word
+ *
+ *  Returns: An signed 64-bit integer representing the extracted signed
+ *           integer, 0 for a width of 0.
+ *
+ *  Effects: It is a Checked Runtime Error if width or the sum of width and lsb
+ *           exceeds BITPACK_MAX_BITS
+ *
+ ****************************************************************************/
+constexpr int64_t Bitpack_gets(uint64_t word, unsigned width, unsigned lsb)
+{
+    return static_cast<int64_t>((Bitpack_getu(word, width, lsb) ^ Bitpack_signbit(width)) - Bitpack_signbit(width));
+}
 
-bool Bitpack_fitss(int64_t n, unsigned width);
+/**************************** Bitpack_newu() ************************
+ *
+ *  Purpose:  Packs a new unsigned value of a specified width into a given
+ *            word at a specified least significant bit position.
+ *
+ *  Parameters:
+ *      1. word --  a 64-bit unsigned integer representing the word to be
+ *                  modified
+ *      2. width --- an unsigned integer representing the width of the field to
+ *                   be modified
+ *      3. lsb -- an unsigned integer representing the least significant bit
+ *                position of the field to be modified
+ *      4. value -- a 64-bit unsigned integer representing the new value to be
+ *                 packed into the field
+ *
+ *  Returns: A 64-bit unsigned integer representing the modified word with the
+ *           new value packed in the specified field. A value that does not
+ *           fit in width bits is masked to width bits, the rest of the word
+ *           is left as it was.
+ *
+ *  Effects:  It is a Checked Runtime Error if width or the sum of width and lsb
+ *           exceeds BITPACK_MAX_BITS
+ *
+ ****************************************************************************/
+constexpr uint64_t Bitpack_newu(uint64_t word, unsigned width, unsigned lsb, uint64_t value)
+{
+    return BITPACK_CHECK(width <= BITPACK_MAX_BITS && lsb + width <= BITPACK_MAX_BITS,
+                         (word & ~(Bitpack_mask(width) << (lsb & 63))) |
+                             ((value & Bitpack_mask(width)) << (lsb & 63)));
+}
 
-uint64_t
-Bitpack_getu(uint64_t word, unsigned width, unsigned lsb);
+/**************************** Bitpack_news() ************************
+ *
+ *  Purpose:  Packs a new signed value of a specified width into a given
+ *            word at a specified least significant bit position, in two's
+ *            complement.
+ *
+ *  Parameters: as Bitpack_newu, value is a signed 64-bit integer
+ *
+ *  Returns: A uint64_t representing the modified word with the new value
+ *           packed in the specified field.
+ *
+ *  Effects:  It is a Checked Runtime Error if width or the sum of width and lsb
+ *           exceeds BITPACK_MAX_BITS
+ *
+ ****************************************************************************/
+constexpr uint64_t Bitpack_news(uint64_t word, unsigned width, unsigned lsb, int64_t value)
+{
+    return Bitpack_newu(word, width, lsb, static_cast<uint64_t>(value));
+}
 
-int64_t
-Bitpack_gets(uint64_t word, unsigned width, unsigned lsb);
+/*
+ * The same for a field known at compile time, checked at compile time
+ */
 
-uint64_t
-Bitpack_newu(uint64_t word, unsigned width, unsigned lsb, uint64_t value);
+template <unsigned WIDTH, unsigned LSB>
+constexpr uint64_t Bitpack_getu(uint64_t word)
+{
+    static_assert(WIDTH > 0 && WIDTH + LSB <= BITPACK_MAX_BITS, "the field does not fit the word");
+    return (word >> LSB) & Bitpack_mask(WIDTH);
+}
 
-uint64_t
-Bitpack_news(uint64_t word, unsigned width, unsigned lsb, int64_t value);
+template <unsigned WIDTH, unsigned LSB>
+constexpr uint64_t Bitpack_newu(uint64_t word, uint64_t value)
+{
+    static_assert(WIDTH > 0 && WIDTH + LSB <= BITPACK_MAX_BITS, "the field does not fit the word");
+    return (word & ~(Bitpack_mask(WIDTH) << LSB)) | ((value & Bitpack_mask(WIDTH)) << LSB);
+}
 
-#endif
\ No newline at end of file
+#endif
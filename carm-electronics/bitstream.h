@@ -0,0 +1,186 @@
+/**************************************************************
+ *
+ *                     bitstream.h
+ *
+ *     Overview: Writes and reads unsigned fields back to back in a byte
+ *                  buffer, most significant bit first, without regard to
+ *                  word boundaries. A frame takes only the bytes its fields
+ *                  need: the last byte is padded with zeros.
+ *
+ *                  Whole bytes are moved straight to and from the buffer
+ *                  when the stream is byte-aligned; otherwise the bits go
+ *                  through a 64-bit accumulator, a field at a time.
+ *
+ *                  Arduino-free, shared by the flight computer, the ground
+ *                  station and the host tests.
+ *
+ **************************************************************/
+
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+class BitWriter
+{
+public:
+  BitWriter(uint8_t *out) : out(out) {}
+
+  // the low width bits of value, width at most 32
+  void write(uint32_t value, uint8_t width)
+  {
+    uint64_t field = value & ((1ULL << width) - 1);
+    if (pending == 0 && width % 8 == 0)
+    {
+      for (uint8_t k = width; k > 0; k -= 8)
+      {
+        out[count++] = field >> (k - 8);
+      }
+      return;
+    }
+    acc = acc << width | field;
+    pending += width;
+    while (pending >= 8)
+    {
+      pending -= 8;
+      out[count++] = acc >> pending;
+    }
+  }
+
+  // a run of bytes, copied as is when the stream is byte-aligned
+  void writeBytes(const uint8_t *bytes, size_t size)
+  {
+    if (pending == 0)
+    {
+      memcpy(out + count, bytes, size);
+      count += size;
+      return;
+    }
+    for (size_t k = 0; k < size; k++)
+    {
+      write(bytes[k], 8);
+    }
+  }
+
+  // pads the last byte with zeros, returns the bytes written
+  size_t finish()
+  {
+    if (pending > 0)
+    {
+      out[count++] = acc << (8 - pending);
+      pending = 0;
+    }
+    return count;
+  }
+
+  size_t bits() const
+  {
+    return count * 8 + pending;
+  }
+
+private:
+  uint8_t *out;
+  uint64_t acc = 0;
+  uint8_t pending = 0; // bits of acc not yet written out
+  size_t count = 0;
+};
+
+class BitReader
+{
+public:
+  BitReader(const uint8_t *in, size_t size) : in(in), size(size) {}
+
+  // the next width bits, width at most 32; reading past the end gives zeros
+  // and sets overrun
+  uint32_t read(uint8_t width)
+  {
+    if (pending == 0 && width % 8 == 0 && count + width / 8 <= size)
+    {
+      uint32_t value = 0;
+      for (uint8_t k = 0; k < width; k += 8)
+      {
+        value = value << 8 | in[count++];
+      }
+      return value;
+    }
+    while (pending < width)
+    {
+      acc = acc << 8 | next();
+      pending += 8;
+    }
+    pending -= width;
+    return (acc >> pending) & ((1ULL << width) - 1);
+  }
+
+  // the zero bits before the next one, at most limit of them (at most 32),
+  // which are read; the one is not. A word at a time rather than a bit
+  uint8_t zeros(uint8_t limit)
+  {
+    while (pending < limit && count < size)
+    {
+      acc = acc << 8 | in[count++];
+      pending += 8;
+    }
+    uint8_t available = pending < limit ? pending : limit;
+    uint32_t window = available == 0 ? 0 : (acc >> (pending - available)) & ((1ULL << available) - 1);
+    if (window != 0)
+    {
+      uint8_t leading = available - (32 - __builtin_clz(window));
+      pending -= leading;
+      return leading;
+    }
+    pending -= available;
+    if (available < limit)
+    {
+      read(limit - available); // past the end, sets overrun
+    }
+    return limit;
+  }
+
+  void readBytes(uint8_t *bytes, size_t size)
+  {
+    if (pending == 0 && count + size <= this->size)
+    {
+      memcpy(bytes, in + count, size);
+      count += size;
+      return;
+    }
+    for (size_t k = 0; k < size; k++)
+    {
+      bytes[k] = read(8);
+    }
+  }
+
+  size_t bits() const
+  {
+    return count * 8 - pending;
+  }
+
+  bool overrun() const
+  {
+    return overran;
+  }
+
+private:
+  uint8_t next()
+  {
+    if (count < size)
+    {
+      return in[count++];
+    }
+    overran = true;
+    count++;
+    return 0;
+  }
+
+  const uint8_t *in;
+  size_t size;
+  uint64_t acc = 0;
+  uint8_t pending = 0; // bits of acc not yet read
+  size_t count = 0;
+  bool overran = false;
+};
+
+#endif
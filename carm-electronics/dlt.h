@@ -0,0 +1,665 @@
+/**************************************************************
+ *
+ *                     dlt.h
+ *
+ *     Overview: The telemetry packets, each described once as a table of
+ *                  fields, and the templates that generate the DLT
+ *                  transform, the bit packing, the unpacking and the
+ *                  inverse transform from that table
+ *
+ *                  A field is a Telemetry member, a width on the wire and,
+ *                  for a DLT field, its range and spacing:
+ *
+ *                      dlt = floor((reading - n_min) / spacing)
+ *
+ *                  computed as a multiply by the reciprocal of the spacing,
+ *                  precomputed with the table. A reading outside the range
+ *                  (or NaN) is clamped to the nearest end of it, never
+ *                  wrapped, and dlt_transform returns which fields were.
+ *
+ *                  Fields are packed in table order into 64-bit words, most
+ *                  significant bit first; a field that would straddle two
+ *                  words starts the next one. The word and bit of every field
+ *                  are computed at compile time, and each packet is checked
+ *                  with static_assert: no field is wider than 32 bits and the
+ *                  range of each fits in its width. Values given to the
+ *                  packing that do not fit are masked to their width rather
+ *                  than spilling into the next field.
+ *
+ *                  The same fields can instead be streamed back to back,
+ *                  across word boundaries, into DltLayout<Packet>::BYTES
+ *                  bytes rather than WORDS * 8. Their byte offsets are
+ *                  known at compile time too, so this needs no bit cursor;
+ *                  bitstream.h is for frames whose fields vary at run time.
+ *
+ *                  The stages are unrolled field by field at compile time,
+ *                  so each is straight-line code with constant shifts and
+ *                  spacings. Every stage writes into buffers the caller
+ *                  provides, sized by Packet::COUNT, DltLayout<Packet>::WORDS
+ *                  or DltLayout<Packet>::BYTES.
+ *
+ *                  Arduino-free, shared by the flight computer, the ground
+ *                  station and the host tests. BBManager's readings are
+ *                  gathered into a Telemetry in DLTransforms.cpp.
+ *
+ **************************************************************/
+
+#ifndef DLT_H
+#define DLT_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bitpack.h"
+#include "def.h"
+#include "rawimu.h"
+
+constexpr float EXT_TEMP_SPACING = 0.0683927699072;
+constexpr float INT_TEMP_SPACING = 0.0620420127015;
+constexpr float ALTITUDE_SPACING = 0.0999481185339;
+constexpr float VERT_VELO_SPACING = 0.0122074037904;
+constexpr float ACCEL_Z_SPACING = 0.0635075720567;
+constexpr float ACCEL_XY_SPACING = 0.0489236790607;
+constexpr float MAG_FORCE_SPACING = 0.0195694716243;
+constexpr float GYRO_XY_SPACING = 0.0027465846506;
+constexpr float GYRO_Z_SPACING = 0.00549320597234;
+constexpr float GPS_SPEED_SPACING = 0.0684261974585;
+
+// every quantity a packet may carry, as the flight computer read it or as
+// the ground station decoded it
+struct Telemetry
+{
+  uint32_t curr_state;
+  uint32_t timestamp; // ms
+  uint32_t failures;
+  uint32_t gps_fix;
+  uint32_t gps_quality;
+  uint32_t gps_num_satellites;
+  uint32_t gps_antenna_status;
+  float gps_lat;  // degrees
+  float gps_long; // degrees
+  float gps_speed;
+  float gps_altitude;
+  float external_temp;
+  float temperature_engbay;
+  float temperature_avbay;
+  float altitude;
+  float vert_velo;
+  float accel_x;
+  float accel_y;
+  float accel_z;
+  float gyro_x;
+  float gyro_y;
+  float gyro_z;
+  float mag_x;
+  float mag_y;
+  float mag_z;
+  // raw LSM9DS1 counts behind the IMU readings, encoded instead of the
+  // readings with IMU_RAW_COUNTS (see rawimu.h)
+  RawAxes accel_counts;
+  RawAxes gyro_counts;
+  RawAxes mag_counts;
+};
+
+enum class DltKind : uint8_t
+{
+  RAW,    // an integer sent as is
+  LINEAR, // a reading through the DLT
+  IMU,    // LINEAR, from the raw counts with IMU_RAW_COUNTS
+  SIGN,   // 1 if the reading is positive, 0 otherwise
+  MICRO,  // |reading| * 10^6, its sign in the SIGN field before it
+};
+
+// the channel a field is sent on in a delta frame, each with its own rate
+// (dltdelta.h)
+enum class DltChannel : uint8_t
+{
+  FLIGHT,  // the state, timestamp, altitude and vertical velocity
+  IMU,     // accelerations and rotations
+  MAG,     // the magnetometer
+  GPS,     // position, GPS altitude and speed
+  HEALTH,  // GPS status and failure flags
+  THERMAL, // temperatures
+};
+
+constexpr uint8_t DLT_CHANNELS = 6;
+
+// a reading to DLT space: multiplied by the reciprocal of the spacing, no
+// division, and clamped to [0, max]
+struct DltQuantizer
+{
+  float n_min;
+  float inv_spacing;
+  float top; // max + 1, the first reading past the range
+  uint32_t max;
+};
+
+// the largest value in DLT space: the top of the range, or of the width if
+// the range does not fit
+constexpr uint32_t dlt_max(uint8_t width, double range)
+{
+  return range < (double)((1ULL << width) - 1) ? (uint32_t)range : (uint32_t)((1ULL << width) - 1);
+}
+
+constexpr DltQuantizer dlt_quantizer(float n_min, float inv_spacing, uint32_t max)
+{
+  return DltQuantizer{n_min, inv_spacing, max + 1.0f, max};
+}
+
+struct DltField
+{
+  DltKind kind;
+  uint8_t width;
+  int16_t n_min;
+  int16_t n_max;
+  float spacing;
+  uint32_t Telemetry::*value; // RAW
+  float Telemetry::*reading;  // all others
+  RawAxes Telemetry::*counts; // IMU
+  int16_t RawAxes::*axis;     // IMU
+  float count_scale;          // IMU, flight units per count
+  DltQuantizer quantizer;     // LINEAR, IMU and MICRO; RAW only uses max
+  uint8_t delta;              // order of the code of its change in a delta frame, see dltdelta.h
+  DltChannel channel;         // the channel it is sent on in a delta frame
+};
+
+constexpr DltField dlt_raw(uint32_t Telemetry::*value, uint8_t width)
+{
+  return DltField{DltKind::RAW, width, 0, 0, 0, value, nullptr, nullptr, nullptr, 0,
+                  dlt_quantizer(0, 1, dlt_max(width, 4294967295.0)), 0, DltChannel::FLIGHT};
+}
+
+constexpr DltField dlt_linear(float Telemetry::*reading, uint8_t width, int16_t n_min, int16_t n_max,
+                              float spacing)
+{
+  return DltField{DltKind::LINEAR, width, n_min, n_max, spacing, nullptr, reading, nullptr, nullptr, 0,
+                  dlt_quantizer(n_min, 1 / spacing, dlt_max(width, (n_max - n_min) / (double)spacing)), 0,
+                  DltChannel::FLIGHT};
+}
+
+constexpr DltField dlt_imu(float Telemetry::*reading, RawAxes Telemetry::*counts, int16_t RawAxes::*axis,
+                           float count_scale, uint8_t width, int16_t n_min, int16_t n_max, float spacing)
+{
+  return DltField{DltKind::IMU, width, n_min, n_max, spacing, nullptr, reading, counts, axis, count_scale,
+                  dlt_quantizer(n_min, 1 / spacing, dlt_max(width, (n_max - n_min) / (double)spacing)), 0,
+                  DltChannel::FLIGHT};
+}
+
+constexpr DltField dlt_sign(float Telemetry::*reading)
+{
+  return DltField{DltKind::SIGN, 1, 0, 1, 0, nullptr, reading, nullptr, nullptr, 0, dlt_quantizer(0, 1, 1), 0,
+                  DltChannel::FLIGHT};
+}
+
+// n_max: largest magnitude, in whole units
+constexpr DltField dlt_micro(float Telemetry::*reading, uint8_t width, int16_t n_max)
+{
+  return DltField{DltKind::MICRO, width, 0, n_max, 0, nullptr, reading, nullptr, nullptr, 0,
+                  dlt_quantizer(0, 1000000, dlt_max(width, n_max * 1000000.0)), 0, DltChannel::FLIGHT};
+}
+
+// f sent in a delta frame as its change from the keyframe, a change of up to
+// about 2^delta steps in delta + 1 to delta + 3 bits, whenever its channel is
+constexpr DltField dlt_delta(const DltField &f, uint8_t delta, DltChannel channel)
+{
+  return DltField{f.kind, f.width, f.n_min, f.n_max, f.spacing, f.value, f.reading,
+                  f.counts, f.axis, f.count_scale, f.quantizer, delta, channel};
+}
+
+/*
+ * quantize_dlt
+ * Parameters: The sensor reading and the quantizer of its field
+ * Returns: The transformed value of the sensor reading; what the sensor reading is in DLT space.
+ *          saturated is set if the reading was outside the field's range (or NaN) and was
+ *          clamped to its nearest end
+ * Notes: Please read the transmission protocol for more details on how this works
+ */
+inline uint32_t quantize_dlt(float reading, const DltQuantizer &q, bool &saturated)
+{
+  float x = (reading - q.n_min) * q.inv_spacing;
+  saturated = !(x >= 0 && x < q.top);
+  return x >= q.top ? q.max : x >= 0 ? static_cast<uint32_t>(x) : 0;
+}
+
+/*
+ * quantize_dlt
+ * Parameters: count readings, the quantizer of each, and where to put the values in DLT space
+ * Returns: A mask with bit i set if reading i saturated, count is at most 32
+ */
+inline uint32_t quantize_dlt(const float readings[], const DltQuantizer quantizers[], uint32_t values[],
+                             uint8_t count)
+{
+  uint32_t saturated = 0;
+  for (uint8_t i = 0; i < count; i++)
+  {
+    bool s;
+    values[i] = quantize_dlt(readings[i], quantizers[i], s);
+    saturated |= static_cast<uint32_t>(s) << i;
+  }
+  return saturated;
+}
+
+/*
+ * deserialize_dlt
+ * Parameters: A value in DLT space, and the minimum value and DLT spacing of its field
+ * Returns: The true (lossy) sensor reading
+ */
+inline float deserialize_dlt(uint32_t serialized, int n_min, float spacing)
+{
+  return serialized * spacing + n_min;
+}
+
+// compile-time layout: first bit of field i, counted from the most
+// significant bit of the first word
+constexpr unsigned dlt_place(unsigned bit, unsigned width)
+{
+  return bit % 64 + width > 64 ? (bit / 64 + 1) * 64 : bit;
+}
+
+template <typename Packet>
+constexpr unsigned dlt_start(unsigned i)
+{
+  return i == 0 ? 0 : dlt_place(dlt_start<Packet>(i - 1) + Packet::fields[i - 1].width, Packet::fields[i].width);
+}
+
+// bits of the fields before field i, streamed back to back
+template <typename Packet>
+constexpr unsigned dlt_stream_bits(unsigned i)
+{
+  return i == 0 ? 0 : dlt_stream_bits<Packet>(i - 1) + Packet::fields[i - 1].width;
+}
+
+// whether the range of a field fits its width and the order of its change
+// in a delta frame is below its width, a table shorter than its
+// COUNT leaves fields of width 0
+constexpr bool dlt_fits(const DltField &f)
+{
+  return f.width > 0 && f.width <= 32 && f.delta < f.width &&
+         (f.kind == DltKind::LINEAR || f.kind == DltKind::IMU
+              ? (f.n_max - f.n_min) / f.spacing < (double)(1ULL << f.width)
+          : f.kind == DltKind::MICRO ? f.n_max * 1000000.0 < (double)(1ULL << f.width)
+                                     : true);
+}
+
+template <typename Packet>
+struct DltLayout
+{
+  static constexpr unsigned BITS = dlt_start<Packet>(Packet::COUNT - 1) + Packet::fields[Packet::COUNT - 1].width;
+  static constexpr unsigned WORDS = (BITS + 63) / 64;
+  static constexpr unsigned BYTES = (dlt_stream_bits<Packet>(Packet::COUNT) + 7) / 8;
+};
+
+template <typename Packet>
+constexpr unsigned DltLayout<Packet>::BITS;
+template <typename Packet>
+constexpr unsigned DltLayout<Packet>::WORDS;
+template <typename Packet>
+constexpr unsigned DltLayout<Packet>::BYTES;
+
+// the four stages for field I of a packet, then the rest of the packet
+template <typename Packet, uint8_t I = 0, bool END = I == Packet::COUNT>
+struct DltCodec
+{
+  static constexpr unsigned WIDTH = Packet::fields[I].width;
+  static constexpr unsigned START = dlt_start<Packet>(I);
+  static constexpr unsigned WORD = START / 64;
+  static constexpr unsigned LSB = 64 - START % 64 - WIDTH;
+  static constexpr uint64_t MASK = Bitpack_mask(WIDTH);
+  static_assert(dlt_fits(Packet::fields[I]), "a field's range does not fit its width");
+
+  // bit I of the result set if the field saturated
+  static uint32_t transform(const Telemetry &t, uint32_t values[])
+  {
+    constexpr DltField f = Packet::fields[I];
+    bool saturated = false;
+    switch (f.kind)
+    {
+    case DltKind::RAW:
+      saturated = t.*f.value > f.quantizer.max;
+      values[I] = saturated ? f.quantizer.max : t.*f.value;
+      break;
+    case DltKind::LINEAR:
+      values[I] = quantize_dlt(t.*f.reading, f.quantizer, saturated);
+      break;
+    case DltKind::IMU:
+#if IMU_RAW_COUNTS
+      values[I] = quantize_dlt_counts((t.*f.counts).*f.axis, dlt_count_map(f.count_scale, f.n_min, f.spacing),
+                                      f.quantizer.max, saturated);
+#else
+      values[I] = quantize_dlt(t.*f.reading, f.quantizer, saturated);
+#endif
+      break;
+    case DltKind::SIGN:
+      values[I] = t.*f.reading > 0 ? 1 : 0;
+      break;
+    case DltKind::MICRO:
+      values[I] = quantize_dlt(fabsf(t.*f.reading), f.quantizer, saturated);
+      break;
+    }
+    return static_cast<uint32_t>(saturated) << I | DltCodec<Packet, I + 1>::transform(t, values);
+  }
+
+  // words are cleared first
+  static void pack(const uint32_t values[], uint64_t words[])
+  {
+    if (I == 0)
+    {
+      for (unsigned w = 0; w < DltLayout<Packet>::WORDS; w++)
+      {
+        words[w] = 0;
+      }
+    }
+    words[WORD] = Bitpack_newu<WIDTH, LSB>(words[WORD], values[I]);
+    DltCodec<Packet, I + 1>::pack(values, words);
+  }
+
+  static void unpack(const uint64_t words[], uint32_t values[])
+  {
+    values[I] = Bitpack_getu<WIDTH, LSB>(words[WORD]);
+    DltCodec<Packet, I + 1>::unpack(words, values);
+  }
+
+  // the stream: the bytes the field spans, and how far its last bit is from
+  // the end of the last one
+  static constexpr unsigned OFFSET = dlt_stream_bits<Packet>(I);
+  static constexpr unsigned BYTE = OFFSET / 8;
+  static constexpr unsigned SPAN = (OFFSET % 8 + WIDTH + 7) / 8;
+  static constexpr unsigned SHIFT = SPAN * 8 - OFFSET % 8 - WIDTH;
+
+  // a field shares at most its first byte with the one before it, a field
+  // starting on a byte boundary is plain byte stores
+  static void write(const uint32_t values[], uint8_t bytes[])
+  {
+    uint64_t v = (values[I] & MASK) << SHIFT;
+    if (OFFSET % 8 == 0)
+    {
+      bytes[BYTE] = v >> 8 * (SPAN - 1);
+    }
+    else
+    {
+      bytes[BYTE] |= v >> 8 * (SPAN - 1);
+    }
+    for (unsigned k = 1; k < SPAN; k++)
+    {
+      bytes[BYTE + k] = v >> 8 * (SPAN - 1 - k);
+    }
+    DltCodec<Packet, I + 1>::write(values, bytes);
+  }
+
+  static void read(const uint8_t bytes[], uint32_t values[])
+  {
+    uint64_t v = 0;
+    for (unsigned k = 0; k < SPAN; k++)
+    {
+      v = v << 8 | bytes[BYTE + k];
+    }
+    values[I] = (v >> SHIFT) & MASK;
+    DltCodec<Packet, I + 1>::read(bytes, values);
+  }
+
+  // the signs go on once every magnitude has been decoded
+  static void untransform(const uint32_t values[], Telemetry &t)
+  {
+    constexpr DltField f = Packet::fields[I];
+    switch (f.kind)
+    {
+    case DltKind::RAW:
+      t.*f.value = values[I];
+      break;
+    case DltKind::LINEAR:
+    case DltKind::IMU:
+      t.*f.reading = deserialize_dlt(values[I], f.n_min, f.spacing);
+      break;
+    case DltKind::SIGN:
+      break;
+    case DltKind::MICRO:
+      t.*f.reading = values[I] / 1000000.0f;
+      break;
+    }
+    DltCodec<Packet, I + 1>::untransform(values, t);
+    if (f.kind == DltKind::SIGN && values[I] != 1)
+    {
+      t.*f.reading = -(t.*f.reading);
+    }
+  }
+};
+
+template <typename Packet, uint8_t I>
+struct DltCodec<Packet, I, true>
+{
+  static uint32_t transform(const Telemetry &, uint32_t[])
+  {
+    return 0;
+  }
+  static void pack(const uint32_t[], uint64_t[]) {}
+  static void unpack(const uint64_t[], uint32_t[]) {}
+  static void write(const uint32_t[], uint8_t[]) {}
+  static void read(const uint8_t[], uint32_t[]) {}
+  static void untransform(const uint32_t[], Telemetry &) {}
+};
+
+// readings to DLT values, values[Packet::COUNT]; returns a mask with bit i
+// set if field i saturated
+template <typename Packet>
+inline uint32_t dlt_transform(const Telemetry &t, uint32_t values[])
+{
+  static_assert(Packet::COUNT <= 32, "a packet's saturation mask is 32 bits");
+  return DltCodec<Packet>::transform(t, values);
+}
+
+// DLT values to words[DltLayout<Packet>::WORDS]
+template <typename Packet>
+inline void dlt_pack(const uint32_t values[], uint64_t words[])
+{
+  DltCodec<Packet>::pack(values, words);
+}
+
+template <typename Packet>
+inline void dlt_unpack(const uint64_t words[], uint32_t values[])
+{
+  DltCodec<Packet>::unpack(words, values);
+}
+
+// DLT values streamed to bytes[DltLayout<Packet>::BYTES], returns the bytes written
+template <typename Packet>
+inline size_t dlt_write(const uint32_t values[], uint8_t bytes[])
+{
+  DltCodec<Packet>::write(values, bytes);
+  return DltLayout<Packet>::BYTES;
+}
+
+// false, and values untouched, if size is short of the packet
+template <typename Packet>
+inline bool dlt_read(const uint8_t bytes[], size_t size, uint32_t values[])
+{
+  if (size < DltLayout<Packet>::BYTES)
+  {
+    return false;
+  }
+  DltCodec<Packet>::read(bytes, values);
+  return true;
+}
+
+// DLT values back to the (lossy) readings, only the packet's fields are written
+template <typename Packet>
+inline void dlt_untransform(const uint32_t values[], Telemetry &t)
+{
+  DltCodec<Packet>::untransform(values, t);
+}
+
+/*
+ * The packets. Please read the transmission protocol for the meaning of
+ * each field; the order here is the order on the wire. Each is a template
+ * only so its table can be defined in this header, use the typedef. SCHEMA
+ * is the tag a frame of the packet is sent with (dltdelta.h).
+ */
+
+enum class DltSchema : uint8_t
+{
+  POWER_ON,
+  LAUNCH_READY,
+  LAUNCH_MODE,
+  RECOVERY,
+  NO_SCHEMA,
+};
+
+constexpr uint8_t DLT_SCHEMAS = 5;
+
+// the most fields of any packet
+constexpr uint8_t DLT_MAX_COUNT = 27;
+
+constexpr float DLT_ACCEL_SCALE = accel_count_scale(IMU_ACCEL_RANGE_G);
+constexpr float DLT_GYRO_SCALE = gyro_count_scale(IMU_GYRO_RANGE_DPS);
+constexpr float DLT_MAG_SCALE = mag_count_scale(IMU_MAG_RANGE_GAUSS);
+
+// The delta orders are the changes expected over the second between
+// keyframes: the sensor noise, the timestamp's second, a descent of 25 m.
+// Flags and the state change rarely, a bit each while they do not. The
+// channel of a field sets how often a delta frame carries it, see
+// DLT_CHANNEL_RATES in dltdelta.h.
+#define DLT_STATE dlt_delta(dlt_raw(&Telemetry::curr_state, 4), 0, DltChannel::FLIGHT)
+#define DLT_SATELLITES dlt_delta(dlt_raw(&Telemetry::gps_num_satellites, 3), 0, DltChannel::HEALTH)
+#define DLT_GPS_FIX dlt_delta(dlt_raw(&Telemetry::gps_fix, 1), 0, DltChannel::HEALTH)
+#define DLT_GPS_QUALITY dlt_delta(dlt_raw(&Telemetry::gps_quality, 2), 0, DltChannel::HEALTH)
+#define DLT_GPS_ANTENNA dlt_delta(dlt_raw(&Telemetry::gps_antenna_status, 2), 0, DltChannel::HEALTH)
+#define DLT_FAILURES dlt_delta(dlt_raw(&Telemetry::failures, 10), 0, DltChannel::HEALTH)
+#define DLT_TIMESTAMP(width) dlt_delta(dlt_raw(&Telemetry::timestamp, width), 10, DltChannel::FLIGHT)
+#define DLT_EXT_TEMP \
+  dlt_delta(dlt_linear(&Telemetry::external_temp, 11, -15, 125, EXT_TEMP_SPACING), 2, DltChannel::THERMAL)
+#define DLT_ENGBAY_TEMP \
+  dlt_delta(dlt_linear(&Telemetry::temperature_engbay, 11, 0, 127, INT_TEMP_SPACING), 2, DltChannel::THERMAL)
+#define DLT_AVBAY_TEMP \
+  dlt_delta(dlt_linear(&Telemetry::temperature_avbay, 11, 0, 127, INT_TEMP_SPACING), 2, DltChannel::THERMAL)
+#define DLT_ALTITUDE dlt_delta(dlt_linear(&Telemetry::altitude, 15, 0, 3275, ALTITUDE_SPACING), 8, DltChannel::FLIGHT)
+#define DLT_GPS_ALTITUDE \
+  dlt_delta(dlt_linear(&Telemetry::gps_altitude, 15, 0, 3275, ALTITUDE_SPACING), 8, DltChannel::GPS)
+#define DLT_GPS_SPEED dlt_delta(dlt_linear(&Telemetry::gps_speed, 10, 0, 70, GPS_SPEED_SPACING), 3, DltChannel::GPS)
+#define DLT_VERT_VELO \
+  dlt_delta(dlt_linear(&Telemetry::vert_velo, 15, -50, 350, VERT_VELO_SPACING), 5, DltChannel::FLIGHT)
+#define DLT_GPS_LONG                                           \
+  dlt_delta(dlt_sign(&Telemetry::gps_long), 0, DltChannel::GPS), \
+      dlt_delta(dlt_micro(&Telemetry::gps_long, 28, 180), 7, DltChannel::GPS)
+#define DLT_GPS_LAT                                           \
+  dlt_delta(dlt_sign(&Telemetry::gps_lat), 0, DltChannel::GPS), \
+      dlt_delta(dlt_micro(&Telemetry::gps_lat, 27, 90), 7, DltChannel::GPS)
+#define DLT_ACCEL(a, width, n_min, n_max, spacing) \
+  dlt_imu(&Telemetry::accel_##a, &Telemetry::accel_counts, &RawAxes::a, DLT_ACCEL_SCALE, width, n_min, n_max, spacing)
+#define DLT_GYRO(a, width, n_min, n_max, spacing) \
+  dlt_imu(&Telemetry::gyro_##a, &Telemetry::gyro_counts, &RawAxes::a, DLT_GYRO_SCALE, width, n_min, n_max, spacing)
+#define DLT_MAG(a)                                                                                  \
+  dlt_delta(dlt_imu(&Telemetry::mag_##a, &Telemetry::mag_counts, &RawAxes::a, DLT_MAG_SCALE, 11, -5, 5, \
+                    MAG_FORCE_SPACING),                                                               \
+            2, DltChannel::MAG)
+#define DLT_ACCEL_XY(a) dlt_delta(DLT_ACCEL(a, 9, 0, 25, ACCEL_XY_SPACING), 3, DltChannel::IMU)
+#define DLT_ACCEL_Z dlt_delta(DLT_ACCEL(z, 11, -30, 100, ACCEL_Z_SPACING), 3, DltChannel::IMU)
+#define DLT_GYRO_XY(a) dlt_delta(DLT_GYRO(a, 20, -1440, 1440, GYRO_XY_SPACING), 8, DltChannel::IMU)
+#define DLT_GYRO_Z dlt_delta(DLT_GYRO(z, 17, -360, 360, GYRO_Z_SPACING), 6, DltChannel::IMU)
+
+template <typename = void>
+struct PowerOnFields
+{
+  static constexpr DltSchema SCHEMA = DltSchema::POWER_ON;
+  static constexpr uint8_t COUNT = 9;
+  static constexpr DltField fields[COUNT] = {
+      DLT_STATE, DLT_EXT_TEMP, DLT_ENGBAY_TEMP, DLT_AVBAY_TEMP, DLT_GPS_QUALITY,
+      DLT_GPS_FIX, DLT_SATELLITES, DLT_GPS_ANTENNA, DLT_FAILURES,
+  };
+};
+
+template <typename T>
+constexpr DltSchema PowerOnFields<T>::SCHEMA;
+template <typename T>
+constexpr uint8_t PowerOnFields<T>::COUNT;
+template <typename T>
+constexpr DltField PowerOnFields<T>::fields[];
+typedef PowerOnFields<> PowerOnPacket;
+
+template <typename = void>
+struct LaunchReadyFields
+{
+  static constexpr DltSchema SCHEMA = DltSchema::LAUNCH_READY;
+  static constexpr uint8_t COUNT = 26;
+  static constexpr DltField fields[COUNT] = {
+      DLT_STATE, DLT_SATELLITES, DLT_GPS_LONG, DLT_GPS_LAT,
+      DLT_GYRO_XY(x), DLT_ACCEL_XY(y), DLT_GYRO_XY(y), DLT_VERT_VELO,
+      DLT_GYRO_Z, DLT_ACCEL_XY(x), DLT_ALTITUDE, DLT_GPS_FIX, DLT_EXT_TEMP, DLT_AVBAY_TEMP,
+      DLT_ACCEL_Z, DLT_MAG(x), DLT_MAG(y), DLT_MAG(z), DLT_FAILURES, DLT_GPS_SPEED,
+      DLT_GPS_ALTITUDE, DLT_GPS_QUALITY, DLT_ENGBAY_TEMP, DLT_GPS_ANTENNA,
+  };
+};
+
+template <typename T>
+constexpr DltSchema LaunchReadyFields<T>::SCHEMA;
+template <typename T>
+constexpr uint8_t LaunchReadyFields<T>::COUNT;
+template <typename T>
+constexpr DltField LaunchReadyFields<T>::fields[];
+typedef LaunchReadyFields<> LaunchReadyPacket;
+
+template <typename = void>
+struct LaunchModeFields
+{
+  static constexpr DltSchema SCHEMA = DltSchema::LAUNCH_MODE;
+  static constexpr uint8_t COUNT = 27;
+  static constexpr DltField fields[COUNT] = {
+      DLT_STATE, DLT_SATELLITES, DLT_GPS_LONG, DLT_GPS_LAT,
+      DLT_GYRO_XY(x), DLT_GPS_ALTITUDE, DLT_ACCEL_XY(x), DLT_GYRO_XY(y),
+      DLT_TIMESTAMP(19), DLT_GYRO_Z, DLT_ALTITUDE, DLT_GPS_ANTENNA, DLT_EXT_TEMP,
+      DLT_ACCEL_XY(y), DLT_AVBAY_TEMP, DLT_ENGBAY_TEMP, DLT_ACCEL_Z, DLT_MAG(x), DLT_MAG(y),
+      DLT_MAG(z), DLT_FAILURES, DLT_GPS_SPEED, DLT_VERT_VELO, DLT_GPS_QUALITY, DLT_GPS_FIX,
+  };
+};
+
+template <typename T>
+constexpr DltSchema LaunchModeFields<T>::SCHEMA;
+template <typename T>
+constexpr uint8_t LaunchModeFields<T>::COUNT;
+template <typename T>
+constexpr DltField LaunchModeFields<T>::fields[];
+typedef LaunchModeFields<> LaunchModePacket;
+
+template <typename = void>
+struct RecoveryFields
+{
+  static constexpr DltSchema SCHEMA = DltSchema::RECOVERY;
+  static constexpr uint8_t COUNT = 13;
+  static constexpr DltField fields[COUNT] = {
+      DLT_STATE, DLT_SATELLITES, DLT_GPS_LONG, DLT_GPS_LAT,
+      DLT_EXT_TEMP, DLT_ENGBAY_TEMP, DLT_AVBAY_TEMP, DLT_GPS_FIX, DLT_FAILURES, DLT_GPS_QUALITY,
+      DLT_GPS_ANTENNA,
+  };
+};
+
+template <typename T>
+constexpr DltSchema RecoveryFields<T>::SCHEMA;
+template <typename T>
+constexpr uint8_t RecoveryFields<T>::COUNT;
+template <typename T>
+constexpr DltField RecoveryFields<T>::fields[];
+typedef RecoveryFields<> RecoveryPacket;
+
+// the launch mode fields in the order the flight computer sends them over
+// the radio, with a longer timestamp
+template <typename = void>
+struct NoSchemaFields
+{
+  static constexpr DltSchema SCHEMA = DltSchema::NO_SCHEMA;
+  static constexpr uint8_t COUNT = 27;
+  static constexpr DltField fields[COUNT] = {
+      DLT_STATE, DLT_SATELLITES, DLT_GPS_LONG, DLT_GPS_LAT,
+      DLT_TIMESTAMP(25), DLT_GYRO_XY(x), DLT_FAILURES, DLT_ACCEL_XY(y),
+      DLT_GYRO_XY(y), DLT_GYRO_Z, DLT_GPS_ALTITUDE, DLT_GPS_SPEED, DLT_GPS_ANTENNA,
+      DLT_MAG(z), DLT_ALTITUDE, DLT_VERT_VELO, DLT_EXT_TEMP, DLT_AVBAY_TEMP, DLT_GPS_FIX,
+      DLT_ENGBAY_TEMP, DLT_ACCEL_Z, DLT_MAG(y), DLT_ACCEL_XY(x), DLT_MAG(x), DLT_GPS_QUALITY,
+  };
+};
+
+template <typename T>
+constexpr DltSchema NoSchemaFields<T>::SCHEMA;
+template <typename T>
+constexpr uint8_t NoSchemaFields<T>::COUNT;
+template <typename T>
+constexpr DltField NoSchemaFields<T>::fields[];
+typedef NoSchemaFields<> NoSchemaPacket;
+
+#endif
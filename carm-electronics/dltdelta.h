@@ -0,0 +1,579 @@
+/**************************************************************
+ *
+ *                     dltdelta.h
+ *
+ *     Overview: Keyframe and delta frames of the packets in dlt.h, so that
+ *                  frames between keyframes send only what changed. Most
+ *                  fields move a few DLT steps between frames; the
+ *                  coordinates, altitudes and gyros are sent whole in every
+ *                  dlt_write frame all the same.
+ *
+ *                  Every frame opens with a byte: its kind in the top three
+ *                  bits, always with the top bit set so an APRS frame on the
+ *                  same channel (ASCII) is never mistaken for one, and a
+ *                  5-bit sequence number counting every frame sent.
+ *
+ *                  key:     the header, the packet's schema tag in a byte
+ *                           (DltSchema), then the packet as dlt_write
+ *                           streams it
+ *                  delta:   the header, the sequence number of its keyframe
+ *                           in 5 bits, a bit for each channel it carries
+ *                           (DltChannel), then the change of each field of
+ *                           those channels from the keyframe in an
+ *                           Exp-Golomb code; its packet is its keyframe's
+ *                  request: the header alone, sent by the ground station
+ *                           when it holds no keyframe for the deltas it
+ *                           receives
+ *
+ *                  A change d of a field whose delta order is k is coded
+ *                  as z = 2d (d >= 0) or -2d - 1, then v = z + 2^k written
+ *                  in its n significant bits after n - 1 - k zeros: an
+ *                  unchanged field is k + 1 bits, each doubling of the
+ *                  change two more. Once the zeros would reach
+ *                  dlt_escape(field), the code would be as long as the
+ *                  field, and the field is sent whole after that many
+ *                  zeros instead.
+ *
+ *                  Deltas are taken against the last keyframe rather than
+ *                  the previous frame, so a lost delta loses only itself. A
+ *                  lost keyframe loses the deltas after it, which the
+ *                  decoder reports as STALE rather than decoding against
+ *                  the wrong keyframe. Keyframes go out every PERIOD
+ *                  frames, at once after a request or a change of packet,
+ *                  and whenever a delta frame would be larger.
+ *
+ *                  Not every channel needs every frame: the GPS fixes once
+ *                  a second and the temperatures drift over minutes. Each
+ *                  channel is sent every so many frames (DltChannelRate)
+ *                  and the decoder holds the last value of the fields a
+ *                  frame leaves out, so the bytes go to the flight and IMU
+ *                  channels. Given a budget of bytes a frame, the encoder
+ *                  fills it with the due channels by priority and the rest
+ *                  wait a frame. A keyframe carries every channel.
+ *
+ *                  Each LoRa packet costs some 30 ms of preamble and header
+ *                  at the flight settings whatever its size, so the frames
+ *                  pay off most sent several to a packet, back to back: a
+ *                  frame's size is known from its own bits.
+ *
+ *                  The delta orders are part of each packet's table, see
+ *                  dlt_delta in dlt.h.
+ *
+ **************************************************************/
+
+#ifndef DLTDELTA_H
+#define DLTDELTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bitpack.h"
+#include "bitstream.h"
+#include "dlt.h"
+
+enum class DltFrameKind : uint8_t
+{
+  KEY = 0x4,
+  DELTA = 0x5,
+  REQUEST = 0x6,
+};
+
+constexpr uint8_t DLT_SEQUENCE_BITS = 5;
+constexpr uint8_t DLT_SEQUENCE_MASK = (1 << DLT_SEQUENCE_BITS) - 1;
+
+constexpr uint8_t dlt_frame_header(DltFrameKind kind, uint8_t sequence)
+{
+  return static_cast<uint8_t>(kind) << DLT_SEQUENCE_BITS | (sequence & DLT_SEQUENCE_MASK);
+}
+
+// a request for a keyframe into bytes[1], returns its size
+inline size_t dlt_request_keyframe(uint8_t bytes[])
+{
+  bytes[0] = dlt_frame_header(DltFrameKind::REQUEST, 0);
+  return 1;
+}
+
+inline bool dlt_is_request(const uint8_t bytes[], size_t size)
+{
+  return size == 1 && bytes[0] >> DLT_SEQUENCE_BITS == static_cast<uint8_t>(DltFrameKind::REQUEST);
+}
+
+// the zeros after which a field is sent whole
+constexpr uint8_t dlt_escape(const DltField &f)
+{
+  return (f.width - f.delta + 1) / 2;
+}
+
+// bits of the delta frame fields before field i, each sent whole
+template <typename Packet>
+constexpr unsigned dlt_delta_max_bits(unsigned i)
+{
+  return i == 0 ? 0 : dlt_delta_max_bits<Packet>(i - 1) + dlt_escape(Packet::fields[i - 1]) + Packet::fields[i - 1].width;
+}
+
+// bits of the delta frame fields before field i, each unchanged
+template <typename Packet>
+constexpr unsigned dlt_delta_min_bits(unsigned i)
+{
+  return i == 0 ? 0 : dlt_delta_min_bits<Packet>(i - 1) + 1 + Packet::fields[i - 1].delta;
+}
+
+// how often a channel goes in a delta frame, and which go first into a
+// frame short of room
+struct DltChannelRate
+{
+  uint8_t period;   // frames from one send to the next, 1 for every frame
+  uint8_t priority; // 0 first
+};
+
+// by DltChannel, in frames at the flight computer's 20 or so a second
+constexpr DltChannelRate DLT_CHANNEL_RATES[DLT_CHANNELS] = {
+    {1, 0},  // FLIGHT
+    {1, 1},  // IMU
+    {4, 3},  // MAG
+    {10, 2}, // GPS, which fixes once a second
+    {10, 4}, // HEALTH
+    {20, 5}, // THERMAL
+};
+
+// the delta frame before its fields: the header, the keyframe's sequence
+// number and the channel bits
+constexpr unsigned DLT_DELTA_HEADER_BITS = 8 + DLT_SEQUENCE_BITS + DLT_CHANNELS;
+
+template <typename Packet>
+struct DltDeltaLayout
+{
+  static constexpr size_t KEY_BYTES = 2 + DltLayout<Packet>::BYTES;
+  // every channel, every field unchanged
+  static constexpr size_t MIN_DELTA_BYTES = (DLT_DELTA_HEADER_BITS + dlt_delta_min_bits<Packet>(Packet::COUNT) + 7) / 8;
+  // every channel, every field sent whole
+  static constexpr size_t MAX_DELTA_BYTES = (DLT_DELTA_HEADER_BITS + dlt_delta_max_bits<Packet>(Packet::COUNT) + 7) / 8;
+  static constexpr size_t MAX_BYTES = KEY_BYTES > MAX_DELTA_BYTES ? KEY_BYTES : MAX_DELTA_BYTES;
+};
+
+template <typename Packet>
+constexpr size_t DltDeltaLayout<Packet>::KEY_BYTES;
+template <typename Packet>
+constexpr size_t DltDeltaLayout<Packet>::MIN_DELTA_BYTES;
+template <typename Packet>
+constexpr size_t DltDeltaLayout<Packet>::MAX_DELTA_BYTES;
+template <typename Packet>
+constexpr size_t DltDeltaLayout<Packet>::MAX_BYTES;
+
+constexpr size_t dlt_larger(size_t a, size_t b)
+{
+  return a > b ? a : b;
+}
+
+// the largest frame of any packet
+constexpr size_t DLT_MAX_FRAME_BYTES =
+    dlt_larger(dlt_larger(dlt_larger(DltDeltaLayout<PowerOnPacket>::MAX_BYTES, DltDeltaLayout<LaunchReadyPacket>::MAX_BYTES),
+                          dlt_larger(DltDeltaLayout<LaunchModePacket>::MAX_BYTES, DltDeltaLayout<RecoveryPacket>::MAX_BYTES)),
+               DltDeltaLayout<NoSchemaPacket>::MAX_BYTES);
+
+/*
+ * The packet of a schema tag, chosen at run time
+ */
+
+// the table of a schema, nullptr (and count 0) for an unknown tag
+inline const DltField *dlt_fields(DltSchema schema, uint8_t &count)
+{
+  switch (schema)
+  {
+  case DltSchema::POWER_ON:
+    count = PowerOnPacket::COUNT;
+    return PowerOnPacket::fields;
+  case DltSchema::LAUNCH_READY:
+    count = LaunchReadyPacket::COUNT;
+    return LaunchReadyPacket::fields;
+  case DltSchema::LAUNCH_MODE:
+    count = LaunchModePacket::COUNT;
+    return LaunchModePacket::fields;
+  case DltSchema::RECOVERY:
+    count = RecoveryPacket::COUNT;
+    return RecoveryPacket::fields;
+  case DltSchema::NO_SCHEMA:
+    count = NoSchemaPacket::COUNT;
+    return NoSchemaPacket::fields;
+  }
+  count = 0;
+  return nullptr;
+}
+
+// dlt_read of the packet of a schema, false for an unknown tag
+inline bool dlt_read(DltSchema schema, const uint8_t bytes[], size_t size, uint32_t values[])
+{
+  switch (schema)
+  {
+  case DltSchema::POWER_ON:
+    return dlt_read<PowerOnPacket>(bytes, size, values);
+  case DltSchema::LAUNCH_READY:
+    return dlt_read<LaunchReadyPacket>(bytes, size, values);
+  case DltSchema::LAUNCH_MODE:
+    return dlt_read<LaunchModePacket>(bytes, size, values);
+  case DltSchema::RECOVERY:
+    return dlt_read<RecoveryPacket>(bytes, size, values);
+  case DltSchema::NO_SCHEMA:
+    return dlt_read<NoSchemaPacket>(bytes, size, values);
+  }
+  return false;
+}
+
+// dlt_pack of the packet of a schema into words[5], returns the words
+// written, 0 for an unknown tag
+inline unsigned dlt_pack(DltSchema schema, const uint32_t values[], uint64_t words[])
+{
+  switch (schema)
+  {
+  case DltSchema::POWER_ON:
+    dlt_pack<PowerOnPacket>(values, words);
+    return DltLayout<PowerOnPacket>::WORDS;
+  case DltSchema::LAUNCH_READY:
+    dlt_pack<LaunchReadyPacket>(values, words);
+    return DltLayout<LaunchReadyPacket>::WORDS;
+  case DltSchema::LAUNCH_MODE:
+    dlt_pack<LaunchModePacket>(values, words);
+    return DltLayout<LaunchModePacket>::WORDS;
+  case DltSchema::RECOVERY:
+    dlt_pack<RecoveryPacket>(values, words);
+    return DltLayout<RecoveryPacket>::WORDS;
+  case DltSchema::NO_SCHEMA:
+    dlt_pack<NoSchemaPacket>(values, words);
+    return DltLayout<NoSchemaPacket>::WORDS;
+  }
+  return 0;
+}
+
+// dlt_untransform of the packet of a schema, false for an unknown tag
+inline bool dlt_untransform(DltSchema schema, const uint32_t values[], Telemetry &t)
+{
+  switch (schema)
+  {
+  case DltSchema::POWER_ON:
+    dlt_untransform<PowerOnPacket>(values, t);
+    return true;
+  case DltSchema::LAUNCH_READY:
+    dlt_untransform<LaunchReadyPacket>(values, t);
+    return true;
+  case DltSchema::LAUNCH_MODE:
+    dlt_untransform<LaunchModePacket>(values, t);
+    return true;
+  case DltSchema::RECOVERY:
+    dlt_untransform<RecoveryPacket>(values, t);
+    return true;
+  case DltSchema::NO_SCHEMA:
+    dlt_untransform<NoSchemaPacket>(values, t);
+    return true;
+  }
+  return false;
+}
+
+template <uint8_t PERIOD = 20>
+class DltDeltaEncoder
+{
+public:
+  // budget: the bytes a delta frame is kept to, 0 for no limit; the most
+  // urgent due channel is sent whatever its size
+  explicit DltDeltaEncoder(size_t budget = 0, const DltChannelRate rates[] = DLT_CHANNEL_RATES)
+      : budget(budget), rates(rates)
+  {
+    for (uint8_t c = 0; c < DLT_CHANNELS; c++)
+    {
+      uint8_t k = c;
+      for (; k > 0 && rates[order[k - 1]].priority > rates[c].priority; k--)
+      {
+        order[k] = order[k - 1];
+      }
+      order[k] = c;
+    }
+  }
+
+  // the next frame, values of Packet, into bytes[DltDeltaLayout<Packet>::MAX_BYTES],
+  // returns its size
+  template <typename Packet>
+  size_t encode(const uint32_t values[], uint8_t bytes[])
+  {
+    static_assert(Packet::COUNT <= DLT_MAX_COUNT, "DLT_MAX_COUNT is short of a packet");
+    uint8_t sequence = next_sequence++;
+    if (since_key < PERIOD && key_schema == Packet::SCHEMA)
+    {
+      uint8_t channels;
+      size_t size = encodeDelta(Packet::fields, Packet::COUNT, values, sequence, bytes, channels);
+      if (size < DltDeltaLayout<Packet>::KEY_BYTES)
+      {
+        since_key++;
+        sent(channels);
+        return size;
+      }
+    }
+    for (uint8_t i = 0; i < Packet::COUNT; i++)
+    {
+      key[i] = values[i] & Bitpack_mask(Packet::fields[i].width);
+    }
+    key_schema = Packet::SCHEMA;
+    key_sequence = sequence;
+    since_key = 1;
+    sent((1 << DLT_CHANNELS) - 1);
+    bytes[0] = dlt_frame_header(DltFrameKind::KEY, sequence);
+    bytes[1] = static_cast<uint8_t>(Packet::SCHEMA);
+    return 2 + dlt_write<Packet>(key, bytes + 2);
+  }
+
+  // the next frame is a keyframe
+  void requestKeyframe()
+  {
+    since_key = PERIOD;
+  }
+
+private:
+  // channels is set to the bits of those the frame carries
+  size_t encodeDelta(const DltField fields[], uint8_t count, const uint32_t values[], uint8_t sequence,
+                     uint8_t bytes[], uint8_t &channels) const
+  {
+    // each field's zeros and code, a field sent whole being its value
+    uint8_t zeros[DLT_MAX_COUNT], code_bits[DLT_MAX_COUNT];
+    uint64_t codes[DLT_MAX_COUNT];
+    unsigned channel_bits[DLT_CHANNELS] = {};
+    for (uint8_t i = 0; i < count; i++)
+    {
+      const DltField &f = fields[i];
+      uint32_t value = values[i] & Bitpack_mask(f.width);
+      int64_t change = static_cast<int64_t>(value) - key[i];
+      codes[i] = (change >= 0 ? 2 * change : -2 * change - 1) + (1ULL << f.delta);
+      zeros[i] = 63 - __builtin_clzll(codes[i]) - f.delta;
+      if (zeros[i] < dlt_escape(f))
+      {
+        code_bits[i] = zeros[i] + 1 + f.delta;
+      }
+      else
+      {
+        zeros[i] = dlt_escape(f);
+        codes[i] = value;
+        code_bits[i] = f.width;
+      }
+      channel_bits[static_cast<uint8_t>(f.channel)] += zeros[i] + code_bits[i];
+    }
+
+    unsigned bits = DLT_DELTA_HEADER_BITS;
+    channels = 0;
+    for (uint8_t k = 0; k < DLT_CHANNELS; k++)
+    {
+      uint8_t c = order[k];
+      if (age[c] + 1 < rates[c].period ||
+          (budget != 0 && channels != 0 && (bits + channel_bits[c] + 7) / 8 > budget))
+      {
+        continue;
+      }
+      channels |= 1 << c;
+      bits += channel_bits[c];
+    }
+
+    BitWriter out(bytes);
+    out.write(dlt_frame_header(DltFrameKind::DELTA, sequence), 8);
+    out.write(key_sequence, DLT_SEQUENCE_BITS);
+    out.write(channels, DLT_CHANNELS);
+    for (uint8_t i = 0; i < count; i++)
+    {
+      if (channels >> static_cast<uint8_t>(fields[i].channel) & 1)
+      {
+        out.write(0, zeros[i]);
+        out.write(codes[i], code_bits[i]);
+      }
+    }
+    return out.finish();
+  }
+
+  void sent(uint8_t channels)
+  {
+    for (uint8_t c = 0; c < DLT_CHANNELS; c++)
+    {
+      age[c] = channels >> c & 1 ? 0 : age[c] < 255 ? age[c] + 1 : 255;
+    }
+  }
+
+  size_t budget;
+  const DltChannelRate *rates;
+  uint8_t order[DLT_CHANNELS];   // the channels, most urgent first
+  uint8_t age[DLT_CHANNELS] = {}; // frames since each was sent
+  uint32_t key[DLT_MAX_COUNT];
+  DltSchema key_schema = DltSchema::POWER_ON;
+  uint8_t key_sequence = 0;
+  uint8_t next_sequence = 0;
+  uint8_t since_key = PERIOD; // the first frame is a keyframe
+};
+
+enum class DltDecoded : uint8_t
+{
+  VALUES,    // values holds the packet of schema(), fresh() those in the frame
+  STALE,     // a delta against a keyframe that was lost, request one; its
+             // size is unknown, so nothing after it in the bytes is usable
+  REQUEST,   // a keyframe request, not for the ground station
+  MALFORMED, // not a frame, too short for its kind, or of an unknown schema
+};
+
+class DltDeltaDecoder
+{
+public:
+  // one received frame, values[DLT_MAX_COUNT] is written only for VALUES
+  DltDecoded decode(const uint8_t bytes[], size_t size, uint32_t values[])
+  {
+    size_t used;
+    return decode(bytes, size, values, used);
+  }
+
+  // the first of the frames sent back to back in bytes; used is set to its
+  // size, where the next frame starts, unless MALFORMED. A STALE frame's
+  // size depends on the keyframe that was lost, so used is the rest of the
+  // bytes
+  DltDecoded decode(const uint8_t bytes[], size_t size, uint32_t values[], size_t &used)
+  {
+    if (size == 0)
+    {
+      return DltDecoded::MALFORMED;
+    }
+    uint8_t kind = bytes[0] >> DLT_SEQUENCE_BITS;
+    uint8_t sequence = bytes[0] & DLT_SEQUENCE_MASK;
+    if (dlt_is_request(bytes, size))
+    {
+      used = 1;
+      return DltDecoded::REQUEST;
+    }
+    if (kind == static_cast<uint8_t>(DltFrameKind::KEY))
+    {
+      uint8_t count;
+      uint32_t read[DLT_MAX_COUNT];
+      DltSchema schema = static_cast<DltSchema>(size > 1 ? bytes[1] : 0xFF);
+      const DltField *fields = dlt_fields(schema, count);
+      if (size < 2 || fields == nullptr || !dlt_read(schema, bytes + 2, size - 2, read))
+      {
+        return DltDecoded::MALFORMED;
+      }
+      used = 2 + (streamBits(fields, count) + 7) / 8;
+      countFrame(sequence);
+      have_key = true;
+      key_schema = schema;
+      key_sequence = sequence;
+      fresh_fields = (1ULL << count) - 1;
+      for (uint8_t i = 0; i < count; i++)
+      {
+        key[i] = read[i];
+        last[i] = read[i];
+        values[i] = read[i];
+      }
+      return DltDecoded::VALUES;
+    }
+    if (kind != static_cast<uint8_t>(DltFrameKind::DELTA))
+    {
+      return DltDecoded::MALFORMED;
+    }
+
+    // a delta's fields are those of the keyframe it names. Without that
+    // keyframe the fields, and so the frame's size, are unknown: the last
+    // keyframe may be of another schema
+    BitReader in(bytes + 1, size - 1);
+    uint8_t against = in.read(DLT_SEQUENCE_BITS);
+    if (in.overrun())
+    {
+      return DltDecoded::MALFORMED;
+    }
+    if (!have_key || against != key_sequence)
+    {
+      countFrame(sequence);
+      have_key = false;
+      used = size;
+      return DltDecoded::STALE;
+    }
+
+    // the fields of the channels it leaves out keep their last values
+    uint8_t channels = in.read(DLT_CHANNELS);
+    uint8_t count;
+    const DltField *fields = dlt_fields(key_schema, count);
+    uint32_t decoded[DLT_MAX_COUNT];
+    uint32_t present = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+      const DltField &f = fields[i];
+      if (!(channels >> static_cast<uint8_t>(f.channel) & 1))
+      {
+        decoded[i] = last[i];
+        continue;
+      }
+      present |= 1UL << i;
+      uint8_t zeros = in.zeros(dlt_escape(f));
+      if (zeros == dlt_escape(f))
+      {
+        decoded[i] = in.read(f.width);
+        continue;
+      }
+      uint64_t code = in.read(zeros + 1 + f.delta) - (1ULL << f.delta);
+      int64_t change = code & 1 ? -static_cast<int64_t>(code >> 1) - 1 : static_cast<int64_t>(code >> 1);
+      decoded[i] = (key[i] + change) & Bitpack_mask(f.width);
+    }
+    if (in.overrun())
+    {
+      return DltDecoded::MALFORMED;
+    }
+    used = 1 + (in.bits() + 7) / 8;
+    countFrame(sequence);
+    fresh_fields = present;
+    for (uint8_t i = 0; i < count; i++)
+    {
+      last[i] = decoded[i];
+      values[i] = decoded[i];
+    }
+    return DltDecoded::VALUES;
+  }
+
+  // the packet of the last frame decoded to VALUES
+  DltSchema schema() const
+  {
+    return key_schema;
+  }
+
+  // bit i set if field i of schema() was in the last frame decoded to
+  // VALUES, the others held from an earlier one
+  uint32_t fresh() const
+  {
+    return fresh_fields;
+  }
+
+  // frames missing from the sequence numbers so far, counting a gap of more
+  // than 31 frames short
+  uint32_t lost() const
+  {
+    return lost_frames;
+  }
+
+private:
+  static unsigned streamBits(const DltField fields[], uint8_t count)
+  {
+    unsigned bits = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+      bits += fields[i].width;
+    }
+    return bits;
+  }
+
+  void countFrame(uint8_t sequence)
+  {
+    if (started)
+    {
+      lost_frames += (sequence - next_sequence) & DLT_SEQUENCE_MASK;
+    }
+    started = true;
+    next_sequence = (sequence + 1) & DLT_SEQUENCE_MASK;
+  }
+
+  uint32_t key[DLT_MAX_COUNT];
+  uint32_t last[DLT_MAX_COUNT];
+  uint32_t fresh_fields = 0;
+  DltSchema key_schema = DltSchema::POWER_ON;
+  bool have_key = false;
+  uint8_t key_sequence = 0;
+  bool started = false;
+  uint8_t next_sequence = 0;
+  uint32_t lost_frames = 0;
+};
+
+#endif
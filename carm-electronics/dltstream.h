@@ -0,0 +1,276 @@
+/**************************************************************
+ *
+ *                     dltstream.h
+ *
+ *     Overview: The ground station's log of the LoRa packets it receives,
+ *                  and the decoding of that log into telemetry records,
+ *                  the same on the ground station and on the computer it
+ *                  is plugged into
+ *
+ *                  The ground station writes each packet to its serial
+ *                  port as a log record:
+ *
+ *                      DLT_LOG_SYNC, the packet's length, the packet
+ *
+ *                  DltStream is pushed the bytes of the log in pieces of
+ *                  any size as they come, finds the records in them,
+ *                  decodes the frames of each packet (dltdelta.h) and hands
+ *                  a DltRecord for each to a sink. Bytes outside a record,
+ *                  as when the port is opened partway through one, or the
+ *                  ground station's own messages (ASCII, never the sync
+ *                  byte), are skipped up to the next sync byte. A packet
+ *                  that is not telemetry, such as APRS on the same
+ *                  channel, is counted and passed over, as is the rest of
+ *                  a packet from a delta against a lost keyframe.
+ *
+ *                  A record holds every quantity as a column (DLT_COLUMNS),
+ *                  which of them the packet carries and which of those the
+ *                  frame itself did, the rest held from earlier frames.
+ *
+ *                  Arduino-free, shared by the ground station, the ground
+ *                  decoder library and the host tests.
+ *
+ **************************************************************/
+
+#ifndef DLTSTREAM_H
+#define DLTSTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dlt.h"
+#include "dltdelta.h"
+
+constexpr uint8_t DLT_LOG_SYNC = 0xA5;
+// the longest LoRa packet, RH_RF95_MAX_MESSAGE_LEN
+constexpr uint8_t DLT_LOG_MAX_PACKET = 251;
+
+// the header of the log record of a packet of size bytes into bytes[2],
+// returns its size
+inline size_t dlt_log_header(uint8_t size, uint8_t bytes[])
+{
+  bytes[0] = DLT_LOG_SYNC;
+  bytes[1] = size;
+  return 2;
+}
+
+// a quantity of Telemetry, the one of value and reading that is not null
+struct DltColumn
+{
+  const char *name;
+  uint32_t Telemetry::*value;
+  float Telemetry::*reading;
+};
+
+constexpr uint8_t DLT_COLUMN_COUNT = 25;
+
+constexpr DltColumn DLT_COLUMNS[DLT_COLUMN_COUNT] = {
+    {"curr_state", &Telemetry::curr_state, nullptr},
+    {"timestamp", &Telemetry::timestamp, nullptr},
+    {"failures", &Telemetry::failures, nullptr},
+    {"gps_fix", &Telemetry::gps_fix, nullptr},
+    {"gps_quality", &Telemetry::gps_quality, nullptr},
+    {"gps_num_satellites", &Telemetry::gps_num_satellites, nullptr},
+    {"gps_antenna_status", &Telemetry::gps_antenna_status, nullptr},
+    {"gps_lat", nullptr, &Telemetry::gps_lat},
+    {"gps_long", nullptr, &Telemetry::gps_long},
+    {"gps_speed", nullptr, &Telemetry::gps_speed},
+    {"gps_altitude", nullptr, &Telemetry::gps_altitude},
+    {"external_temp", nullptr, &Telemetry::external_temp},
+    {"temperature_engbay", nullptr, &Telemetry::temperature_engbay},
+    {"temperature_avbay", nullptr, &Telemetry::temperature_avbay},
+    {"altitude", nullptr, &Telemetry::altitude},
+    {"vert_velo", nullptr, &Telemetry::vert_velo},
+    {"accel_x", nullptr, &Telemetry::accel_x},
+    {"accel_y", nullptr, &Telemetry::accel_y},
+    {"accel_z", nullptr, &Telemetry::accel_z},
+    {"gyro_x", nullptr, &Telemetry::gyro_x},
+    {"gyro_y", nullptr, &Telemetry::gyro_y},
+    {"gyro_z", nullptr, &Telemetry::gyro_z},
+    {"mag_x", nullptr, &Telemetry::mag_x},
+    {"mag_y", nullptr, &Telemetry::mag_y},
+    {"mag_z", nullptr, &Telemetry::mag_z},
+};
+
+// the column a field decodes to, DLT_COLUMN_COUNT if none
+inline uint8_t dlt_column_of(const DltField &f)
+{
+  for (uint8_t c = 0; c < DLT_COLUMN_COUNT; c++)
+  {
+    if (f.kind == DltKind::RAW ? DLT_COLUMNS[c].value == f.value : DLT_COLUMNS[c].reading == f.reading)
+    {
+      return c;
+    }
+  }
+  return DLT_COLUMN_COUNT;
+}
+
+inline double dlt_column_value(const Telemetry &t, uint8_t c)
+{
+  return DLT_COLUMNS[c].value != nullptr ? t.*DLT_COLUMNS[c].value : t.*DLT_COLUMNS[c].reading;
+}
+
+struct DltRecord
+{
+  DltSchema schema;
+  uint32_t columns; // bit c set if the packet carries column c
+  uint32_t fresh;   // of those, the ones in the frame
+  Telemetry telemetry;
+};
+
+struct DltStreamStats
+{
+  uint64_t bytes;     // pushed
+  uint64_t skipped;   // outside a record, or from a stale frame on in one
+  uint64_t packets;   // records
+  uint64_t frames;    // decoded to a DltRecord
+  uint64_t stale;     // deltas against a lost keyframe
+  uint64_t malformed; // packets, or the rest of them, that are not telemetry
+};
+
+class DltStream
+{
+public:
+  DltStream()
+  {
+    for (uint8_t s = 0; s < DLT_SCHEMAS; s++)
+    {
+      uint8_t count;
+      const DltField *fields = dlt_fields(static_cast<DltSchema>(s), count);
+      columns[s] = 0;
+      for (uint8_t i = 0; i < count; i++)
+      {
+        field_columns[s][i] = dlt_column_of(fields[i]);
+        columns[s] |= 1UL << field_columns[s][i];
+      }
+    }
+  }
+
+  // the next bytes of the log; sink(const DltRecord &) is called for each
+  // frame decoded, in order
+  template <typename Sink>
+  void push(const uint8_t bytes[], size_t size, Sink &sink)
+  {
+    counts.bytes += size;
+    while (size > 0)
+    {
+      // a record whole in bytes is decoded where it is, the start of one
+      // is held until the rest comes
+      if (pending_size == 0)
+      {
+        if (bytes[0] != DLT_LOG_SYNC)
+        {
+          counts.skipped++;
+          bytes++;
+          size--;
+          continue;
+        }
+        if (size >= 2 && !isLength(bytes[1]))
+        {
+          counts.skipped++;
+          bytes++;
+          size--;
+          continue;
+        }
+        if (size >= 2 && size >= 2u + bytes[1])
+        {
+          decodePacket(bytes + 2, bytes[1], sink);
+          size -= 2 + bytes[1];
+          bytes += 2 + bytes[1];
+          continue;
+        }
+      }
+      size_t take = pending_size < 2 ? 1 : 2 + pending[1] - pending_size;
+      take = take < size ? take : size;
+      memcpy(pending + pending_size, bytes, take);
+      pending_size += take;
+      bytes += take;
+      size -= take;
+      if (pending_size == 2 && !isLength(pending[1]))
+      {
+        // not a record after all, look for a sync byte from the length on
+        counts.skipped++;
+        pending_size = 0;
+        bytes--;
+        size++;
+      }
+      else if (pending_size >= 2 && pending_size == 2u + pending[1])
+      {
+        pending_size = 0;
+        decodePacket(pending + 2, pending[1], sink);
+      }
+    }
+  }
+
+  const DltStreamStats &stats() const
+  {
+    return counts;
+  }
+
+  // frames missing from the sequence numbers, see DltDeltaDecoder::lost
+  uint32_t lost() const
+  {
+    return decoder.lost();
+  }
+
+private:
+  static bool isLength(uint8_t size)
+  {
+    return size > 0 && size <= DLT_LOG_MAX_PACKET;
+  }
+
+  template <typename Sink>
+  void decodePacket(const uint8_t packet[], size_t size, Sink &sink)
+  {
+    counts.packets++;
+    size_t offset = 0;
+    while (offset < size)
+    {
+      size_t used;
+      uint32_t values[DLT_MAX_COUNT];
+      DltDecoded decoded = decoder.decode(packet + offset, size - offset, values, used);
+      if (decoded == DltDecoded::MALFORMED)
+      {
+        counts.malformed++;
+        return;
+      }
+      if (decoded == DltDecoded::STALE)
+      {
+        // its size is unknown, so is where the next frame starts
+        counts.stale++;
+        counts.skipped += size - offset;
+        return;
+      }
+      offset += used;
+      if (decoded != DltDecoded::VALUES)
+      {
+        continue;
+      }
+
+      uint8_t s = static_cast<uint8_t>(decoder.schema());
+      uint8_t count;
+      dlt_fields(decoder.schema(), count);
+      record.schema = decoder.schema();
+      record.columns = columns[s];
+      record.fresh = 0;
+      for (uint8_t i = 0; i < count; i++)
+      {
+        record.fresh |= (decoder.fresh() >> i & 1UL) << field_columns[s][i];
+      }
+      dlt_untransform(decoder.schema(), values, record.telemetry);
+      counts.frames++;
+      sink(static_cast<const DltRecord &>(record));
+    }
+  }
+
+  DltDeltaDecoder decoder;
+  DltRecord record = {};
+  uint32_t columns[DLT_SCHEMAS];
+  uint8_t field_columns[DLT_SCHEMAS][DLT_MAX_COUNT];
+  uint8_t pending[2 + DLT_LOG_MAX_PACKET];
+  size_t pending_size = 0;
+  DltStreamStats counts = {};
+};
+
+#endif
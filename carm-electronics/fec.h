@@ -0,0 +1,371 @@
+/**************************************************************
+ *
+ *                     fec.h
+ *
+ *     Overview: Reed-Solomon forward error correction of a LoRa packet, so
+ *                  a packet with a few bytes in error is corrected at the
+ *                  ground rather than lost to the radio's CRC
+ *
+ *                  A coded packet is a marker byte three times, the packet,
+ *                  then its parity bytes. The marker has the top three bits
+ *                  set, a frame kind no telemetry frame (dltdelta.h) or
+ *                  APRS packet starts with, and half the parity bytes in the
+ *                  low five. The copies are voted, so one byte in error does
+ *                  not lose the packet.
+ *
+ *                  The packet and its parity are a codeword of the
+ *                  RS(255, 255 - parity) code over GF(2^8), shortened to the
+ *                  packet's length: the generator's roots are a^1 to
+ *                  a^parity, a a root of x^8 + x^4 + x^3 + x^2 + 1. Up to
+ *                  parity / 2 bytes in error are corrected wherever they
+ *                  are. A LoRa packet (at most 251 bytes) is always a single
+ *                  codeword, so interleaving several within a packet would
+ *                  correct nothing more.
+ *
+ *                  For the errors to reach the decoder a coded packet is
+ *                  sent without the radio's CRC, and received with the
+ *                  receiver's CRC off and any header address accepted
+ *                  (RH_RF95::setPayloadCRC, setPromiscuous). A plain packet
+ *                  is sent with the CRC, which the radio still checks, and
+ *                  passes through the decoder untouched.
+ *
+ *                  Arduino-free, shared by the flight computer, the ground
+ *                  station and the host tests.
+ *
+ **************************************************************/
+
+#ifndef FEC_H
+#define FEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+constexpr uint8_t FEC_MARKER_COPIES = 3;
+constexpr uint8_t FEC_MARKER_KIND = 0xE0;
+constexpr uint8_t FEC_MAX_PARITY = 62;
+constexpr size_t FEC_MAX_CODEWORD = 255;
+
+// the bytes parity adds to a packet
+constexpr size_t fec_overhead(uint8_t parity)
+{
+  return parity == 0 ? 0 : FEC_MARKER_COPIES + parity;
+}
+
+constexpr bool fec_is_marker(uint8_t byte)
+{
+  return (byte & FEC_MARKER_KIND) == FEC_MARKER_KIND && (byte & ~FEC_MARKER_KIND) != 0;
+}
+
+// GF(2^8): a^k for k up to 509, so the sum of two logarithms needs no
+// reduction, and the logarithm of each non-zero element
+struct Gf256
+{
+  uint8_t exp[510];
+  uint8_t log[256];
+
+  Gf256()
+  {
+    uint16_t x = 1;
+    for (uint16_t k = 0; k < 255; k++)
+    {
+      exp[k] = x;
+      exp[k + 255] = x;
+      log[x] = k;
+      x <<= 1;
+      if (x & 0x100)
+      {
+        x ^= 0x11D;
+      }
+    }
+    log[0] = 0; // never used
+  }
+
+  uint8_t mul(uint8_t a, uint8_t b) const
+  {
+    return a == 0 || b == 0 ? 0 : exp[log[a] + log[b]];
+  }
+
+  // b non-zero
+  uint8_t div(uint8_t a, uint8_t b) const
+  {
+    return a == 0 ? 0 : exp[log[a] + 255 - log[b]];
+  }
+
+  // a^k, k up to 254 * 2
+  uint8_t power(uint16_t k) const
+  {
+    return exp[k % 255];
+  }
+};
+
+inline const Gf256 &gf256()
+{
+  static const Gf256 field;
+  return field;
+}
+
+/*
+ * rs_encode
+ * Parameters: size data bytes, the parity bytes to add and the generator for them (FecEncoder)
+ * Returns: Nothing, the parity bytes go to parity[parity_size]
+ */
+inline void rs_encode(const uint8_t data[], size_t size, const uint8_t generator[], uint8_t parity_size,
+                      uint8_t parity[])
+{
+  const Gf256 &gf = gf256();
+  memset(parity, 0, parity_size);
+  // parity[0] is the coefficient of the highest power, as it is sent
+  for (size_t k = 0; k < size; k++)
+  {
+    uint8_t feedback = data[k] ^ parity[0];
+    memmove(parity, parity + 1, parity_size - 1);
+    parity[parity_size - 1] = 0;
+    if (feedback != 0)
+    {
+      uint8_t log_feedback = gf.log[feedback];
+      for (uint8_t i = 0; i < parity_size; i++)
+      {
+        if (generator[i] != 0)
+        {
+          parity[i] ^= gf.exp[log_feedback + gf.log[generator[i]]];
+        }
+      }
+    }
+  }
+}
+
+/*
+ * rs_decode
+ * Parameters: A codeword of size bytes (at most 255), the last parity_size of them parity
+ * Returns: The bytes corrected, -1 (and the codeword untouched) if there are more errors than
+ *          parity_size / 2 or they cannot be placed within the codeword
+ */
+inline int rs_decode(uint8_t codeword[], size_t size, uint8_t parity_size)
+{
+  const Gf256 &gf = gf256();
+  if (size > FEC_MAX_CODEWORD || parity_size == 0 || parity_size > FEC_MAX_PARITY || size <= parity_size)
+  {
+    return -1;
+  }
+
+  // the syndromes, the codeword at each root of the generator
+  uint8_t syndromes[FEC_MAX_PARITY];
+  bool clean = true;
+  for (uint8_t j = 0; j < parity_size; j++)
+  {
+    uint8_t s = 0;
+    uint8_t log_root = j + 1;
+    for (size_t k = 0; k < size; k++)
+    {
+      s = (s == 0 ? 0 : gf.exp[gf.log[s] + log_root]) ^ codeword[k];
+    }
+    syndromes[j] = s;
+    clean &= s == 0;
+  }
+  if (clean)
+  {
+    return 0;
+  }
+
+  // Berlekamp-Massey: the error locator, whose roots are the inverses of
+  // the errors' positions
+  uint8_t locator[FEC_MAX_PARITY + 1] = {1}, previous[FEC_MAX_PARITY + 1] = {1};
+  uint8_t errors = 0, shift = 1, previous_discrepancy = 1;
+  for (uint8_t r = 0; r < parity_size; r++)
+  {
+    uint8_t discrepancy = syndromes[r];
+    for (uint8_t i = 1; i <= errors; i++)
+    {
+      discrepancy ^= gf.mul(locator[i], syndromes[r - i]);
+    }
+    if (discrepancy == 0)
+    {
+      shift++;
+      continue;
+    }
+    uint8_t scale = gf.div(discrepancy, previous_discrepancy);
+    uint8_t before[FEC_MAX_PARITY + 1];
+    memcpy(before, locator, sizeof(before));
+    for (uint8_t i = 0; i + shift <= parity_size; i++)
+    {
+      locator[i + shift] ^= gf.mul(scale, previous[i]);
+    }
+    if (2 * errors <= r)
+    {
+      errors = r + 1 - errors;
+      memcpy(previous, before, sizeof(previous));
+      previous_discrepancy = discrepancy;
+      shift = 1;
+    }
+    else
+    {
+      shift++;
+    }
+  }
+  if (2 * errors > parity_size)
+  {
+    return -1;
+  }
+
+  // Chien search: byte k is in error if the locator is zero at a^-(size - 1 - k)
+  uint8_t positions[FEC_MAX_PARITY / 2];
+  uint8_t found = 0;
+  for (size_t k = 0; k < size && found <= errors; k++)
+  {
+    uint16_t log_inverse = 255 - (size - 1 - k) % 255;
+    uint8_t value = 0;
+    for (uint8_t i = 0; i <= errors; i++)
+    {
+      if (locator[i] != 0)
+      {
+        value ^= gf.exp[gf.log[locator[i]] + (log_inverse * i) % 255];
+      }
+    }
+    if (value == 0)
+    {
+      if (found == errors)
+      {
+        return -1;
+      }
+      positions[found++] = k;
+    }
+  }
+  if (found != errors)
+  {
+    return -1;
+  }
+
+  // Forney: the error evaluator S(x)L(x) mod x^parity over the locator's
+  // derivative, at each error's inverse
+  uint8_t evaluator[FEC_MAX_PARITY];
+  for (uint8_t i = 0; i < parity_size; i++)
+  {
+    uint8_t e = 0;
+    for (uint8_t j = 0; j <= i && j <= errors; j++)
+    {
+      e ^= gf.mul(syndromes[i - j], locator[j]);
+    }
+    evaluator[i] = e;
+  }
+  uint8_t values[FEC_MAX_PARITY / 2];
+  for (uint8_t f = 0; f < found; f++)
+  {
+    uint16_t log_inverse = 255 - (size - 1 - positions[f]) % 255;
+    uint8_t numerator = 0, denominator = 0;
+    for (uint8_t i = 0; i < parity_size; i++)
+    {
+      numerator ^= gf.mul(evaluator[i], gf.power(log_inverse * i % 255));
+    }
+    for (uint8_t i = 1; i <= errors; i += 2)
+    {
+      denominator ^= gf.mul(locator[i], gf.power(log_inverse * (i - 1) % 255));
+    }
+    if (denominator == 0)
+    {
+      return -1;
+    }
+    values[f] = gf.div(numerator, denominator);
+  }
+  for (uint8_t f = 0; f < found; f++)
+  {
+    codeword[positions[f]] ^= values[f];
+  }
+  return found;
+}
+
+class FecEncoder
+{
+public:
+  /*
+   * encode
+   * Parameters: A packet of size bytes at the start of a buffer of capacity bytes, and the
+   *             parity bytes to add (even, at most FEC_MAX_PARITY; 0 for none)
+   * Returns: The size of the coded packet, in place of the plain one. The parity is cut to
+   *          what fits the buffer and the codeword, and the packet left plain if none does
+   */
+  size_t encode(uint8_t bytes[], size_t size, size_t capacity, uint8_t parity)
+  {
+    parity = parity > FEC_MAX_PARITY ? FEC_MAX_PARITY : parity & ~1;
+    size_t room = capacity > size + FEC_MARKER_COPIES ? capacity - size - FEC_MARKER_COPIES : 0;
+    size_t codeword_room = FEC_MAX_CODEWORD > size ? FEC_MAX_CODEWORD - size : 0;
+    room = room < codeword_room ? room : codeword_room;
+    parity = parity <= room ? parity : room & ~1;
+    if (parity == 0 || size == 0)
+    {
+      return size;
+    }
+    if (parity != generator_size)
+    {
+      buildGenerator(parity);
+    }
+    memmove(bytes + FEC_MARKER_COPIES, bytes, size);
+    memset(bytes, FEC_MARKER_KIND | parity / 2, FEC_MARKER_COPIES);
+    rs_encode(bytes + FEC_MARKER_COPIES, size, generator, parity, bytes + FEC_MARKER_COPIES + size);
+    return FEC_MARKER_COPIES + size + parity;
+  }
+
+private:
+  // the generator's coefficients below its leading one, the highest power first
+  void buildGenerator(uint8_t parity)
+  {
+    const Gf256 &gf = gf256();
+    uint8_t g[FEC_MAX_PARITY + 1] = {1}; // g[i] the coefficient of x^i
+    for (uint8_t j = 1; j <= parity; j++)
+    {
+      uint8_t root = gf.power(j);
+      for (uint8_t i = j; i > 0; i--)
+      {
+        g[i] = g[i - 1] ^ gf.mul(root, g[i]);
+      }
+      g[0] = gf.mul(root, g[0]);
+    }
+    for (uint8_t i = 0; i < parity; i++)
+    {
+      generator[i] = g[parity - 1 - i];
+    }
+    generator_size = parity;
+  }
+
+  uint8_t generator[FEC_MAX_PARITY];
+  uint8_t generator_size = 0;
+};
+
+/*
+ * fec_decode
+ * Parameters: A packet as received, of size bytes
+ * Returns: The bytes corrected, 0 for a plain packet, -1 for a coded packet with more errors
+ *          than its parity corrects. A coded packet is corrected in place and moved to the
+ *          start of bytes, size set to its plain size
+ * Notes:
+ *      - A plain packet never starts with a marker. One whose first byte is not a marker
+ *            but whose next two are the same marker is taken for a coded packet with its
+ *            first marker in error if it decodes as one, else left plain
+ */
+inline int fec_decode(uint8_t bytes[], size_t &size)
+{
+  if (size < FEC_MARKER_COPIES)
+  {
+    return 0;
+  }
+  uint8_t a = bytes[0], b = bytes[1], c = bytes[2];
+  uint8_t voted = (a & b) | (a & c) | (b & c);
+  bool first = fec_is_marker(a);
+  bool others = b == c && fec_is_marker(b);
+  if (!first && !others)
+  {
+    return 0;
+  }
+  uint8_t marker = fec_is_marker(voted) ? voted : first ? a : b;
+  uint8_t parity = (marker & ~FEC_MARKER_KIND) * 2;
+  int corrected = rs_decode(bytes + FEC_MARKER_COPIES, size - FEC_MARKER_COPIES, parity);
+  if (corrected < 0)
+  {
+    return first ? -1 : 0;
+  }
+  size -= FEC_MARKER_COPIES + parity;
+  memmove(bytes, bytes + FEC_MARKER_COPIES, size);
+  return corrected + (a != marker) + (b != marker) + (c != marker);
+}
+
+#endif
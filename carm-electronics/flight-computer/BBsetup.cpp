@@ -37,9 +37,18 @@ bool setup_IMU(Adafruit_LSM9DS1 &lsm_obj)
         }
         else
         {
-            lsm_obj.setupAccel(lsm_obj.LSM9DS1_ACCELRANGE_4G);
-            lsm_obj.setupMag(lsm_obj.LSM9DS1_MAGGAIN_4GAUSS);
-            lsm_obj.setupGyro(lsm_obj.LSM9DS1_GYROSCALE_500DPS);
+            // ranges from def.h, the raw count scales are derived from them
+            lsm_obj.setupAccel(IMU_ACCEL_RANGE_G == 2   ? lsm_obj.LSM9DS1_ACCELRANGE_2G
+                               : IMU_ACCEL_RANGE_G == 4 ? lsm_obj.LSM9DS1_ACCELRANGE_4G
+                               : IMU_ACCEL_RANGE_G == 8 ? lsm_obj.LSM9DS1_ACCELRANGE_8G
+                                                        : lsm_obj.LSM9DS1_ACCELRANGE_16G);
+            lsm_obj.setupMag(IMU_MAG_RANGE_GAUSS == 4    ? lsm_obj.LSM9DS1_MAGGAIN_4GAUSS
+                             : IMU_MAG_RANGE_GAUSS == 8  ? lsm_obj.LSM9DS1_MAGGAIN_8GAUSS
+                             : IMU_MAG_RANGE_GAUSS == 12 ? lsm_obj.LSM9DS1_MAGGAIN_12GAUSS
+                                                         : lsm_obj.LSM9DS1_MAGGAIN_16GAUSS);
+            lsm_obj.setupGyro(IMU_GYRO_RANGE_DPS == 245   ? lsm_obj.LSM9DS1_GYROSCALE_245DPS
+                              : IMU_GYRO_RANGE_DPS == 500 ? lsm_obj.LSM9DS1_GYROSCALE_500DPS
+                                                          : lsm_obj.LSM9DS1_GYROSCALE_2000DPS);
             Serial.println("Complete!");
             return true;
         }
@@ -1,4 +0,0 @@
-bool simulate_drogue_deploy()
-{
-    return true;
-}
\ No newline at end of file
@@ -6,39 +6,108 @@
 #include "algebra.h"
 #include "altitude.h"
 
+// Mahony feedback gains, tuned on the G53FJ IMU log with
+// tests/filter-tests/attitude_bench.cpp
+static const float MAHONY_KP = 0.5;
+static const float MAHONY_KI = 0.0;
+// trust the accelerometer as a gravity reference only within 0.15 g of 1 g
+static const float MAHONY_ACCEL_GATE = 0.15;
+
 AltitudeEstimator::AltitudeEstimator(float sigmaAccel, float sigmaGyro, float sigmaBaro,
-                                     float ca, float accelThreshold)
-    : kalman(ca, sigmaGyro, sigmaAccel), complementary(sigmaAccel, sigmaBaro, accelThreshold)
+                                     float ca, float accelThreshold, float sigmaGps,
+                                     AttitudeEngine engine)
+    : kalman(ca, sigmaGyro, sigmaAccel), mahony(MAHONY_KP, MAHONY_KI, MAHONY_ACCEL_GATE),
+      complementary(sigmaAccel, sigmaBaro, accelThreshold),
+      gpsComplementary(sigmaAccel, sigmaGps, accelThreshold)
 {
+        if (engine == AttitudeEngine::MAHONY)
+        {
+                attitude = &mahony;
+        }
+        else
+        {
+                attitude = &kalman;
+        }
         this->sigmaAccel = sigmaAccel;
         this->sigmaGyro = sigmaGyro;
         this->sigmaBaro = sigmaBaro;
+        this->sigmaGps = sigmaGps;
         this->ca = ca;
         this->accelThreshold = accelThreshold;
 }
 
-void AltitudeEstimator::estimate(float accel[3], float gyro[3], float baroHeight, uint32_t timestamp)
+void AltitudeEstimator::propagateTo(uint32_t timestamp)
 {
-        float deltat = (float)(timestamp - previousTime) / 1000.0f;
-        float verticalAccel = kalman.estimate(pastGyro,
-                                              pastAccel,
-                                              deltat);
-        complementary.estimate(&estimatedVelocity,
-                               &estimatedAltitude,
-                               baroHeight,
-                               pastAltitude,
-                               pastVerticalVelocity,
-                               pastVerticalAccel,
-                               deltat);
+        // measurements older than the current estimate are applied as they are
+        if ((int32_t)(timestamp - stateTime) <= 0)
+        {
+                return;
+        }
+        float deltat = (float)(timestamp - stateTime) / 1e6f;
+        complementary.propagate(&estimatedVelocity, &estimatedAltitude,
+                                pastVerticalAccel, deltat);
+        stateTime = timestamp;
+}
+
+void AltitudeEstimator::predict(float accel[3], float gyro[3], uint32_t timestamp)
+{
+        if (!initialized)
+        {
+                copyVector(pastGyro, gyro);
+                copyVector(pastAccel, accel);
+                copyVector(padAxis, accel);
+                normalizeVector(padAxis);
+                previousTime = timestamp;
+                stateTime = timestamp;
+                initialized = true;
+                return;
+        }
+        float deltat = (float)(timestamp - previousTime) / 1e6f;
+        float verticalAccel = attitude->estimate(pastGyro,
+                                                 pastAccel,
+                                                 deltat);
+        propagateTo(timestamp);
         // update values for next iteration
         copyVector(pastGyro, gyro);
         copyVector(pastAccel, accel);
-        pastAltitude = estimatedAltitude;
-        pastVerticalVelocity = estimatedVelocity;
         pastVerticalAccel = verticalAccel;
         previousTime = timestamp;
 }
 
+void AltitudeEstimator::predict(float accel[3], float gyro[3], float mag[3], uint32_t timestamp)
+{
+        attitude->setMagnetometer(mag);
+        predict(accel, gyro, timestamp);
+}
+
+void AltitudeEstimator::updateBaro(float baroHeight, uint32_t timestamp)
+{
+        propagateTo(timestamp);
+        // the gains are rates, the first measurement has no interval to scale them by
+        float deltat = baroSeen ? (float)(timestamp - previousBaroTime) / 1e6f : 0;
+        complementary.correct(&estimatedVelocity, &estimatedAltitude, baroHeight, deltat);
+        // once per barometer sample, as the single-rate filter did, so the
+        // window's length in time does not shrink as the IMU rate rises
+        complementary.zeroVelocity(&estimatedVelocity);
+        previousBaroTime = timestamp;
+        baroSeen = true;
+}
+
+void AltitudeEstimator::updateGps(float gpsHeight, uint32_t timestamp)
+{
+        propagateTo(timestamp);
+        float deltat = gpsSeen ? (float)(timestamp - previousGpsTime) / 1e6f : 0;
+        gpsComplementary.correct(&estimatedVelocity, &estimatedAltitude, gpsHeight, deltat);
+        previousGpsTime = timestamp;
+        gpsSeen = true;
+}
+
+void AltitudeEstimator::estimate(float accel[3], float gyro[3], float baroHeight, uint32_t timestamp)
+{
+        predict(accel, gyro, timestamp);
+        updateBaro(baroHeight, timestamp);
+}
+
 float AltitudeEstimator::getAltitude()
 {
         // return the last estimated altitude
@@ -57,18 +126,44 @@ float AltitudeEstimator::getVerticalAcceleration()
         return pastVerticalAccel;
 }
 
+float AltitudeEstimator::getTilt()
+{
+        float up[3];
+        float cosTilt;
+        attitude->getUpVector(up);
+        dotProductVectors(& cosTilt, up, padAxis);
+        if (cosTilt > 1)
+        {
+                cosTilt = 1;
+        }
+        else if (cosTilt < -1)
+        {
+                cosTilt = -1;
+        }
+        return acos(cosTilt) * 180.0f / M_PI;
+}
+
+float AltitudeEstimator::getRollRate()
+{
+        float rollRate;
+        dotProductVectors(& rollRate, pastGyro, padAxis);
+        return rollRate;
+}
+
 void AltitudeEstimator::resetPriors()
 {
         pastGyro[0] = 0;
         pastGyro[1] = 0;
-        pastGyro[3] = 0;
+        pastGyro[2] = 0;
         pastAccel[0] = 0;
         pastAccel[1] = 0;
-        pastAccel[3] = 0;
+        pastAccel[2] = 0;
         pastVerticalAccel = 0;
-        pastVerticalVelocity = 0;
-        pastAltitude = 0;
+        initialized = false;
+        baroSeen = false;
+        gpsSeen = false;
         previousTime = 0;
+        stateTime = 0;
         estimatedAltitude = 0;
         estimatedVelocity = 0;
 }
@@ -76,4 +171,6 @@ void AltitudeEstimator::resetPriors()
 void AltitudeEstimator::setInitTime(unsigned long time)
 {
         previousTime = time;
-}
\ No newline at end of file
+        stateTime = time;
+        initialized = true;
+}
@@ -1,12 +1,29 @@
 /*
     altitude.h: Altitude estimation via barometer/accelerometer fusion
+
+    The IMU and the height sensors are fed independently so each can run at
+    its own rate: predict() integrates every IMU sample, updateBaro() and
+    updateGps() correct the propagated state whenever a new height arrives.
+    estimate() keeps the old single-rate behaviour for callers that sample
+    everything together.
+
+    Vertical acceleration comes from an AttitudeFilter: the 3x3 gravity
+    Kalman filter, or the cheaper Mahony quaternion filter which also makes
+    use of the magnetometer.
 */
 
 #pragma once
 
+#include <stdint.h>
+
 #include "filters.h"
 #include "algebra.h"
-#include <Arduino.h>
+
+enum class AttitudeEngine
+{
+  KALMAN = 0,
+  MAHONY
+};
 
 class AltitudeEstimator
 {
@@ -17,31 +34,67 @@ private:
   float sigmaAccel;
   float sigmaGyro;
   float sigmaBaro;
+  float sigmaGps;
   // Acceleration markov chain model state transition constant
   float ca;
   // Zero-velocity update acceleration threshold
   float accelThreshold;
   // gravity
   float g = 9.81;
-  // For computing the sampling period
-  uint32_t previousTime = millis();
+  // For computing the sampling periods. The first IMU sample only sets the
+  // clock, so no sampling period is computed against an arbitrary origin
+  bool initialized = false;
+  uint32_t previousTime = 0;      // last IMU sample
+  uint32_t stateTime = 0;         // time the altitude/velocity estimate refers to
+  uint32_t previousBaroTime = 0;  // last barometer correction
+  uint32_t previousGpsTime = 0;   // last GPS correction
+  bool baroSeen = false;
+  bool gpsSeen = false;
   // required filters for altitude and vertical velocity estimation
   KalmanFilter kalman;
+  MahonyFilter mahony;
+  // whichever of the two above was selected at construction
+  AttitudeFilter *attitude;
   ComplementaryFilter complementary;
+  // same filter structure, gains derived from the GPS altitude noise
+  ComplementaryFilter gpsComplementary;
   // Estimated past vertical acceleration
   float pastVerticalAccel = 0;
-  float pastVerticalVelocity = 0;
-  float pastAltitude = 0;
   float pastGyro[3] = {0, 0, 0};
   float pastAccel[3] = {0, 0, 0};
+  // body axis that pointed up at the first sample (the rocket's long axis
+  // when sitting on the pad), reference for tilt and roll rate
+  float padAxis[3] = {0, 0, 1};
   // estimated altitude and vertical velocity
   float estimatedAltitude = 0;
   float estimatedVelocity = 0;
 
+  // brings the altitude/velocity estimate forward to timestamp using the
+  // last vertical acceleration, without touching the attitude filter
+  void propagateTo(uint32_t timestamp);
+
 public:
   AltitudeEstimator(float sigmaAccel, float sigmaGyro, float sigmaBaro,
-                    float ca, float accelThreshold);
+                    float ca, float accelThreshold, float sigmaGps,
+                    AttitudeEngine engine = AttitudeEngine::KALMAN);
 
+  // IMU time update, accel in g and gyro in rad/s, timestamp in us (the
+  // low 32 bits of the FlightClock; only differences are used, so the wrap
+  // every 71.6 minutes does no harm)
+  void predict(float accel[3], float gyro[3], uint32_t timestamp);
+
+  // same as above with a magnetometer sample (any unit) for the Mahony engine
+  void predict(float accel[3], float gyro[3], float mag[3], uint32_t timestamp);
+
+  // barometric height measurement update, height in meters above the pad
+  void updateBaro(float baroHeight, uint32_t timestamp);
+
+  // GPS height measurement update. The height has to be referenced to the
+  // same origin as the barometer (i.e. GPS altitude minus the pad's GPS
+  // altitude), not mean sea level
+  void updateGps(float gpsHeight, uint32_t timestamp);
+
+  // single-rate update: predict() followed by updateBaro() at one timestamp
   void estimate(float accel[3], float gyro[3], float baroHeight, uint32_t timestamp);
 
   float getAltitude();
@@ -50,6 +103,12 @@ public:
 
   float getVerticalAcceleration();
 
+  // angle between the pad axis and the estimated vertical, in degrees
+  float getTilt();
+
+  // angular rate about the pad axis, in rad/s
+  float getRollRate();
+
   void resetPriors();
 
   void setInitTime(unsigned long time);
@@ -0,0 +1,85 @@
+/*
+    apogee.cpp: Ballistic apogee prediction during coast
+*/
+
+#include <math.h>
+
+#include "apogee.h"
+
+ApogeePredictor::ApogeePredictor(float smoothing, float minDragVelocity)
+{
+        this->smoothing = smoothing;
+        this->minDragVelocity = minDragVelocity;
+}
+
+void ApogeePredictor::update(float altitude, float velocity, float accel, uint32_t timestamp)
+{
+        lastTime = timestamp;
+        ascending = velocity > 0;
+        if (!ascending)
+        {
+                timeToApogee = 0;
+                apogeeAltitude = altitude;
+                return;
+        }
+
+        // deceleration beyond gravity is drag; under thrust it is negative
+        // and the sample is skipped
+        float dragAccel = -accel - g;
+        if (velocity > minDragVelocity && dragAccel > 0)
+        {
+                float sample = dragAccel / (velocity * velocity);
+                drag = dragSamples ? drag + smoothing * (sample - drag) : sample;
+                if (dragSamples < UINT16_MAX)
+                {
+                        dragSamples++;
+                }
+        }
+
+        if (drag > 0)
+        {
+                float rootGk = sqrt(g * drag);
+                timeToApogee = atan(velocity * rootGk / g) / rootGk;
+                apogeeAltitude = altitude + log(1 + drag * velocity * velocity / g) / (2 * drag);
+        }
+        else
+        {
+                timeToApogee = velocity / g;
+                apogeeAltitude = altitude + velocity * velocity / (2 * g);
+        }
+}
+
+bool ApogeePredictor::valid(uint16_t minSamples)
+{
+        return dragSamples >= minSamples;
+}
+
+float ApogeePredictor::getTimeToApogee()
+{
+        return timeToApogee;
+}
+
+uint32_t ApogeePredictor::getApogeeTime()
+{
+        return lastTime + (uint32_t)(timeToApogee * 1e6f);
+}
+
+float ApogeePredictor::getApogeeAltitude()
+{
+        return apogeeAltitude;
+}
+
+float ApogeePredictor::getDragCoefficient()
+{
+        return drag;
+}
+
+void ApogeePredictor::reset()
+{
+        drag = 0;
+        dragSamples = 0;
+        lastTime = 0;
+        timeToApogee = 0;
+        apogeeAltitude = 0;
+        ascending = false;
+}
@@ -0,0 +1,62 @@
+/*
+    apogee.h: Ballistic apogee prediction during coast
+
+    After burnout the rocket decelerates as a = -g - k*v^2, k being the drag
+    per unit mass. k is estimated from the vertical acceleration and velocity
+    the AltitudeEstimator already produces (smoothed over samples), and the
+    closed-form solution of that model gives the time and altitude of apogee:
+
+        t_apo = atan(v*sqrt(k/g)) / sqrt(g*k)
+        h_apo = h + ln(1 + k*v^2/g) / (2*k)
+
+    which falls back to the drag-free t = v/g, h + v^2/(2g) while k is
+    unknown. Each update costs a handful of multiplies, one atan and one log.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+class ApogeePredictor
+{
+
+private:
+  // weight of a new drag sample in the exponential average
+  float smoothing;
+  // minimum speed at which drag is measured, below it the estimate of k is
+  // dominated by the acceleration noise
+  float minDragVelocity;
+  float g = 9.81;
+  // drag per unit mass, 1/m
+  float drag = 0;
+  uint16_t dragSamples = 0;
+  // predictions made at the last update
+  uint32_t lastTime = 0;
+  float timeToApogee = 0;
+  float apogeeAltitude = 0;
+  bool ascending = false;
+
+public:
+  ApogeePredictor(float smoothing, float minDragVelocity);
+
+  // altitude (m), vertical velocity (m/s), vertical acceleration (m/s^2)
+  // from the estimator, timestamp in us as for the estimator
+  void update(float altitude, float velocity, float accel, uint32_t timestamp);
+
+  // true once k has been measured over minSamples updates while ascending
+  bool valid(uint16_t minSamples);
+
+  // seconds from the last update until apogee, 0 once descending
+  float getTimeToApogee();
+
+  // absolute time of the predicted apogee, in us, low 32 bits
+  uint32_t getApogeeTime();
+
+  // predicted apogee altitude, m
+  float getApogeeAltitude();
+
+  float getDragCoefficient();
+
+  void reset();
+
+}; // class ApogeePredictor
@@ -0,0 +1,84 @@
+/*
+    barometer.cpp: Pressure to altitude conversion without pow()
+*/
+
+#include <math.h>
+
+#include "barometer.h"
+
+static const float RATIO_MIN = 0.5f;
+static const float RATIO_MAX = 1.1f;
+static const int SEGMENTS = 256;
+static const float SEGMENTS_PER_RATIO = SEGMENTS / (RATIO_MAX - RATIO_MIN);
+
+// 44330 * (1 - r^0.1903) for r = RATIO_MIN + (RATIO_MAX - RATIO_MIN) * i / SEGMENTS
+static const float ALTITUDE_TABLE[SEGMENTS + 1] = {
+        5478.1482f, 5443.5567f, 5409.0957f, 5374.7640f, 5340.5605f, 5306.4843f,
+        5272.5342f, 5238.7091f, 5205.0082f, 5171.4303f, 5137.9745f, 5104.6398f,
+        5071.4251f, 5038.3296f, 5005.3523f, 4972.4922f, 4939.7485f, 4907.1201f,
+        4874.6063f, 4842.2061f, 4809.9185f, 4777.7429f, 4745.6782f, 4713.7236f,
+        4681.8784f, 4650.1416f, 4618.5124f, 4586.9901f, 4555.5738f, 4524.2627f,
+        4493.0561f, 4461.9531f, 4430.9530f, 4400.0551f, 4369.2586f, 4338.5627f,
+        4307.9668f, 4277.4700f, 4247.0718f, 4216.7713f, 4186.5679f, 4156.4608f,
+        4126.4495f, 4096.5332f, 4066.7112f, 4036.9829f, 4007.3477f, 3977.8048f,
+        3948.3537f, 3918.9937f, 3889.7241f, 3860.5445f, 3831.4540f, 3802.4522f,
+        3773.5385f, 3744.7122f, 3715.9727f, 3687.3196f, 3658.7521f, 3630.2697f,
+        3601.8719f, 3573.5581f, 3545.3277f, 3517.1802f, 3489.1151f, 3461.1318f,
+        3433.2298f, 3405.4086f, 3377.6676f, 3350.0063f, 3322.4243f, 3294.9209f,
+        3267.4958f, 3240.1484f, 3212.8782f, 3185.6847f, 3158.5675f, 3131.5261f,
+        3104.5600f, 3077.6687f, 3050.8518f, 3024.1089f, 2997.4394f, 2970.8429f,
+        2944.3190f, 2917.8672f, 2891.4872f, 2865.1783f, 2838.9404f, 2812.7728f,
+        2786.6752f, 2760.6472f, 2734.6883f, 2708.7982f, 2682.9765f, 2657.2226f,
+        2631.5364f, 2605.9172f, 2580.3648f, 2554.8788f, 2529.4588f, 2504.1044f,
+        2478.8152f, 2453.5909f, 2428.4310f, 2403.3353f, 2378.3033f, 2353.3347f,
+        2328.4291f, 2303.5862f, 2278.8057f, 2254.0871f, 2229.4301f, 2204.8345f,
+        2180.2998f, 2155.8257f, 2131.4119f, 2107.0580f, 2082.7638f, 2058.5288f,
+        2034.3529f, 2010.2356f, 1986.1766f, 1962.1756f, 1938.2324f, 1914.3466f,
+        1890.5178f, 1866.7459f, 1843.0304f, 1819.3711f, 1795.7678f, 1772.2200f,
+        1748.7275f, 1725.2901f, 1701.9074f, 1678.5791f, 1655.3050f, 1632.0847f,
+        1608.9181f, 1585.8048f, 1562.7446f, 1539.7371f, 1516.7822f, 1493.8795f,
+        1471.0288f, 1448.2298f, 1425.4823f, 1402.7860f, 1380.1406f, 1357.5459f,
+        1335.0016f, 1312.5076f, 1290.0634f, 1267.6690f, 1245.3240f, 1223.0282f,
+        1200.7813f, 1178.5832f, 1156.4336f, 1134.3322f, 1112.2788f, 1090.2732f,
+        1068.3151f, 1046.4044f, 1024.5407f, 1002.7239f, 980.9538f, 959.2300f,
+        937.5525f, 915.9210f, 894.3352f, 872.7949f, 851.3000f, 829.8503f,
+        808.4454f, 787.0852f, 765.7695f, 744.4981f, 723.2708f, 702.0873f,
+        680.9476f, 659.8513f, 638.7982f, 617.7883f, 596.8212f, 575.8968f,
+        555.0149f, 534.1753f, 513.3778f, 492.6223f, 471.9084f, 451.2361f,
+        430.6052f, 410.0154f, 389.4666f, 368.9586f, 348.4913f, 328.0644f,
+        307.6777f, 287.3312f, 267.0245f, 246.7576f, 226.5303f, 206.3424f,
+        186.1937f, 166.0840f, 146.0132f, 125.9812f, 105.9877f, 86.0326f,
+        66.1157f, 46.2369f, 26.3959f, 6.5927f, -13.1729f, -32.9011f,
+        -52.5921f, -72.2459f, -91.8628f, -111.4430f, -130.9864f, -150.4934f,
+        -169.9641f, -189.3986f, -208.7970f, -228.1596f, -247.4864f, -266.7777f,
+        -286.0335f, -305.2540f, -324.4394f, -343.5897f, -362.7052f, -381.7860f,
+        -400.8322f, -419.8439f, -438.8213f, -457.7646f, -476.6738f, -495.5492f,
+        -514.3908f, -533.1987f, -551.9732f, -570.7143f, -589.4222f, -608.0970f,
+        -626.7389f, -645.3479f, -663.9242f, -682.4679f, -700.9792f, -719.4581f,
+        -737.9049f, -756.3196f, -774.7023f, -793.0533f, -811.3725f,
+};
+
+PressureAltitude::PressureAltitude(float seaLevelHpa)
+{
+        setSeaLevelPressure(seaLevelHpa);
+}
+
+void PressureAltitude::setSeaLevelPressure(float seaLevelHpa)
+{
+        invSeaLevel = 1.0f / seaLevelHpa;
+}
+
+float PressureAltitude::altitude(float pressureHpa) const
+{
+        float ratio = pressureHpa * invSeaLevel;
+        float position = (ratio - RATIO_MIN) * SEGMENTS_PER_RATIO;
+        // also false for NaN, which pow() passes through
+        if (!(position >= 0 && position < SEGMENTS))
+        {
+                return 44330.0f * (1.0f - powf(ratio, 0.1903f));
+        }
+        int index = (int)position;
+        float fraction = position - index;
+        float low = ALTITUDE_TABLE[index];
+        return low + fraction * (ALTITUDE_TABLE[index + 1] - low);
+}
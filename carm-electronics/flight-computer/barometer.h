@@ -0,0 +1,38 @@
+/*
+    barometer.h: Pressure to altitude conversion without pow()
+
+    The BMP3XX library converts with the international barometric formula,
+
+        h = 44330 * (1 - (P/P0)^0.1903)
+
+    in double precision soft-float, which on the M0 costs far more than the
+    rest of the barometer path. h only depends on the pressure ratio
+    r = P/P0, so it is tabulated once over r in [0.5, 1.1] (about -810 m to
+    5480 m, the 0-3275 m DLT range from any launch site below 2 km) and
+    linearly interpolated: one multiply by the precomputed 1/P0, one to
+    index the table and a lerp.
+
+    Maximum error against the formula is 1.1 cm from 0 to 3275 m and 1.7 cm
+    at the top of the table, against 0.5 m of sensor noise
+    (tests/profiling/baro_altitude_bench.cpp). Ratios outside the table fall
+    back to powf().
+*/
+
+#pragma once
+
+class PressureAltitude
+{
+
+private:
+  float invSeaLevel;
+
+public:
+  // sea level pressure in hPa, SEALEVELPRESSURE_HPA unless known on the day
+  PressureAltitude(float seaLevelHpa);
+
+  void setSeaLevelPressure(float seaLevelHpa);
+
+  // pressure in hPa to altitude in m above the sea level pressure
+  float altitude(float pressureHpa) const;
+
+}; // class PressureAltitude
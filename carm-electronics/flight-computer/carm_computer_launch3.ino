@@ -11,7 +11,8 @@
 #include "BBManager.h"
 #include "BBsetup.h"
 #include "DLTransforms.h"
-#include "compression.h"
+#include "pyro.h"
+#include "flightclock.h"
 
 Adafruit_LSM9DS1 lsm = Adafruit_LSM9DS1();                 // imu
 Adafruit_BMP3XX bmp;                                       // barometric pressure sensor
@@ -24,6 +25,14 @@ File error_data;                                           // file object for er
 BBManager bboard_manager = BBManager();
 StateDeterminer state_determiner = StateDeterminer();
 RH_RF95 rf95(RFM95_CS, RFM95_INT);
+PyroScheduler pyro(ARDUINO_PYRO_GPIO, PYRO_SENSE_DELAY * 1000UL);
+TelemetryEncoder telemetry_frames;
+FecEncoder telemetry_fec;
+uint8_t telemetry_packet[RH_RF95_MAX_MESSAGE_LEN];
+uint8_t telemetry_packet_size = 0;
+uint8_t telemetry_packet_frames = 0;
+uint8_t drogue_channel;
+uint8_t main_channel;
 
 const char *callsign = "KC1SIL";
 const char *destination_callsign = "APRS"; // generic destination SSID
@@ -71,8 +80,38 @@ void createAPRSPacket(char *buffer, float lat_degree_minutes, char lat_dir,
              callsign, destination_callsign, cf_pi, info_field, fcs_str);
 }
 
+// fires the charge of the state just entered, from the sample the transition
+// was decided on; the pulse itself is run by pyro.tick() from the loop
+void schedulePyro(state entered, uint64_t time)
+{
+    PyroAction action = {time, PYRO_HOLD * 1000UL, PYRO_RETRIES, PYRO_RETRY_INTERVAL * 1000UL};
+    if (entered == state::APOGEE_PHASE)
+    {
+        pyro.schedule(drogue_channel, action);
+    }
+    else if (entered == state::MAIN_DEPLOY_ATTEMPT)
+    {
+        pyro.schedule(main_channel, action);
+    }
+}
+
+// waitPacketSent, ticking the pyro channels while the radio transmits so a
+// pulse's on-time does not stretch by the packet's airtime
+void waitPacketSentTicking()
+{
+    while (rf95.mode() == RHGenericDriver::RHModeTx)
+    {
+        pyro.tick(flight_clock.now());
+    }
+    pyro.tick(flight_clock.now());
+}
+
 void setup()
 {
+    // pyro pins first, so they are held low from as early as possible
+    drogue_channel = pyro.addChannel(DROGUE_PYRO_PIN);
+    main_channel = pyro.addChannel(MAIN_PYRO_PIN);
+
     bool imu_setup = setup_IMU(lsm);
     bool bmp_setup = setup_BMP(bmp);
     bool temp_setup1 = setup_tempsens(tempsensor_avbay, 0x19);
@@ -208,14 +247,42 @@ void loop()
         bboard_manager.gps_num_satellites = (int)GPS.satellites;
         bboard_manager.gps_antenna_status = (int)GPS.antenna;
     }
+    state previous_state = bboard_manager.curr_state;
     state_determiner.determineState(bboard_manager);
+    if (bboard_manager.curr_state != previous_state)
+    {
+        schedulePyro(bboard_manager.curr_state, bboard_manager.timestamp);
+    }
+    pyro.tick(flight_clock.now());
     bboard_manager.writeSensorData(launch_data, error_data);
 
     switchSPIDevice(RFM95_CS);
-    unsigned int *launchmode_d = transform_launchmode(bboard_manager);
-    uint64_t *launchmode_words = pack_noschema(launchmode_d);
-    rf95.send((uint8_t *)launchmode_words, sizeof(launchmode_words));
-    rf95.waitPacketSent();
+    // the packet for the current state, see schema_for
+    telemetry_packet_size += encode_telemetry(bboard_manager, telemetry_frames, telemetry_packet + telemetry_packet_size);
+    telemetry_packet_frames++;
+    // room left for the parity, see fec_parity_for; should the state change
+    // to more parity than fits, the encoder sends what does
+    uint8_t parity = fec_parity_for(bboard_manager.curr_state);
+    if (telemetry_packet_frames == TELEMETRY_FRAMES_PER_PACKET ||
+        telemetry_packet_size + DLT_MAX_FRAME_BYTES + fec_overhead(parity) > sizeof(telemetry_packet))
+    {
+        size_t size = telemetry_fec.encode(telemetry_packet, telemetry_packet_size, sizeof(telemetry_packet), parity);
+        // a coded packet goes without the CRC, for the ground station to
+        // correct rather than the radio to drop
+        rf95.setPayloadCRC(size == telemetry_packet_size);
+        rf95.send(telemetry_packet, size);
+        waitPacketSentTicking();
+        telemetry_packet_size = 0;
+        telemetry_packet_frames = 0;
+    }
+
+    // the ground station asks for a keyframe when it has lost one
+    uint8_t request[RH_RF95_MAX_MESSAGE_LEN];
+    uint8_t request_len = sizeof(request);
+    if (rf95.available() && rf95.recv(request, &request_len) && dlt_is_request(request, request_len))
+    {
+        telemetry_frames.requestKeyframe();
+    }
 
     // following APRS AX.25 protocol to transmit to MCC
     char ax25_buffer[255];
@@ -223,6 +290,7 @@ void loop()
                      static_cast<float>(GPS.longitude), GPS.lon,
                      static_cast<float>(GPS.speed),
                      static_cast<float>(GPS.angle), (int)GPS.altitude);
+    rf95.setPayloadCRC(true);
     rf95.send((uint8_t *)ax25_buffer, sizeof(ax25_buffer) + 1);
-    rf95.waitPacketSent();
+    waitPacketSentTicking();
 }
@@ -43,4 +43,30 @@
 #define SD_CS 13
 #define GPSSerial Serial1
 #define GPSECHO false
-#define BUZZER_PIN 9
\ No newline at end of file
+#define BUZZER_PIN 9
+
+// LSM9DS1 ranges set up by setup_IMU
+#define IMU_ACCEL_RANGE_G 4
+#define IMU_MAG_RANGE_GAUSS 4
+#define IMU_GYRO_RANGE_DPS 500
+// keep the LSM9DS1 readings as raw register counts and encode telemetry from
+// them with integer math, 0 for the driver's float readings (see rawimu.h)
+#define IMU_RAW_COUNTS 1
+
+// e-match pins, fired and continuity-sensed by PyroScheduler (pyro.h)
+#define MAIN_PYRO_PIN 15
+#define DROGUE_PYRO_PIN 16
+#define PYRO_HOLD 500            // ms per pulse
+#define PYRO_RETRIES 2           // extra pulses while the e-match still conducts
+#define PYRO_RETRY_INTERVAL 1000 // ms
+#define PYRO_SENSE_DELAY 20      // ms from the end of a pulse to the continuity reading
+
+// telemetry frames sent to one LoRa packet (dltdelta.h), and the frames from
+// one keyframe to the next
+#define TELEMETRY_FRAMES_PER_PACKET 4
+#define TELEMETRY_KEYFRAME_PERIOD 20
+// Reed-Solomon parity bytes on each telemetry packet (fec.h), every two
+// correct a byte in error; 0 sends the packets plain, under the radio's CRC
+#define TELEMETRY_FEC_PAD 0
+#define TELEMETRY_FEC_FLIGHT 16
+#define TELEMETRY_FEC_RECOVERY 32
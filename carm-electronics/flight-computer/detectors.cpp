@@ -0,0 +1,328 @@
+/*
+    detectors.cpp: Redundant flight event detectors and the voter between them
+*/
+
+#include <math.h>
+
+#include "detectors.h"
+
+// pad calibration: weight of a new reading in the gravity average, and how
+// far from 1 g a reading may be to count as standing still
+static const float PAD_SMOOTHING = 0.02;
+static const float PAD_STILL = 1.0;       // m/s^2
+static const float INNOVATION_SMOOTHING = 0.05;
+static const float GRAVITY = 9.80665;     // m/s^2
+static const float CLIP_FRACTION = 0.98;  // of the range
+
+static uint8_t index(FlightEvent event)
+{
+        return static_cast<uint8_t>(event);
+}
+
+static uint8_t index(Detector detector)
+{
+        return static_cast<uint8_t>(detector);
+}
+
+// 1 at no error, 1/2 at scale
+static float trust(float error, float scale)
+{
+        float r = error / scale;
+        return 1 / (1 + r * r);
+}
+
+EventVoter::EventVoter(const DetectorConfig &config)
+{
+        this->config = config;
+        for (uint8_t d = 0; d < DETECTOR_COUNT; d++)
+        {
+                for (uint8_t e = 0; e < FLIGHT_EVENT_COUNT; e++)
+                {
+                        latches[d][e].run = 0;
+                        latches[d][e].fired = false;
+                        latches[d][e].at = 0;
+                        confidence[d][e] = 0;
+                }
+        }
+        for (uint8_t e = 0; e < FLIGHT_EVENT_COUNT; e++)
+        {
+                decisionTimes[e] = 0;
+        }
+}
+
+void EventVoter::update(const DetectorInput &input)
+{
+        updateFused(input);
+        updateBaro(input);
+        updateImu(input);
+        vote(input.time);
+}
+
+void EventVoter::observe(Detector detector, FlightEvent event, bool condition, uint64_t time, uint8_t confirm)
+{
+        Latch &latch = latches[index(detector)][index(event)];
+        if (latch.fired)
+        {
+                return;
+        }
+        latch.run = condition ? latch.run + 1 : 0;
+        if (latch.run >= confirm)
+        {
+                latch.fired = true;
+                latch.at = time;
+        }
+}
+
+bool EventVoter::fired(Detector detector, FlightEvent event) const
+{
+        return latches[index(detector)][index(event)].fired;
+}
+
+void EventVoter::updateFused(const DetectorInput &input)
+{
+        const FlightEstimates &e = input.fused;
+        if (input.baroValid)
+        {
+                innovation += INNOVATION_SMOOTHING * (e.altitude - input.baroAltitude - innovation);
+        }
+        float c = trust(innovation, config.fusedDivergence);
+        for (uint8_t k = 0; k < FLIGHT_EVENT_COUNT; k++)
+        {
+                confidence[index(Detector::FUSED)][k] = c;
+        }
+
+        observe(Detector::FUSED, FlightEvent::LAUNCH,
+                e.accel > config.launchAccel && e.velocity > config.launchVelocity, e.time, config.confirmTicks);
+        observe(Detector::FUSED, FlightEvent::BURNOUT,
+                fired(Detector::FUSED, FlightEvent::LAUNCH) && e.accel < 0, e.time, config.confirmTicks);
+        // the prediction is already smoothed, it latches on its own; a noisy
+        // velocity can step over a [0, 1] window, so anything below counts
+        bool predicted = e.timeToApogee <= config.apogeeLead;
+        observe(Detector::FUSED, FlightEvent::APOGEE,
+                fired(Detector::FUSED, FlightEvent::BURNOUT) && (predicted || e.velocity <= 1), e.time,
+                predicted ? 1 : config.confirmTicks);
+        observe(Detector::FUSED, FlightEvent::MAIN,
+                fired(Detector::FUSED, FlightEvent::APOGEE) && e.altitude <= config.mainAltitude && e.velocity < 0,
+                e.time, config.confirmTicks);
+}
+
+void EventVoter::updateBaro(const DetectorInput &input)
+{
+        baroTimes[baroHead] = input.time;
+        baroAltitudes[baroHead] = input.baroAltitude;
+        baroValid[baroHead] = input.baroValid;
+        baroHead = (baroHead + 1) % BARO_WINDOW;
+        if (baroCount < BARO_WINDOW)
+        {
+                baroCount++;
+        }
+
+        // least-squares line through the valid readings, time in s relative
+        // to the newest so the sums stay small
+        uint8_t n = 0;
+        float st = 0, sh = 0, stt = 0, sth = 0;
+        for (uint8_t k = 0; k < baroCount; k++)
+        {
+                if (!baroValid[k])
+                {
+                        continue;
+                }
+                float t = static_cast<int32_t>(baroTimes[k] - input.time) / 1e6f;
+                float h = baroAltitudes[k];
+                n++;
+                st += t;
+                sh += h;
+                stt += t * t;
+                sth += t * h;
+        }
+        float c = 0;
+        float det = n * stt - st * st;
+        if (n >= 3 && det > 0)
+        {
+                baroVelocity = (n * sth - st * sh) / det;
+                baroAltitude = (sh - baroVelocity * st) / n; // at t = 0, the newest reading
+                float sq = 0;
+                for (uint8_t k = 0; k < baroCount; k++)
+                {
+                        if (baroValid[k])
+                        {
+                                float t = static_cast<int32_t>(baroTimes[k] - input.time) / 1e6f;
+                                float r = baroAltitudes[k] - (baroAltitude + baroVelocity * t);
+                                sq += r * r;
+                        }
+                }
+                baroResidual = sqrtf(sq / n);
+                c = static_cast<float>(n) / BARO_WINDOW * trust(baroResidual, config.baroNoise);
+                if (baroAltitude > baroPeak)
+                {
+                        baroPeak = baroAltitude;
+                }
+        }
+        uint8_t b = index(Detector::BARO);
+        confidence[b][index(FlightEvent::LAUNCH)] = c;
+        confidence[b][index(FlightEvent::BURNOUT)] = 0;
+        confidence[b][index(FlightEvent::APOGEE)] = c;
+        confidence[b][index(FlightEvent::MAIN)] = c;
+        if (c == 0)
+        {
+                return;
+        }
+
+        observe(Detector::BARO, FlightEvent::LAUNCH,
+                baroAltitude > config.baroLaunchAltitude && baroVelocity > config.launchVelocity, input.time,
+                config.confirmTicks);
+        observe(Detector::BARO, FlightEvent::APOGEE,
+                baroPeak > config.baroLaunchAltitude && baroVelocity < 0, input.time, config.confirmTicks);
+        observe(Detector::BARO, FlightEvent::MAIN,
+                fired(Detector::BARO, FlightEvent::APOGEE) && baroAltitude <= config.mainAltitude && baroVelocity < 0,
+                input.time, config.confirmTicks);
+}
+
+void EventVoter::updateImu(const DetectorInput &input)
+{
+        const float *a = input.accel;
+        float norm = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+        bool launched = fired(Detector::IMU, FlightEvent::LAUNCH);
+        if (!launched && fabsf(norm - GRAVITY) < PAD_STILL)
+        {
+                float w = padCalibrated ? PAD_SMOOTHING : 1;
+                for (uint8_t k = 0; k < 3; k++)
+                {
+                        padForce[k] += w * (a[k] - padForce[k]);
+                }
+                padCalibrated = true;
+        }
+        uint8_t m = index(Detector::IMU);
+        if (!padCalibrated)
+        {
+                for (uint8_t e = 0; e < FLIGHT_EVENT_COUNT; e++)
+                {
+                        confidence[m][e] = 0;
+                }
+                imuTime = input.time;
+                return;
+        }
+
+        // specific force along the pad vertical, less the pad's 1 g
+        float g = sqrtf(padForce[0] * padForce[0] + padForce[1] * padForce[1] + padForce[2] * padForce[2]);
+        float vertical = (a[0] * padForce[0] + a[1] * padForce[1] + a[2] * padForce[2]) / g - g;
+        float dt = static_cast<int32_t>(input.time - imuTime) / 1e6f;
+        imuTime = input.time;
+        imuVelocity += vertical * dt;
+        // until launch, anything short of a real push is the pad
+        if (!launched && vertical < config.launchAccel / 2)
+        {
+                imuVelocity = 0;
+        }
+        if (launched)
+        {
+                for (uint8_t k = 0; k < 3; k++)
+                {
+                        clipped = clipped || fabsf(a[k]) >= CLIP_FRACTION * config.accelLimit;
+                }
+        }
+        confidence[m][index(FlightEvent::LAUNCH)] = 1;
+        confidence[m][index(FlightEvent::BURNOUT)] = 1;
+        confidence[m][index(FlightEvent::APOGEE)] = clipped ? config.clippedConfidence : 1;
+        confidence[m][index(FlightEvent::MAIN)] = 0;
+
+        observe(Detector::IMU, FlightEvent::LAUNCH,
+                vertical > config.launchAccel && imuVelocity > config.launchVelocity, input.time, config.confirmTicks);
+        observe(Detector::IMU, FlightEvent::BURNOUT, launched && vertical < 0, input.time, config.confirmTicks);
+        observe(Detector::IMU, FlightEvent::APOGEE, fired(Detector::IMU, FlightEvent::BURNOUT) && imuVelocity <= 0,
+                input.time, config.confirmTicks);
+}
+
+void EventVoter::vote(uint64_t time)
+{
+        for (uint8_t e = 0; e < FLIGHT_EVENT_COUNT; e++)
+        {
+                if (decisions & (1 << e))
+                {
+                        continue;
+                }
+                float total = 0, yes = 0;
+                for (uint8_t d = 0; d < DETECTOR_COUNT; d++)
+                {
+                        float w = config.weight[d] * confidence[d][e];
+                        total += w;
+                        if (latches[d][e].fired)
+                        {
+                                yes += w;
+                        }
+                }
+                if (yes > 0 && yes >= config.quorum * total)
+                {
+                        decisions |= 1 << e;
+                        decisionTimes[e] = time;
+                }
+        }
+}
+
+uint8_t EventVoter::getDecisions() const
+{
+        return decisions;
+}
+
+bool EventVoter::decided(FlightEvent event) const
+{
+        return decisions & (1 << index(event));
+}
+
+uint64_t EventVoter::decidedAt(FlightEvent event) const
+{
+        return decisionTimes[index(event)];
+}
+
+bool EventVoter::hasFired(Detector detector, FlightEvent event) const
+{
+        return fired(detector, event);
+}
+
+uint64_t EventVoter::firedAt(Detector detector, FlightEvent event) const
+{
+        return latches[index(detector)][index(event)].at;
+}
+
+float EventVoter::getConfidence(Detector detector, FlightEvent event) const
+{
+        return confidence[index(detector)][index(event)];
+}
+
+uint16_t EventVoter::getVotes() const
+{
+        uint16_t votes = 0;
+        for (uint8_t d = 0; d < DETECTOR_COUNT; d++)
+        {
+                for (uint8_t e = 0; e < FLIGHT_EVENT_COUNT; e++)
+                {
+                        if (latches[d][e].fired)
+                        {
+                                votes |= 1 << (FLIGHT_EVENT_COUNT * d + e);
+                        }
+                }
+        }
+        return votes;
+}
+
+FlightEvent EventVoter::pendingEvent() const
+{
+        for (uint8_t e = 0; e < FLIGHT_EVENT_COUNT; e++)
+        {
+                if (!(decisions & (1 << e)))
+                {
+                        return static_cast<FlightEvent>(e);
+                }
+        }
+        return FlightEvent::MAIN;
+}
+
+float EventVoter::getBaroVelocity() const
+{
+        return baroVelocity;
+}
+
+float EventVoter::getImuVelocity() const
+{
+        return imuVelocity;
+}
@@ -0,0 +1,154 @@
+/*
+    detectors.h: Redundant flight event detectors and the voter between them
+
+    Three detectors look for launch, burnout, apogee and main every tick,
+    each on its own slice of the sensors, so one failure does not blind all
+    of them:
+      - fused: the AltitudeEstimator/ApogeePredictor estimates, under the
+        conditions the flight rules used to test directly
+      - baro: a least-squares line through the last BARO_WINDOW barometer
+        readings, altitude and climb rate from the barometer alone
+      - imu: the accelerometer alone, projected on the gravity direction
+        measured on the pad and integrated into a velocity
+
+    A detector latches an event once its condition has held for
+    confirmTicks ticks in a row. It also rates its confidence in every
+    event from 0 to 1, where 0 means it cannot judge the event at all:
+      - fused: falls as the estimated altitude drifts away from the
+        barometer (smoothed innovation), which is how a diverging filter
+        shows up
+      - baro: the share of valid readings in the window, falling as the
+        residual of the line grows (ejection and transonic pressure
+        transients); it has no say on burnout
+      - imu: for apogee, drops to clippedConfidence once the accelerometer
+        has clipped at its range, since the integral is wrong from then on;
+        it has no say on main
+
+    The voter declares an event once the detectors that latched it hold at
+    least quorum of the weighted confidence of all detectors that can judge
+    it. With equal weights and a quorum of 0.6, that means two of three
+    healthy detectors, both of two, or the last one standing.
+
+    A tick costs a line fit over BARO_WINDOW readings and a few dozen float
+    operations.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "transitions.h"
+
+enum class FlightEvent : uint8_t
+{
+  LAUNCH,
+  BURNOUT,
+  APOGEE,
+  MAIN
+};
+
+enum class Detector : uint8_t
+{
+  FUSED,
+  BARO,
+  IMU
+};
+
+static const uint8_t FLIGHT_EVENT_COUNT = 4;
+static const uint8_t DETECTOR_COUNT = 3;
+
+struct DetectorConfig
+{
+  float launchAccel;        // m/s^2 up, fused and imu
+  float launchVelocity;     // m/s, all three
+  float baroLaunchAltitude; // m above the pad
+  float apogeeLead;         // s, fused apogee on the prediction
+  float mainAltitude;       // m above the pad
+  float accelLimit;         // m/s^2, accelerometer range
+  uint8_t confirmTicks;
+  // voting
+  float weight[DETECTOR_COUNT];
+  float quorum;
+  float fusedDivergence;   // m of smoothed innovation halving the fused confidence
+  float baroNoise;         // m of residual halving the baro confidence
+  float clippedConfidence; // imu apogee after clipping
+};
+
+// what the detectors get to look at every tick
+struct DetectorInput
+{
+  uint64_t time;      // us
+  float accel[3];     // m/s^2, raw specific force
+  float baroAltitude; // m above the pad
+  bool baroValid;
+  FlightEstimates fused;
+};
+
+class EventVoter
+{
+
+public:
+  static const uint8_t BARO_WINDOW = 8;
+
+  EventVoter(const DetectorConfig &config);
+
+  void update(const DetectorInput &input);
+
+  // bit e: event e has been declared
+  uint8_t getDecisions() const;
+  bool decided(FlightEvent event) const;
+  uint64_t decidedAt(FlightEvent event) const; // us
+
+  bool hasFired(Detector detector, FlightEvent event) const;
+  uint64_t firedAt(Detector detector, FlightEvent event) const; // us
+  float getConfidence(Detector detector, FlightEvent event) const;
+  // bit 4 * detector + event: the detector has latched the event
+  uint16_t getVotes() const;
+  // first event not declared yet, MAIN once all are
+  FlightEvent pendingEvent() const;
+
+  float getBaroVelocity() const; // m/s
+  float getImuVelocity() const;  // m/s
+
+private:
+  struct Latch
+  {
+    uint8_t run;
+    bool fired;
+    uint64_t at;
+  };
+
+  void observe(Detector detector, FlightEvent event, bool condition, uint64_t time, uint8_t confirm);
+  bool fired(Detector detector, FlightEvent event) const;
+  void updateFused(const DetectorInput &input);
+  void updateBaro(const DetectorInput &input);
+  void updateImu(const DetectorInput &input);
+  void vote(uint64_t time);
+
+  DetectorConfig config;
+  Latch latches[DETECTOR_COUNT][FLIGHT_EVENT_COUNT];
+  float confidence[DETECTOR_COUNT][FLIGHT_EVENT_COUNT];
+  uint8_t decisions = 0;
+  uint64_t decisionTimes[FLIGHT_EVENT_COUNT];
+
+  // fused: smoothed altitude - baro altitude
+  float innovation = 0;
+
+  // baro: the window, oldest overwritten first
+  uint64_t baroTimes[BARO_WINDOW];
+  float baroAltitudes[BARO_WINDOW];
+  bool baroValid[BARO_WINDOW];
+  uint8_t baroHead = 0;
+  uint8_t baroCount = 0;
+  float baroAltitude = 0;
+  float baroVelocity = 0;
+  float baroResidual = 0;
+  float baroPeak = 0;
+
+  // imu: pad specific force, pointing up
+  float padForce[3] = {0, 0, 0};
+  bool padCalibrated = false;
+  float imuVelocity = 0;
+  uint64_t imuTime = 0;
+  bool clipped = false;
+
+}; // class EventVoter
@@ -110,15 +110,14 @@ void KalmanFilter::updateState(float updatedState[3], float predictedState[3], f
 void KalmanFilter::updateErrorCovariance(float covariance[3][3], float errorCovariance[3][3], float gain[3][3])
 {
     // required matrices
-    float identity[3][3];
-    identityMatrix3x3(identity);
     float tmp[3][3];
     float tmp2[3][3];
     // update error covariance with measurement
+    // (I - K.dot(H)).dot(P)
     matrixProduct3x3(tmp, gain, H);
     matrixProduct3x3(tmp2, tmp, errorCovariance);
-    scaleAndAccumulateMatrix3x3(identity, -1.0, tmp2);
-    copyMatrix3x3(covariance, tmp2);
+    copyMatrix3x3(covariance, errorCovariance);
+    scaleAndAccumulateMatrix3x3(covariance, -1.0, tmp2);
 }
 
 
@@ -159,18 +158,147 @@ float KalmanFilter::estimate(float gyro[3], float accel[3], float deltat)
     return accelEarth;
 }
 
+void KalmanFilter::getUpVector(float up[3])
+{
+    copyVector(up, currentState);
+}
+
+
+MahonyFilter::MahonyFilter(float kp, float ki, float accelGate)
+{
+    this->twoKp = 2 * kp;
+    this->twoKi = 2 * ki;
+    this->accelGate = accelGate;
+}
+
+void MahonyFilter::align(float accel[3])
+{
+    // shortest rotation taking the measured up direction onto earth z:
+    // q = [1 + a.z, a x z], normalized
+    float a[3];
+    copyVector(a, accel);
+    normalizeVector(a);
+    q[0] = 1 + a[2];
+    q[1] = a[1];
+    q[2] = -a[0];
+    q[3] = 0;
+    if (q[0] < 1e-6f) {
+        // upside down, any half turn about a horizontal axis will do
+        q[0] = 0;
+        q[1] = 1;
+        q[2] = 0;
+    }
+    float norm = sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+    for (uint8_t k = 0; k < 4; ++k) {
+        q[k] /= norm;
+    }
+    aligned = true;
+}
+
+void MahonyFilter::setMagnetometer(float mag[3])
+{
+    copyVector(this->mag, mag);
+    hasMag = (mag[0] != 0 || mag[1] != 0 || mag[2] != 0);
+}
+
+float MahonyFilter::estimate(float gyro[3], float accel[3], float deltat)
+{
+    if (!aligned) {
+        align(accel);
+    }
+    float q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    float gx = gyro[0], gy = gyro[1], gz = gyro[2];
+    // estimated direction of gravity (half of the third row of R)
+    float halfvx = q1*q3 - q0*q2;
+    float halfvy = q0*q1 + q2*q3;
+    float halfvz = q0*q0 - 0.5f + q3*q3;
+    float accelNorm;
+    vectorLength(& accelNorm, accel);
+
+    if (accelNorm > 0 && fabs(accelNorm - 1) < accelGate) {
+        float ax = accel[0] / accelNorm;
+        float ay = accel[1] / accelNorm;
+        float az = accel[2] / accelNorm;
+        // error is the cross product between measured and estimated gravity
+        float halfex = ay*halfvz - az*halfvy;
+        float halfey = az*halfvx - ax*halfvz;
+        float halfez = ax*halfvy - ay*halfvx;
+
+        float magNorm;
+        vectorLength(& magNorm, mag);
+        if (hasMag && magNorm > 0) {
+            float mx = mag[0] / magNorm;
+            float my = mag[1] / magNorm;
+            float mz = mag[2] / magNorm;
+            // earth-frame field, flattened onto the x/z plane
+            float hx = 2*(mx*(0.5f - q2*q2 - q3*q3) + my*(q1*q2 - q0*q3) + mz*(q1*q3 + q0*q2));
+            float hy = 2*(mx*(q1*q2 + q0*q3) + my*(0.5f - q1*q1 - q3*q3) + mz*(q2*q3 - q0*q1));
+            float bx = sqrt(hx*hx + hy*hy);
+            float bz = 2*(mx*(q1*q3 - q0*q2) + my*(q2*q3 + q0*q1) + mz*(0.5f - q1*q1 - q2*q2));
+            // estimated direction of the field in the body frame
+            float halfwx = bx*(0.5f - q2*q2 - q3*q3) + bz*(q1*q3 - q0*q2);
+            float halfwy = bx*(q1*q2 - q0*q3) + bz*(q0*q1 + q2*q3);
+            float halfwz = bx*(q0*q2 + q1*q3) + bz*(0.5f - q1*q1 - q2*q2);
+            halfex += my*halfwz - mz*halfwy;
+            halfey += mz*halfwx - mx*halfwz;
+            halfez += mx*halfwy - my*halfwx;
+        }
+
+        if (twoKi > 0) {
+            integralFB[0] += twoKi * halfex * deltat;
+            integralFB[1] += twoKi * halfey * deltat;
+            integralFB[2] += twoKi * halfez * deltat;
+            gx += integralFB[0];
+            gy += integralFB[1];
+            gz += integralFB[2];
+        }
+        gx += twoKp * halfex;
+        gy += twoKp * halfey;
+        gz += twoKp * halfez;
+    }
+
+    // integrate the quaternion rate
+    gx *= 0.5f * deltat;
+    gy *= 0.5f * deltat;
+    gz *= 0.5f * deltat;
+    q[0] = q0 + (-q1*gx - q2*gy - q3*gz);
+    q[1] = q1 + (q0*gx + q2*gz - q3*gy);
+    q[2] = q2 + (q0*gy - q1*gz + q3*gx);
+    q[3] = q3 + (q0*gz + q1*gy - q2*gx);
+    float norm = sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+    for (uint8_t k = 0; k < 4; ++k) {
+        q[k] /= norm;
+    }
+
+    // return vertical acceleration estimate, same convention as KalmanFilter
+    float up[3];
+    float accelEarth;
+    getUpVector(up);
+    dotProductVectors(& accelEarth, accel, up);
+    return 9.81f * accelEarth - 9.81f;
+}
+
+void MahonyFilter::getUpVector(float up[3])
+{
+    up[0] = 2*(q[1]*q[3] - q[0]*q[2]);
+    up[1] = 2*(q[0]*q[1] + q[2]*q[3]);
+    up[2] = q[0]*q[0] - q[1]*q[1] - q[2]*q[2] + q[3]*q[3];
+}
+
+void MahonyFilter::getQuaternion(float quat[4])
+{
+    for (uint8_t k = 0; k < 4; ++k) {
+        quat[k] = q[k];
+    }
+}
+
 
 float ComplementaryFilter::ApplyZUPT(float accel, float vel)
 {
-    // first update ZUPT array with latest estimation
-    ZUPT[ZUPTIdx] = accel;
-    // and move index to next slot
-    uint8_t nextIndex = (ZUPTIdx + 1) % ZUPT_SIZE;
-    ZUPTIdx = nextIndex;
+    // first update ZUPT window with latest estimation
+    ZUPT.push(accel);
     // Apply Zero-velocity update
-    for (uint8_t k = 0; k < ZUPT_SIZE; ++k) {
-        if (abs(ZUPT[k]) > accelThreshold) return vel;
-    }
+    if (ZUPT.maxAbs() > accelThreshold) return vel;
     return 0.0;
 }
 
@@ -180,14 +308,11 @@ ComplementaryFilter::ComplementaryFilter(float sigmaAccel, float sigmaBaro, floa
     // Compute the filter gain
     gain[0] = sqrt(2 * sigmaAccel / sigmaBaro);
     gain[1] = sigmaAccel / sigmaBaro;
+    // positive root of gain[0]*dt + gain[1]*dt^2/2 = 1
+    maxCorrectionDeltat = (sqrt(gain[0]*gain[0] + 2*gain[1]) - gain[0]) / gain[1];
     // If acceleration is below the threshold the ZUPT counter
     // will be increased
     this->accelThreshold = accelThreshold;
-    // initialize zero-velocity update
-    ZUPTIdx = 0;
-    for (uint8_t k = 0; k < ZUPT_SIZE; ++k) {
-        ZUPT[k] = 0;
-    }
 }
 
 void ComplementaryFilter::estimate(float * velocity, float * altitude, float baroAltitude,
@@ -200,3 +325,29 @@ void ComplementaryFilter::estimate(float * velocity, float * altitude, float bar
     // Compute zero-velocity update
     *velocity = ApplyZUPT(accel, *velocity);
 }
+
+void ComplementaryFilter::propagate(float * velocity, float * altitude, float accel, float deltat)
+{
+    *altitude = *altitude + deltat*(*velocity) + accel*deltat*deltat/2;
+    *velocity = *velocity + deltat*accel;
+    if (!propagated || fabs(accel) > peakAccel) peakAccel = fabs(accel);
+    lastAccel = accel;
+    propagated = true;
+}
+
+void ComplementaryFilter::zeroVelocity(float * velocity)
+{
+    // with no IMU sample since the last check, the last one still holds
+    *velocity = ApplyZUPT(propagated ? peakAccel : lastAccel, *velocity);
+    propagated = false;
+}
+
+void ComplementaryFilter::correct(float * velocity, float * altitude, float measuredAltitude, float deltat)
+{
+    // a long gap between measurements (sensor dropout, slow GPS) would
+    // otherwise turn into a correction larger than the innovation itself
+    if (deltat > maxCorrectionDeltat) deltat = maxCorrectionDeltat;
+    float innovation = measuredAltitude - *altitude;
+    *altitude = *altitude + deltat*(gain[0] + gain[1]*deltat/2)*innovation;
+    *velocity = *velocity + deltat*gain[1]*innovation;
+}
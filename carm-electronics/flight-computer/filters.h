@@ -9,8 +9,24 @@
 #include <stdint.h>
 
 #include "algebra.h"
+#include "movingstats.h"
 
-class KalmanFilter {
+// Interface shared by the attitude filters. AltitudeEstimator only needs the
+// gravity direction out of them to turn body-frame acceleration into vertical
+// acceleration, so any of them can be swapped in behind it
+class AttitudeFilter {
+  public:
+    // accel in g, gyro in rad/s; returns vertical acceleration in m/s^2
+    virtual float estimate(float gyro[3], float accel[3], float deltat) = 0;
+
+    // estimated "up" direction expressed in the body frame (unit vector)
+    virtual void getUpVector(float up[3]) = 0;
+
+    // magnetometer sample for filters that track heading, ignored otherwise
+    virtual void setMagnetometer(float[3]) {}
+}; // Class AttitudeFilter
+
+class KalmanFilter : public AttitudeFilter {
   private:
     float currentState[3] = {0, 0, 1};
     float currErrorCovariance[3][3] = {{100, 0, 0},{0, 100, 0},{0, 0, 100}};
@@ -40,19 +56,67 @@ class KalmanFilter {
 
     float estimate(float gyro[3], float accel[3], float deltat);
 
+    void getUpVector(float up[3]);
+
 }; // Class KalmanFilter
 
+// Mahony nonlinear complementary filter on a unit quaternion. Gyro rates are
+// integrated directly and the accelerometer (gravity) and magnetometer
+// (heading) errors are fed back through a PI controller: O(1), no matrix
+// inverse, one square root per normalization. The accelerometer correction is
+// suspended while the measured magnitude is far from 1 g, i.e. under thrust
+// and drag, when it no longer points along gravity
+class MahonyFilter : public AttitudeFilter {
+  private:
+    // body-to-earth rotation
+    float q[4] = {1, 0, 0, 0};
+    // integral of the attitude error, for gyro bias compensation
+    float integralFB[3] = {0, 0, 0};
+    float mag[3] = {0, 0, 0};
+    bool hasMag = false;
+    bool aligned = false;
+    float twoKp;
+    float twoKi;
+    float accelGate;
+
+    // sets the quaternion so that the measured acceleration points up
+    void align(float accel[3]);
+
+  public:
+
+    // kp, ki: proportional/integral feedback gains; accelGate: largest
+    // deviation of |accel| from 1 g (in g) for which gravity is trusted
+    MahonyFilter(float kp, float ki, float accelGate);
+
+    float estimate(float gyro[3], float accel[3], float deltat);
+
+    void getUpVector(float up[3]);
+
+    void setMagnetometer(float mag[3]);
+
+    void getQuaternion(float quat[4]);
+
+}; // Class MahonyFilter
+
 class ComplementaryFilter {
 
   private:
 
     // filter gain
     float gain[2];
-    // Zero-velocity update
+    // longest interval a single correction may span before the altitude
+    // gain would exceed 1 and overshoot the measurement
+    float maxCorrectionDeltat;
+    // Zero-velocity update: velocity is zeroed while every one of the last
+    // ZUPT_SIZE accelerations stays within accelThreshold
     float accelThreshold;
     static const uint8_t ZUPT_SIZE = 12;
-    uint8_t ZUPTIdx;
-    float   ZUPT[ZUPT_SIZE];
+    MovingStats<float, ZUPT_SIZE> ZUPT;
+    // largest acceleration propagated since the last zero-velocity check,
+    // so the window spans ZUPT_SIZE checks whatever the IMU rate
+    float peakAccel = 0;
+    float lastAccel = 0;
+    bool propagated = false;
 
     float ApplyZUPT(float accel, float vel);
 
@@ -62,4 +126,15 @@ class ComplementaryFilter {
 
     void estimate(float * velocity, float * altitude, float baroAltitude,
                   float pastAltitude, float pastVelocity, float accel, float deltat);
+
+    // inertial half of estimate(): integrates accel over deltat
+    void propagate(float * velocity, float * altitude, float accel, float deltat);
+
+    // zero-velocity check of estimate(), once per height measurement: the
+    // largest acceleration propagated since the last check enters the window
+    void zeroVelocity(float * velocity);
+
+    // measurement half of estimate(): pulls the state towards a height
+    // measurement, deltat being the time since the previous correction
+    void correct(float * velocity, float * altitude, float measuredAltitude, float deltat);
 }; // Class ComplementaryFilter
@@ -0,0 +1,37 @@
+/*
+    flightclock.cpp: Monotonic microsecond time base for the flight computer
+*/
+
+#include "flightclock.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+static uint32_t arduinoMicros()
+{
+        return micros();
+}
+
+FlightClock flight_clock(arduinoMicros);
+#endif
+
+FlightClock::FlightClock(uint32_t (*source)())
+{
+        this->source = source;
+}
+
+uint64_t FlightClock::now()
+{
+        uint32_t low = source();
+        if (low < last)
+        {
+                high++;
+        }
+        last = low;
+        return (static_cast<uint64_t>(high) << 32) | low;
+}
+
+uint32_t FlightClock::toMillis(uint64_t time)
+{
+        return static_cast<uint32_t>(time / 1000);
+}
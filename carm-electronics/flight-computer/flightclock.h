@@ -0,0 +1,47 @@
+/*
+    flightclock.h: Monotonic microsecond time base for the flight computer
+
+    micros() wraps every 71.6 minutes, sooner than a rocket may leave the
+    pad, and millis() is too coarse to tell two loop ticks apart from
+    sensor jitter. FlightClock extends micros() to 64 bits: now() keeps the
+    last 32-bit reading and bumps a high word whenever a reading comes back
+    smaller, so it never goes backwards as long as it is read at least once
+    per wrap (the main loop reads it every tick). A read costs the source
+    call, a compare and a 64-bit add; it is not safe to call from an
+    interrupt while the loop may be reading it too.
+
+    Every timestamp in the flight code is a now() value in us: the samples
+    in BBManager, the transition table, the event detectors, the pyro
+    scheduler and the log. The filters only need the gaps between samples
+    and take the low 32 bits, whose differences stay right across the wrap.
+
+    The source is a plain function so the host tests can drive the clock.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+class FlightClock
+{
+
+public:
+  // source: free-running 32-bit us counter, micros() on the board
+  FlightClock(uint32_t (*source)());
+
+  // us since the source started, never decreasing
+  uint64_t now();
+
+  static uint32_t toMillis(uint64_t time);
+
+private:
+  uint32_t (*source)();
+  uint32_t high = 0; // wraps seen so far
+  uint32_t last = 0; // source reading at the last now()
+
+}; // class FlightClock
+
+#ifdef ARDUINO
+// on micros()
+extern FlightClock flight_clock;
+#endif
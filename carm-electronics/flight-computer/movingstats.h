@@ -0,0 +1,173 @@
+/**************************************************************
+ *
+ *                     movingstats.h
+ *
+ *     Overview: Statistics over the last N samples of a signal, kept in a
+ *                  fixed ring buffer so nothing is allocated at runtime.
+ *                  Pushing a sample and querying the mean, variance,
+ *                  min, max or largest magnitude are all O(1) (the
+ *                  extrema are amortized O(1), through monotonic deques).
+ *                  Replaces trash_bin/MovingAvg, which needed cppQueue.
+ *
+ *     Usage:
+ *        MovingStats<float, 12> window;
+ *        window.push(reading);
+ *        if (window.full() && window.maxAbs() < threshold) ...
+ *
+ **************************************************************/
+
+#ifndef MOVING_STATS_H
+#define MOVING_STATS_H
+
+#include <math.h>
+#include <stdint.h>
+
+template <typename T, uint16_t N>
+class MovingStats
+{
+    static_assert(N > 0, "MovingStats needs room for at least one sample");
+
+public:
+    MovingStats()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        head = 0;
+        count = 0;
+        pushed = 0;
+        runningMean = 0;
+        runningM2 = 0;
+        minQueue.clear();
+        maxQueue.clear();
+    }
+
+    // adds a sample, dropping the oldest one once the window is full
+    void push(T value)
+    {
+        if (count == N)
+        {
+            T oldest = samples[head];
+            // sliding Welford update: swap the oldest sample for the new one
+            // without going through a sum of squares, which loses everything
+            // to cancellation on offset signals such as raw altitude
+            T oldMean = runningMean;
+            runningMean += (value - oldest) / N;
+            runningM2 += (value - oldest) * (value - runningMean + oldest - oldMean);
+            if (runningM2 < 0)
+            {
+                runningM2 = 0;
+            }
+            // the oldest sample leaves the deques if it is still at their front
+            if (!minQueue.empty() && minQueue.front() == pushed - N)
+            {
+                minQueue.popFront();
+            }
+            if (!maxQueue.empty() && maxQueue.front() == pushed - N)
+            {
+                maxQueue.popFront();
+            }
+        }
+        else
+        {
+            count++;
+            T delta = value - runningMean;
+            runningMean += delta / count;
+            runningM2 += delta * (value - runningMean);
+        }
+
+        samples[head] = value;
+        head = (head + 1) % N;
+
+        // deques hold sequence numbers of samples still in the window; each
+        // is kept sorted so the front is the extremum
+        while (!minQueue.empty() && at(minQueue.back()) >= value)
+        {
+            minQueue.popBack();
+        }
+        minQueue.pushBack(pushed);
+        while (!maxQueue.empty() && at(maxQueue.back()) <= value)
+        {
+            maxQueue.popBack();
+        }
+        maxQueue.pushBack(pushed);
+        pushed++;
+    }
+
+    uint16_t size() const { return count; }
+    bool full() const { return count == N; }
+    bool empty() const { return count == 0; }
+    static uint16_t capacity() { return N; }
+
+    // most recent sample
+    T last() const { return samples[(head + N - 1) % N]; }
+
+    // all queries return 0 on an empty window
+    T mean() const { return runningMean; }
+
+    // population variance of the samples in the window
+    T variance() const { return count ? runningM2 / count : 0; }
+
+    T stddev() const { return sqrt(variance()); }
+
+    T min() const { return count ? at(minQueue.front()) : 0; }
+
+    T max() const { return count ? at(maxQueue.front()) : 0; }
+
+    // largest magnitude in the window
+    T maxAbs() const
+    {
+        T lo = -min();
+        T hi = max();
+        return lo > hi ? lo : hi;
+    }
+
+private:
+    // fixed capacity deque of sample sequence numbers
+    class IndexDeque
+    {
+    public:
+        void clear()
+        {
+            first = 0;
+            length = 0;
+        }
+        bool empty() const { return length == 0; }
+        uint32_t front() const { return slots[first]; }
+        uint32_t back() const { return slots[(first + length - 1) % N]; }
+        void popFront()
+        {
+            first = (first + 1) % N;
+            length--;
+        }
+        void popBack() { length--; }
+        void pushBack(uint32_t index)
+        {
+            slots[(first + length) % N] = index;
+            length++;
+        }
+
+    private:
+        uint32_t slots[N];
+        uint16_t first;
+        uint16_t length;
+    };
+
+    // sample by sequence number, only valid while it is in the window
+    T at(uint32_t index) const { return samples[index % N]; }
+
+    T samples[N];
+    uint16_t head;
+    uint16_t count;
+    // sequence number of the next sample, head == pushed % N (2^32 samples
+    // is over a year of flight loop at 100 Hz)
+    uint32_t pushed;
+    T runningMean;
+    T runningM2;
+    IndexDeque minQueue;
+    IndexDeque maxQueue;
+};
+
+#endif
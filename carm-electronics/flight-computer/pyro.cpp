@@ -0,0 +1,185 @@
+/*
+    pyro.cpp: Non-blocking pyro channel scheduler
+*/
+
+#include "pyro.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+static void arduinoSetOutput(uint8_t pin, bool output)
+{
+        pinMode(pin, output ? OUTPUT : INPUT);
+}
+
+static void arduinoWrite(uint8_t pin, bool high)
+{
+        digitalWrite(pin, high ? HIGH : LOW);
+}
+
+static bool arduinoRead(uint8_t pin)
+{
+        return digitalRead(pin) == HIGH;
+}
+
+const PyroGpio ARDUINO_PYRO_GPIO = {arduinoSetOutput, arduinoWrite, arduinoRead};
+#endif
+
+const uint8_t PyroScheduler::MAX_CHANNELS;
+const uint8_t PyroScheduler::NO_CHANNEL;
+
+PyroScheduler::PyroScheduler(const PyroGpio &gpio, uint32_t senseDelay)
+{
+        this->gpio = gpio;
+        this->senseDelay = senseDelay;
+}
+
+uint8_t PyroScheduler::addChannel(uint8_t pin)
+{
+        if (channelCount == MAX_CHANNELS)
+        {
+                return NO_CHANNEL;
+        }
+        Channel &channel = channels[channelCount];
+        channel.pin = pin;
+        channel.status = PyroStatus::IDLE;
+        channel.attempts = 0;
+        channel.next = 0;
+        channel.firedAt = 0;
+        gpio.write(pin, false);
+        gpio.setOutput(pin, false);
+        channel.continuity = gpio.read(pin);
+        return channelCount++;
+}
+
+bool PyroScheduler::schedule(uint8_t channel, const PyroAction &action)
+{
+        if (channel >= channelCount || channels[channel].status == PyroStatus::FIRING)
+        {
+                return false;
+        }
+        Channel &c = channels[channel];
+        c.action = action;
+        c.attempts = 0;
+        c.next = action.at;
+        c.status = PyroStatus::SCHEDULED;
+        return true;
+}
+
+void PyroScheduler::cancel(uint8_t channel)
+{
+        if (channel >= channelCount)
+        {
+                return;
+        }
+        Channel &c = channels[channel];
+        if (c.status == PyroStatus::FIRING)
+        {
+                gpio.write(c.pin, false);
+                gpio.setOutput(c.pin, false);
+        }
+        c.status = PyroStatus::IDLE;
+}
+
+void PyroScheduler::tick(uint64_t now)
+{
+        for (uint8_t i = 0; i < channelCount; i++)
+        {
+                Channel &c = channels[i];
+                if (c.status != PyroStatus::FIRING)
+                {
+                        c.continuity = gpio.read(c.pin);
+                }
+                switch (c.status)
+                {
+                case PyroStatus::SCHEDULED:
+                case PyroStatus::RETRY_WAIT:
+                        if (now >= c.next)
+                        {
+                                startPulse(c, now);
+                        }
+                        break;
+                case PyroStatus::FIRING:
+                        if (now >= c.next)
+                        {
+                                endPulse(c, now);
+                        }
+                        break;
+                case PyroStatus::SENSING:
+                        if (now < c.next)
+                        {
+                                break;
+                        }
+                        // an e-match that still conducts did not burn through
+                        if (!c.continuity)
+                        {
+                                c.status = PyroStatus::FIRED;
+                        }
+                        else if (c.attempts <= c.action.retries)
+                        {
+                                c.status = PyroStatus::RETRY_WAIT;
+                                c.next = now + c.action.retryInterval;
+                        }
+                        else
+                        {
+                                c.status = PyroStatus::FAILED;
+                        }
+                        break;
+                default:
+                        break;
+                }
+        }
+}
+
+PyroStatus PyroScheduler::getStatus(uint8_t channel) const
+{
+        return channels[channel].status;
+}
+
+bool PyroScheduler::hasContinuity(uint8_t channel) const
+{
+        return channels[channel].continuity;
+}
+
+uint8_t PyroScheduler::getAttempts(uint8_t channel) const
+{
+        return channels[channel].attempts;
+}
+
+uint64_t PyroScheduler::getFiredAt(uint8_t channel) const
+{
+        return channels[channel].firedAt;
+}
+
+bool PyroScheduler::busy() const
+{
+        for (uint8_t i = 0; i < channelCount; i++)
+        {
+                PyroStatus s = channels[i].status;
+                if (s != PyroStatus::IDLE && s != PyroStatus::FIRED && s != PyroStatus::FAILED)
+                {
+                        return true;
+                }
+        }
+        return false;
+}
+
+void PyroScheduler::startPulse(Channel &c, uint64_t now)
+{
+        // low before switching to an output, so the pin never glitches high
+        gpio.write(c.pin, false);
+        gpio.setOutput(c.pin, true);
+        gpio.write(c.pin, true);
+        c.attempts++;
+        c.firedAt = now;
+        c.next = now + c.action.hold;
+        c.status = PyroStatus::FIRING;
+}
+
+void PyroScheduler::endPulse(Channel &c, uint64_t now)
+{
+        gpio.write(c.pin, false);
+        gpio.setOutput(c.pin, false);
+        c.next = now + senseDelay;
+        c.status = PyroStatus::SENSING;
+}
@@ -0,0 +1,117 @@
+/*
+    pyro.h: Non-blocking pyro channel scheduler
+
+    Each channel is one e-match pin, used two ways: as an input it senses
+    continuity (reads high through an intact e-match, as in
+    tests/continuity/main_drogue.ino), as an output driven high it fires.
+
+    An action is "fire at time t, hold the pin high for hold us". tick() is
+    called from the main loop with the current time and moves every channel
+    along, so a pulse never stops the sampling the way delay(500) would:
+
+        SCHEDULED --t--> FIRING --hold--> SENSING --senseDelay--> FIRED
+                           ^                 |
+                           |   continuity    v
+                           +--- RETRY_WAIT <-+--- no retries left: FAILED
+
+    After a pulse the pin goes back to an input and is read once the
+    circuit has settled: if the e-match still conducts it did not burn, and
+    the pulse is repeated after retryInterval up to retries more times. A
+    channel that had no continuity to begin with ends FIRED, which then
+    says nothing about the charge; check hasContinuity() before scheduling.
+
+    All times are FlightClock values in us (flightclock.h), which do not
+    wrap, so an action may be scheduled any time ahead. The pins are driven through
+    PyroGpio, the Arduino calls on the board and a mock on the host.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+struct PyroGpio
+{
+  void (*setOutput)(uint8_t pin, bool output); // pinMode OUTPUT / INPUT
+  void (*write)(uint8_t pin, bool high);
+  bool (*read)(uint8_t pin);
+};
+
+#ifdef ARDUINO
+// pinMode, digitalWrite and digitalRead
+extern const PyroGpio ARDUINO_PYRO_GPIO;
+#endif
+
+enum class PyroStatus : uint8_t
+{
+  IDLE,
+  SCHEDULED,
+  FIRING,
+  SENSING,
+  RETRY_WAIT,
+  FIRED,
+  FAILED
+};
+
+struct PyroAction
+{
+  uint64_t at;            // us, first pulse
+  uint32_t hold;          // us the pin is held high per pulse
+  uint8_t retries;        // extra pulses while continuity remains
+  uint32_t retryInterval; // us from the end of a pulse to the next
+};
+
+class PyroScheduler
+{
+
+public:
+  static const uint8_t MAX_CHANNELS = 4;
+  static const uint8_t NO_CHANNEL = 0xFF;
+
+  // us between the end of a pulse and the continuity reading
+  PyroScheduler(const PyroGpio &gpio, uint32_t senseDelay);
+
+  // sets the pin up as a continuity input, returns the channel or NO_CHANNEL
+  // once all are taken
+  uint8_t addChannel(uint8_t pin);
+
+  // replaces whatever the channel was doing, unless it is mid-pulse; returns
+  // false then or for an unknown channel
+  bool schedule(uint8_t channel, const PyroAction &action);
+
+  // drops the action, pulls the pin low at once if it was firing
+  void cancel(uint8_t channel);
+
+  // advances every channel to now (us), never blocks
+  void tick(uint64_t now);
+
+  PyroStatus getStatus(uint8_t channel) const;
+  // continuity at the last reading, taken every tick the pin is an input
+  bool hasContinuity(uint8_t channel) const;
+  // pulses fired for the current action
+  uint8_t getAttempts(uint8_t channel) const;
+  // us, start of the last pulse
+  uint64_t getFiredAt(uint8_t channel) const;
+  // true while any channel is between SCHEDULED and the end of its action
+  bool busy() const;
+
+private:
+  struct Channel
+  {
+    uint8_t pin;
+    PyroStatus status;
+    PyroAction action;
+    uint8_t attempts;
+    bool continuity;
+    uint64_t next;    // us, when the current step ends
+    uint64_t firedAt; // us
+  };
+
+  void startPulse(Channel &channel, uint64_t now);
+  void endPulse(Channel &channel, uint64_t now);
+
+  PyroGpio gpio;
+  uint32_t senseDelay;
+  Channel channels[MAX_CHANNELS];
+  uint8_t channelCount = 0;
+
+}; // class PyroScheduler
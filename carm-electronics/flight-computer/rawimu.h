@@ -0,0 +1,86 @@
+/*
+    rawimu.h: LSM9DS1 readings kept as raw register counts
+
+    The Adafruit driver turns every int16 count into a float in flight units
+    (m/s^2, rad/s, uT), and quantize_dlt then subtracts, multiplies by the
+    reciprocal of the spacing and truncates it back into an integer, all in
+    soft-float on the M0.
+    With IMU_RAW_COUNTS set BBManager keeps the counts instead, and each
+    telemetry field maps them to DLT space with one 32x32->64 bit multiply,
+    an add and taking the upper word:
+
+        dlt = (counts * gain + offset) >> 32
+        gain = 2^32 * unit_per_count / spacing
+        offset = 2^32 * -n_min / spacing
+
+    gain and offset are computed at compile time from the ranges in def.h.
+    Only the estimator and the datalog convert counts to floats, one multiply
+    by the count scale per axis.
+
+    The result equals floor((reading - n_min) / spacing) on the driver's
+    float reading, except where the float rounding of the driver lands a
+    reading on the other side of a DLT step boundary (one step off, see
+    tests/unit-tests/rawimu_test.cpp). Readings below the range encode as 0,
+    as the M0's float to unsigned conversion does. quantize_dlt_counts also
+    clamps readings above the range to the field's largest value, as
+    quantize_dlt does.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+struct RawAxes
+{
+  int16_t x;
+  int16_t y;
+  int16_t z;
+};
+
+// one count in flight units for each range setup_IMU can select, the
+// factors the Adafruit LSM9DS1 and LIS3MDL drivers apply
+
+// m/s^2 per count
+constexpr float accel_count_scale(int rangeG)
+{
+  return (rangeG == 2 ? 0.061f : rangeG == 4 ? 0.122f : rangeG == 8 ? 0.244f : 0.732f) / 1000 * 9.80665f;
+}
+
+// rad/s per count
+constexpr float gyro_count_scale(int rangeDps)
+{
+  return (rangeDps == 245 ? 0.00875f : rangeDps == 500 ? 0.0175f : 0.07f) * 0.017453293f;
+}
+
+// uT per count
+constexpr float mag_count_scale(int rangeGauss)
+{
+  return 100.0f / (rangeGauss == 4 ? 6842 : rangeGauss == 8 ? 3421 : rangeGauss == 12 ? 2281 : 1711);
+}
+
+// fixed point mapping of counts to one DLT field
+struct DltCountMap
+{
+  int64_t gain;
+  int64_t offset;
+};
+
+constexpr DltCountMap dlt_count_map(float unitPerCount, int nMin, float spacing)
+{
+  return DltCountMap{(int64_t)((double)unitPerCount / spacing * 4294967296.0 + 0.5),
+                     (int64_t)(-nMin / (double)spacing * 4294967296.0 + 0.5)};
+}
+
+inline unsigned int serialize_dlt_counts(int16_t counts, const DltCountMap &map)
+{
+  int64_t scaled = counts * map.gain + map.offset;
+  return scaled < 0 ? 0 : (unsigned int)(scaled >> 32);
+}
+
+// serialize_dlt_counts clamped to [0, max], saturated set if it was clamped
+inline uint32_t quantize_dlt_counts(int16_t counts, const DltCountMap &map, uint32_t max, bool &saturated)
+{
+  int64_t scaled = counts * map.gain + map.offset;
+  saturated = scaled < 0 || (scaled >> 32) > max;
+  return scaled < 0 ? 0 : (scaled >> 32) > max ? max : (uint32_t)(scaled >> 32);
+}
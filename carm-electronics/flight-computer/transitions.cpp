@@ -0,0 +1,148 @@
+/*
+    transitions.cpp: Table-driven state machine for the flight states
+*/
+
+#include "transitions.h"
+
+TransitionTable::TransitionTable(const TransitionRule *rules, uint8_t ruleCount, uint8_t initialState)
+{
+        this->rules = rules;
+        this->ruleCount = ruleCount > MAX_RULES ? MAX_RULES : ruleCount;
+
+        // counting sort of the rules by source state, keeping table order
+        // within a state; rules naming a state out of range, or without a
+        // guard, are left out
+        for (uint8_t s = 0; s <= MAX_STATES; s++)
+        {
+                first[s] = 0;
+        }
+        for (uint8_t r = 0; r < this->ruleCount; r++)
+        {
+                if (isValid(rules[r]))
+                {
+                        first[rules[r].from + 1]++;
+                }
+        }
+        for (uint8_t s = 0; s < MAX_STATES; s++)
+        {
+                first[s + 1] += first[s];
+        }
+        uint8_t next[MAX_STATES];
+        for (uint8_t s = 0; s < MAX_STATES; s++)
+        {
+                next[s] = first[s];
+        }
+        for (uint8_t r = 0; r < this->ruleCount; r++)
+        {
+                if (isValid(rules[r]))
+                {
+                        order[next[rules[r].from]++] = r;
+                }
+                uint8_t m = rules[r].m;
+                windows[r].m = m < 1 ? 1 : m > 32 ? 32 : m;
+                uint8_t n = rules[r].n;
+                windows[r].n = n < 1 ? 1 : n > windows[r].m ? windows[r].m : n;
+                stats[r].fired = 0;
+                stats[r].firedAt = 0;
+                stats[r].pendingTicks = 0;
+        }
+
+        for (uint8_t s = 0; s < MAX_STATES; s++)
+        {
+                entered[s] = 0;
+                everEntered[s] = false;
+        }
+        state = 0;
+        enter(initialState, 0);
+}
+
+int TransitionTable::tick(const FlightEstimates &estimates)
+{
+        for (uint8_t i = first[state]; i < first[state + 1]; i++)
+        {
+                uint8_t r = order[i];
+                const TransitionRule &rule = rules[r];
+                RuleWindow &window = windows[r];
+
+                // slide the window: drop the result falling out of the last
+                // m, add this tick's
+                uint32_t oldest = (window.history >> (window.m - 1)) & 1;
+                window.count -= oldest;
+                window.history <<= 1;
+                if (rule.guard(estimates))
+                {
+                        window.history |= 1;
+                        window.count++;
+                }
+                if (window.m < 32)
+                {
+                        window.history &= (1UL << window.m) - 1;
+                }
+                window.pending = window.count ? window.pending + 1 : 0;
+
+                bool debounced = window.count >= window.n;
+                bool dwelled = estimates.time - entered[state] >= rule.minDwell;
+                bool unlocked = rule.lockout == 0 ||
+                                (everEntered[rule.lockoutState] &&
+                                 estimates.time - entered[rule.lockoutState] >= rule.lockout);
+                if (debounced && dwelled && unlocked)
+                {
+                        stats[r].fired++;
+                        stats[r].firedAt = estimates.time;
+                        stats[r].pendingTicks = window.pending;
+                        enter(rule.to, estimates.time);
+                        return r;
+                }
+        }
+        return -1;
+}
+
+uint8_t TransitionTable::getState() const
+{
+        return state;
+}
+
+void TransitionTable::setState(uint8_t state, uint64_t time)
+{
+        enter(state, time);
+}
+
+uint8_t TransitionTable::getRuleCount() const
+{
+        return ruleCount;
+}
+
+const TransitionRule &TransitionTable::getRule(uint8_t rule) const
+{
+        return rules[rule];
+}
+
+const TransitionStats &TransitionTable::getStats(uint8_t rule) const
+{
+        return stats[rule];
+}
+
+bool TransitionTable::isValid(const TransitionRule &rule)
+{
+        return rule.from < MAX_STATES && rule.to < MAX_STATES && rule.guard != nullptr &&
+               (rule.lockout == 0 || rule.lockoutState < MAX_STATES);
+}
+
+// a state out of range is ignored
+void TransitionTable::enter(uint8_t state, uint64_t time)
+{
+        if (state >= MAX_STATES)
+        {
+                return;
+        }
+        this->state = state;
+        entered[state] = time;
+        everEntered[state] = true;
+        // the rules of the new state start from an empty window
+        for (uint8_t i = first[state]; i < first[state + 1]; i++)
+        {
+                windows[order[i]].history = 0;
+                windows[order[i]].count = 0;
+                windows[order[i]].pending = 0;
+        }
+}
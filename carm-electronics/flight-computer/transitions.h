@@ -0,0 +1,112 @@
+/*
+    transitions.h: Table-driven state machine for the flight states
+
+    The machine is a table of rules: from a state, to a state, a guard
+    looked at once per tick, and the conditions under which a holding guard
+    actually fires:
+      - debounce: the guard held on at least n of the last m ticks
+      - dwell: at least minDwell us spent in the source state
+      - lockout: at least lockout us since lockoutState was last entered
+        (say, apogee no sooner than 2 s after liftoff)
+
+    Only the rules of the current state are evaluated, in table order, and
+    the first that fires wins. The rules are indexed by source state once
+    when the table is built and each keeps its last m guard results in a
+    bit mask with a running count, so a tick is O(1) in the size of the
+    table and the debounce window.
+
+    Each rule also counts how many ticks its guard was pending (held on at
+    least once in the window) before it fired, which is how late the
+    debounce made the transition.
+
+    The table is checked when it is built: a rule naming a state past
+    MAX_STATES, or with no guard, is never evaluated; m is taken within 1
+    to 32 and n within 1 to m.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+// what the guards get to look at every tick
+struct FlightEstimates
+{
+  uint64_t time;  // us, FlightClock (flightclock.h)
+  float altitude; // m above the pad
+  float velocity; // m/s, up
+  float accel;    // m/s^2, up, gravity removed
+  // ballistic prediction from ApogeePredictor, NAN until it is trusted
+  float timeToApogee; // s
+  // bit e: flight event e declared by the EventVoter (detectors.h)
+  uint8_t events;
+};
+
+typedef bool (*TransitionGuard)(const FlightEstimates &estimates);
+
+struct TransitionRule
+{
+  uint8_t from;
+  uint8_t to;
+  TransitionGuard guard;
+  uint8_t n; // guard on at least n ...
+  uint8_t m; // ... of the last m ticks, m <= 32
+  uint32_t minDwell; // us
+  uint8_t lockoutState;
+  uint32_t lockout; // us, 0 for none
+};
+
+struct TransitionStats
+{
+  uint16_t fired;        // times the rule fired
+  uint64_t firedAt;      // us, last time it fired
+  uint16_t pendingTicks; // ticks the guard was pending before it last fired
+};
+
+class TransitionTable
+{
+
+public:
+  static const uint8_t MAX_STATES = 16;
+  static const uint8_t MAX_RULES = 24;
+
+  // rules are not copied and must outlive the table
+  TransitionTable(const TransitionRule *rules, uint8_t ruleCount, uint8_t initialState);
+
+  // evaluates the rules of the current state, returns the index of the rule
+  // that fired or -1
+  int tick(const FlightEstimates &estimates);
+
+  uint8_t getState() const;
+
+  // forced transition (ground commands), clears the debounce windows
+  void setState(uint8_t state, uint64_t time);
+
+  uint8_t getRuleCount() const;
+  const TransitionRule &getRule(uint8_t rule) const;
+  const TransitionStats &getStats(uint8_t rule) const;
+
+private:
+  struct RuleWindow
+  {
+    uint8_t m;        // the rule's m, within 1 to 32
+    uint8_t n;        // the rule's n, within 1 to m
+    uint32_t history; // bit k: guard result k ticks ago
+    uint8_t count;    // ones among the last m results
+    uint16_t pending; // ticks since count last left 0
+  };
+
+  static bool isValid(const TransitionRule &rule);
+  void enter(uint8_t state, uint64_t time);
+
+  const TransitionRule *rules;
+  uint8_t ruleCount;
+  uint8_t state;
+  // rules of state s are order[first[s]] .. order[first[s + 1] - 1]
+  uint8_t order[MAX_RULES];
+  uint8_t first[MAX_STATES + 1];
+  RuleWindow windows[MAX_RULES];
+  TransitionStats stats[MAX_RULES];
+  uint64_t entered[MAX_STATES];
+  bool everEntered[MAX_STATES];
+
+}; // class TransitionTable
@@ -0,0 +1,246 @@
+/**************************************************************
+ *
+ *                     dltbatch.h
+ *
+ *     Overview: Bulk decoding of an archive of frames of one packet, each
+ *                  laid out the same: the WORDS 64-bit words of dlt_pack,
+ *                  as the ground station logged them before the delta
+ *                  frames, or the BYTES of dlt_write, a keyframe's body.
+ *
+ *                  Rather than a frame at a time (dlt_unpack, dlt_read),
+ *                  each field is pulled out of every frame into a column of
+ *                  its own, then the readings of each column worked out
+ *                  together: the same load, shift and mask, or the same
+ *                  multiply and add, over many frames.
+ *
+ *                  With AVX2 (-mavx2) a field is gathered from four frames
+ *                  at a time and the readings are computed eight at a time;
+ *                  SSE2 does the readings four at a time; otherwise the
+ *                  loops are plain C++. dlt_decode_batch splits the frames
+ *                  among threads.
+ *
+ *                  A field is loaded as the 8 bytes from its first, so a
+ *                  frame is read a little past its end but never past the
+ *                  archive's. The byte stream is most significant bit first
+ *                  and is read assuming a little-endian host.
+ *
+ *                  Host only, for the ground decoder and the tests.
+ *
+ **************************************************************/
+
+#ifndef DLTBATCH_H
+#define DLTBATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "../dlt.h"
+
+enum class DltFrameLayout : uint8_t
+{
+  WORDS, // dlt_pack, the words in host order
+  BYTES, // dlt_write
+};
+
+// where a field is in a frame: the 64 bits from byte offset, shifted right
+// by shift and masked
+struct DltBatchField
+{
+  size_t offset;
+  uint8_t shift;
+  uint32_t mask;
+};
+
+template <typename Packet, uint8_t I = 0, bool END = I == Packet::COUNT>
+struct DltBatchLayout
+{
+  typedef DltCodec<Packet, I> Codec;
+
+  static void fill(DltFrameLayout layout, DltBatchField fields[])
+  {
+    fields[I] = layout == DltFrameLayout::WORDS
+                    ? DltBatchField{Codec::WORD * 8, Codec::LSB, static_cast<uint32_t>(Codec::MASK)}
+                    : DltBatchField{Codec::BYTE, static_cast<uint8_t>(64 - Codec::OFFSET % 8 - Codec::WIDTH),
+                                    static_cast<uint32_t>(Codec::MASK)};
+    DltBatchLayout<Packet, I + 1>::fill(layout, fields);
+  }
+};
+
+template <typename Packet, uint8_t I>
+struct DltBatchLayout<Packet, I, true>
+{
+  static void fill(DltFrameLayout, DltBatchField[]) {}
+};
+
+/*
+ * dlt_extract
+ * Parameters: count frames stride bytes apart, the field to take from each and whether the
+ *             frames are a byte stream (big-endian) rather than host words
+ * Returns: Nothing, the field of frame k goes to out[k]
+ */
+inline void dlt_extract(const uint8_t frames[], size_t stride, size_t count, const DltBatchField &f, bool big_endian,
+                        uint32_t out[])
+{
+  // the frames whose 8 bytes end within the archive
+  size_t end = count * stride;
+  size_t whole = end >= f.offset + 8 ? (end - f.offset - 8) / stride + 1 : 0;
+  whole = whole < count ? whole : count;
+  size_t k = 0;
+#ifdef __AVX2__
+  const __m256i bswap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                         15, 14, 13, 12, 11, 10, 9, 8);
+  const __m256i low_halves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+  const __m256i mask = _mm256_set1_epi64x(f.mask);
+  const __m128i shift = _mm_cvtsi32_si128(f.shift);
+  __m256i index = _mm256_setr_epi64x(f.offset, f.offset + stride, f.offset + 2 * stride, f.offset + 3 * stride);
+  const __m256i step = _mm256_set1_epi64x(4 * stride);
+  for (; k + 4 <= whole; k += 4)
+  {
+    __m256i w = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(frames), index, 1);
+    if (big_endian)
+    {
+      w = _mm256_shuffle_epi8(w, bswap);
+    }
+    w = _mm256_and_si256(_mm256_srl_epi64(w, shift), mask);
+    w = _mm256_permutevar8x32_epi32(w, low_halves);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + k), _mm256_castsi256_si128(w));
+    index = _mm256_add_epi64(index, step);
+  }
+#endif
+  for (; k < count; k++)
+  {
+    const uint8_t *p = frames + k * stride + f.offset;
+    uint64_t w = 0;
+    if (k < whole)
+    {
+      memcpy(&w, p, 8);
+    }
+    else
+    {
+      memcpy(&w, p, end - (p - frames));
+    }
+    if (big_endian)
+    {
+      w = __builtin_bswap64(w);
+    }
+    out[k] = (w >> f.shift) & f.mask;
+  }
+}
+
+/*
+ * dlt_dequantize
+ * Parameters: count values in DLT space and the minimum and spacing of their field
+ * Returns: Nothing, readings[k] is deserialize_dlt(values[k], n_min, spacing)
+ */
+inline void dlt_dequantize(const uint32_t values[], size_t count, int n_min, float spacing, float readings[])
+{
+  size_t k = 0;
+#if defined(__AVX2__)
+  const __m256 min8 = _mm256_set1_ps(n_min), spacing8 = _mm256_set1_ps(spacing);
+  for (; k + 8 <= count; k += 8)
+  {
+    __m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + k)));
+    _mm256_storeu_ps(readings + k, _mm256_add_ps(_mm256_mul_ps(v, spacing8), min8));
+  }
+#elif defined(__SSE2__)
+  const __m128 min4 = _mm_set1_ps(n_min), spacing4 = _mm_set1_ps(spacing);
+  for (; k + 4 <= count; k += 4)
+  {
+    __m128 v = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(values + k)));
+    _mm_storeu_ps(readings + k, _mm_add_ps(_mm_mul_ps(v, spacing4), min4));
+  }
+#endif
+  for (; k < count; k++)
+  {
+    readings[k] = deserialize_dlt(values[k], n_min, spacing);
+  }
+}
+
+// the readings of count frames from their columns, as dlt_untransform
+template <typename Packet>
+inline void dlt_untransform_columns(uint32_t *const columns[], size_t count, float *const readings[])
+{
+  for (uint8_t i = 0; i < Packet::COUNT; i++)
+  {
+    const DltField &f = Packet::fields[i];
+    if (readings[i] == nullptr)
+    {
+      continue;
+    }
+    switch (f.kind)
+    {
+    case DltKind::LINEAR:
+    case DltKind::IMU:
+      dlt_dequantize(columns[i], count, f.n_min, f.spacing, readings[i]);
+      break;
+    case DltKind::MICRO:
+      // the SIGN field before it, the same as the reading's sign
+      for (size_t k = 0; k < count; k++)
+      {
+        float magnitude = columns[i][k] / 1000000.0f;
+        readings[i][k] = i > 0 && columns[i - 1][k] != 1 ? -magnitude : magnitude;
+      }
+      break;
+    case DltKind::RAW:
+    case DltKind::SIGN:
+      break;
+    }
+  }
+}
+
+// the frames decoded together, a few KB of them
+constexpr size_t DLT_BATCH_BLOCK = 256;
+
+/*
+ * dlt_decode_batch
+ * Parameters: count frames of Packet stride bytes apart, laid out as layout; the columns to
+ *             unpack them to, columns[Packet::COUNT][count]; the columns of the readings,
+ *             readings[Packet::COUNT][count], for the LINEAR, IMU and MICRO fields, the rest
+ *             (and any not wanted) null; and the threads to split the frames among
+ * Returns: Nothing
+ */
+template <typename Packet>
+inline void dlt_decode_batch(const uint8_t frames[], size_t stride, size_t count, DltFrameLayout layout,
+                             uint32_t *const columns[], float *const readings[], unsigned threads = 1)
+{
+  DltBatchField fields[Packet::COUNT];
+  DltBatchLayout<Packet>::fill(layout, fields);
+  // a block of frames at a time, the block's frames staying in cache from one field to the next
+  auto run = [&](size_t first, size_t last) {
+    for (; first < last; first += DLT_BATCH_BLOCK)
+    {
+      size_t block = last - first < DLT_BATCH_BLOCK ? last - first : DLT_BATCH_BLOCK;
+      uint32_t *block_columns[Packet::COUNT];
+      float *block_readings[Packet::COUNT];
+      for (uint8_t i = 0; i < Packet::COUNT; i++)
+      {
+        block_columns[i] = columns[i] + first;
+        block_readings[i] = readings[i] != nullptr ? readings[i] + first : nullptr;
+        dlt_extract(frames + first * stride, stride, block, fields[i], layout == DltFrameLayout::BYTES,
+                    block_columns[i]);
+      }
+      dlt_untransform_columns<Packet>(block_columns, block, block_readings);
+    }
+  };
+
+  threads = threads == 0 ? 1 : threads;
+  std::vector<std::thread> workers;
+  for (unsigned t = 1; t < threads; t++)
+  {
+    workers.emplace_back(run, count * t / threads, count * (t + 1) / threads);
+  }
+  run(0, count / threads);
+  for (std::thread &worker : workers)
+  {
+    worker.join();
+  }
+}
+
+#endif
@@ -0,0 +1,103 @@
+/**************************************************************
+ *
+ *                     dltdecode.cpp
+ *
+ *     Overview: The C interface of dltdecode.h over DltStream
+ *
+ **************************************************************/
+
+#include "dltdecode.h"
+
+#include <math.h>
+#include <new>
+#include <vector>
+
+#include "../dltstream.h"
+
+static_assert(DLT_ROW_COLUMNS == DLT_COLUMN_COUNT, "a row is one double a column");
+
+// a DltRecord as a row
+static void fill_row(const DltRecord &record, dlt_row &row)
+{
+  row.schema = static_cast<uint32_t>(record.schema);
+  row.columns = record.columns;
+  row.fresh = record.fresh;
+  row.reserved = 0;
+  for (uint8_t c = 0; c < DLT_COLUMN_COUNT; c++)
+  {
+    row.values[c] = record.columns >> c & 1 ? dlt_column_value(record.telemetry, c) : NAN;
+  }
+}
+
+struct dlt_decoder
+{
+  DltStream stream;
+  std::vector<dlt_row> rows;
+  size_t first = 0; // the oldest row not yet read
+
+  void operator()(const DltRecord &record)
+  {
+    rows.emplace_back();
+    fill_row(record, rows.back());
+  }
+};
+
+unsigned dlt_column_count(void)
+{
+  return DLT_COLUMN_COUNT;
+}
+
+const char *dlt_column_name(unsigned column)
+{
+  return column < DLT_COLUMN_COUNT ? DLT_COLUMNS[column].name : nullptr;
+}
+
+int dlt_column_integer(unsigned column)
+{
+  return column < DLT_COLUMN_COUNT && DLT_COLUMNS[column].value != nullptr;
+}
+
+dlt_decoder *dlt_decoder_new(void)
+{
+  return new (std::nothrow) dlt_decoder();
+}
+
+void dlt_decoder_free(dlt_decoder *decoder)
+{
+  delete decoder;
+}
+
+size_t dlt_decoder_push(dlt_decoder *decoder, const uint8_t *bytes, size_t size)
+{
+  decoder->stream.push(bytes, size, *decoder);
+  return decoder->rows.size() - decoder->first;
+}
+
+size_t dlt_decoder_read(dlt_decoder *decoder, dlt_row *rows, size_t count)
+{
+  size_t waiting = decoder->rows.size() - decoder->first;
+  count = count < waiting ? count : waiting;
+  for (size_t k = 0; k < count; k++)
+  {
+    rows[k] = decoder->rows[decoder->first + k];
+  }
+  decoder->first += count;
+  if (decoder->first == decoder->rows.size())
+  {
+    decoder->rows.clear();
+    decoder->first = 0;
+  }
+  return count;
+}
+
+void dlt_decoder_stats(const dlt_decoder *decoder, dlt_stats *stats)
+{
+  const DltStreamStats &counts = decoder->stream.stats();
+  stats->bytes = counts.bytes;
+  stats->skipped = counts.skipped;
+  stats->packets = counts.packets;
+  stats->frames = counts.frames;
+  stats->stale = counts.stale;
+  stats->malformed = counts.malformed;
+  stats->lost = decoder->stream.lost();
+}
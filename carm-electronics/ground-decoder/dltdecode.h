@@ -0,0 +1,75 @@
+/**************************************************************
+ *
+ *                     dltdecode.h
+ *
+ *     Overview: A C interface to DltStream (dltstream.h), for the
+ *                  ground station's Python through ctypes (dltdecode.py)
+ *                  and anything else that cannot take a C++ template
+ *
+ *                  Bytes of the ground station's serial log are pushed in
+ *                  as they come and the decoded frames read out as rows:
+ *                  every column of DLT_COLUMNS as a double, NaN for those
+ *                  the frame's packet does not carry.
+ *
+ *     Build the library (from this directory):
+ *        g++ -O2 -std=c++11 -shared -fPIC -I../flight-computer dltdecode.cpp -o libdltdecode.so
+ *
+ **************************************************************/
+
+#ifndef DLTDECODE_H
+#define DLTDECODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// the columns of a row, as DLT_COLUMN_COUNT in dltstream.h
+#define DLT_ROW_COLUMNS 25
+
+  typedef struct dlt_decoder dlt_decoder;
+
+  typedef struct
+  {
+    uint32_t schema;  // DltSchema
+    uint32_t columns; // bit c set if the frame's packet carries column c
+    uint32_t fresh;   // of those, the ones in the frame, the rest held from earlier frames
+    uint32_t reserved;
+    double values[DLT_ROW_COLUMNS];
+  } dlt_row;
+
+  typedef struct
+  {
+    uint64_t bytes;
+    uint64_t skipped;
+    uint64_t packets;
+    uint64_t frames;
+    uint64_t stale;
+    uint64_t malformed;
+    uint64_t lost;
+  } dlt_stats;
+
+  unsigned dlt_column_count(void);
+  // null past the last column
+  const char *dlt_column_name(unsigned column);
+  // whether a column is a count or flags rather than a reading
+  int dlt_column_integer(unsigned column);
+
+  // null if out of memory
+  dlt_decoder *dlt_decoder_new(void);
+  void dlt_decoder_free(dlt_decoder *decoder);
+
+  // the next bytes of the log, returns the rows waiting to be read
+  size_t dlt_decoder_push(dlt_decoder *decoder, const uint8_t *bytes, size_t size);
+  // up to count waiting rows, oldest first, returns how many
+  size_t dlt_decoder_read(dlt_decoder *decoder, dlt_row *rows, size_t count);
+  void dlt_decoder_stats(const dlt_decoder *decoder, dlt_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,102 @@
+# The ground station's telemetry decoder, libdltdecode (dltdecode.h), for
+# Python. Build the library first, see dltdecode.h; set DLTDECODE_LIB to
+# load it from elsewhere than next to this file.
+#
+#   decoder = Decoder()
+#   for row in decoder.push(serial_port.read(serial_port.in_waiting)):
+#       print(row["schema"], row["altitude"])
+
+import ctypes
+import math
+import os
+
+_here = os.path.dirname(os.path.abspath(__file__))
+_lib = ctypes.CDLL(
+    os.environ.get("DLTDECODE_LIB", os.path.join(_here, "libdltdecode.so"))
+)
+
+SCHEMAS = ["power_on", "launch_ready", "launch_mode", "recovery", "no_schema"]
+
+_lib.dlt_column_count.restype = ctypes.c_uint
+_lib.dlt_column_name.restype = ctypes.c_char_p
+_lib.dlt_column_name.argtypes = [ctypes.c_uint]
+COLUMNS = [_lib.dlt_column_name(c).decode() for c in range(_lib.dlt_column_count())]
+
+
+class Row(ctypes.Structure):
+    _fields_ = [
+        ("schema", ctypes.c_uint32),
+        ("columns", ctypes.c_uint32),
+        ("fresh", ctypes.c_uint32),
+        ("reserved", ctypes.c_uint32),
+        ("values", ctypes.c_double * len(COLUMNS)),
+    ]
+
+
+class Stats(ctypes.Structure):
+    _fields_ = [
+        (name, ctypes.c_uint64)
+        for name in [
+            "bytes",
+            "skipped",
+            "packets",
+            "frames",
+            "stale",
+            "malformed",
+            "lost",
+        ]
+    ]
+
+
+# a row of the CLI's --binary output, for numpy.fromfile
+ROW = [("schema", "<u4"), ("columns", "<u4"), ("fresh", "<u4"), ("reserved", "<u4")] + [
+    (name, "<f8") for name in COLUMNS
+]
+
+_lib.dlt_decoder_new.restype = ctypes.c_void_p
+_lib.dlt_decoder_free.argtypes = [ctypes.c_void_p]
+_lib.dlt_decoder_push.restype = ctypes.c_size_t
+_lib.dlt_decoder_push.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_size_t]
+_lib.dlt_decoder_read.restype = ctypes.c_size_t
+_lib.dlt_decoder_read.argtypes = [ctypes.c_void_p, ctypes.POINTER(Row), ctypes.c_size_t]
+_lib.dlt_decoder_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(Stats)]
+
+
+class Decoder:
+    """
+    Bytes of the ground station's serial log in, a dict per decoded frame
+    out: "schema", "fresh" (the columns in the frame itself, the others
+    held from earlier frames) and the columns the frame's packet carries
+    """
+
+    def __init__(self):
+        self._decoder = _lib.dlt_decoder_new()
+        if not self._decoder:
+            raise MemoryError("dlt_decoder_new")
+
+    def __del__(self):
+        if getattr(self, "_decoder", None):
+            _lib.dlt_decoder_free(self._decoder)
+            self._decoder = None
+
+    def push(self, data):
+        waiting = _lib.dlt_decoder_push(self._decoder, bytes(data), len(data))
+        rows = (Row * waiting)()
+        count = _lib.dlt_decoder_read(self._decoder, rows, waiting)
+        return [self._to_dict(rows[k]) for k in range(count)]
+
+    def stats(self):
+        stats = Stats()
+        _lib.dlt_decoder_stats(self._decoder, ctypes.byref(stats))
+        return {name: getattr(stats, name) for name, _ in Stats._fields_}
+
+    @staticmethod
+    def _to_dict(row):
+        decoded = {
+            "schema": SCHEMAS[row.schema] if row.schema < len(SCHEMAS) else "unknown",
+            "fresh": [name for c, name in enumerate(COLUMNS) if row.fresh >> c & 1],
+        }
+        for c, name in enumerate(COLUMNS):
+            if not math.isnan(row.values[c]):
+                decoded[name] = row.values[c]
+        return decoded
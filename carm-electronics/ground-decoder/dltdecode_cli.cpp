@@ -0,0 +1,124 @@
+/**************************************************************
+ *
+ *                     dltdecode_cli.cpp
+ *
+ *     Overview: Decodes a captured ground station log (dltstream.h) to
+ *                  CSV, a row per frame with a column for each quantity,
+ *                  empty where the frame's packet does not carry it; or,
+ *                  with --binary, to the dlt_row structs of dltdecode.h
+ *                  back to back, for numpy.fromfile with dltdecode.ROW
+ *
+ *                  The readings are written as the shortest text that reads
+ *                  back to the same float, with std::to_chars, so this one
+ *                  file is C++17. The counts of DltStreamStats go to stderr
+ *                  at the end.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++17 -I../flight-computer dltdecode_cli.cpp dltdecode.cpp -o dltdecode
+ *     Run:
+ *        ./dltdecode [--binary] [log [out]]
+ *        with stdin and stdout for a log or out not given
+ *
+ **************************************************************/
+
+#include <charconv>
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "dltdecode.h"
+
+static const size_t CHUNK = 1 << 20;
+static const size_t ROWS = 4096;
+
+static const char *SCHEMA_NAMES[] = {"power_on", "launch_ready", "launch_mode", "recovery", "no_schema"};
+
+static void write_csv_header(FILE *out)
+{
+  fputs("schema", out);
+  for (unsigned c = 0; c < dlt_column_count(); c++)
+  {
+    fprintf(out, ",%s", dlt_column_name(c));
+  }
+  fputs(",fresh\n", out);
+}
+
+// the integer columns as integers, the readings as the floats they were
+static void write_csv_row(const dlt_row &row, const bool integer[], FILE *out)
+{
+  char line[64 + 24 * DLT_ROW_COLUMNS];
+  char *end = line + sizeof(line);
+  const char *schema = row.schema < 5 ? SCHEMA_NAMES[row.schema] : "unknown";
+  size_t length = strlen(schema);
+  memcpy(line, schema, length);
+  char *p = line + length;
+  for (unsigned c = 0; c < DLT_ROW_COLUMNS; c++)
+  {
+    *p++ = ',';
+    if (isnan(row.values[c]))
+    {
+      continue;
+    }
+    p = integer[c] ? std::to_chars(p, end, static_cast<uint32_t>(row.values[c])).ptr
+                   : std::to_chars(p, end, static_cast<float>(row.values[c])).ptr;
+  }
+  *p++ = ',';
+  p = std::to_chars(p, end, row.fresh).ptr;
+  *p++ = '\n';
+  fwrite(line, 1, p - line, out);
+}
+
+int main(int argc, char *argv[])
+{
+  bool binary = argc > 1 && strcmp(argv[1], "--binary") == 0;
+  int arg = binary ? 2 : 1;
+  FILE *in = argc > arg ? fopen(argv[arg], "rb") : stdin;
+  FILE *out = argc > arg + 1 ? fopen(argv[arg + 1], binary ? "wb" : "w") : stdout;
+  if (in == nullptr || out == nullptr)
+  {
+    fprintf(stderr, "usage: %s [--binary] [log [out]]\n", argv[0]);
+    return 1;
+  }
+
+  dlt_decoder *decoder = dlt_decoder_new();
+  static uint8_t bytes[CHUNK];
+  static dlt_row rows[ROWS];
+  bool integer[DLT_ROW_COLUMNS];
+  for (unsigned c = 0; c < DLT_ROW_COLUMNS; c++)
+  {
+    integer[c] = dlt_column_integer(c);
+  }
+  if (!binary)
+  {
+    write_csv_header(out);
+  }
+  size_t size;
+  while ((size = fread(bytes, 1, sizeof(bytes), in)) > 0)
+  {
+    dlt_decoder_push(decoder, bytes, size);
+    size_t count;
+    while ((count = dlt_decoder_read(decoder, rows, ROWS)) > 0)
+    {
+      if (binary)
+      {
+        fwrite(rows, sizeof(dlt_row), count, out);
+        continue;
+      }
+      for (size_t k = 0; k < count; k++)
+      {
+        write_csv_row(rows[k], integer, out);
+      }
+    }
+  }
+
+  dlt_stats stats;
+  dlt_decoder_stats(decoder, &stats);
+  fprintf(stderr,
+          "%" PRIu64 " bytes, %" PRIu64 " skipped; %" PRIu64 " packets, %" PRIu64 " not telemetry; %" PRIu64
+          " frames decoded, %" PRIu64 " stale, %" PRIu64 " lost\n",
+          stats.bytes, stats.skipped, stats.packets, stats.malformed, stats.frames, stats.stale, stats.lost);
+  dlt_decoder_free(decoder);
+  fclose(out);
+  return 0;
+}
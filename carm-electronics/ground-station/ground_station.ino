@@ -12,9 +12,8 @@
  **************************************************************/
 
 #include <RH_RF95.h>
-#include "DLTransforms.h"
-#include "untransformed.h"
-#include "decompression.h"
+#include "dltstream.h"
+#include "fec.h"
 
 #if defined(ADAFRUIT_FEATHER_M0) || defined(ADAFRUIT_FEATHER_M0_EXPRESS) || defined(ARDUINO_SAMD_FEATHER_M0) // Feather M0 w/Radio
 #define RFM95_CS 8
@@ -24,19 +23,14 @@
 #endif
 
 #define RF95_FREQ 433.0
-static const unsigned DECIMAL_COUNT = 4;
-static const unsigned GPS_DECIMAL_COUNT = 6;
 
 // - - - - - - - - - - - - - - - - - - - - - - - - - - -
 //   Initializing revelant objects and structs
 // - - - - - - - - - - - - - - - - - - - - - - - - - - -
 // Singleton instance of the radio driver
 RH_RF95 rf95(RFM95_CS, RFM95_INT);
-
-// - - - - - - - - - - - - - - - - - - - - - - - - - - -
-//   Function contracts
-// - - - - - - - - - - - - - - - - - - - - - - - - - - -
-void uint16_to_binary_string(uint16_t num, char *result);
+// the last telemetry keyframe, the delta frames are decoded against it
+DltDeltaDecoder telemetry_frames;
 
 void setup()
 {
@@ -82,88 +76,64 @@ void setup()
     // If you are using RFM95/96/97/98 modules which uses the PA_BOOST transmitter pin, then
     // you can set transmitter powers from 5 to 23 dBm:
     rf95.setTxPower(23, false);
+
+    // telemetry packets with error correction come without the CRC, and a
+    // byte in error in the header's address would drop them (fec.h); the
+    // radio still drops packets sent with a CRC that fails
+    rf95.setPayloadCRC(false);
+    rf95.setPromiscuous(true);
 }
 
 void loop()
 {
-    uint64_t buf[5];
-    uint8_t len = sizeof(buf);
+    uint8_t frame[RH_RF95_MAX_MESSAGE_LEN];
+    uint8_t len = sizeof(frame);
 
-    if (rf95.available())
+    if (rf95.available() && rf95.recv(frame, &len))
     {
-        // Should be a reply message for us now
-        if (rf95.recv((uint8_t *)buf, &len))
+        // corrected in place, a packet with more errors than its parity
+        // corrects is lost as the CRC would have lost it
+        size_t size = len;
+        if (fec_decode(frame, size) < 0)
         {
-            // the first word will always have the state in the first four bits
-            // unsigned int *launchmode_d = unpack_noschema(buf);
-            // launchmodedata launchdata = untransform_launchmode(launchmode_d); // TODO: rename the var
-
-            // // Print all the data to serial so the parser can read it and send it to the db and dashboard
-            // Serial.print(launchdata.curr_state);
-            // Serial.print(",");
-            // Serial.print(launchdata.gps_num_satellites);
-            // Serial.print(",");
-            // Serial.print(float(launchdata.gps_long / 1000000), GPS_DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(float(launchdata.gps_lat / 1000000), GPS_DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.gyro_x, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.accel_y, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.gyro_y, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.vert_velo, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.gyro_z, DECIMAL_COUNT);
-            // Serial.print(",");
-
-            // Serial.print(launchdata.accel_x, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.altitude, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.gps_fix);
-            // Serial.print(",");
-            // // Serial.print(launchdata.external_temp, DECIMAL_COUNT);
-            // // Serial.print(",");
-            // Serial.print(launchdata.temperature_avbay, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.accel_z, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.mag_y, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.mag_z, DECIMAL_COUNT);
-            // Serial.print(",");
-
-            // char failures_bits_str[17];
-            // uint16_to_binary_string(launchdata.failures, failures_bits_str);
-            // Serial.print(failures_bits_str);
-            // Serial.print(",");
-
-            // Serial.print(launchdata.gps_speed, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.gps_altitude, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.print(launchdata.gps_quality);
-            // // Serial.print(",");
-            // // Serial.print(launchdata.temperature_engbay, DECIMAL_COUNT);
-            // Serial.print(",");
-            // Serial.println(launchdata.gps_antenna_status);
-
-            for (int i = 0; i < 4; i++) {
-                Serial.print(buf[i]);
-                Serial.print(",");
+            return;
+        }
+        len = size;
+
+        // every packet goes to the computer as a log record, which decodes
+        // it (ground-decoder/, dltstream.h)
+        uint8_t header[2];
+        Serial.write(header, dlt_log_header(len, header));
+        Serial.write(frame, len);
+
+        // a packet holds one or more telemetry frames back to back, an APRS
+        // packet none; they are only decoded here to know when to ask for
+        // a keyframe
+        uint32_t values[DLT_MAX_COUNT];
+        bool stale = false;
+        size_t offset = 0, used;
+        DltDecoded decoded;
+        while (offset < len &&
+               (decoded = telemetry_frames.decode(frame + offset, len - offset, values, used)) !=
+                   DltDecoded::MALFORMED)
+        {
+            // a stale frame's size is unknown, nothing after it is a frame
+            if (decoded == DltDecoded::STALE)
+            {
+                stale = true;
+                break;
             }
-            Serial.println(buf[4]);
+            offset += used;
         }
-    }
-}
 
-void uint16_to_binary_string(uint16_t num, char *result)
-{
-    for (int i = 15; i >= 0; i--)
-    {
-        result[15 - i] = ((num & (1 << i)) ? '1' : '0');
+        // deltas against a keyframe we never received, ask for a new one
+        if (stale)
+        {
+            uint8_t request[1];
+            rf95.setPayloadCRC(true);
+            rf95.send(request, dlt_request_keyframe(request));
+            rf95.waitPacketSent();
+            rf95.setPayloadCRC(false);
+        }
     }
-    result[16] = '\0'; // Null-terminate the string
-}
\ No newline at end of file
+}
@@ -8,19 +8,29 @@ import pdb
 from queue import Empty
 import serial
 import csv
+import os
+
+sys.path.append(
+    os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "ground-decoder")
+)
+import dltdecode
+
+# a column for the packet of each frame, then one for each quantity, empty
+# where the packet does not carry it
+HEADERS = ["schema"] + dltdecode.COLUMNS
 
 
 class Rocket:
 
     def __init__(self):
-        self.time_series_data = {"Compressed Data": []}
+        self.time_series_data = {header: [] for header in HEADERS}
         self.written_data = []
 
     # Need to make getter and setter funcs bc proxy objs are spawned by the manager,
     #   so direct access is not possible
     def set(self, min_dict):
-        for key, value in min_dict.items():
-            self.time_series_data[key].append(value)
+        for key in self.time_series_data:
+            self.time_series_data[key].append(min_dict.get(key, ""))
         # print(self.time_series_data)
 
     def get(self):
@@ -40,14 +50,16 @@ def read_serial_data(rocket, timeout=1):
 
         print(f"Connected to COM11 at 115200 baudrate.")
 
+        # the ground station forwards every packet it receives as a log
+        # record, decoded here (ground-decoder/dltdecode.py)
+        decoder = dltdecode.Decoder()
         while True:
             if ser.in_waiting > 0:
-                data = ser.readline().decode("utf-8").strip()
-                labeled_data = {"Compressed Data": data}
-                rocket.set(labeled_data)
+                for row in decoder.push(ser.read(ser.in_waiting)):
+                    rocket.set(row)
+                    print(row)
 
             # Sleep for a short duration to avoid busy-waiting
-            print(data)
             time.sleep(0.1)
 
     except serial.SerialException as e:
@@ -70,7 +82,7 @@ def write_to_csv(rocket):
         rows = zip(*data_to_write.values())
 
         with open(
-            "compresseddata.csv",
+            "telemetry.csv",
             "a",
             newline="",
         ) as csvfile:
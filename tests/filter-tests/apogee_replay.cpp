@@ -0,0 +1,122 @@
+/**************************************************************
+ *
+ *                     apogee_replay.cpp
+ *
+ *     Overview: Replays the synthetic (OpenRocket) and recorded flights
+ *                  through AltitudeEstimator and ApogeePredictor with the
+ *                  flight constants and reports:
+ *                  - how the predicted apogee time and altitude converge in
+ *                    the seconds before the true apogee
+ *                  - when apogee is called by the predictor, by the old
+ *                    [0, 1] m/s velocity window and by the velocity fallback,
+ *                    relative to the true apogee
+ *                  - the cost of one predictor update
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer apogee_replay.cpp
+ *            ../../carm-electronics/flight-computer/altitude.cpp
+ *            ../../carm-electronics/flight-computer/apogee.cpp
+ *            ../../carm-electronics/flight-computer/filters.cpp
+ *            ../../carm-electronics/flight-computer/algebra.cpp -o apogee_replay
+ *     Run:
+ *        ./apogee_replay [imu log] [openrocket export]
+ *
+ **************************************************************/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "altitude.h"
+#include "apogee.h"
+#include "movingstats.h"
+#include "../../carm-electronics/StateDetermination.h"
+#include "flightlog.hpp"
+
+static const float LOOKAHEADS[] = {5, 3, 2, 1, 0.5};
+static const int LOOKAHEAD_COUNT = sizeof(LOOKAHEADS) / sizeof(LOOKAHEADS[0]);
+// the velocity calls are made on the average of the last few estimates
+static const uint16_t VELOCITY_WINDOW = 5;
+
+static void replay(const Flight &flight)
+{
+    AltitudeEstimator estimator(SIGMA_ACCEL, SIGMA_GYRO, SIGMA_BARO, CA, ACCEL_THRESHOLD, SIGMA_GPS);
+    ApogeePredictor predictor(APOGEE_DRAG_SMOOTHING, APOGEE_MIN_DRAG_VELOCITY);
+    MovingStats<float, VELOCITY_WINDOW> velocity_window;
+
+    // apogee calls, ms; only looked for once the rocket is well on its way up
+    float called_predictor = NAN, called_window = NAN, called_fallback = NAN;
+    bool coasting = false;
+    int next_lookahead = 0;
+    double update_ns = 0;
+    size_t updates = 0;
+
+    std::printf("%s flight: true apogee %.1f m at %.2f s\n", flight.name, flight.true_apogee_altitude,
+                flight.true_apogee / 1000.0f);
+    std::printf("  %12s %16s %18s %10s\n", "before apogee", "predicted time", "predicted altitude", "drag k");
+    for (size_t k = 0; k < flight.time.size(); k++)
+    {
+        float accel[3] = {flight.accel[0][k], flight.accel[1][k], flight.accel[2][k]};
+        float gyro[3] = {flight.gyro[0][k], flight.gyro[1][k], flight.gyro[2][k]};
+        uint32_t t = flight.time[k];
+        // the filters run on us
+        uint32_t t_us = t * 1000;
+        estimator.predict(accel, gyro, t_us);
+        estimator.updateBaro(flight.baro[k], t_us);
+        float altitude = estimator.getAltitude();
+        float velocity = estimator.getVerticalVelocity();
+
+        auto start = std::chrono::steady_clock::now();
+        predictor.update(altitude, velocity, estimator.getVerticalAcceleration(), t_us);
+        update_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        updates++;
+
+        velocity_window.push(velocity);
+        if (!coasting)
+        {
+            // stands in for BURNOUT_PHASE -> COAST_PHASE
+            coasting = flight.true_burnout >= 0 && t >= flight.true_burnout;
+            continue;
+        }
+        float v = velocity_window.mean();
+        if (std::isnan(called_predictor) && predictor.valid(APOGEE_MIN_DRAG_SAMPLES) &&
+            predictor.getTimeToApogee() <= APOGEE_LEAD_TIME)
+            called_predictor = t;
+        if (std::isnan(called_window) && v >= 0 && v <= 1)
+            called_window = t;
+        if (std::isnan(called_fallback) && v <= 1)
+            called_fallback = t;
+
+        while (next_lookahead < LOOKAHEAD_COUNT &&
+               t >= flight.true_apogee - LOOKAHEADS[next_lookahead] * 1000)
+        {
+            std::printf("  %11.1fs %+15.2fs %+17.1fm %10.5f\n", LOOKAHEADS[next_lookahead],
+                        (predictor.getApogeeTime() / 1000.0f - flight.true_apogee) / 1000.0f,
+                        predictor.getApogeeAltitude() - flight.true_apogee_altitude,
+                        predictor.getDragCoefficient());
+            next_lookahead++;
+        }
+    }
+    std::printf("  apogee called, relative to the true apogee (s):\n");
+    std::printf("    predictor          %+.3f\n", (called_predictor - flight.true_apogee) / 1000.0f);
+    std::printf("    velocity in [0, 1] %+.3f\n", (called_window - flight.true_apogee) / 1000.0f);
+    std::printf("    velocity <= 1      %+.3f\n", (called_fallback - flight.true_apogee) / 1000.0f);
+    std::printf("  predictor update: %.1f ns\n\n", update_ns / updates);
+}
+
+int main(int argc, char **argv)
+{
+    const char *log_path = argc > 1 ? argv[1] : "G53FJ_10Feb24.csv";
+    const char *truth_path = argc > 2 ? argv[2] : "openrocket_revG.csv";
+    std::vector<ImuSample> log;
+    std::vector<TruthSample> truth;
+    if (!load_imu_log(log_path, log) || !load_openrocket(truth_path, truth))
+    {
+        std::fprintf(stderr, "Unable to open %s or %s\n", log_path, truth_path);
+        return 1;
+    }
+    replay(synthesize_flight(truth, log, MAIN_DEPLOY_ALTITUDE));
+    replay(recorded_flight(log, MAIN_DEPLOY_ALTITUDE));
+    return 0;
+}
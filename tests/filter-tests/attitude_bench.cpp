@@ -0,0 +1,227 @@
+/**************************************************************
+ *
+ *                     attitude_bench.cpp
+ *
+ *     Overview: Compares the attitude engines AltitudeEstimator can use
+ *                  (3x3 gravity Kalman filter vs Mahony quaternion filter)
+ *                  on a recorded IMU log:
+ *                  - cost of one update (ns and, on x86, TSC cycles)
+ *                  - vertical acceleration error on the pad, where the truth
+ *                    is 0 m/s^2
+ *                  - vertical acceleration error in flight against the
+ *                    acceleration derived from the barometer track, over
+ *                    the whole ascent and over the coast alone (the boost
+ *                    is too short for the baro-derived reference to follow)
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer attitude_bench.cpp
+ *            ../../carm-electronics/flight-computer/filters.cpp
+ *            ../../carm-electronics/flight-computer/algebra.cpp -o attitude_bench
+ *     Run:
+ *        ./attitude_bench [imu log, default G53FJ_10Feb24.csv]
+ *
+ **************************************************************/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "filters.h"
+#include "flightlog.hpp"
+
+// standard noise deviations used in flight, see StateDetermination.h
+static const float SIGMA_GYRO = 0.337;
+static const float SIGMA_ACCEL = 0.640;
+static const float CA = 0.5;
+static const float MAHONY_KP = 0.5;
+static const float MAHONY_KI = 0.0;
+static const float MAHONY_ACCEL_GATE = 0.15;
+static const int TIMING_REPEATS = 50;
+
+struct EngineResult
+{
+    const char *name;
+    double ns_per_update;
+    double cycles_per_update;
+    std::vector<float> vertical_accel;
+};
+
+// runs one engine over the log the way AltitudeEstimator::predict() does
+static void replay(AttitudeFilter &filter, const std::vector<ImuSample> &log,
+                   bool use_mag, std::vector<float> &vertical_accel)
+{
+    vertical_accel.assign(log.size(), 0);
+    for (size_t i = 1; i < log.size(); i++)
+    {
+        float accel[3], gyro[3], mag[3];
+        for (int k = 0; k < 3; k++)
+        {
+            accel[k] = log[i - 1].accel[k] / 9.81f;
+            gyro[k] = log[i - 1].gyro[k];
+            mag[k] = log[i - 1].mag[k];
+        }
+        if (use_mag)
+        {
+            filter.setMagnetometer(mag);
+        }
+        float deltat = (log[i].time - log[i - 1].time) / 1000.0f;
+        vertical_accel[i] = filter.estimate(gyro, accel, deltat);
+    }
+}
+
+template <class Filter, class Make>
+static EngineResult run_engine(const char *name, Make make, const std::vector<ImuSample> &log, bool use_mag)
+{
+    EngineResult r;
+    r.name = name;
+    {
+        Filter filter = make();
+        replay(filter, log, use_mag, r.vertical_accel);
+    }
+
+    // timing: the update itself only, inputs prepared up front
+    std::vector<float> scratch;
+    auto start = std::chrono::steady_clock::now();
+#ifdef HAVE_TSC
+    unsigned long long tsc_start = __rdtsc();
+#endif
+    for (int rep = 0; rep < TIMING_REPEATS; rep++)
+    {
+        Filter filter = make();
+        replay(filter, log, use_mag, scratch);
+    }
+#ifdef HAVE_TSC
+    unsigned long long tsc_end = __rdtsc();
+#endif
+    auto end = std::chrono::steady_clock::now();
+    double updates = (double)TIMING_REPEATS * (log.size() - 1);
+    r.ns_per_update = std::chrono::duration<double, std::nano>(end - start).count() / updates;
+#ifdef HAVE_TSC
+    r.cycles_per_update = (tsc_end - tsc_start) / updates;
+#else
+    r.cycles_per_update = 0;
+#endif
+    return r;
+}
+
+// second derivative of the barometric altitude by a local quadratic fit over
+// +-half_window_ms, the reference vertical acceleration in flight
+static std::vector<float> baro_acceleration(const std::vector<ImuSample> &log, uint32_t half_window_ms)
+{
+    std::vector<float> accel(log.size(), NAN);
+    size_t lo = 0, hi = 0;
+    for (size_t i = 0; i < log.size(); i++)
+    {
+        while (log[i].time - log[lo].time > half_window_ms)
+            lo++;
+        while (hi + 1 < log.size() && log[hi + 1].time - log[i].time <= half_window_ms)
+            hi++;
+        if (hi - lo < 5)
+            continue;
+        // least squares h = c0 + c1 t + c2 t^2, accel = 2 c2
+        double s[5] = {0, 0, 0, 0, 0}, r[3] = {0, 0, 0};
+        for (size_t j = lo; j <= hi; j++)
+        {
+            double t = ((double)log[j].time - log[i].time) / 1000.0;
+            double p = 1;
+            for (int k = 0; k < 5; k++)
+            {
+                s[k] += p;
+                if (k < 3)
+                    r[k] += p * log[j].altitude;
+                p *= t;
+            }
+        }
+        double m[3][4] = {{s[0], s[1], s[2], r[0]}, {s[1], s[2], s[3], r[1]}, {s[2], s[3], s[4], r[2]}};
+        for (int c = 0; c < 3; c++)
+            for (int row = c + 1; row < 3; row++)
+            {
+                double f = m[row][c] / m[c][c];
+                for (int k = c; k < 4; k++)
+                    m[row][k] -= f * m[c][k];
+            }
+        double c2 = m[2][3] / m[2][2];
+        accel[i] = (float)(2 * c2);
+    }
+    return accel;
+}
+
+static double rms(const std::vector<float> &a, const std::vector<float> &b, size_t from, size_t to)
+{
+    double sum = 0;
+    size_t n = 0;
+    for (size_t i = from; i < to && i < a.size(); i++)
+    {
+        if (std::isnan(b[i]))
+            continue;
+        double d = a[i] - b[i];
+        sum += d * d;
+        n++;
+    }
+    return n ? std::sqrt(sum / n) : NAN;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "G53FJ_10Feb24.csv";
+    std::vector<ImuSample> log;
+    if (!load_imu_log(path, log))
+    {
+        std::fprintf(stderr, "Unable to open %s\n", path);
+        return 1;
+    }
+
+    // liftoff: first sample above 2 g, burnout: first sample after it below
+    // 1 g, apogee: highest baro altitude after liftoff
+    size_t liftoff = 0, burnout = 0, apogee = 0;
+    for (size_t i = 0; i < log.size(); i++)
+    {
+        float n = std::sqrt(log[i].accel[0] * log[i].accel[0] + log[i].accel[1] * log[i].accel[1] +
+                            log[i].accel[2] * log[i].accel[2]);
+        if (liftoff == 0 && n > 2 * 9.81f)
+        {
+            liftoff = i;
+        }
+        else if (liftoff != 0 && n < 9.81f)
+        {
+            burnout = i;
+            break;
+        }
+    }
+    for (size_t i = liftoff; i < log.size(); i++)
+        if (log[i].altitude > log[apogee].altitude)
+            apogee = i;
+    size_t pad_end = liftoff;
+    while (pad_end > 0 && log[liftoff].time - log[pad_end].time < 1000)
+        pad_end--;
+
+    std::vector<float> zeros(log.size(), 0);
+    std::vector<float> reference = baro_acceleration(log, 250);
+
+    std::vector<EngineResult> results;
+    results.push_back(run_engine<KalmanFilter>(
+        "kalman (3x3)", [] { return KalmanFilter(CA, SIGMA_GYRO, SIGMA_ACCEL); }, log, false));
+    results.push_back(run_engine<MahonyFilter>(
+        "mahony", [] { return MahonyFilter(MAHONY_KP, MAHONY_KI, MAHONY_ACCEL_GATE); }, log, false));
+    results.push_back(run_engine<MahonyFilter>(
+        "mahony + mag", [] { return MahonyFilter(MAHONY_KP, MAHONY_KI, MAHONY_ACCEL_GATE); }, log, true));
+
+    std::printf("log: %s, %zu samples, liftoff at %u ms, burnout at %u ms, baro apogee at %u ms\n\n",
+                path, log.size(), log[liftoff].time, log[burnout].time, log[apogee].time);
+    std::printf("%-14s %10s %14s %10s %12s %12s\n", "engine", "ns/update", "cycles/update",
+                "pad rms", "ascent rms", "coast rms");
+    for (const EngineResult &r : results)
+    {
+        std::printf("%-14s %10.1f %14.0f %10.3f %12.3f %12.3f\n", r.name, r.ns_per_update, r.cycles_per_update,
+                    rms(r.vertical_accel, zeros, 1, pad_end),
+                    rms(r.vertical_accel, reference, liftoff, apogee),
+                    rms(r.vertical_accel, reference, burnout, apogee));
+    }
+    std::printf("\nrms values are vertical acceleration errors in m/s^2\n");
+    return 0;
+}
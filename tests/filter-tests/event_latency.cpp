@@ -0,0 +1,401 @@
+/**************************************************************
+ *
+ *                     event_latency.cpp
+ *
+ *     Overview: How long after the real event StateDeterminer switches
+ *                  state. Replays flights through the real StateDeterminer
+ *                  (AltitudeEstimator, ApogeePredictor and FLIGHT_RULES)
+ *                  and reports, per flight and per event, the detection
+ *                  latency and the false triggers.
+ *
+ *                  Flights and their truth:
+ *                  - OpenRocket exports, turned into sensor streams with the
+ *                    pad noise of the IMU log (synthesize_flight); truth is
+ *                    the simulation
+ *                  - recorded logs (IMU logs and BBManager datalogs), every
+ *                    session; truth comes from the RTS smoother (rts.hpp).
+ *                    Sessions in which the smoother finds no launch are pad
+ *                    time, where any transition is a false trigger
+ *
+ *                  Events are launch (POWERED_FLIGHT_PHASE), burnout
+ *                  (BURNOUT_PHASE), apogee (APOGEE_PHASE) and main
+ *                  (MAIN_DEPLOY_ATTEMPT). A detection more than
+ *                  FALSE_TRIGGER_MARGIN ahead of the truth counts as a false
+ *                  trigger rather than a negative latency.
+ *
+ *                  Each event is also timed on every one of the redundant
+ *                  detectors (detectors.h) on its own, before the vote.
+ *
+ *                  The last line is the score to bring down when the state
+ *                  logic or the filter changes: the mean absolute latency
+ *                  over all detected events, plus the misses and false
+ *                  triggers.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer event_latency.cpp
+ *            ../../carm-electronics/StateDetermination.cpp
+ *            ../../carm-electronics/flight-computer/altitude.cpp
+ *            ../../carm-electronics/flight-computer/apogee.cpp
+ *            ../../carm-electronics/flight-computer/filters.cpp
+ *            ../../carm-electronics/flight-computer/algebra.cpp
+ *            ../../carm-electronics/flight-computer/transitions.cpp
+ *            ../../carm-electronics/flight-computer/detectors.cpp -o event_latency
+ *     Run:
+ *        ./event_latency [--truth openrocket.csv ...] [log ...]
+ *
+ *        with no arguments: openrocket_revG.csv, G53FJ_10Feb24.csv,
+ *        shifted_time_alt.csv and ../data-analysis/data/test-flight2/DATALOG.CSV
+ *
+ **************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "altitude.h"
+#include "../../carm-electronics/StateDetermination.h"
+#include "flightlog.hpp"
+#include "rts.hpp"
+
+enum Event
+{
+    LAUNCH = 0,
+    BURNOUT,
+    APOGEE,
+    MAIN,
+    EVENT_COUNT
+};
+
+static const char *EVENT_NAMES[EVENT_COUNT] = {"launch", "burnout", "apogee", "main"};
+static const state EVENT_STATES[EVENT_COUNT] = {state::POWERED_FLIGHT_PHASE, state::BURNOUT_PHASE,
+                                                state::APOGEE_PHASE, state::MAIN_DEPLOY_ATTEMPT};
+static const double FALSE_TRIGGER_MARGIN = 500; // ms
+static const double SMOOTHER_JERK = 50;
+static const uint32_t PAD_WINDOW = 1000; // ms
+
+struct Replay
+{
+    std::string name;
+    std::vector<SensorFrame> frames;
+    // ms, negative when unknown or when the flight has no such event
+    double truth[EVENT_COUNT];
+    bool pad_only;
+};
+
+struct Totals
+{
+    double latency_sum[EVENT_COUNT] = {0};
+    double latency_max[EVENT_COUNT] = {0};
+    int detected[EVENT_COUNT] = {0};
+    int missed[EVENT_COUNT] = {0};
+    int false_triggers[EVENT_COUNT] = {0};
+    int other_false_triggers = 0;
+    // each of the redundant detectors on its own, signed latency
+    double detector_sum[DETECTOR_COUNT][EVENT_COUNT] = {{0}};
+    int detector_found[DETECTOR_COUNT][EVENT_COUNT] = {{0}};
+    int detector_expected[DETECTOR_COUNT][EVENT_COUNT] = {{0}};
+};
+
+static const char *DETECTOR_NAMES[DETECTOR_COUNT] = {"fused", "baro", "imu"};
+// events each detector can judge at all (detectors.h)
+static const bool DETECTOR_EVENTS[DETECTOR_COUNT][EVENT_COUNT] = {
+    {true, true, true, true}, {true, false, true, true}, {true, true, true, false}};
+
+static int event_of(state s)
+{
+    for (int e = 0; e < EVENT_COUNT; e++)
+        if (EVENT_STATES[e] == s)
+            return e;
+    return -1;
+}
+
+static void replay(const Replay &r, Totals &totals)
+{
+    StateDeterminer determiner;
+    double detected[EVENT_COUNT];
+    std::fill(detected, detected + EVENT_COUNT, -1.0);
+    int false_triggers = 0;
+    std::vector<std::string> notes;
+    for (const SensorFrame &frame : r.frames)
+    {
+        if (determiner.update(frame) < 0)
+            continue;
+        double time = frame.time / 1000.0; // ms, as the truth
+        state now = determiner.getState();
+        int e = event_of(now);
+        char note[96];
+        if (r.pad_only)
+        {
+            std::snprintf(note, sizeof(note), "false trigger: state %d at %.2f s on the pad",
+                          static_cast<int>(now), time / 1000.0);
+            notes.push_back(note);
+            false_triggers++;
+            totals.other_false_triggers++;
+            continue;
+        }
+        if (e < 0 || detected[e] >= 0)
+            continue;
+        if (r.truth[e] >= 0 && time < r.truth[e] - FALSE_TRIGGER_MARGIN)
+        {
+            std::snprintf(note, sizeof(note), "false trigger: %s at %.2f s, %.2f s early", EVENT_NAMES[e],
+                          time / 1000.0, (r.truth[e] - time) / 1000.0);
+            notes.push_back(note);
+            totals.false_triggers[e]++;
+            false_triggers++;
+        }
+        detected[e] = time;
+    }
+
+    std::printf("%s: %zu samples%s\n", r.name.c_str(), r.frames.size(), r.pad_only ? ", on the pad" : "");
+    if (!r.pad_only)
+    {
+        const EventVoter &voter = determiner.getVoter();
+        std::printf("  %-8s %10s %10s %12s | detectors (ms): %6s %6s %6s\n", "event", "truth (s)", "state (s)",
+                    "latency (ms)", DETECTOR_NAMES[0], DETECTOR_NAMES[1], DETECTOR_NAMES[2]);
+        for (int e = 0; e < EVENT_COUNT; e++)
+        {
+            // what each detector latched, before the vote
+            char detectors[64] = "";
+            for (int d = 0; d < DETECTOR_COUNT; d++)
+            {
+                Detector detector = static_cast<Detector>(d);
+                FlightEvent event = static_cast<FlightEvent>(e);
+                char cell[16] = "     -";
+                if (r.truth[e] >= 0 && DETECTOR_EVENTS[d][e])
+                {
+                    totals.detector_expected[d][e]++;
+                    if (voter.hasFired(detector, event))
+                    {
+                        double latency = voter.firedAt(detector, event) / 1000.0 - r.truth[e];
+                        std::snprintf(cell, sizeof(cell), "%+6.0f", latency);
+                        totals.detector_found[d][e]++;
+                        totals.detector_sum[d][e] += latency;
+                    }
+                    else
+                        std::snprintf(cell, sizeof(cell), "%6s", "missed");
+                }
+                std::snprintf(detectors + std::strlen(detectors), sizeof(detectors) - std::strlen(detectors),
+                              " %s", cell);
+            }
+            if (r.truth[e] < 0)
+            {
+                std::printf("  %-8s %10s %10s %12s |               %s\n", EVENT_NAMES[e], "-",
+                            detected[e] < 0 ? "-" : "detected", "no truth", detectors);
+                continue;
+            }
+            if (detected[e] < 0)
+            {
+                std::printf("  %-8s %10.2f %10s %12s |               %s\n", EVENT_NAMES[e], r.truth[e] / 1000.0,
+                            "-", "missed", detectors);
+                totals.missed[e]++;
+                continue;
+            }
+            double latency = detected[e] - r.truth[e];
+            std::printf("  %-8s %10.2f %10.2f %+12.0f |               %s\n", EVENT_NAMES[e], r.truth[e] / 1000.0,
+                        detected[e] / 1000.0, latency, detectors);
+            if (latency >= -FALSE_TRIGGER_MARGIN)
+            {
+                totals.detected[e]++;
+                totals.latency_sum[e] += std::fabs(latency);
+                totals.latency_max[e] = std::max(totals.latency_max[e], std::fabs(latency));
+            }
+        }
+    }
+    for (const std::string &note : notes)
+        std::printf("  %s\n", note.c_str());
+    if (r.pad_only && !false_triggers)
+        std::printf("  no transitions\n");
+    std::printf("\n");
+}
+
+// truth of a recorded session from the RTS smoother, on the same vertical
+// acceleration the flight code computes
+static void smooth_truth(Replay &r)
+{
+    AltitudeEstimator estimator(SIGMA_ACCEL, SIGMA_GYRO, SIGMA_BARO, CA, ACCEL_THRESHOLD, SIGMA_GPS);
+    RtsSmoother smoother(SMOOTHER_JERK, SIGMA_BARO, SIGMA_ACCEL, MAIN_DEPLOY_ALTITUDE);
+    for (const SensorFrame &f : r.frames)
+    {
+        float accel[3], gyro[3] = {f.gyro[0], f.gyro[1], f.gyro[2]};
+        for (int k = 0; k < 3; k++)
+            accel[k] = f.accel[k] / FLIGHTLOG_GRAVITY;
+        uint32_t time = static_cast<uint32_t>(f.time);
+        estimator.predict(accel, gyro, time);
+        if (f.baro_valid)
+            estimator.updateBaro(f.altitude, time);
+        smoother.push(f.time / 1000, f.baro_valid ? f.altitude : NAN, estimator.getVerticalAcceleration());
+    }
+    FlightSummary summary = smoother.smooth();
+    r.pad_only = summary.launch_time < 0;
+    r.truth[LAUNCH] = summary.launch_time;
+    r.truth[BURNOUT] = summary.burnout_time;
+    r.truth[APOGEE] = r.pad_only ? -1 : summary.apogee_time;
+    r.truth[MAIN] = summary.main_time;
+}
+
+// every session of a log, altitudes above the median of its first second
+static void load_recorded(const char *path, std::vector<Replay> &replays)
+{
+    ImuLogReader reader;
+    if (!reader.open(path))
+    {
+        std::fprintf(stderr, "Unable to open %s\n", path);
+        return;
+    }
+    std::vector<std::vector<ImuSample>> sessions;
+    ImuSample s;
+    while (reader.next(s))
+    {
+        if (reader.newSession())
+            sessions.emplace_back();
+        sessions.back().push_back(s);
+    }
+    for (size_t i = 0; i < sessions.size(); i++)
+    {
+        std::vector<float> pad;
+        for (const ImuSample &p : sessions[i])
+            if (p.time < PAD_WINDOW && !std::isnan(p.altitude))
+                pad.push_back(p.altitude);
+        float pad_altitude = 0;
+        if (!pad.empty())
+        {
+            std::nth_element(pad.begin(), pad.begin() + pad.size() / 2, pad.end());
+            pad_altitude = pad[pad.size() / 2];
+        }
+
+        Replay r;
+        r.name = path;
+        if (sessions.size() > 1)
+            r.name += " session " + std::to_string(i);
+        for (const ImuSample &p : sessions[i])
+        {
+            SensorFrame f;
+            f.time = p.time * 1000ULL;
+            for (int k = 0; k < 3; k++)
+            {
+                f.accel[k] = p.accel[k];
+                f.gyro[k] = p.gyro[k];
+                f.mag[k] = p.mag[k];
+            }
+            f.baro_valid = !std::isnan(p.altitude);
+            f.altitude = p.altitude - pad_altitude;
+            r.frames.push_back(f);
+        }
+        smooth_truth(r);
+        replays.push_back(r);
+    }
+}
+
+static void load_simulated(const char *truth_path, const std::vector<ImuSample> &noise_log,
+                           std::vector<Replay> &replays)
+{
+    std::vector<TruthSample> truth;
+    if (!load_openrocket(truth_path, truth))
+    {
+        std::fprintf(stderr, "Unable to open %s\n", truth_path);
+        return;
+    }
+    Flight flight = synthesize_flight(truth, noise_log, MAIN_DEPLOY_ALTITUDE);
+    Replay r;
+    r.name = std::string(truth_path) + " (simulated)";
+    r.pad_only = false;
+    for (size_t k = 0; k < flight.time.size(); k++)
+    {
+        SensorFrame f;
+        f.time = flight.time[k] * 1000ULL;
+        for (int a = 0; a < 3; a++)
+        {
+            f.accel[a] = flight.accel[a][k] * FLIGHTLOG_GRAVITY;
+            f.gyro[a] = flight.gyro[a][k];
+            f.mag[a] = 0;
+        }
+        f.altitude = flight.baro[k];
+        f.baro_valid = true;
+        r.frames.push_back(f);
+    }
+    r.truth[LAUNCH] = flight.true_launch;
+    r.truth[BURNOUT] = flight.true_burnout;
+    r.truth[APOGEE] = flight.true_apogee;
+    r.truth[MAIN] = flight.true_main;
+    replays.push_back(r);
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<const char *> truths, logs;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--truth") && i + 1 < argc)
+            truths.push_back(argv[++i]);
+        else
+            logs.push_back(argv[i]);
+    }
+    if (truths.empty() && logs.empty())
+    {
+        truths.push_back("openrocket_revG.csv");
+        logs.push_back("G53FJ_10Feb24.csv");
+        logs.push_back("shifted_time_alt.csv");
+        logs.push_back("../data-analysis/data/test-flight2/DATALOG.CSV");
+    }
+
+    std::vector<Replay> replays;
+    if (!truths.empty())
+    {
+        // simulated flights take their sensor noise from the pad of the IMU log
+        std::vector<ImuSample> noise_log;
+        if (!load_imu_log("G53FJ_10Feb24.csv", noise_log))
+        {
+            std::fprintf(stderr, "Unable to open G53FJ_10Feb24.csv for the sensor noise\n");
+            return 1;
+        }
+        for (const char *path : truths)
+            load_simulated(path, noise_log, replays);
+    }
+    for (const char *path : logs)
+        load_recorded(path, replays);
+
+    Totals totals;
+    for (const Replay &r : replays)
+        replay(r, totals);
+
+    std::printf("%-8s %9s %9s %7s %7s %15s\n", "event", "mean (ms)", "max (ms)", "found", "missed", "false triggers");
+    double sum = 0;
+    int found = 0, missed = 0, false_triggers = totals.other_false_triggers;
+    for (int e = 0; e < EVENT_COUNT; e++)
+    {
+        int n = totals.detected[e];
+        std::printf("%-8s %9.0f %9.0f %7d %7d %15d\n", EVENT_NAMES[e], n ? totals.latency_sum[e] / n : NAN,
+                    totals.latency_max[e], n, totals.missed[e], totals.false_triggers[e]);
+        sum += totals.latency_sum[e];
+        found += n;
+        missed += totals.missed[e];
+        false_triggers += totals.false_triggers[e];
+    }
+    std::printf("pad false triggers: %d\n\n", totals.other_false_triggers);
+
+    std::printf("detectors alone, mean latency (ms) and found/expected\n%-8s", "");
+    for (int e = 0; e < EVENT_COUNT; e++)
+        std::printf(" %16s", EVENT_NAMES[e]);
+    std::printf("\n");
+    for (int d = 0; d < DETECTOR_COUNT; d++)
+    {
+        std::printf("%-8s", DETECTOR_NAMES[d]);
+        for (int e = 0; e < EVENT_COUNT; e++)
+        {
+            int n = totals.detector_found[d][e];
+            if (!DETECTOR_EVENTS[d][e])
+                std::printf(" %16s", "-");
+            else
+                std::printf(" %+9.0f %2d/%-2d", n ? totals.detector_sum[d][e] / n : NAN, n,
+                            totals.detector_expected[d][e]);
+        }
+        std::printf("\n");
+    }
+    std::printf("\n");
+    std::printf("score: %.0f ms mean latency, %d missed, %d false triggers\n", found ? sum / found : NAN, missed,
+                false_triggers);
+    return 0;
+}
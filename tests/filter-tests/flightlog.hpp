@@ -0,0 +1,434 @@
+/**************************************************************
+ *
+ *                     flightlog.hpp
+ *
+ *     Overview: Loaders for the flight logs kept in this repo so the
+ *                  host-side filter tools can replay them through the
+ *                  flight code
+ *
+ *     Formats:
+ *        - IMU log (G53FJ_10Feb24.csv, shifted_time*.csv):
+ *            t,AX,AY,AZ,GX,GY,GZ,T,mX,mY,mZ,BT,BP,BA
+ *        - BBManager datalog (DATALOG.CSV), read by column name so the
+ *          columns added over time do not matter
+ *        - OpenRocket export (openrocket_revG.csv), simulated truth:
+ *            time,altitude,vert_velo,vert_accel
+ *
+ *     Both can be turned into a Flight, the sensor stream the flight code
+ *     sees plus whatever truth is known about it.
+ *
+ **************************************************************/
+
+#ifndef FLIGHTLOG_HPP
+#define FLIGHTLOG_HPP
+
+#include <inttypes.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct ImuSample
+{
+    uint32_t time;    // ms
+    float accel[3];   // m/s^2
+    float gyro[3];    // rad/s
+    float mag[3];
+    float pressure;   // hPa
+    float altitude;   // m, barometric
+};
+
+struct TruthSample
+{
+    float time;       // s
+    float altitude;   // m above the pad
+    float velocity;   // m/s
+    float accel;      // m/s^2, vertical, gravity excluded
+};
+
+// splits one csv line into floats, returns the number of fields read
+inline size_t split_csv_floats(const std::string &line, std::vector<float> &fields)
+{
+    fields.clear();
+    std::istringstream ss(line);
+    std::string token;
+    while (std::getline(ss, token, ','))
+    {
+        try
+        {
+            fields.push_back(std::stof(token));
+        }
+        catch (...)
+        {
+            fields.push_back(0);
+        }
+    }
+    return fields.size();
+}
+
+// streams an IMU log or a BBManager datalog one sample at a time, so long
+// logs never have to be held in memory. Columns are found by header name;
+// times are shifted so the first sample is at t = 0. A datalog holds every
+// power cycle of the board: when the clock goes backwards a new session
+// starts, again at t = 0, and newSession() reports it
+class ImuLogReader
+{
+public:
+    bool open(const std::string &path)
+    {
+        file.open(path);
+        std::string header;
+        if (!file.is_open() || !std::getline(file, header))
+        {
+            return false;
+        }
+        // IMU log and datalog names for each ImuSample field
+        static const char *const NAMES[COLUMN_COUNT][2] = {
+            {"t", "time (ms)"},
+            {"AX", "x acceleration (m/s^2)"},
+            {"AY", "y acceleration (m/s^2)"},
+            {"AZ", "z acceleration (m/s^2)"},
+            {"GX", "x gyro (dps)"},
+            {"GY", "y gyro (dps)"},
+            {"GZ", "z gyro (dps)"},
+            {"mX", "x magnetic force (gauss)"},
+            {"mY", "y magnetic force (gauss)"},
+            {"mZ", "z magnetic force (gauss)"},
+            {"BP", "air pressure (kPa)"},
+            {"BA", "altitude (m)"},
+        };
+        std::vector<std::string> names;
+        std::istringstream ss(header);
+        std::string name;
+        while (std::getline(ss, name, ','))
+        {
+            if (!name.empty() && name.back() == '\r')
+                name.pop_back();
+            names.push_back(name);
+        }
+        required_fields = 0;
+        for (int c = 0; c < COLUMN_COUNT; c++)
+        {
+            column[c] = -1;
+            for (size_t i = 0; i < names.size(); i++)
+                if (names[i] == NAMES[c][0] || names[i] == NAMES[c][1])
+                    column[c] = (int)i;
+            if (column[c] < 0)
+                return false;
+            required_fields = std::max(required_fields, (size_t)column[c] + 1);
+        }
+        return true;
+    }
+
+    // false at the end of the file, malformed rows are skipped
+    bool next(ImuSample &s)
+    {
+        while (std::getline(file, line))
+        {
+            // strtod rather than streams, datalogs run to tens of thousands
+            // of rows
+            fields.clear();
+            const char *p = line.c_str();
+            for (;;)
+            {
+                char *end;
+                double v = std::strtod(p, &end);
+                fields.push_back(end == p ? NAN : v);
+                p = std::strchr(end, ',');
+                if (!p)
+                    break;
+                p++;
+            }
+            if (fields.size() < required_fields || std::isnan(fields[column[TIME]]))
+            {
+                continue;
+            }
+            // times in the raw logs do not fit in a float's mantissa
+            double t = fields[column[TIME]];
+            session_started = first_time < 0 || t < last_time;
+            if (session_started)
+            {
+                first_time = t;
+            }
+            last_time = t;
+            s.time = (uint32_t)(t - first_time);
+            for (int k = 0; k < 3; k++)
+            {
+                s.accel[k] = fields[column[ACCEL + k]];
+                s.gyro[k] = fields[column[GYRO + k]];
+                s.mag[k] = fields[column[MAG + k]];
+            }
+            s.pressure = fields[column[PRESSURE]];
+            s.altitude = fields[column[ALTITUDE]];
+            return true;
+        }
+        return false;
+    }
+
+    // true if the sample returned by the last next() opened a session
+    bool newSession() const { return session_started; }
+
+private:
+    enum
+    {
+        TIME = 0,
+        ACCEL = 1,
+        GYRO = 4,
+        MAG = 7,
+        PRESSURE = 10,
+        ALTITUDE = 11,
+        COLUMN_COUNT = 12
+    };
+    std::ifstream file;
+    std::string line;
+    std::vector<double> fields;
+    int column[COLUMN_COUNT];
+    size_t required_fields = 0;
+    double first_time = -1;
+    double last_time = 0;
+    bool session_started = false;
+};
+
+// loads an IMU log or datalog, keeping its longest session (the flight)
+inline bool load_imu_log(const std::string &path, std::vector<ImuSample> &samples)
+{
+    ImuLogReader reader;
+    if (!reader.open(path))
+    {
+        return false;
+    }
+    std::vector<ImuSample> session;
+    ImuSample s;
+    samples.clear();
+    while (reader.next(s))
+    {
+        if (reader.newSession() && session.size() > samples.size())
+            samples.swap(session);
+        if (reader.newSession())
+            session.clear();
+        session.push_back(s);
+    }
+    if (session.size() > samples.size())
+        samples.swap(session);
+    return !samples.empty();
+}
+
+// loads an OpenRocket export, samples are unevenly spaced in time
+inline bool load_openrocket(const std::string &path, std::vector<TruthSample> &samples)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    std::string line;
+    std::vector<float> f;
+    std::getline(file, line); // header
+    while (std::getline(file, line))
+    {
+        if (split_csv_floats(line, f) < 4)
+        {
+            continue;
+        }
+        TruthSample s;
+        s.time = f[0];
+        s.altitude = f[1];
+        s.velocity = f[2];
+        s.accel = f[3];
+        samples.push_back(s);
+    }
+    return !samples.empty();
+}
+
+// truth linearly interpolated at time t (s), clamped to the ends of the run
+inline TruthSample interpolate_truth(const std::vector<TruthSample> &truth, float t)
+{
+    if (t <= truth.front().time)
+    {
+        return truth.front();
+    }
+    if (t >= truth.back().time)
+    {
+        return truth.back();
+    }
+    size_t lo = 0, hi = truth.size() - 1;
+    while (hi - lo > 1)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (truth[mid].time <= t)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    float w = (t - truth[lo].time) / (truth[hi].time - truth[lo].time);
+    TruthSample s;
+    s.time = t;
+    s.altitude = truth[lo].altitude + w * (truth[hi].altitude - truth[lo].altitude);
+    s.velocity = truth[lo].velocity + w * (truth[hi].velocity - truth[lo].velocity);
+    s.accel = truth[lo].accel + w * (truth[hi].accel - truth[lo].accel);
+    return s;
+}
+
+static const float FLIGHTLOG_GRAVITY = 9.81;
+// synthetic flights: pad time before the OpenRocket run and sampling period
+static const float SYNTH_PAD_TIME = 2.0;
+static const uint32_t SYNTH_PERIOD_MS = 25;
+
+// one flight as the estimator sees it, plus whatever truth is known
+struct Flight
+{
+    const char *name;
+    std::vector<uint32_t> time;   // ms
+    std::vector<float> accel[3];  // g
+    std::vector<float> gyro[3];   // rad/s
+    std::vector<float> baro;      // m above the pad
+    // per-sample truth, empty for recorded flights
+    std::vector<float> true_altitude;
+    std::vector<float> true_velocity;
+    // truth event times in ms, negative if unknown
+    float true_launch, true_burnout, true_apogee, true_main;
+    float true_apogee_altitude;
+};
+
+// sensor noise on the pad of a log: accel x/y/z, gyro x/y/z and baro, over
+// its first second
+struct PadStatistics
+{
+    float mean[7];
+    float stddev[7];
+};
+
+inline PadStatistics pad_statistics(const std::vector<ImuSample> &log)
+{
+    double mean[7] = {0}, sq[7] = {0};
+    size_t n = 0;
+    for (; n < log.size() && log[n].time < 1000; n++)
+    {
+        float v[7] = {log[n].accel[0], log[n].accel[1], log[n].accel[2],
+                      log[n].gyro[0], log[n].gyro[1], log[n].gyro[2], log[n].altitude};
+        for (int k = 0; k < 7; k++)
+        {
+            mean[k] += v[k];
+            sq[k] += v[k] * v[k];
+        }
+    }
+    PadStatistics pad;
+    for (int k = 0; k < 7; k++)
+    {
+        mean[k] /= n;
+        pad.mean[k] = mean[k];
+        pad.stddev[k] = std::sqrt(std::max(0.0, sq[k] / n - mean[k] * mean[k]));
+    }
+    return pad;
+}
+
+// IMU and baro generated from the OpenRocket truth, rocket standing straight
+// up along the IMU x axis (as in the recorded log), noise and gyro bias taken
+// from the recorded log's pad segment
+inline Flight synthesize_flight(const std::vector<TruthSample> &truth, const std::vector<ImuSample> &log,
+                                float main_altitude, unsigned seed = 1)
+{
+    PadStatistics pad = pad_statistics(log);
+    const float *mean = pad.mean, *stddev = pad.stddev;
+
+    Flight f;
+    f.name = "synthetic";
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0, 1);
+    float end = SYNTH_PAD_TIME + truth.back().time;
+    float true_apogee = 0, apogee_time = 0, burnout_time = -1, main_time = -1;
+    for (uint32_t t = 0; t / 1000.0f <= end; t += SYNTH_PERIOD_MS)
+    {
+        float flight_time = t / 1000.0f - SYNTH_PAD_TIME;
+        TruthSample s;
+        if (flight_time < 0)
+        {
+            s.time = flight_time;
+            s.altitude = 0;
+            s.velocity = 0;
+            s.accel = 0;
+        }
+        else
+        {
+            s = interpolate_truth(truth, flight_time);
+        }
+        // specific force along the vertical axis
+        float specific = s.accel + FLIGHTLOG_GRAVITY;
+        f.time.push_back(t);
+        f.accel[0].push_back((specific + stddev[0] * noise(rng)) / FLIGHTLOG_GRAVITY);
+        f.accel[1].push_back((stddev[1] * noise(rng)) / FLIGHTLOG_GRAVITY);
+        f.accel[2].push_back((stddev[2] * noise(rng)) / FLIGHTLOG_GRAVITY);
+        for (int k = 0; k < 3; k++)
+            f.gyro[k].push_back(mean[3 + k] + stddev[3 + k] * noise(rng));
+        f.baro.push_back(s.altitude + stddev[6] * noise(rng));
+        f.true_altitude.push_back(s.altitude);
+        f.true_velocity.push_back(s.velocity);
+
+        if (s.altitude > true_apogee)
+        {
+            true_apogee = s.altitude;
+            apogee_time = t;
+        }
+        if (flight_time > 0 && burnout_time < 0 && s.accel < 0)
+            burnout_time = t;
+        if (apogee_time > 0 && main_time < 0 && s.velocity < 0 && s.altitude <= main_altitude)
+            main_time = t;
+    }
+    f.true_launch = SYNTH_PAD_TIME * 1000;
+    f.true_burnout = burnout_time;
+    f.true_apogee = apogee_time;
+    f.true_main = main_time;
+    f.true_apogee_altitude = true_apogee;
+    return f;
+}
+
+// the recorded log as StateDeterminer sees it: baro zeroed on the pad as
+// BBManager::setBaroOffset does, events from the log itself
+inline Flight recorded_flight(const std::vector<ImuSample> &log, float main_altitude)
+{
+    Flight f;
+    f.name = "recorded";
+    double pad = 0;
+    size_t n = 0;
+    for (; n < log.size() && log[n].time < 1000; n++)
+        pad += log[n].altitude;
+    pad /= n;
+
+    f.true_launch = f.true_burnout = f.true_apogee = f.true_main = -1;
+    f.true_apogee_altitude = -1e9f;
+    for (const ImuSample &s : log)
+    {
+        f.time.push_back(s.time);
+        for (int k = 0; k < 3; k++)
+        {
+            f.accel[k].push_back(s.accel[k] / FLIGHTLOG_GRAVITY);
+            f.gyro[k].push_back(s.gyro[k]);
+        }
+        float altitude = s.altitude - pad;
+        f.baro.push_back(altitude);
+        float norm = std::sqrt(s.accel[0] * s.accel[0] + s.accel[1] * s.accel[1] + s.accel[2] * s.accel[2]);
+        if (f.true_launch < 0 && norm > 2 * FLIGHTLOG_GRAVITY)
+            f.true_launch = s.time;
+        else if (f.true_launch >= 0 && f.true_burnout < 0 && norm < FLIGHTLOG_GRAVITY)
+            f.true_burnout = s.time;
+        if (f.true_launch >= 0 && altitude > f.true_apogee_altitude)
+        {
+            f.true_apogee_altitude = altitude;
+            f.true_apogee = s.time;
+        }
+    }
+    for (size_t k = 0; k < log.size(); k++)
+        if (log[k].time > f.true_apogee && f.baro[k] <= main_altitude)
+        {
+            f.true_main = log[k].time;
+            break;
+        }
+    return f;
+}
+
+#endif
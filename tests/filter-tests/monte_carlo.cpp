@@ -0,0 +1,372 @@
+/**************************************************************
+ *
+ *                     monte_carlo.cpp
+ *
+ *     Overview: How often StateDeterminer misfires. Generates thousands of
+ *                  variants of one simulated flight and runs each through
+ *                  the real StateDeterminer (AltitudeEstimator,
+ *                  ApogeePredictor and FLIGHT_RULES) on every core, then
+ *                  reports the distribution of the transition latencies and
+ *                  the misfire rate.
+ *
+ *                  Every run starts from the OpenRocket truth and the pad
+ *                  noise of the IMU log (as synthesize_flight does) and draws
+ *                  its own perturbation:
+ *                  - accel and gyro bias, accel, gyro and baro noise scaled
+ *                    from the pad noise
+ *                  - dropouts: baro readings that fail, IMU readings that
+ *                    come back stale
+ *                  - timing: jitter on the loop period, stalls (SD writes)
+ *                    and a random time on the pad
+ *                  - accel and gyro clipped at the ranges of def.h
+ *
+ *                  Events are launch, burnout, apogee and main, timed as in
+ *                  event_latency.cpp; a detection more than
+ *                  FALSE_TRIGGER_MARGIN ahead of the truth is a misfire.
+ *
+ *                  Run k always uses seed + k, so the results do not depend
+ *                  on the number of threads. Runs are handed out in chunks
+ *                  and share nothing but the chunk counter, so the sweep
+ *                  scales with the cores.
+ *
+ *     Build (from this directory):
+ *        g++ -O3 -std=c++11 -pthread -I../../carm-electronics/flight-computer monte_carlo.cpp
+ *            ../../carm-electronics/StateDetermination.cpp
+ *            ../../carm-electronics/flight-computer/altitude.cpp
+ *            ../../carm-electronics/flight-computer/apogee.cpp
+ *            ../../carm-electronics/flight-computer/filters.cpp
+ *            ../../carm-electronics/flight-computer/algebra.cpp
+ *            ../../carm-electronics/flight-computer/transitions.cpp
+ *            ../../carm-electronics/flight-computer/detectors.cpp -o monte_carlo
+ *     Run:
+ *        ./monte_carlo [--runs N] [--threads N] [--seed N] [--csv runs.csv]
+ *                      [--log G53FJ_10Feb24.csv] [--truth openrocket_revG.csv]
+ *
+ **************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "def.h"
+#include "../../carm-electronics/StateDetermination.h"
+#include "flightlog.hpp"
+
+enum Event
+{
+    LAUNCH = 0,
+    BURNOUT,
+    APOGEE,
+    MAIN,
+    EVENT_COUNT
+};
+
+static const char *EVENT_NAMES[EVENT_COUNT] = {"launch", "burnout", "apogee", "main"};
+static const state EVENT_STATES[EVENT_COUNT] = {state::POWERED_FLIGHT_PHASE, state::BURNOUT_PHASE,
+                                                state::APOGEE_PHASE, state::MAIN_DEPLOY_ATTEMPT};
+static const float FALSE_TRIGGER_MARGIN = 500; // ms
+// how long after the truth main the run keeps going before calling it missed
+static const float MAIN_TIMEOUT = 10000; // ms
+static const size_t CHUNK = 16;
+
+// perturbation ranges, per run
+static const float ACCEL_BIAS_SIGMA = 0.03;       // g
+static const float GYRO_BIAS_SIGMA = 0.02;        // rad/s
+static const float NOISE_SCALE_MIN = 0.5;         // of the pad noise
+static const float NOISE_SCALE_MAX = 3;
+static const float BARO_DROPOUT_MAX = 0.05;       // probability per sample
+static const float IMU_STALE_MAX = 0.02;          // probability per sample
+static const float PERIOD_JITTER_MAX = 5;         // ms, either way
+static const float STALL_PROBABILITY = 0.002;     // per sample
+static const float STALL_MIN = 50, STALL_MAX = 300; // ms
+static const float PAD_TIME_MAX = 5;              // s on top of SYNTH_PAD_TIME
+
+static const float ACCEL_LIMIT = IMU_ACCEL_RANGE_G;                      // g
+static const float GYRO_LIMIT = IMU_GYRO_RANGE_DPS * 3.14159265f / 180;  // rad/s
+
+struct Perturbation
+{
+    float accel_bias[3];
+    float gyro_bias[3];
+    float accel_noise, gyro_noise, baro_noise;
+    float baro_dropout, imu_stale;
+    float jitter;
+    float pad_time; // s
+};
+
+struct RunResult
+{
+    Perturbation p;
+    float latency[EVENT_COUNT]; // ms, NAN when missed
+    bool misfire[EVENT_COUNT];
+    uint32_t samples;
+};
+
+// truth events in flight time (s), as synthesize_flight finds them
+struct TruthEvents
+{
+    float burnout, apogee, main;
+};
+
+static TruthEvents truth_events(const std::vector<TruthSample> &truth, float main_altitude)
+{
+    TruthEvents events = {-1, 0, -1};
+    float apogee_altitude = 0;
+    for (const TruthSample &s : truth)
+    {
+        if (s.altitude > apogee_altitude)
+        {
+            apogee_altitude = s.altitude;
+            events.apogee = s.time;
+        }
+        if (s.time > 0 && events.burnout < 0 && s.accel < 0)
+            events.burnout = s.time;
+        if (events.apogee > 0 && events.main < 0 && s.velocity < 0 && s.altitude <= main_altitude)
+            events.main = s.time;
+    }
+    return events;
+}
+
+static Perturbation draw(std::mt19937 &rng)
+{
+    std::normal_distribution<float> normal(0, 1);
+    std::uniform_real_distribution<float> uniform(0, 1);
+    Perturbation p;
+    for (int k = 0; k < 3; k++)
+    {
+        p.accel_bias[k] = ACCEL_BIAS_SIGMA * normal(rng);
+        p.gyro_bias[k] = GYRO_BIAS_SIGMA * normal(rng);
+    }
+    p.accel_noise = NOISE_SCALE_MIN + (NOISE_SCALE_MAX - NOISE_SCALE_MIN) * uniform(rng);
+    p.gyro_noise = NOISE_SCALE_MIN + (NOISE_SCALE_MAX - NOISE_SCALE_MIN) * uniform(rng);
+    p.baro_noise = NOISE_SCALE_MIN + (NOISE_SCALE_MAX - NOISE_SCALE_MIN) * uniform(rng);
+    p.baro_dropout = BARO_DROPOUT_MAX * uniform(rng);
+    p.imu_stale = IMU_STALE_MAX * uniform(rng);
+    p.jitter = PERIOD_JITTER_MAX * uniform(rng);
+    p.pad_time = SYNTH_PAD_TIME + PAD_TIME_MAX * uniform(rng);
+    return p;
+}
+
+static float clip(float v, float limit)
+{
+    return std::max(-limit, std::min(limit, v));
+}
+
+// one perturbed flight, generated sample by sample straight into the
+// StateDeterminer
+static RunResult run(unsigned seed, const std::vector<TruthSample> &truth, const TruthEvents &events,
+                     const PadStatistics &pad)
+{
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0, 1);
+    std::uniform_real_distribution<float> uniform(0, 1);
+    RunResult r;
+    r.p = draw(rng);
+    const Perturbation &p = r.p;
+
+    float truth_ms[EVENT_COUNT] = {p.pad_time * 1000, (p.pad_time + events.burnout) * 1000,
+                                   (p.pad_time + events.apogee) * 1000, (p.pad_time + events.main) * 1000};
+    for (int e = 0; e < EVENT_COUNT; e++)
+    {
+        r.latency[e] = NAN;
+        r.misfire[e] = false;
+    }
+
+    StateDeterminer determiner;
+    SensorFrame frame;
+    float accel[3] = {0}, gyro[3] = {0};
+    float end = std::min((p.pad_time + truth.back().time) * 1000, truth_ms[MAIN] + MAIN_TIMEOUT);
+    int found = 0;
+    r.samples = 0;
+    for (float t = 0; t <= end && found < EVENT_COUNT;)
+    {
+        float flight_time = t / 1000 - p.pad_time;
+        TruthSample s;
+        if (flight_time < 0)
+        {
+            s.altitude = 0;
+            s.accel = 0;
+        }
+        else
+        {
+            s = interpolate_truth(truth, flight_time);
+        }
+
+        // stale IMU readings repeat the last ones
+        if (r.samples == 0 || uniform(rng) >= p.imu_stale)
+        {
+            float specific[3] = {(s.accel + FLIGHTLOG_GRAVITY) / FLIGHTLOG_GRAVITY, 0, 0};
+            for (int k = 0; k < 3; k++)
+            {
+                float a = specific[k] + p.accel_bias[k] + p.accel_noise * pad.stddev[k] / FLIGHTLOG_GRAVITY * noise(rng);
+                accel[k] = clip(a, ACCEL_LIMIT) * FLIGHTLOG_GRAVITY;
+                gyro[k] = clip(pad.mean[3 + k] + p.gyro_bias[k] + p.gyro_noise * pad.stddev[3 + k] * noise(rng),
+                               GYRO_LIMIT);
+            }
+        }
+        // the jitter is kept to the us, as the flight clock would see it
+        frame.time = static_cast<uint64_t>(t * 1000.0);
+        for (int k = 0; k < 3; k++)
+        {
+            frame.accel[k] = accel[k];
+            frame.gyro[k] = gyro[k];
+            frame.mag[k] = 0;
+        }
+        frame.baro_valid = uniform(rng) >= p.baro_dropout;
+        frame.altitude = frame.baro_valid ? s.altitude + p.baro_noise * pad.stddev[6] * noise(rng) : 0;
+        r.samples++;
+
+        if (determiner.update(frame) >= 0)
+        {
+            state now = determiner.getState();
+            for (int e = 0; e < EVENT_COUNT; e++)
+            {
+                if (EVENT_STATES[e] != now || !std::isnan(r.latency[e]))
+                    continue;
+                r.latency[e] = frame.time / 1000.0f - truth_ms[e];
+                r.misfire[e] = r.latency[e] < -FALSE_TRIGGER_MARGIN;
+                found++;
+            }
+        }
+
+        t += SYNTH_PERIOD_MS + p.jitter * (2 * uniform(rng) - 1);
+        if (uniform(rng) < STALL_PROBABILITY)
+            t += STALL_MIN + (STALL_MAX - STALL_MIN) * uniform(rng);
+    }
+    return r;
+}
+
+// value at fraction q of the sorted values
+static float percentile(const std::vector<float> &sorted, double q)
+{
+    if (sorted.empty())
+        return NAN;
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(q * sorted.size()))];
+}
+
+int main(int argc, char **argv)
+{
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t runs = 10000;
+    unsigned seed = 1;
+    std::string csv_path, log_path = "G53FJ_10Feb24.csv", truth_path = "openrocket_revG.csv";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!std::strcmp(argv[i], "--runs"))
+            runs = std::strtoul(argv[i + 1], NULL, 10);
+        else if (!std::strcmp(argv[i], "--threads"))
+            threads = std::max(1, std::atoi(argv[i + 1]));
+        else if (!std::strcmp(argv[i], "--seed"))
+            seed = std::strtoul(argv[i + 1], NULL, 10);
+        else if (!std::strcmp(argv[i], "--csv"))
+            csv_path = argv[i + 1];
+        else if (!std::strcmp(argv[i], "--log"))
+            log_path = argv[i + 1];
+        else if (!std::strcmp(argv[i], "--truth"))
+            truth_path = argv[i + 1];
+    }
+
+    std::vector<ImuSample> log;
+    std::vector<TruthSample> truth;
+    if (!load_imu_log(log_path, log) || !load_openrocket(truth_path, truth))
+    {
+        std::fprintf(stderr, "Unable to open %s or %s\n", log_path.c_str(), truth_path.c_str());
+        return 1;
+    }
+    PadStatistics pad = pad_statistics(log);
+    TruthEvents events = truth_events(truth, MAIN_DEPLOY_ALTITUDE);
+
+    std::vector<RunResult> results(runs);
+    std::atomic<size_t> next_chunk(0);
+    auto worker = [&]() {
+        for (;;)
+        {
+            size_t start = next_chunk.fetch_add(CHUNK);
+            if (start >= runs)
+                return;
+            size_t stop = std::min(runs, start + CHUNK);
+            for (size_t k = start; k < stop; k++)
+                results[k] = run(seed + k, truth, events, pad);
+        }
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++)
+        pool.emplace_back(worker);
+    for (std::thread &t : pool)
+        t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    size_t samples = 0;
+    for (const RunResult &r : results)
+        samples += r.samples;
+    std::printf("%zu runs on %u threads in %.2f s (%.0f runs/s, %.1f M samples/s)\n\n", runs, threads, seconds,
+                runs / seconds, samples / seconds / 1e6);
+
+    if (!csv_path.empty())
+    {
+        FILE *csv = std::fopen(csv_path.c_str(), "w");
+        if (csv)
+        {
+            std::fprintf(csv, "run,accel_bias_x,accel_bias_y,accel_bias_z,gyro_bias_x,gyro_bias_y,gyro_bias_z,"
+                              "accel_noise,gyro_noise,baro_noise,baro_dropout,imu_stale,jitter,pad_time");
+            for (int e = 0; e < EVENT_COUNT; e++)
+                std::fprintf(csv, ",%s_latency,%s_misfire", EVENT_NAMES[e], EVENT_NAMES[e]);
+            std::fprintf(csv, "\n");
+            for (size_t k = 0; k < runs; k++)
+            {
+                const Perturbation &p = results[k].p;
+                std::fprintf(csv, "%zu,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g", k, p.accel_bias[0], p.accel_bias[1],
+                             p.accel_bias[2], p.gyro_bias[0], p.gyro_bias[1], p.gyro_bias[2], p.accel_noise,
+                             p.gyro_noise, p.baro_noise, p.baro_dropout, p.imu_stale, p.jitter, p.pad_time);
+                for (int e = 0; e < EVENT_COUNT; e++)
+                    std::fprintf(csv, ",%g,%d", results[k].latency[e], results[k].misfire[e]);
+                std::fprintf(csv, "\n");
+            }
+            std::fclose(csv);
+        }
+    }
+
+    std::printf("%-8s %8s %8s %8s | %9s %8s %8s %8s %8s %8s\n", "event", "found", "missed", "misfire", "mean (ms)",
+                "p1", "p50", "p90", "p99", "max");
+    size_t bad_runs = 0;
+    for (const RunResult &r : results)
+    {
+        bool bad = false;
+        for (int e = 0; e < EVENT_COUNT; e++)
+            bad = bad || r.misfire[e] || std::isnan(r.latency[e]);
+        bad_runs += bad;
+    }
+    for (int e = 0; e < EVENT_COUNT; e++)
+    {
+        std::vector<float> latencies;
+        size_t misfires = 0;
+        double sum = 0;
+        for (const RunResult &r : results)
+        {
+            if (r.misfire[e])
+                misfires++;
+            else if (!std::isnan(r.latency[e]))
+            {
+                latencies.push_back(r.latency[e]);
+                sum += r.latency[e];
+            }
+        }
+        std::sort(latencies.begin(), latencies.end());
+        size_t missed = runs - misfires - latencies.size();
+        std::printf("%-8s %8zu %8zu %8zu | %9.0f %8.0f %8.0f %8.0f %8.0f %8.0f\n", EVENT_NAMES[e],
+                    latencies.size(), missed, misfires, latencies.empty() ? NAN : sum / latencies.size(),
+                    percentile(latencies, 0.01), percentile(latencies, 0.5), percentile(latencies, 0.9),
+                    percentile(latencies, 0.99), latencies.empty() ? NAN : latencies.back());
+    }
+    std::printf("\nruns with a misfire or a missed event: %zu of %zu (%.3f%%)\n", bad_runs, runs,
+                100.0 * bad_runs / runs);
+    return 0;
+}
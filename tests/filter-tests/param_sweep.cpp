@@ -0,0 +1,628 @@
+/**************************************************************
+ *
+ *                     param_sweep.cpp
+ *
+ *     Overview: Tunes the noise constants of StateDetermination.h
+ *                  (SIGMA_ACCEL, SIGMA_GYRO, SIGMA_BARO, CA, ACCEL_THRESHOLD)
+ *                  by replaying flights through a grid of AltitudeEstimator
+ *                  configurations on every core.
+ *
+ *                  Each worker owns a batch of configurations stored
+ *                  structure-of-arrays (one array per filter variable, one
+ *                  lane per configuration) and steps the whole batch one
+ *                  sample at a time, so the per-sample loop over lanes is
+ *                  branch-free and vectorizes. The batch repeats the math of
+ *                  KalmanFilter + ComplementaryFilter + AltitudeEstimator; the
+ *                  flight constants are also run through the real
+ *                  AltitudeEstimator and the two are checked against each
+ *                  other before anything is reported.
+ *
+ *                  Two flights are replayed per configuration:
+ *                  - synthetic: IMU and baro generated from the OpenRocket
+ *                    truth with the noise measured on the pad in the log,
+ *                    scored on altitude/velocity error against the truth
+ *                  - recorded: the IMU log, scored on the apogee against the
+ *                    barometer track
+ *                  and the state transitions of StateDeterminer (launch,
+ *                  burnout, apogee, main) are timed against the truth events.
+ *                  Flight constants and transition settings come from
+ *                  StateDetermination.h.
+ *
+ *     Build (from this directory):
+ *        g++ -O3 -march=native -fno-math-errno -std=c++11 -pthread
+ *            -I../../carm-electronics/flight-computer param_sweep.cpp
+ *            ../../carm-electronics/flight-computer/altitude.cpp
+ *            ../../carm-electronics/flight-computer/apogee.cpp
+ *            ../../carm-electronics/flight-computer/filters.cpp
+ *            ../../carm-electronics/flight-computer/algebra.cpp
+ *            ../../carm-electronics/flight-computer/transitions.cpp
+ *            ../../carm-electronics/flight-computer/detectors.cpp
+ *            ../../carm-electronics/StateDetermination.cpp -o param_sweep
+ *     Run:
+ *        ./param_sweep [--threads N] [--top N] [--csv results.csv]
+ *                      [--log G53FJ_10Feb24.csv] [--truth openrocket_revG.csv]
+ *
+ **************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "altitude.h"
+#include "apogee.h"
+#include "../../carm-electronics/StateDetermination.h"
+#include "flightlog.hpp"
+
+// current flight constants
+static const float FLIGHT_SIGMA_ACCEL = SIGMA_ACCEL;
+static const float FLIGHT_SIGMA_GYRO = SIGMA_GYRO;
+static const float FLIGHT_SIGMA_BARO = SIGMA_BARO;
+static const float FLIGHT_CA = CA;
+static const float FLIGHT_ACCEL_THRESHOLD = ACCEL_THRESHOLD;
+// ComplementaryFilter::ZUPT_SIZE
+static const int ZUPT_SIZE = 12;
+
+static const float GRAVITY = 9.81;
+// configurations per work item
+static const int BATCH_LANES = 256;
+// score weight of the apogee detection delay, m per s
+static const float APOGEE_DELAY_WEIGHT = 10;
+static const float MISSED_EVENT_PENALTY = 1000;
+
+struct Config
+{
+    float sigma_accel;
+    float sigma_gyro;
+    float sigma_baro;
+    float ca;
+    float accel_threshold;
+};
+
+enum Event
+{
+    LAUNCH = 0,
+    BURNOUT,
+    APOGEE,
+    MAIN,
+    EVENT_COUNT
+};
+static const char *EVENT_NAMES[EVENT_COUNT] = {"launch", "burnout", "apogee", "main"};
+
+struct FlightMetrics
+{
+    float altitude_rms;
+    float velocity_rms;
+    float apogee_error;            // estimated max altitude - true apogee, m
+    float event_delay[EVENT_COUNT]; // detected - true, s; NAN when missed
+};
+
+struct Result
+{
+    Config config;
+    FlightMetrics flights[2];
+    float score;
+};
+
+// AltitudeEstimator (Kalman engine) for BATCH_LANES configurations at once.
+// Every per-configuration variable is its own array; everything that only
+// depends on the input stream (clocks, previous IMU sample) is shared
+class BatchEstimator
+{
+public:
+    explicit BatchEstimator(const Config *configs, int lanes) : lanes(lanes)
+    {
+        for (int i = 0; i < lanes; i++)
+        {
+            const Config &c = configs[i];
+            ca[i] = c.ca;
+            sigma_gyro2[i] = c.sigma_gyro * c.sigma_gyro;
+            sigma_accel2[i] = c.sigma_accel * c.sigma_accel;
+            // ComplementaryFilter gains
+            g0[i] = std::sqrt(2 * c.sigma_accel / c.sigma_baro);
+            g1[i] = c.sigma_accel / c.sigma_baro;
+            max_deltat[i] = (std::sqrt(g0[i] * g0[i] + 2 * g1[i]) - g0[i]) / g1[i];
+            threshold[i] = c.accel_threshold;
+            // KalmanFilter initial state
+            s0[i] = 0;
+            s1[i] = 0;
+            s2[i] = 1;
+            p00[i] = 100, p01[i] = 0, p02[i] = 0;
+            p10[i] = 0, p11[i] = 100, p12[i] = 0;
+            p20[i] = 0, p21[i] = 0, p22[i] = 100;
+            pas0[i] = 0, pas1[i] = 0, pas2[i] = 0;
+            past_vertical_accel[i] = 0;
+            altitude[i] = 0;
+            velocity[i] = 0;
+            quiet[i] = 0;
+        }
+    }
+
+    // AltitudeEstimator::predict() followed by updateBaro()
+    void step(const float accel[3], const float gyro[3], float baro, uint32_t t)
+    {
+        if (!initialized)
+        {
+            std::memcpy(past_gyro, gyro, sizeof(past_gyro));
+            std::memcpy(past_accel, accel, sizeof(past_accel));
+            previous_time = t;
+            state_time = t;
+            initialized = true;
+        }
+        else
+        {
+            float deltat = (t - previous_time) / 1000.0f;
+            float state_deltat = (int32_t)(t - state_time) > 0 ? (t - state_time) / 1000.0f : 0;
+            if (state_deltat > 0)
+            {
+                zupt_pushed++;
+                state_time = t;
+            }
+            predictLanes(deltat, state_deltat);
+            std::memcpy(past_gyro, gyro, sizeof(past_gyro));
+            std::memcpy(past_accel, accel, sizeof(past_accel));
+            previous_time = t;
+        }
+        float baro_deltat = baro_seen ? (t - previous_baro_time) / 1000.0f : 0;
+        correctLanes(baro, baro_deltat);
+        previous_baro_time = t;
+        baro_seen = true;
+    }
+
+    int lanes;
+    // outputs
+    float altitude[BATCH_LANES];
+    float velocity[BATCH_LANES];
+    float past_vertical_accel[BATCH_LANES];
+
+private:
+    void predictLanes(float dt, float state_dt)
+    {
+        const float w0 = past_gyro[0], w1 = past_gyro[1], w2 = past_gyro[2];
+        const float a0 = past_accel[0] * GRAVITY, a1 = past_accel[1] * GRAVITY, a2 = past_accel[2] * GRAVITY;
+        // A = I - dt * skew(gyro)
+        const float a01 = dt * w2, a02 = -dt * w1;
+        const float a10 = -dt * w2, a12 = dt * w0;
+        const float a20 = dt * w1, a21 = -dt * w0;
+        const float dt2 = dt * dt;
+        const float h = GRAVITY;
+        const float zupt_count = (float)(zupt_pushed < ZUPT_SIZE ? zupt_pushed : ZUPT_SIZE);
+
+        for (int i = 0; i < lanes; i++)
+        {
+            // predictState
+            float x0 = s0[i] + a01 * s1[i] + a02 * s2[i];
+            float x1 = a10 * s0[i] + s1[i] + a12 * s2[i];
+            float x2 = a20 * s0[i] + a21 * s1[i] + s2[i];
+            float inv = 1.0f / std::sqrt(x0 * x0 + x1 * x1 + x2 * x2);
+            x0 *= inv, x1 *= inv, x2 *= inv;
+
+            // predictErrorCovariance: A P A^T + Q, Q = dt^2 sg^2 (|s|^2 I - s s^T)
+            float ap00 = p00[i] + a01 * p10[i] + a02 * p20[i];
+            float ap01 = p01[i] + a01 * p11[i] + a02 * p21[i];
+            float ap02 = p02[i] + a01 * p12[i] + a02 * p22[i];
+            float ap10 = a10 * p00[i] + p10[i] + a12 * p20[i];
+            float ap11 = a10 * p01[i] + p11[i] + a12 * p21[i];
+            float ap12 = a10 * p02[i] + p12[i] + a12 * p22[i];
+            float ap20 = a20 * p00[i] + a21 * p10[i] + p20[i];
+            float ap21 = a20 * p01[i] + a21 * p11[i] + p21[i];
+            float ap22 = a20 * p02[i] + a21 * p12[i] + p22[i];
+            float q = dt2 * sigma_gyro2[i];
+            float ss = s0[i] * s0[i] + s1[i] * s1[i] + s2[i] * s2[i];
+            float c00 = ap00 + ap01 * a01 + ap02 * a02 + q * (ss - s0[i] * s0[i]);
+            float c01 = ap00 * a10 + ap01 + ap02 * a12 - q * s0[i] * s1[i];
+            float c02 = ap00 * a20 + ap01 * a21 + ap02 - q * s0[i] * s2[i];
+            float c10 = ap10 + ap11 * a01 + ap12 * a02 - q * s1[i] * s0[i];
+            float c11 = ap10 * a10 + ap11 + ap12 * a12 + q * (ss - s1[i] * s1[i]);
+            float c12 = ap10 * a20 + ap11 * a21 + ap12 - q * s1[i] * s2[i];
+            float c20 = ap20 + ap21 * a01 + ap22 * a02 - q * s2[i] * s0[i];
+            float c21 = ap20 * a10 + ap21 + ap22 * a12 - q * s2[i] * s1[i];
+            float c22 = ap20 * a20 + ap21 * a21 + ap22 + q * (ss - s2[i] * s2[i]);
+
+            // updateGain: K = h C (h^2 C + r I)^-1
+            float pas_norm = std::sqrt(pas0[i] * pas0[i] + pas1[i] * pas1[i] + pas2[i] * pas2[i]);
+            float r = sigma_accel2[i] + (1.0f / 3.0f) * ca[i] * ca[i] * pas_norm;
+            float m00 = h * h * c00 + r, m01 = h * h * c01, m02 = h * h * c02;
+            float m10 = h * h * c10, m11 = h * h * c11 + r, m12 = h * h * c12;
+            float m20 = h * h * c20, m21 = h * h * c21, m22 = h * h * c22 + r;
+            float det = m00 * (m11 * m22 - m12 * m21) - m01 * (m10 * m22 - m12 * m20) +
+                        m02 * (m10 * m21 - m11 * m20);
+            float idet = 1.0f / det;
+            float i00 = (m11 * m22 - m12 * m21) * idet;
+            float i01 = (m02 * m21 - m01 * m22) * idet;
+            float i02 = (m01 * m12 - m02 * m11) * idet;
+            float i10 = (m12 * m20 - m10 * m22) * idet;
+            float i11 = (m00 * m22 - m02 * m20) * idet;
+            float i12 = (m02 * m10 - m00 * m12) * idet;
+            float i20 = (m10 * m21 - m11 * m20) * idet;
+            float i21 = (m01 * m20 - m00 * m21) * idet;
+            float i22 = (m00 * m11 - m01 * m10) * idet;
+            float k00 = h * (c00 * i00 + c01 * i10 + c02 * i20);
+            float k01 = h * (c00 * i01 + c01 * i11 + c02 * i21);
+            float k02 = h * (c00 * i02 + c01 * i12 + c02 * i22);
+            float k10 = h * (c10 * i00 + c11 * i10 + c12 * i20);
+            float k11 = h * (c10 * i01 + c11 * i11 + c12 * i21);
+            float k12 = h * (c10 * i02 + c11 * i12 + c12 * i22);
+            float k20 = h * (c20 * i00 + c21 * i10 + c22 * i20);
+            float k21 = h * (c20 * i01 + c21 * i11 + c22 * i21);
+            float k22 = h * (c20 * i02 + c21 * i12 + c22 * i22);
+
+            // updateState
+            float e0 = a0 - ca[i] * pas0[i] - h * x0;
+            float e1 = a1 - ca[i] * pas1[i] - h * x1;
+            float e2 = a2 - ca[i] * pas2[i] - h * x2;
+            float u0 = x0 + k00 * e0 + k01 * e1 + k02 * e2;
+            float u1 = x1 + k10 * e0 + k11 * e1 + k12 * e2;
+            float u2 = x2 + k20 * e0 + k21 * e1 + k22 * e2;
+            inv = 1.0f / std::sqrt(u0 * u0 + u1 * u1 + u2 * u2);
+            u0 *= inv, u1 *= inv, u2 *= inv;
+
+            // updateErrorCovariance: (I - h K) C
+            p00[i] = c00 - h * (k00 * c00 + k01 * c10 + k02 * c20);
+            p01[i] = c01 - h * (k00 * c01 + k01 * c11 + k02 * c21);
+            p02[i] = c02 - h * (k00 * c02 + k01 * c12 + k02 * c22);
+            p10[i] = c10 - h * (k10 * c00 + k11 * c10 + k12 * c20);
+            p11[i] = c11 - h * (k10 * c01 + k11 * c11 + k12 * c21);
+            p12[i] = c12 - h * (k10 * c02 + k11 * c12 + k12 * c22);
+            p20[i] = c20 - h * (k20 * c00 + k21 * c10 + k22 * c20);
+            p21[i] = c21 - h * (k20 * c01 + k21 * c11 + k22 * c21);
+            p22[i] = c22 - h * (k20 * c02 + k21 * c12 + k22 * c22);
+            s0[i] = u0, s1[i] = u1, s2[i] = u2;
+
+            // vertical acceleration
+            pas0[i] = a0 - h * u0;
+            pas1[i] = a1 - h * u1;
+            pas2[i] = a2 - h * u2;
+            float vertical = pas0[i] * u0 + pas1[i] * u1 + pas2[i] * u2;
+
+            // ComplementaryFilter::propagate with the previous vertical
+            // acceleration; the ZUPT window only sees it if time moved on
+            float pva = past_vertical_accel[i];
+            float alt = altitude[i] + state_dt * velocity[i] + pva * state_dt * state_dt / 2;
+            float vel = velocity[i] + state_dt * pva;
+            float still = (std::fabs(pva) <= threshold[i]) ? quiet[i] + 1 : 0;
+            float q_new = state_dt > 0 ? still : quiet[i];
+            bool zupt = state_dt > 0 && q_new >= zupt_count;
+            altitude[i] = alt;
+            velocity[i] = zupt ? 0.0f : vel;
+            quiet[i] = q_new;
+            past_vertical_accel[i] = vertical;
+        }
+    }
+
+    // ComplementaryFilter::correct
+    void correctLanes(float baro, float deltat)
+    {
+        for (int i = 0; i < lanes; i++)
+        {
+            float dt = deltat < max_deltat[i] ? deltat : max_deltat[i];
+            float innovation = baro - altitude[i];
+            altitude[i] += dt * (g0[i] + g1[i] * dt / 2) * innovation;
+            velocity[i] += dt * g1[i] * innovation;
+        }
+    }
+
+    // parameters
+    float ca[BATCH_LANES], sigma_gyro2[BATCH_LANES], sigma_accel2[BATCH_LANES];
+    float g0[BATCH_LANES], g1[BATCH_LANES], max_deltat[BATCH_LANES], threshold[BATCH_LANES];
+    // KalmanFilter state, error covariance and previous sensor acceleration
+    float s0[BATCH_LANES], s1[BATCH_LANES], s2[BATCH_LANES];
+    float p00[BATCH_LANES], p01[BATCH_LANES], p02[BATCH_LANES];
+    float p10[BATCH_LANES], p11[BATCH_LANES], p12[BATCH_LANES];
+    float p20[BATCH_LANES], p21[BATCH_LANES], p22[BATCH_LANES];
+    float pas0[BATCH_LANES], pas1[BATCH_LANES], pas2[BATCH_LANES];
+    // consecutive ZUPT samples within the threshold
+    float quiet[BATCH_LANES];
+
+    // shared clocks and inputs
+    bool initialized = false;
+    bool baro_seen = false;
+    uint32_t previous_time = 0, state_time = 0, previous_baro_time = 0;
+    int zupt_pushed = 0;
+    float past_gyro[3], past_accel[3];
+};
+
+// StateDeterminer's transition table, per lane
+struct LaneEvents
+{
+    TransitionTable transitions{FLIGHT_RULES, FLIGHT_RULE_COUNT, static_cast<uint8_t>(state::POWER_ON)};
+    float time[EVENT_COUNT] = {NAN, NAN, NAN, NAN};
+    ApogeePredictor predictor{APOGEE_DRAG_SMOOTHING, APOGEE_MIN_DRAG_VELOCITY};
+    EventVoter voter{FLIGHT_DETECTORS};
+
+    // raw accelerometer (g) and barometer for the detectors besides the lane,
+    // t in ms; the flight code runs on us
+    void step(float accel, float velocity, float altitude, uint32_t t, const float raw_accel[3], float baro)
+    {
+        uint64_t us = t * 1000ULL;
+        predictor.update(altitude, velocity, accel, static_cast<uint32_t>(us));
+        FlightEstimates estimates;
+        estimates.time = us;
+        estimates.altitude = altitude;
+        estimates.velocity = velocity;
+        estimates.accel = accel;
+        estimates.timeToApogee = predictor.valid(APOGEE_MIN_DRAG_SAMPLES) ? predictor.getTimeToApogee() : NAN;
+        DetectorInput input;
+        input.time = us;
+        for (int k = 0; k < 3; k++)
+            input.accel[k] = raw_accel[k] * GRAVITY;
+        input.baroAltitude = baro;
+        input.baroValid = true;
+        input.fused = estimates;
+        voter.update(input);
+        estimates.events = voter.getDecisions();
+        if (transitions.tick(estimates) < 0)
+            return;
+        switch (static_cast<state>(transitions.getState()))
+        {
+        case state::POWERED_FLIGHT_PHASE:
+            time[LAUNCH] = t;
+            break;
+        case state::BURNOUT_PHASE:
+            time[BURNOUT] = t;
+            break;
+        case state::APOGEE_PHASE:
+            time[APOGEE] = t;
+            break;
+        case state::MAIN_DEPLOY_ATTEMPT:
+            time[MAIN] = t;
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+static void run_batch(const Config *configs, int lanes, const Flight &flight, FlightMetrics *metrics)
+{
+    BatchEstimator estimator(configs, lanes);
+    std::vector<LaneEvents> events(lanes);
+    float sq_alt[BATCH_LANES] = {0}, sq_vel[BATCH_LANES] = {0}, max_alt[BATCH_LANES];
+    std::fill(max_alt, max_alt + lanes, -1e9f);
+    bool has_truth = !flight.true_altitude.empty();
+
+    for (size_t k = 0; k < flight.time.size(); k++)
+    {
+        float accel[3] = {flight.accel[0][k], flight.accel[1][k], flight.accel[2][k]};
+        float gyro[3] = {flight.gyro[0][k], flight.gyro[1][k], flight.gyro[2][k]};
+        estimator.step(accel, gyro, flight.baro[k], flight.time[k]);
+        if (has_truth)
+        {
+            float ta = flight.true_altitude[k], tv = flight.true_velocity[k];
+            for (int i = 0; i < lanes; i++)
+            {
+                float da = estimator.altitude[i] - ta, dv = estimator.velocity[i] - tv;
+                sq_alt[i] += da * da;
+                sq_vel[i] += dv * dv;
+            }
+        }
+        for (int i = 0; i < lanes; i++)
+        {
+            max_alt[i] = std::max(max_alt[i], estimator.altitude[i]);
+            events[i].step(estimator.past_vertical_accel[i], estimator.velocity[i],
+                           estimator.altitude[i], flight.time[k], accel, flight.baro[k]);
+        }
+    }
+
+    const float truth[EVENT_COUNT] = {flight.true_launch, flight.true_burnout, flight.true_apogee, flight.true_main};
+    for (int i = 0; i < lanes; i++)
+    {
+        FlightMetrics &m = metrics[i];
+        m.altitude_rms = has_truth ? std::sqrt(sq_alt[i] / flight.time.size()) : NAN;
+        m.velocity_rms = has_truth ? std::sqrt(sq_vel[i] / flight.time.size()) : NAN;
+        m.apogee_error = max_alt[i] - flight.true_apogee_altitude;
+        for (int e = 0; e < EVENT_COUNT; e++)
+            m.event_delay[e] = truth[e] < 0 ? NAN : (events[i].time[e] - truth[e]) / 1000.0f;
+    }
+}
+
+// runs the flight constants through the real AltitudeEstimator and returns
+// the largest altitude difference with lane 0 of a batch
+static float check_against_flight_code(const Flight &flight, const Config &config)
+{
+    AltitudeEstimator reference(config.sigma_accel, config.sigma_gyro, config.sigma_baro,
+                                config.ca, config.accel_threshold, 5.0);
+    BatchEstimator batch(&config, 1);
+    float worst = 0;
+    for (size_t k = 0; k < flight.time.size(); k++)
+    {
+        float accel[3] = {flight.accel[0][k], flight.accel[1][k], flight.accel[2][k]};
+        float gyro[3] = {flight.gyro[0][k], flight.gyro[1][k], flight.gyro[2][k]};
+        float accel_copy[3] = {accel[0], accel[1], accel[2]};
+        reference.predict(accel_copy, gyro, flight.time[k] * 1000);
+        reference.updateBaro(flight.baro[k], flight.time[k] * 1000);
+        batch.step(accel, gyro, flight.baro[k], flight.time[k]);
+        float scale = std::max(1.0f, std::fabs(reference.getAltitude()));
+        worst = std::max(worst, std::fabs(reference.getAltitude() - batch.altitude[0]) / scale);
+    }
+    return worst;
+}
+
+static float score(const Result &r)
+{
+    const FlightMetrics &synth = r.flights[0];
+    const FlightMetrics &rec = r.flights[1];
+    float s = synth.altitude_rms + synth.velocity_rms;
+    for (const FlightMetrics *m : {&synth, &rec})
+    {
+        if (std::isnan(m->event_delay[APOGEE]))
+            s += MISSED_EVENT_PENALTY;
+        else
+            s += APOGEE_DELAY_WEIGHT * std::fabs(m->event_delay[APOGEE]);
+        // a launch detected on the pad is worse than any late detection
+        if (std::isnan(m->event_delay[LAUNCH]) || m->event_delay[LAUNCH] < 0)
+            s += MISSED_EVENT_PENALTY;
+    }
+    return std::isnan(s) ? INFINITY : s;
+}
+
+static std::vector<Config> make_grid()
+{
+    const float scales[] = {0.125, 0.25, 0.5, 1, 2, 4, 8};
+    const float cas[] = {0.1, 0.3, 0.5, 0.7, 0.9};
+    const float thresholds[] = {0.1, 0.2, 0.3, 0.5, 0.8};
+    std::vector<Config> grid;
+    for (float sa : scales)
+        for (float sg : scales)
+            for (float sb : scales)
+                for (float ca : cas)
+                    for (float th : thresholds)
+                        grid.push_back(Config{FLIGHT_SIGMA_ACCEL * sa, FLIGHT_SIGMA_GYRO * sg,
+                                              FLIGHT_SIGMA_BARO * sb, ca, th});
+    return grid;
+}
+
+static void print_result(int rank, const Result &r)
+{
+    const FlightMetrics &s = r.flights[0], &l = r.flights[1];
+    std::printf("%4d %8.3f | %6.3f %6.3f %6.3f %4.2f %4.2f | %7.2f %7.2f %7.2f | %6.2f %6.2f %6.2f %6.2f | %7.2f %6.2f %6.2f\n",
+                rank, r.score, r.config.sigma_accel, r.config.sigma_gyro, r.config.sigma_baro, r.config.ca,
+                r.config.accel_threshold, s.altitude_rms, s.velocity_rms, s.apogee_error,
+                s.event_delay[LAUNCH], s.event_delay[BURNOUT], s.event_delay[APOGEE], s.event_delay[MAIN],
+                l.apogee_error, l.event_delay[LAUNCH], l.event_delay[APOGEE]);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int top = 10;
+    std::string csv_path, log_path = "G53FJ_10Feb24.csv", truth_path = "openrocket_revG.csv";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!std::strcmp(argv[i], "--threads"))
+            threads = std::max(1, std::atoi(argv[i + 1]));
+        else if (!std::strcmp(argv[i], "--top"))
+            top = std::atoi(argv[i + 1]);
+        else if (!std::strcmp(argv[i], "--csv"))
+            csv_path = argv[i + 1];
+        else if (!std::strcmp(argv[i], "--log"))
+            log_path = argv[i + 1];
+        else if (!std::strcmp(argv[i], "--truth"))
+            truth_path = argv[i + 1];
+    }
+
+    std::vector<ImuSample> log;
+    std::vector<TruthSample> truth;
+    if (!load_imu_log(log_path, log) || !load_openrocket(truth_path, truth))
+    {
+        std::fprintf(stderr, "Unable to open %s or %s\n", log_path.c_str(), truth_path.c_str());
+        return 1;
+    }
+    Flight flights[2] = {synthesize_flight(truth, log, MAIN_DEPLOY_ALTITUDE), recorded_flight(log, MAIN_DEPLOY_ALTITUDE)};
+
+    Config flight_config = {FLIGHT_SIGMA_ACCEL, FLIGHT_SIGMA_GYRO, FLIGHT_SIGMA_BARO, FLIGHT_CA,
+                            FLIGHT_ACCEL_THRESHOLD};
+    for (const Flight &f : flights)
+    {
+        float diff = check_against_flight_code(f, flight_config);
+        std::printf("%s flight: %zu samples, batch vs AltitudeEstimator max relative altitude difference %.2e\n",
+                    f.name, f.time.size(), diff);
+        if (diff > 1e-3f)
+        {
+            std::fprintf(stderr, "batch estimator no longer matches the flight code\n");
+            return 1;
+        }
+    }
+
+    std::vector<Config> grid = make_grid();
+    std::vector<Result> results(grid.size());
+    std::atomic<size_t> next_batch(0);
+    auto worker = [&]() {
+        FlightMetrics metrics[BATCH_LANES];
+        for (;;)
+        {
+            size_t start = next_batch.fetch_add(BATCH_LANES);
+            if (start >= grid.size())
+                return;
+            int lanes = (int)std::min<size_t>(BATCH_LANES, grid.size() - start);
+            for (int f = 0; f < 2; f++)
+            {
+                run_batch(&grid[start], lanes, flights[f], metrics);
+                for (int i = 0; i < lanes; i++)
+                    results[start + i].flights[f] = metrics[i];
+            }
+            for (int i = 0; i < lanes; i++)
+            {
+                results[start + i].config = grid[start + i];
+                results[start + i].score = score(results[start + i]);
+            }
+        }
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++)
+        pool.emplace_back(worker);
+    for (std::thread &t : pool)
+        t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    size_t steps = grid.size() * (flights[0].time.size() + flights[1].time.size());
+    std::printf("%zu configurations on %u threads in %.2f s (%.1f M estimator steps/s)\n\n",
+                grid.size(), threads, seconds, steps / seconds / 1e6);
+
+    if (!csv_path.empty())
+    {
+        FILE *csv = std::fopen(csv_path.c_str(), "w");
+        if (csv)
+        {
+            std::fprintf(csv, "sigma_accel,sigma_gyro,sigma_baro,ca,accel_threshold,score");
+            for (const Flight &f : flights)
+            {
+                std::fprintf(csv, ",%s_altitude_rms,%s_velocity_rms,%s_apogee_error", f.name, f.name, f.name);
+                for (int e = 0; e < EVENT_COUNT; e++)
+                    std::fprintf(csv, ",%s_%s_delay", f.name, EVENT_NAMES[e]);
+            }
+            std::fprintf(csv, "\n");
+            for (const Result &r : results)
+            {
+                std::fprintf(csv, "%g,%g,%g,%g,%g,%g", r.config.sigma_accel, r.config.sigma_gyro,
+                             r.config.sigma_baro, r.config.ca, r.config.accel_threshold, r.score);
+                for (const FlightMetrics &m : r.flights)
+                {
+                    std::fprintf(csv, ",%g,%g,%g", m.altitude_rms, m.velocity_rms, m.apogee_error);
+                    for (int e = 0; e < EVENT_COUNT; e++)
+                        std::fprintf(csv, ",%g", m.event_delay[e]);
+                }
+                std::fprintf(csv, "\n");
+            }
+            std::fclose(csv);
+        }
+    }
+
+    // rank of the current constants before sorting
+    size_t current = 0;
+    for (size_t i = 0; i < grid.size(); i++)
+        if (grid[i].sigma_accel == FLIGHT_SIGMA_ACCEL && grid[i].sigma_gyro == FLIGHT_SIGMA_GYRO &&
+            grid[i].sigma_baro == FLIGHT_SIGMA_BARO && grid[i].ca == FLIGHT_CA &&
+            grid[i].accel_threshold == FLIGHT_ACCEL_THRESHOLD)
+            current = i;
+    Result current_result = results[current];
+    std::sort(results.begin(), results.end(),
+              [](const Result &a, const Result &b) { return a.score < b.score; });
+    int current_rank = 0;
+    for (size_t i = 0; i < results.size(); i++)
+        if (results[i].score <= current_result.score)
+            current_rank = i + 1;
+
+    std::printf("                | parameters                         | synthetic vs truth      | "
+                "synthetic event delay (s)   | recorded\n");
+    std::printf("rank    score | s_acc  s_gyr  s_bar  ca   zupt | alt rms vel rms apo err | "
+                "launch burnout apogee  main  | apo err launch apogee\n");
+    for (int i = 0; i < top && i < (int)results.size(); i++)
+        print_result(i + 1, results[i]);
+    std::printf("...\n");
+    print_result(current_rank, current_result);
+    std::printf("(current constants)\n\n");
+
+    const Config &best = results[0].config;
+    std::printf("best set, for StateDetermination.h:\n");
+    std::printf("#define SIGMA_GYRO %.3f\n#define SIGMA_ACCEL %.3f\n#define SIGMA_BARO %.3f\n"
+                "#define CA %.1f\n#define ACCEL_THRESHOLD %.1f\n",
+                best.sigma_gyro, best.sigma_accel, best.sigma_baro, best.ca, best.accel_threshold);
+    return 0;
+}
@@ -0,0 +1,413 @@
+/**************************************************************
+ *
+ *                     rts.hpp
+ *
+ *     Overview: Rauch-Tung-Striebel smoother for post-flight reconstruction
+ *                  of altitude, vertical velocity and vertical acceleration.
+ *
+ *                  Forward pass: Kalman filter on x = [h, v, a] with a
+ *                  white-jerk model, fed the barometric altitude and the
+ *                  vertical acceleration AltitudeEstimator computes in
+ *                  flight (each sample may carry either or both).
+ *                  Backward pass: the RTS recursion over the stored forward
+ *                  estimates, from the last sample to the first, which also
+ *                  picks out the flight events and extremes.
+ *
+ *                  The forward estimates are kept in a SpillVector, which
+ *                  holds at most two pages in memory and spills the rest to
+ *                  a temporary file, so memory stays bounded whatever the
+ *                  length of the log.
+ *
+ **************************************************************/
+
+#ifndef RTS_HPP
+#define RTS_HPP
+
+#include <inttypes.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// append-only array of trivially copyable records, paged out to a temporary
+// file; sequential access in either direction only touches two pages
+template <typename T, size_t PAGE = 4096>
+class SpillVector
+{
+public:
+    SpillVector() : spill(NULL), count(0)
+    {
+        for (int c = 0; c < 2; c++)
+        {
+            cache[c].resize(PAGE);
+            cached_page[c] = NONE;
+            dirty[c] = false;
+        }
+        next_victim = 0;
+    }
+
+    ~SpillVector()
+    {
+        if (spill)
+            std::fclose(spill);
+    }
+
+    size_t size() const { return count; }
+
+    void push_back(const T &record)
+    {
+        count++;
+        at(count - 1) = record;
+    }
+
+    // reference valid until the next call touches a third page
+    T &at(size_t index)
+    {
+        size_t page = index / PAGE;
+        for (int c = 0; c < 2; c++)
+            if (cached_page[c] == page)
+            {
+                dirty[c] = true;
+                next_victim = 1 - c;
+                return cache[c][index % PAGE];
+            }
+        int c = next_victim;
+        evict(c);
+        load(c, page);
+        dirty[c] = true;
+        next_victim = 1 - c;
+        return cache[c][index % PAGE];
+    }
+
+    // bytes held in memory, whatever the size
+    static size_t residentBytes() { return 2 * PAGE * sizeof(T); }
+
+private:
+    static const size_t NONE = (size_t)-1;
+
+    void evict(int c)
+    {
+        if (cached_page[c] == NONE || !dirty[c])
+            return;
+        if (!spill && !(spill = std::tmpfile()))
+        {
+            std::perror("SpillVector");
+            std::abort();
+        }
+        std::fseek(spill, (long)(cached_page[c] * PAGE * sizeof(T)), SEEK_SET);
+        std::fwrite(cache[c].data(), sizeof(T), PAGE, spill);
+        if (cached_page[c] >= pages_on_disk)
+            pages_on_disk = cached_page[c] + 1;
+    }
+
+    void load(int c, size_t page)
+    {
+        cached_page[c] = page;
+        if (page < pages_on_disk)
+        {
+            std::fseek(spill, (long)(page * PAGE * sizeof(T)), SEEK_SET);
+            if (std::fread(cache[c].data(), sizeof(T), PAGE, spill) == PAGE)
+                return;
+        }
+        // a new page
+        std::memset(cache[c].data(), 0, PAGE * sizeof(T));
+    }
+
+    FILE *spill;
+    size_t count;
+    size_t pages_on_disk = 0;
+    std::vector<T> cache[2];
+    size_t cached_page[2];
+    bool dirty[2];
+    int next_victim;
+};
+
+struct SmoothedState
+{
+    uint32_t time;  // ms
+    double altitude;
+    double velocity;
+    double accel;
+    double altitude_sigma;
+};
+
+// event times (ms) and extremes of a smoothed flight, from the backward pass
+struct FlightSummary
+{
+    double apogee_altitude = -INFINITY;
+    uint32_t apogee_time = 0;
+    double max_velocity = -INFINITY;
+    uint32_t max_velocity_time = 0;
+    // negative when not found
+    int64_t launch_time = -1;
+    int64_t burnout_time = -1;
+    int64_t main_time = -1;
+    int64_t landing_time = -1;
+};
+
+class RtsSmoother
+{
+public:
+    // jerk: white jerk spectral density ((m/s^3)^2/Hz); sigmas of the two
+    // measurements; main_altitude for the main event
+    RtsSmoother(double jerk, double sigma_baro, double sigma_accel, double main_altitude)
+        : jerk(jerk), baro_var(sigma_baro * sigma_baro), accel_var(sigma_accel * sigma_accel),
+          main_altitude(main_altitude)
+    {
+    }
+
+    // forward pass, one sample at a time; NAN skips a measurement
+    void push(uint32_t time, double baro, double accel)
+    {
+        Record r;
+        r.time = time;
+        if (records.size() == 0)
+        {
+            // start from the first baro reading, at rest
+            r.xp[0] = std::isnan(baro) ? 0 : baro;
+            r.xp[1] = 0;
+            r.xp[2] = 0;
+            double p0[6] = {baro_var * 100, 0, 0, 1, 0, 100};
+            std::memcpy(r.pp, p0, sizeof(p0));
+            r.dt = 0;
+        }
+        else
+        {
+            const Record &prev = records.at(records.size() - 1);
+            r.dt = (time - prev.time) / 1000.0;
+            predict(prev.x, prev.p, r.dt, r.xp, r.pp);
+        }
+        std::memcpy(r.x, r.xp, sizeof(r.x));
+        std::memcpy(r.p, r.pp, sizeof(r.p));
+        if (!std::isnan(baro))
+            update(r.x, r.p, 0, baro, baro_var, true);
+        if (!std::isnan(accel))
+            update(r.x, r.p, 2, accel, accel_var, false);
+        records.push_back(r);
+    }
+
+    // backward pass, from the last sample to the first; the smoothed states
+    // replace the filtered ones in the store
+    FlightSummary smooth()
+    {
+        FlightSummary summary;
+        size_t n = records.size();
+        if (n == 0)
+            return summary;
+        double xs[3], ps[6];
+        {
+            Record &last = records.at(n - 1);
+            std::memcpy(xs, last.x, sizeof(xs));
+            std::memcpy(ps, last.p, sizeof(ps));
+        }
+        bool landed = true;
+        for (size_t k = n; k-- > 0;)
+        {
+            if (k + 1 < n)
+            {
+                // the next sample's prediction, then this sample's estimate
+                Record next = records.at(k + 1);
+                Record &cur = records.at(k);
+                rtsStep(cur, next, xs, ps);
+            }
+            Record &cur = records.at(k);
+            std::memcpy(cur.x, xs, sizeof(xs));
+            std::memcpy(cur.p, ps, sizeof(ps));
+            summarize(state(cur), summary, landed);
+        }
+        smoothed = true;
+        return summary;
+    }
+
+    // calls out(state) for every sample in time order, smoothed once
+    // smooth() has run
+    template <typename Output>
+    void forEach(Output out)
+    {
+        for (size_t k = 0; k < records.size(); k++)
+            out(state(records.at(k)));
+    }
+
+    bool isSmoothed() const { return smoothed; }
+
+    size_t size() const { return records.size(); }
+    static size_t residentBytes() { return SpillVector<Record>::residentBytes(); }
+
+private:
+    // symmetric 3x3 matrices are stored as {00, 01, 02, 11, 12, 22}
+    struct Record
+    {
+        uint32_t time;
+        double dt;      // from the previous sample, s
+        double xp[3];   // predicted
+        double pp[6];
+        double x[3];    // filtered
+        double p[6];
+    };
+
+    static SmoothedState state(const Record &r)
+    {
+        SmoothedState s;
+        s.time = r.time;
+        s.altitude = r.x[0];
+        s.velocity = r.x[1];
+        s.accel = r.x[2];
+        s.altitude_sigma = std::sqrt(r.p[0]);
+        return s;
+    }
+
+    static double &el(double *m, int i, int j)
+    {
+        static const int INDEX[3][3] = {{0, 1, 2}, {1, 3, 4}, {2, 4, 5}};
+        return m[INDEX[i][j]];
+    }
+    static double el(const double *m, int i, int j)
+    {
+        static const int INDEX[3][3] = {{0, 1, 2}, {1, 3, 4}, {2, 4, 5}};
+        return m[INDEX[i][j]];
+    }
+
+    static void transition(double dt, double f[3][3])
+    {
+        double m[3][3] = {{1, dt, dt * dt / 2}, {0, 1, dt}, {0, 0, 1}};
+        std::memcpy(f, m, sizeof(m));
+    }
+
+    void predict(const double x[3], const double p[6], double dt, double xp[3], double pp[6])
+    {
+        double f[3][3];
+        transition(dt, f);
+        for (int i = 0; i < 3; i++)
+            xp[i] = f[i][0] * x[0] + f[i][1] * x[1] + f[i][2] * x[2];
+        // F P F^T + Q, Q for white jerk
+        double fp[3][3];
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                fp[i][j] = f[i][0] * el(p, 0, j) + f[i][1] * el(p, 1, j) + f[i][2] * el(p, 2, j);
+        double dt2 = dt * dt, dt3 = dt2 * dt, dt4 = dt3 * dt, dt5 = dt4 * dt;
+        double q[3][3] = {{dt5 / 20, dt4 / 8, dt3 / 6}, {dt4 / 8, dt3 / 3, dt2 / 2}, {dt3 / 6, dt2 / 2, dt}};
+        for (int i = 0; i < 3; i++)
+            for (int j = i; j < 3; j++)
+                el(pp, i, j) = fp[i][0] * f[j][0] + fp[i][1] * f[j][1] + fp[i][2] * f[j][2] + jerk * q[i][j];
+    }
+
+    // scalar measurement of state component c; isolated barometer
+    // innovations past 5 sigma (spikes, the reading at power up) are dropped,
+    // a run of them means the filter is off and they are taken
+    void update(double x[3], double p[6], int c, double z, double var, bool gate)
+    {
+        double s = el(p, c, c) + var;
+        double innovation = z - x[c];
+        if (gate && innovation * innovation > 25 * s && ++rejected <= MAX_REJECTED)
+            return;
+        if (gate)
+            rejected = 0;
+        double k[3] = {el(p, 0, c) / s, el(p, 1, c) / s, el(p, 2, c) / s};
+        for (int i = 0; i < 3; i++)
+            x[i] += k[i] * innovation;
+        double pc[3] = {el(p, c, 0), el(p, c, 1), el(p, c, 2)};
+        for (int i = 0; i < 3; i++)
+            for (int j = i; j < 3; j++)
+                el(p, i, j) -= k[i] * pc[j];
+    }
+
+    // xs, ps: smoothed state of sample k+1 in, of sample k out
+    void rtsStep(const Record &cur, const Record &next, double xs[3], double ps[6])
+    {
+        double f[3][3];
+        transition(next.dt, f);
+        // C = P F^T Pp^-1
+        double pft[3][3];
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                pft[i][j] = el(cur.p, i, 0) * f[j][0] + el(cur.p, i, 1) * f[j][1] + el(cur.p, i, 2) * f[j][2];
+        double inv[3][3];
+        invert(next.pp, inv);
+        double c[3][3];
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                c[i][j] = pft[i][0] * inv[0][j] + pft[i][1] * inv[1][j] + pft[i][2] * inv[2][j];
+        // x = xf + C (xs' - xp'), P = Pf + C (Ps' - Pp') C^T
+        double dx[3], dp[3][3];
+        for (int i = 0; i < 3; i++)
+            dx[i] = xs[i] - next.xp[i];
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                dp[i][j] = el(ps, i, j) - el(next.pp, i, j);
+        double x[3], p[6];
+        for (int i = 0; i < 3; i++)
+            x[i] = cur.x[i] + c[i][0] * dx[0] + c[i][1] * dx[1] + c[i][2] * dx[2];
+        double cd[3][3];
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                cd[i][j] = c[i][0] * dp[0][j] + c[i][1] * dp[1][j] + c[i][2] * dp[2][j];
+        for (int i = 0; i < 3; i++)
+            for (int j = i; j < 3; j++)
+                el(p, i, j) = el(cur.p, i, j) + cd[i][0] * c[j][0] + cd[i][1] * c[j][1] + cd[i][2] * c[j][2];
+        std::memcpy(xs, x, sizeof(x));
+        std::memcpy(ps, p, sizeof(p));
+    }
+
+    static void invert(const double *m, double inv[3][3])
+    {
+        double a = el(m, 0, 0), b = el(m, 0, 1), c = el(m, 0, 2);
+        double d = el(m, 1, 1), e = el(m, 1, 2), f = el(m, 2, 2);
+        double c00 = d * f - e * e, c01 = c * e - b * f, c02 = b * e - c * d;
+        double det = a * c00 + b * c01 + c * c02;
+        double r = 1.0 / det;
+        inv[0][0] = c00 * r;
+        inv[0][1] = inv[1][0] = c01 * r;
+        inv[0][2] = inv[2][0] = c02 * r;
+        inv[1][1] = (a * f - c * c) * r;
+        inv[1][2] = inv[2][1] = (b * c - a * e) * r;
+        inv[2][2] = (a * d - b * b) * r;
+    }
+
+    // the backward pass sees the flight last sample first: "earliest" events
+    // are the last ones found
+    void summarize(const SmoothedState &s, FlightSummary &sum, bool &landed)
+    {
+        if (s.altitude >= sum.apogee_altitude)
+        {
+            sum.apogee_altitude = s.altitude;
+            sum.apogee_time = s.time;
+        }
+        if (s.velocity >= sum.max_velocity)
+        {
+            sum.max_velocity = s.velocity;
+            sum.max_velocity_time = s.time;
+        }
+        // launch: earliest time moving up faster than LIFTOFF_VELOCITY
+        if (s.velocity > LIFTOFF_VELOCITY)
+            sum.launch_time = s.time;
+        // burnout: earliest switch from thrust to deceleration while flying
+        if (have_later && s.accel >= 0 && later.accel < 0 && later.velocity > LIFTOFF_VELOCITY)
+            sum.burnout_time = later.time;
+        // main: earliest descent through the main deploy altitude
+        if (have_later && s.altitude > main_altitude && later.altitude <= main_altitude && later.velocity < 0)
+            sum.main_time = later.time;
+        // landing: the sample after the last one still moving
+        if (landed && std::fabs(s.velocity) > LANDED_VELOCITY)
+        {
+            landed = false;
+            if (have_later)
+                sum.landing_time = later.time;
+        }
+        later = s;
+        have_later = true;
+    }
+
+    static constexpr double LIFTOFF_VELOCITY = 5;
+    static constexpr double LANDED_VELOCITY = 1;
+    static const int MAX_REJECTED = 3;
+
+    double jerk, baro_var, accel_var, main_altitude;
+    SpillVector<Record> records;
+    SmoothedState later;
+    bool have_later = false;
+    bool smoothed = false;
+    int rejected = 0;
+};
+
+#endif
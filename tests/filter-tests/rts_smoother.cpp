@@ -0,0 +1,239 @@
+/**************************************************************
+ *
+ *                     rts_smoother.cpp
+ *
+ *     Overview: Post-flight reconstruction of altitude and vertical
+ *                  velocity from a recorded log. Streams the log through
+ *                  AltitudeEstimator (for the vertical acceleration in the
+ *                  earth frame) and the RTS smoother in rts.hpp, then reports
+ *                  per session:
+ *                  - smoothed apogee, maximum velocity and the times of
+ *                    launch, burnout, main deploy altitude and landing
+ *                  - time spent parsing/filtering and smoothing
+ *
+ *                  Altitudes are above the pad, taken as the median
+ *                  barometric altitude over the first second of the session.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer rts_smoother.cpp
+ *            ../../carm-electronics/flight-computer/altitude.cpp
+ *            ../../carm-electronics/flight-computer/filters.cpp
+ *            ../../carm-electronics/flight-computer/algebra.cpp -o rts_smoother
+ *     Run:
+ *        ./rts_smoother [log] [--jerk q] [--out smoothed.csv] [--all-sessions]
+ *
+ *        log defaults to G53FJ_10Feb24.csv, BBManager datalogs
+ *        (../data-analysis/data/test-flight2/DATALOG.CSV) work as well.
+ *        Only the longest session (the flight) is reported unless
+ *        --all-sessions is given; --out writes the last one reported.
+ *
+ **************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "altitude.h"
+#include "../../carm-electronics/StateDetermination.h"
+#include "flightlog.hpp"
+#include "rts.hpp"
+
+// white jerk spectral density, (m/s^3)^2/Hz; motor ignition and burnout are
+// the only jerks of note
+static const double DEFAULT_JERK = 50;
+static const uint32_t PAD_WINDOW = 1000; // ms
+
+typedef std::chrono::steady_clock Clock;
+
+struct Session
+{
+    int index;
+    size_t samples;
+    double pad;
+    double filter_ms;
+    std::unique_ptr<RtsSmoother> smoother;
+};
+
+// feeds the samples of one session, the first second is held back to find
+// the pad altitude
+class SessionFilter
+{
+public:
+    SessionFilter(int index, double jerk)
+        : estimator(SIGMA_ACCEL, SIGMA_GYRO, SIGMA_BARO, CA, ACCEL_THRESHOLD, SIGMA_GPS)
+    {
+        session.index = index;
+        session.samples = 0;
+        session.pad = NAN;
+        session.filter_ms = 0;
+        session.smoother.reset(new RtsSmoother(jerk, SIGMA_BARO, SIGMA_ACCEL, MAIN_DEPLOY_ALTITUDE));
+    }
+
+    void push(const ImuSample &s)
+    {
+        session.samples++;
+        if (std::isnan(session.pad))
+        {
+            held.push_back(s);
+            if (s.time < PAD_WINDOW)
+                return;
+            findPad();
+            for (const ImuSample &h : held)
+                feed(h);
+            held.clear();
+            return;
+        }
+        feed(s);
+    }
+
+    Session &finish()
+    {
+        if (std::isnan(session.pad))
+        {
+            findPad();
+            for (const ImuSample &h : held)
+                feed(h);
+        }
+        return session;
+    }
+
+private:
+    void findPad()
+    {
+        std::vector<float> altitudes;
+        for (const ImuSample &h : held)
+            if (!std::isnan(h.altitude))
+                altitudes.push_back(h.altitude);
+        if (altitudes.empty())
+        {
+            session.pad = 0;
+            return;
+        }
+        std::nth_element(altitudes.begin(), altitudes.begin() + altitudes.size() / 2, altitudes.end());
+        session.pad = altitudes[altitudes.size() / 2];
+    }
+
+    void feed(const ImuSample &s)
+    {
+        float accel[3], gyro[3];
+        for (int k = 0; k < 3; k++)
+        {
+            accel[k] = s.accel[k] / FLIGHTLOG_GRAVITY;
+            gyro[k] = s.gyro[k];
+        }
+        float baro = s.altitude - session.pad;
+        // the estimator runs on us, the smoother on ms
+        estimator.predict(accel, gyro, s.time * 1000);
+        if (!std::isnan(baro))
+            estimator.updateBaro(baro, s.time * 1000);
+        session.smoother->push(s.time, baro, estimator.getVerticalAcceleration());
+    }
+
+    AltitudeEstimator estimator;
+    std::vector<ImuSample> held;
+    Session session;
+};
+
+static void print_event(const char *name, int64_t time)
+{
+    if (time < 0)
+        std::printf("  %-10s not found\n", name);
+    else
+        std::printf("  %-10s %10.2f s\n", name, time / 1000.0);
+}
+
+static void report(Session &session, const char *out_path)
+{
+    auto start = Clock::now();
+    FlightSummary summary = session.smoother->smooth();
+    double smooth_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    std::printf("session %d: %zu samples, pad at %.1f m\n", session.index, session.samples, session.pad);
+    std::printf("  apogee     %10.2f s  %8.1f m\n", summary.apogee_time / 1000.0, summary.apogee_altitude);
+    std::printf("  max vel    %10.2f s  %8.1f m/s\n", summary.max_velocity_time / 1000.0, summary.max_velocity);
+    print_event("launch", summary.launch_time);
+    print_event("burnout", summary.burnout_time);
+    print_event("main", summary.main_time);
+    print_event("landing", summary.landing_time);
+    std::printf("  read + forward pass %.2f ms, backward pass %.2f ms, %zu KiB resident\n\n",
+                session.filter_ms, smooth_ms, RtsSmoother::residentBytes() / 1024);
+
+    if (!out_path)
+        return;
+    FILE *out = std::fopen(out_path, "w");
+    if (!out)
+    {
+        std::fprintf(stderr, "Unable to write %s\n", out_path);
+        return;
+    }
+    std::fprintf(out, "time (ms),altitude (m),velocity (m/s),acceleration (m/s^2),altitude sigma (m)\n");
+    session.smoother->forEach([out](const SmoothedState &s) {
+        std::fprintf(out, "%u,%.3f,%.3f,%.3f,%.3f\n", s.time, s.altitude, s.velocity, s.accel, s.altitude_sigma);
+    });
+    std::fclose(out);
+}
+
+int main(int argc, char **argv)
+{
+    const char *log_path = "G53FJ_10Feb24.csv";
+    const char *out_path = NULL;
+    double jerk = DEFAULT_JERK;
+    bool all_sessions = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!std::strcmp(argv[i], "--jerk") && i + 1 < argc)
+            jerk = std::atof(argv[++i]);
+        else if (!std::strcmp(argv[i], "--out") && i + 1 < argc)
+            out_path = argv[++i];
+        else if (!std::strcmp(argv[i], "--all-sessions"))
+            all_sessions = true;
+        else
+            log_path = argv[i];
+    }
+
+    ImuLogReader reader;
+    if (!reader.open(log_path))
+    {
+        std::fprintf(stderr, "Unable to open %s\n", log_path);
+        return 1;
+    }
+
+    // only the longest session is kept when reporting the flight alone
+    Session longest;
+    longest.samples = 0;
+    std::unique_ptr<SessionFilter> current;
+    int sessions = 0;
+    auto start = Clock::now();
+    auto finish = [&]() {
+        if (!current)
+            return;
+        Session &s = current->finish();
+        s.filter_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (all_sessions)
+            report(s, out_path);
+        else if (s.samples > longest.samples)
+            longest = std::move(s);
+        current.reset();
+        start = Clock::now();
+    };
+    ImuSample sample;
+    while (reader.next(sample))
+    {
+        if (reader.newSession())
+        {
+            finish();
+            current.reset(new SessionFilter(sessions++, jerk));
+        }
+        current->push(sample);
+    }
+    finish();
+    if (!all_sessions && longest.smoother)
+        report(longest, out_path);
+    return 0;
+}
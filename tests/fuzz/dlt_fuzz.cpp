@@ -0,0 +1,369 @@
+/**************************************************************
+ *
+ *                     dlt_fuzz.cpp
+ *
+ *     Overview: libFuzzer entry point for everything the ground station
+ *                  unpacks from bytes it did not write. The first byte of an
+ *                  input picks the target, the rest is its input:
+ *                  0 dlt_read of a keyframe body, the next byte the schema:
+ *                    writing the values back must give the bits read
+ *                  1 dlt_unpack of packed words, the next byte the schema:
+ *                    packing the values back must give the words, less the
+ *                    bits no field uses
+ *                  2 DltDeltaDecoder over frames sent back to back: every
+ *                    frame used is within the input and every value within
+ *                    its field's width
+ *                  3 DltStream over a log pushed in two pieces, split where
+ *                    the next byte says: every byte counted, every record's
+ *                    columns those of its schema
+ *                  4 fec_decode of a packet as received (fec.h): a packet
+ *                    left plain is untouched, a corrected one is a
+ *                    codeword of its parity
+ *
+ *                  Anything else, a crash or sanitizer report included, is
+ *                  a finding. Without libFuzzer (g++), DLT_FUZZ_MAIN builds
+ *                  a main that runs the files it is given, or else random
+ *                  inputs and mutations of real frames.
+ *
+ *     Build with libFuzzer (from this directory):
+ *        clang++ -g -O1 -std=c++11 -fsanitize=fuzzer,address,undefined -I../../carm-electronics/flight-computer dlt_fuzz.cpp -o dlt_fuzz
+ *     Run:
+ *        ./dlt_fuzz -max_len=600 corpus/
+ *
+ *     Build without (from this directory):
+ *        g++ -g -O1 -std=c++11 -fsanitize=address,undefined -DDLT_FUZZ_MAIN -I../../carm-electronics/flight-computer dlt_fuzz.cpp -o dlt_fuzz
+ *     Run:
+ *        ./dlt_fuzz [inputs...]
+ *
+ **************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../carm-electronics/dltstream.h"
+#include "../../carm-electronics/fec.h"
+
+#define FUZZ_CHECK(condition)                                                     \
+    do                                                                            \
+    {                                                                             \
+        if (!(condition))                                                         \
+        {                                                                         \
+            fprintf(stderr, "%s:%d: %s does not hold\n", __FILE__, __LINE__, #condition); \
+            abort();                                                              \
+        }                                                                         \
+    } while (0)
+
+enum FuzzTarget : uint8_t
+{
+    READ,
+    UNPACK,
+    DELTA,
+    STREAM,
+    FEC,
+    TARGETS,
+};
+
+static void check_widths(const DltField fields[], uint8_t count, const uint32_t values[])
+{
+    for (uint8_t i = 0; i < count; i++)
+        FUZZ_CHECK(values[i] <= Bitpack_mask(fields[i].width));
+}
+
+template <typename Packet>
+static void fuzz_read(const uint8_t data[], size_t size)
+{
+    uint32_t values[Packet::COUNT];
+    if (!dlt_read<Packet>(data, size, values))
+    {
+        FUZZ_CHECK(size < DltLayout<Packet>::BYTES);
+        return;
+    }
+    check_widths(Packet::fields, Packet::COUNT, values);
+    uint8_t bytes[DltLayout<Packet>::BYTES] = {};
+    dlt_write<Packet>(values, bytes);
+    const unsigned bits = dlt_stream_bits<Packet>(Packet::COUNT);
+    for (unsigned k = 0; k < bits / 8; k++)
+        FUZZ_CHECK(bytes[k] == data[k]);
+    if (bits % 8 != 0)
+    {
+        uint8_t used = static_cast<uint8_t>(0xFF00 >> (bits % 8));
+        FUZZ_CHECK((bytes[bits / 8] & used) == (data[bits / 8] & used));
+    }
+    Telemetry t = {};
+    dlt_untransform<Packet>(values, t);
+}
+
+template <typename Packet>
+static void fuzz_unpack(const uint8_t data[], size_t size)
+{
+    uint64_t words[DltLayout<Packet>::WORDS] = {};
+    memcpy(words, data, size < sizeof(words) ? size : sizeof(words));
+    uint32_t values[Packet::COUNT], ones[Packet::COUNT];
+    dlt_unpack<Packet>(words, values);
+    check_widths(Packet::fields, Packet::COUNT, values);
+
+    // the bits of the fields: every field all ones
+    uint64_t used[DltLayout<Packet>::WORDS], packed[DltLayout<Packet>::WORDS];
+    for (uint8_t i = 0; i < Packet::COUNT; i++)
+        ones[i] = Bitpack_mask(Packet::fields[i].width);
+    dlt_pack<Packet>(ones, used);
+    dlt_pack<Packet>(values, packed);
+    for (unsigned w = 0; w < DltLayout<Packet>::WORDS; w++)
+        FUZZ_CHECK(packed[w] == (words[w] & used[w]));
+}
+
+template <typename Packet>
+struct Read
+{
+    static void run(const uint8_t data[], size_t size)
+    {
+        fuzz_read<Packet>(data, size);
+    }
+};
+
+template <typename Packet>
+struct Unpack
+{
+    static void run(const uint8_t data[], size_t size)
+    {
+        fuzz_unpack<Packet>(data, size);
+    }
+};
+
+// the target of a packet, by its schema byte
+template <template <typename> class Target>
+static void by_schema(uint8_t schema, const uint8_t data[], size_t size)
+{
+    switch (static_cast<DltSchema>(schema % DLT_SCHEMAS))
+    {
+    case DltSchema::POWER_ON:
+        Target<PowerOnPacket>::run(data, size);
+        break;
+    case DltSchema::LAUNCH_READY:
+        Target<LaunchReadyPacket>::run(data, size);
+        break;
+    case DltSchema::LAUNCH_MODE:
+        Target<LaunchModePacket>::run(data, size);
+        break;
+    case DltSchema::RECOVERY:
+        Target<RecoveryPacket>::run(data, size);
+        break;
+    case DltSchema::NO_SCHEMA:
+        Target<NoSchemaPacket>::run(data, size);
+        break;
+    }
+}
+
+static void fuzz_delta(const uint8_t data[], size_t size)
+{
+    DltDeltaDecoder decoder;
+    while (size > 0)
+    {
+        uint32_t values[DLT_MAX_COUNT];
+        size_t used = 0;
+        DltDecoded decoded = decoder.decode(data, size, values, used);
+        if (decoded == DltDecoded::MALFORMED)
+            return;
+        FUZZ_CHECK(used > 0 && used <= size);
+        // a stale delta's size is unknown, it takes the rest
+        FUZZ_CHECK(decoded != DltDecoded::STALE || used == size);
+        if (decoded == DltDecoded::VALUES)
+        {
+            uint8_t count;
+            const DltField *fields = dlt_fields(decoder.schema(), count);
+            FUZZ_CHECK(fields != nullptr);
+            check_widths(fields, count, values);
+            FUZZ_CHECK((decoder.fresh() & ~static_cast<uint32_t>(Bitpack_mask(count))) == 0);
+            Telemetry t = {};
+            FUZZ_CHECK(dlt_untransform(decoder.schema(), values, t));
+        }
+        data += used;
+        size -= used;
+    }
+}
+
+struct FuzzSink
+{
+    uint64_t records = 0;
+
+    void operator()(const DltRecord &record)
+    {
+        records++;
+        uint8_t count;
+        FUZZ_CHECK(dlt_fields(record.schema, count) != nullptr);
+        FUZZ_CHECK((record.fresh & ~record.columns) == 0);
+        FUZZ_CHECK(record.columns != 0 && (record.columns >> DLT_COLUMN_COUNT) == 0);
+    }
+};
+
+static void fuzz_stream(const uint8_t data[], size_t size)
+{
+    if (size == 0)
+        return;
+    size_t split = data[0] % size;
+    data++;
+    size--;
+    split = split < size ? split : size;
+    DltStream stream;
+    FuzzSink sink;
+    stream.push(data, split, sink);
+    stream.push(data + split, size - split, sink);
+    FUZZ_CHECK(stream.stats().bytes == size);
+    FUZZ_CHECK(stream.stats().frames == sink.records);
+}
+
+static void fuzz_fec(const uint8_t data[], size_t size)
+{
+    uint8_t packet[FEC_MAX_CODEWORD + FEC_MARKER_COPIES];
+    if (size > sizeof(packet))
+        return;
+    memcpy(packet, data, size);
+    size_t decoded = size;
+    int corrected = fec_decode(packet, decoded);
+    if (corrected <= 0 && (decoded == size || corrected < 0))
+    {
+        FUZZ_CHECK(decoded == size && memcmp(packet, data, size) == 0);
+        return;
+    }
+    // coded: the packet, its parity and the markers
+    uint8_t parity = (size - decoded - FEC_MARKER_COPIES);
+    FUZZ_CHECK(decoded < size && parity % 2 == 0 && parity > 0);
+    FecEncoder encoder;
+    uint8_t coded[FEC_MAX_CODEWORD + FEC_MARKER_COPIES];
+    memcpy(coded, packet, decoded);
+    FUZZ_CHECK(encoder.encode(coded, decoded, sizeof(coded), parity) == size);
+    unsigned differ = 0;
+    for (size_t k = 0; k < size; k++)
+        differ += coded[k] != data[k];
+    FUZZ_CHECK(differ == static_cast<unsigned>(corrected));
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size < 2)
+        return 0;
+    switch (data[0] % TARGETS)
+    {
+    case READ:
+        by_schema<Read>(data[1], data + 2, size - 2);
+        break;
+    case UNPACK:
+        by_schema<Unpack>(data[1], data + 2, size - 2);
+        break;
+    case DELTA:
+        fuzz_delta(data + 1, size - 1);
+        break;
+    case STREAM:
+        fuzz_stream(data + 1, size - 1);
+        break;
+    case FEC:
+        fuzz_fec(data + 1, size - 1);
+        break;
+    }
+    return 0;
+}
+
+#ifdef DLT_FUZZ_MAIN
+
+#include <random>
+#include <vector>
+
+// real frames of a short flight, to mutate: a keyframe and deltas, some
+// logged as the ground station logs them
+static std::vector<uint8_t> flight(std::mt19937 &rng, bool logged)
+{
+    DltDeltaEncoder<> encoder;
+    std::vector<uint8_t> out;
+    Telemetry t = {};
+    for (int k = 0; k < 30; k++)
+    {
+        t.curr_state = 4;
+        t.timestamp = 50 * k;
+        t.altitude = 100 + 3 * k + rng() % 7;
+        t.gyro_counts.x = rng() % 200;
+        t.gps_lat = 42.4f;
+        uint32_t values[LaunchModePacket::COUNT];
+        uint8_t frame[DltDeltaLayout<LaunchModePacket>::MAX_BYTES];
+        dlt_transform<LaunchModePacket>(t, values);
+        size_t size = encoder.encode<LaunchModePacket>(values, frame);
+        if (logged)
+        {
+            uint8_t header[2];
+            out.insert(out.end(), header, header + dlt_log_header(size, header));
+        }
+        out.insert(out.end(), frame, frame + size);
+    }
+    return out;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        for (int a = 1; a < argc; a++)
+        {
+            FILE *in = fopen(argv[a], "rb");
+            if (in == nullptr)
+            {
+                perror(argv[a]);
+                return 1;
+            }
+            std::vector<uint8_t> data;
+            int c;
+            while ((c = fgetc(in)) != EOF)
+                data.push_back(c);
+            fclose(in);
+            LLVMFuzzerTestOneInput(data.data(), data.size());
+        }
+        return 0;
+    }
+
+    std::mt19937 rng(49);
+    const int RUNS = 200000;
+    for (int run = 0; run < RUNS; run++)
+    {
+        // the target, and for the codecs and the stream the byte after it
+        std::vector<uint8_t> data(1, run % TARGETS);
+        if (data[0] != DELTA && data[0] != FEC)
+            data.push_back(rng());
+        if (data[0] == FEC && run % 3 != 0)
+        {
+            // real frames coded, with up to a byte more in error than the
+            // parity corrects
+            std::vector<uint8_t> packet = flight(rng, false);
+            size_t size = 1 + rng() % 150;
+            uint8_t parity = 2 * (1 + rng() % (FEC_MAX_PARITY / 2));
+            FecEncoder encoder;
+            size = encoder.encode(packet.data(), size, packet.size(), parity);
+            packet.resize(size);
+            for (int errors = rng() % (parity / 2 + 2); errors > 0; errors--)
+                packet[rng() % size] ^= 1 + rng() % 255;
+            data.insert(data.end(), packet.begin(), packet.end());
+        }
+        else if (data[0] >= DELTA && run % 3 != 0)
+        {
+            // a real flight with a few bytes changed, cut short
+            std::vector<uint8_t> frames = flight(rng, data[0] == STREAM);
+            for (int flips = rng() % 4; flips > 0; flips--)
+                frames[rng() % frames.size()] ^= 1 << (rng() % 8);
+            frames.resize(rng() % (frames.size() + 1));
+            data.insert(data.end(), frames.begin(), frames.end());
+        }
+        else
+        {
+            size_t start = data.size();
+            data.resize(start + rng() % 64);
+            for (size_t k = start; k < data.size(); k++)
+                data[k] = rng();
+        }
+        // heap copy of exactly the input, so reading past it is caught
+        std::vector<uint8_t> exact(data);
+        LLVMFuzzerTestOneInput(exact.data(), exact.size());
+    }
+    printf("%d inputs\n", RUNS);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,177 @@
+/**************************************************************
+ *
+ *                     baro_altitude_bench.cpp
+ *
+ *     Overview: Checks PressureAltitude (flight-computer/barometer.h)
+ *                  against the pow() form the BMP3XX library's
+ *                  readAltitude uses:
+ *                  - maximum error over the whole table and by altitude band
+ *                  - error against the pressure/altitude columns of the
+ *                    recorded logs, sea level pressure recovered from the log
+ *                  - time per conversion for pow(), powf() and the table
+ *
+ *                  Host timings only rank the three, soft-float on the M0
+ *                  widens the gap considerably.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer baro_altitude_bench.cpp
+ *            ../../carm-electronics/flight-computer/barometer.cpp -o baro_altitude_bench
+ *     Run:
+ *        ./baro_altitude_bench [log ...]
+ *
+ *        logs default to ../filter-tests/G53FJ_10Feb24.csv and
+ *        ../data-analysis/data/test-flight2/DATALOG.CSV
+ *
+ **************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "barometer.h"
+#include "../filter-tests/flightlog.hpp"
+
+static const float SEALEVELPRESSURE_HPA = 1012.3; // def.h
+static const float DLT_MAX_ALTITUDE = 3275;
+
+// what Adafruit_BMP3XX::readAltitude computes
+static float library_altitude(float pressure, float sea_level)
+{
+    return 44330.0 * (1.0 - pow(pressure / sea_level, 0.1903));
+}
+
+static double exact_altitude(double pressure, double sea_level)
+{
+    return 44330.0 * (1.0 - std::pow(pressure / sea_level, 0.1903));
+}
+
+static double exact_pressure(double altitude, double sea_level)
+{
+    return sea_level * std::pow(1.0 - altitude / 44330.0, 1.0 / 0.1903);
+}
+
+static void table_error()
+{
+    static const float BANDS[][2] = {{-500, 0}, {0, 1000}, {1000, 2000}, {2000, DLT_MAX_ALTITUDE},
+                                     {DLT_MAX_ALTITUDE, 5400}};
+    PressureAltitude converter(SEALEVELPRESSURE_HPA);
+    std::printf("max error against the formula, sea level %.1f hPa\n", SEALEVELPRESSURE_HPA);
+    std::printf("  %16s %12s %12s\n", "altitude (m)", "table (m)", "powf (m)");
+    for (const auto &band : BANDS)
+    {
+        double table_max = 0, powf_max = 0;
+        for (double h = band[0]; h <= band[1]; h += 0.01)
+        {
+            float p = exact_pressure(h, SEALEVELPRESSURE_HPA);
+            double exact = exact_altitude(p, SEALEVELPRESSURE_HPA);
+            table_max = std::max(table_max, std::fabs(converter.altitude(p) - exact));
+            float ratio = p / SEALEVELPRESSURE_HPA;
+            powf_max = std::max(powf_max, std::fabs(44330.0f * (1.0f - powf(ratio, 0.1903f)) - exact));
+        }
+        std::printf("  %7.0f..%-7.0f %12.4f %12.4f\n", band[0], band[1], table_max, powf_max);
+    }
+    std::printf("\n");
+}
+
+// the sea level pressure the log was recorded with, from the median row
+static float recover_sea_level(const std::vector<ImuSample> &rows)
+{
+    std::vector<float> estimates;
+    for (const ImuSample &s : rows)
+        if (s.pressure > 0 && !std::isnan(s.altitude))
+            estimates.push_back(s.pressure / std::pow(1.0 - s.altitude / 44330.0, 1.0 / 0.1903));
+    std::nth_element(estimates.begin(), estimates.begin() + estimates.size() / 2, estimates.end());
+    return estimates[estimates.size() / 2];
+}
+
+static void validate_log(const char *path)
+{
+    ImuLogReader reader;
+    if (!reader.open(path))
+    {
+        std::fprintf(stderr, "Unable to open %s\n", path);
+        return;
+    }
+    std::vector<ImuSample> rows;
+    ImuSample s;
+    while (reader.next(s))
+        if (s.pressure > 0)
+            rows.push_back(s);
+    if (rows.empty())
+        return;
+    float sea_level = recover_sea_level(rows);
+    PressureAltitude converter(sea_level);
+    double table_log = 0, library_log = 0, table_library = 0, rms = 0;
+    std::vector<float> deviations;
+    float low = INFINITY, high = -INFINITY;
+    for (const ImuSample &r : rows)
+    {
+        float table = converter.altitude(r.pressure);
+        float library = library_altitude(r.pressure, sea_level);
+        table_log = std::max(table_log, (double)std::fabs(table - r.altitude));
+        deviations.push_back(std::fabs(table - r.altitude));
+        library_log = std::max(library_log, (double)std::fabs(library - r.altitude));
+        table_library = std::max(table_library, (double)std::fabs(table - library));
+        rms += (table - library) * (table - library);
+        low = std::min(low, r.altitude);
+        high = std::max(high, r.altitude);
+    }
+    std::printf("%s: %zu rows, %.0f..%.0f m, sea level %.2f hPa\n", path, rows.size(), low, high, sea_level);
+    std::nth_element(deviations.begin(), deviations.begin() + deviations.size() / 2, deviations.end());
+    // older firmware logged pressure and altitude from separate sensor
+    // reads, so the maximum is the change between two reads in flight
+    std::printf("  |table - logged|       %.4f m median, %.4f m max\n", deviations[deviations.size() / 2],
+                table_log);
+    std::printf("  max |pow - logged|     %.4f m  (pressure is logged rounded)\n", library_log);
+    std::printf("  max |table - pow|      %.4f m, rms %.4f m\n\n", table_library, std::sqrt(rms / rows.size()));
+}
+
+template <typename Convert>
+static double time_ns(const std::vector<float> &pressures, Convert convert)
+{
+    volatile float sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < 20; rep++)
+        for (float p : pressures)
+            sink = sink + convert(p);
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return ns / (20.0 * pressures.size());
+}
+
+static void benchmark()
+{
+    // pressures over the flight envelope, in a shuffled order so the table
+    // is not walked sequentially
+    std::vector<float> pressures;
+    for (int i = 0; i < 100000; i++)
+        pressures.push_back(exact_pressure(DLT_MAX_ALTITUDE * ((i * 7919) % 100000) / 100000.0,
+                                           SEALEVELPRESSURE_HPA));
+    PressureAltitude converter(SEALEVELPRESSURE_HPA);
+    std::printf("time per conversion\n");
+    std::printf("  pow  (readAltitude) %6.2f ns\n",
+                time_ns(pressures, [](float p) { return library_altitude(p, SEALEVELPRESSURE_HPA); }));
+    std::printf("  powf                %6.2f ns\n", time_ns(pressures, [](float p) {
+                    return 44330.0f * (1.0f - powf(p / SEALEVELPRESSURE_HPA, 0.1903f));
+                }));
+    std::printf("  table               %6.2f ns\n",
+                time_ns(pressures, [&converter](float p) { return converter.altitude(p); }));
+}
+
+int main(int argc, char **argv)
+{
+    table_error();
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; i++)
+            validate_log(argv[i]);
+    }
+    else
+    {
+        validate_log("../filter-tests/G53FJ_10Feb24.csv");
+        validate_log("../data-analysis/data/test-flight2/DATALOG.CSV");
+    }
+    benchmark();
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**************************************************************
+ *
+ *                     bitpack_bench.cpp
+ *
+ *     Overview: Packs and unpacks the launch mode packet (dlt.h) into its
+ *                  five words three ways, on random values:
+ *                  - Bitpack_newu/Bitpack_getu with the widths and lsbs read
+ *                    from a table and the calls kept out of line, as when
+ *                    they lived in bitpack.cpp
+ *                  - the same calls inlined from bitpack.h
+ *                  - dlt_pack/dlt_unpack, every width and lsb a template
+ *                    argument
+ *
+ *                  Built without NDEBUG the first two also run the checked
+ *                  variants. M0 cycle counts for the same three are
+ *                  measured by bitpack_cycles.ino.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -DNDEBUG -I../../carm-electronics/flight-computer bitpack_bench.cpp -o bitpack_bench
+ *     Run:
+ *        ./bitpack_bench
+ *
+ **************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../../carm-electronics/bitpack.h"
+#include "../../carm-electronics/dlt.h"
+
+typedef LaunchModePacket Packet;
+typedef DltLayout<Packet> Layout;
+
+static const int FRAMES = 20000;
+static const int PASSES = 100;
+
+static unsigned widths[Packet::COUNT], lsbs[Packet::COUNT], words_of[Packet::COUNT];
+
+__attribute__((noinline)) static uint64_t newu_call(uint64_t word, unsigned width, unsigned lsb, uint64_t value)
+{
+    return Bitpack_newu(word, width, lsb, value);
+}
+
+__attribute__((noinline)) static uint64_t getu_call(uint64_t word, unsigned width, unsigned lsb)
+{
+    return Bitpack_getu(word, width, lsb);
+}
+
+static void pack_out_of_line(const uint32_t values[], uint64_t words[])
+{
+    for (unsigned w = 0; w < Layout::WORDS; w++)
+        words[w] = 0;
+    for (unsigned i = 0; i < Packet::COUNT; i++)
+        words[words_of[i]] = newu_call(words[words_of[i]], widths[i], lsbs[i], values[i]);
+}
+
+static void unpack_out_of_line(const uint64_t words[], uint32_t values[])
+{
+    for (unsigned i = 0; i < Packet::COUNT; i++)
+        values[i] = getu_call(words[words_of[i]], widths[i], lsbs[i]);
+}
+
+static void pack_inline(const uint32_t values[], uint64_t words[])
+{
+    for (unsigned w = 0; w < Layout::WORDS; w++)
+        words[w] = 0;
+    for (unsigned i = 0; i < Packet::COUNT; i++)
+        words[words_of[i]] = Bitpack_newu(words[words_of[i]], widths[i], lsbs[i], values[i]);
+}
+
+static void unpack_inline(const uint64_t words[], uint32_t values[])
+{
+    for (unsigned i = 0; i < Packet::COUNT; i++)
+        values[i] = Bitpack_getu(words[words_of[i]], widths[i], lsbs[i]);
+}
+
+template <void (*PACK)(const uint32_t[], uint64_t[]), void (*UNPACK)(const uint64_t[], uint32_t[])>
+static void bench(const char *name, const std::vector<uint32_t> &values)
+{
+    std::vector<uint64_t> words(FRAMES * Layout::WORDS);
+    std::vector<uint32_t> decoded(values.size());
+    double pack_seconds = 0, unpack_seconds = 0;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        for (int k = 0; k < FRAMES; k++)
+            PACK(&values[k * Packet::COUNT], &words[k * Layout::WORDS]);
+        auto packed = std::chrono::steady_clock::now();
+        for (int k = 0; k < FRAMES; k++)
+            UNPACK(&words[k * Layout::WORDS], &decoded[k * Packet::COUNT]);
+        auto unpacked = std::chrono::steady_clock::now();
+        pack_seconds += std::chrono::duration<double>(packed - begin).count();
+        unpack_seconds += std::chrono::duration<double>(unpacked - packed).count();
+    }
+    double frames = static_cast<double>(FRAMES) * PASSES;
+    std::printf("  %-26s pack %6.1f ns %6.1f Mframes/s  unpack %6.1f ns %6.1f Mframes/s%s\n", name,
+                pack_seconds / frames * 1e9, frames / pack_seconds / 1e6, unpack_seconds / frames * 1e9,
+                frames / unpack_seconds / 1e6, decoded == values ? "" : "  ROUND TRIP FAILED");
+}
+
+int main()
+{
+    for (unsigned i = 0; i < Packet::COUNT; i++)
+    {
+        unsigned start = dlt_start<Packet>(i);
+        widths[i] = Packet::fields[i].width;
+        words_of[i] = start / 64;
+        lsbs[i] = 64 - start % 64 - widths[i];
+    }
+
+    std::mt19937 rng(42);
+    std::vector<uint32_t> values(FRAMES * Packet::COUNT);
+    for (int k = 0; k < FRAMES; k++)
+        for (unsigned i = 0; i < Packet::COUNT; i++)
+            values[k * Packet::COUNT + i] = rng() & Bitpack_mask(widths[i]);
+
+    std::printf("launch mode packet, %u fields in %u words, %s\n", Packet::COUNT, Layout::WORDS,
+                BITPACK_CHECKED ? "checked" : "unchecked");
+    bench<pack_out_of_line, unpack_out_of_line>("out of line, table", values);
+    bench<pack_inline, unpack_inline>("inline, table", values);
+    bench<dlt_pack<Packet>, dlt_unpack<Packet>>("inline, template arguments", values);
+    return 0;
+}
@@ -0,0 +1,143 @@
+/**************************************************************
+ *
+ *                     bitpack_cycles.ino
+ *
+ *     Overview: CPU cycles per launch mode packet to pack and unpack its
+ *                  five words on the Feather M0, the three ways
+ *                  bitpack_bench.cpp times on the host: Bitpack_newu/getu
+ *                  out of line with the layout read from a table, the same
+ *                  inlined, and inlined with every width and lsb a
+ *                  template argument
+ *
+ *                  The M0 has no 64-bit shifter: a shift by a variable
+ *                  count is a call into libgcc, one by a constant a few
+ *                  32-bit instructions, which is most of the difference.
+ *
+ *                  The layout is dlt.h's LaunchModePacket, copied here as
+ *                  the Arduino IDE only compiles the files next to the sketch
+ *
+ **************************************************************/
+
+#include "../../carm-electronics/bitpack.h"
+
+const unsigned FIELDS = 27;
+const unsigned WORDS = 5;
+const unsigned long FRAMES = 20000;
+
+// {width, word, lsb} of each field
+constexpr unsigned LAYOUT[FIELDS][3] = {
+    {4, 0, 60}, {3, 0, 57}, {1, 0, 56}, {28, 0, 28}, {1, 0, 27}, {27, 0, 0}, {20, 1, 44},
+    {15, 1, 29}, {9, 1, 20}, {20, 1, 0}, {19, 2, 45}, {17, 2, 28}, {15, 2, 13}, {2, 2, 11},
+    {11, 2, 0}, {9, 3, 55}, {11, 3, 44}, {11, 3, 33}, {11, 3, 22}, {11, 3, 11}, {11, 3, 0},
+    {11, 4, 53}, {10, 4, 43}, {10, 4, 33}, {15, 4, 18}, {2, 4, 16}, {1, 4, 15},
+};
+
+uint32_t values[FIELDS];
+uint32_t decoded[FIELDS];
+volatile uint64_t words[WORDS];
+unsigned layout[FIELDS][3]; // read at run time
+
+__attribute__((noinline)) uint64_t newu_call(uint64_t word, unsigned width, unsigned lsb, uint64_t value)
+{
+    return Bitpack_newu(word, width, lsb, value);
+}
+
+__attribute__((noinline)) uint64_t getu_call(uint64_t word, unsigned width, unsigned lsb)
+{
+    return Bitpack_getu(word, width, lsb);
+}
+
+void pack_out_of_line()
+{
+    for (unsigned i = 0; i < FIELDS; i++)
+    {
+        words[layout[i][1]] = newu_call(words[layout[i][1]], layout[i][0], layout[i][2], values[i]);
+    }
+}
+
+void unpack_out_of_line()
+{
+    for (unsigned i = 0; i < FIELDS; i++)
+    {
+        decoded[i] = getu_call(words[layout[i][1]], layout[i][0], layout[i][2]);
+    }
+}
+
+void pack_inline()
+{
+    for (unsigned i = 0; i < FIELDS; i++)
+    {
+        words[layout[i][1]] = Bitpack_newu(words[layout[i][1]], layout[i][0], layout[i][2], values[i]);
+    }
+}
+
+void unpack_inline()
+{
+    for (unsigned i = 0; i < FIELDS; i++)
+    {
+        decoded[i] = Bitpack_getu(words[layout[i][1]], layout[i][0], layout[i][2]);
+    }
+}
+
+template <unsigned I = 0, bool END = I == FIELDS>
+struct Fields
+{
+    static void pack()
+    {
+        words[LAYOUT[I][1]] = Bitpack_newu<LAYOUT[I][0], LAYOUT[I][2]>(words[LAYOUT[I][1]], values[I]);
+        Fields<I + 1>::pack();
+    }
+
+    static void unpack()
+    {
+        decoded[I] = Bitpack_getu<LAYOUT[I][0], LAYOUT[I][2]>(words[LAYOUT[I][1]]);
+        Fields<I + 1>::unpack();
+    }
+};
+
+template <unsigned I>
+struct Fields<I, true>
+{
+    static void pack() {}
+    static void unpack() {}
+};
+
+void report(const char *name, void (*run)())
+{
+    unsigned long begin = micros();
+    for (unsigned long k = 0; k < FRAMES; k++)
+    {
+        values[0] = k;
+        run();
+    }
+    unsigned long elapsed = micros() - begin;
+    Serial.print(name);
+    Serial.print(": ");
+    Serial.print((float)elapsed * (F_CPU / 1000000) / FRAMES);
+    Serial.println(" cycles/frame");
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Serial)
+        ;
+
+    for (unsigned i = 0; i < FIELDS; i++)
+    {
+        values[i] = (0x9E3779B9u * (i + 1)) & Bitpack_mask(LAYOUT[i][0]);
+        for (unsigned k = 0; k < 3; k++)
+        {
+            layout[i][k] = LAYOUT[i][k];
+        }
+    }
+
+    report("pack, out of line", pack_out_of_line);
+    report("unpack, out of line", unpack_out_of_line);
+    report("pack, inline", pack_inline);
+    report("unpack, inline", unpack_inline);
+    report("pack, template arguments", Fields<>::pack);
+    report("unpack, template arguments", Fields<>::unpack);
+}
+
+void loop() {}
@@ -0,0 +1,134 @@
+/**************************************************************
+ *
+ *                     bitstream_bench.cpp
+ *
+ *     Overview: Every packet in dlt.h sent as a back to back bit stream
+ *                  (dlt_write/dlt_read) against the 64-bit words it was
+ *                  sent in (dlt_pack/dlt_unpack, bit for bit the old pack_*
+ *                  functions, see dlt_bench.cpp):
+ *                  - bytes per frame, and the airtime that saves at the
+ *                    flight radio settings
+ *                  - time to encode and decode a frame, on random values,
+ *                    and the same stream through BitWriter/BitReader
+ *                    (bitstream.h), a field at a time
+ *
+ *                  Host timings only rank the two; both are integer code,
+ *                  the M0 has no 64-bit shifter so the words lose more there.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer bitstream_bench.cpp -o bitstream_bench
+ *     Run:
+ *        ./bitstream_bench
+ *
+ **************************************************************/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../../carm-electronics/bitstream.h"
+#include "../../carm-electronics/dlt.h"
+
+static const int FRAMES = 20000;
+static const int PASSES = 50;
+
+// RadioHead's RH_RF95 default modem config: 125 kHz, 4/5, SF7, explicit
+// header with CRC, 8 symbol preamble
+static double airtime_ms(unsigned payload)
+{
+    const double sf = 7, symbol_ms = (1 << 7) / 125.0;
+    // RadioHead prepends a 4 byte header to every payload
+    double bits = 8.0 * (payload + 4) - 4 * sf + 28 + 16;
+    double symbols = 8 + 4.25 + 8 + (bits > 0 ? std::ceil(bits / (4 * sf)) * 5 : 0);
+    return symbols * symbol_ms;
+}
+
+template <typename Packet>
+static void bench(const char *name)
+{
+    typedef DltLayout<Packet> Layout;
+    std::mt19937 rng(41);
+    std::vector<uint32_t> values(FRAMES * Packet::COUNT);
+    for (int k = 0; k < FRAMES; k++)
+    {
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+        {
+            values[k * Packet::COUNT + i] = rng() & ((1ULL << Packet::fields[i].width) - 1);
+        }
+    }
+
+    std::vector<uint64_t> words(FRAMES * Layout::WORDS);
+    std::vector<uint8_t> bytes(FRAMES * Layout::BYTES);
+    std::vector<uint32_t> decoded(FRAMES * Packet::COUNT);
+    uint64_t sink = 0;
+    double seconds[6] = {0, 0, 0, 0, 0, 0};
+    int mismatches = 0;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        for (int k = 0; k < FRAMES; k++)
+            dlt_pack<Packet>(&values[k * Packet::COUNT], &words[k * Layout::WORDS]);
+        auto packed = std::chrono::steady_clock::now();
+        for (int k = 0; k < FRAMES; k++)
+            dlt_unpack<Packet>(&words[k * Layout::WORDS], &decoded[k * Packet::COUNT]);
+        auto unpacked = std::chrono::steady_clock::now();
+        sink += decoded[pass];
+        for (int k = 0; k < FRAMES; k++)
+            dlt_write<Packet>(&values[k * Packet::COUNT], &bytes[k * Layout::BYTES]);
+        auto written = std::chrono::steady_clock::now();
+        for (int k = 0; k < FRAMES; k++)
+            dlt_read<Packet>(&bytes[k * Layout::BYTES], Layout::BYTES, &decoded[k * Packet::COUNT]);
+        auto read = std::chrono::steady_clock::now();
+        sink += decoded[pass];
+        for (int k = 0; k < FRAMES; k++)
+        {
+            BitWriter out(&bytes[k * Layout::BYTES]);
+            for (uint8_t i = 0; i < Packet::COUNT; i++)
+                out.write(values[k * Packet::COUNT + i], Packet::fields[i].width);
+            out.finish();
+        }
+        auto cursor_written = std::chrono::steady_clock::now();
+        for (int k = 0; k < FRAMES; k++)
+        {
+            BitReader in(&bytes[k * Layout::BYTES], Layout::BYTES);
+            for (uint8_t i = 0; i < Packet::COUNT; i++)
+                decoded[k * Packet::COUNT + i] = in.read(Packet::fields[i].width);
+        }
+        auto cursor_read = std::chrono::steady_clock::now();
+        sink += decoded[pass];
+
+        seconds[0] += std::chrono::duration<double>(packed - begin).count();
+        seconds[1] += std::chrono::duration<double>(unpacked - packed).count();
+        seconds[2] += std::chrono::duration<double>(written - unpacked).count();
+        seconds[3] += std::chrono::duration<double>(read - written).count();
+        seconds[4] += std::chrono::duration<double>(cursor_written - read).count();
+        seconds[5] += std::chrono::duration<double>(cursor_read - cursor_written).count();
+        if (pass == 0)
+        {
+            mismatches = decoded != values;
+        }
+    }
+
+    double frames = static_cast<double>(FRAMES) * PASSES;
+    std::printf("%-12s %3u bits  words %3u B %6.2f ms  stream %3u B %6.2f ms  (-%u B)\n", name,
+                dlt_stream_bits<Packet>(Packet::COUNT), Layout::WORDS * 8, airtime_ms(Layout::WORDS * 8),
+                Layout::BYTES, airtime_ms(Layout::BYTES), Layout::WORDS * 8 - Layout::BYTES);
+    std::printf("%-12s ns/frame: pack %5.1f unpack %5.1f  write %5.1f read %5.1f  BitWriter %5.1f BitReader %5.1f%s\n",
+                "", seconds[0] / frames * 1e9, seconds[1] / frames * 1e9, seconds[2] / frames * 1e9,
+                seconds[3] / frames * 1e9, seconds[4] / frames * 1e9, seconds[5] / frames * 1e9,
+                mismatches ? "  ROUND TRIP FAILED" : "");
+    std::printf("%-12s (checksum %llu)\n", "", static_cast<unsigned long long>(sink));
+}
+
+int main()
+{
+    std::printf("payload and airtime per frame at SF7/125 kHz, then the time to encode and decode it\n");
+    bench<PowerOnPacket>("power on");
+    bench<LaunchReadyPacket>("launch ready");
+    bench<LaunchModePacket>("launch mode");
+    bench<RecoveryPacket>("recovery");
+    bench<NoSchemaPacket>("no schema");
+    return 0;
+}
@@ -0,0 +1,104 @@
+/**************************************************************
+ *
+ *                     detector_bench.cpp
+ *
+ *     Overview: What the redundant event detectors (flight-computer/
+ *                  detectors.h) cost per tick, next to the AltitudeEstimator
+ *                  step they run beside, replaying the IMU log over and over.
+ *
+ *                  Host timings only give the ratio between the two; both
+ *                  are float code, so soft-float on the M0 scales them
+ *                  roughly alike. The detection latency of each detector is
+ *                  in ../filter-tests/event_latency.cpp.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer detector_bench.cpp
+ *            ../../carm-electronics/StateDetermination.cpp
+ *            ../../carm-electronics/flight-computer/altitude.cpp
+ *            ../../carm-electronics/flight-computer/apogee.cpp
+ *            ../../carm-electronics/flight-computer/filters.cpp
+ *            ../../carm-electronics/flight-computer/algebra.cpp
+ *            ../../carm-electronics/flight-computer/transitions.cpp
+ *            ../../carm-electronics/flight-computer/detectors.cpp -o detector_bench
+ *     Run:
+ *        ./detector_bench [log]
+ *
+ *        log defaults to ../filter-tests/G53FJ_10Feb24.csv
+ *
+ **************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "../../carm-electronics/StateDetermination.h"
+#include "../filter-tests/flightlog.hpp"
+
+static const int PASSES = 50;
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "../filter-tests/G53FJ_10Feb24.csv";
+    std::vector<ImuSample> log;
+    if (!load_imu_log(path, log))
+    {
+        std::fprintf(stderr, "Unable to open %s\n", path);
+        return 1;
+    }
+    float pad = log.front().altitude;
+
+    // the estimator once, keeping what the detectors need from it
+    std::vector<DetectorInput> inputs;
+    double estimator_seconds = 0;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        AltitudeEstimator estimator(SIGMA_ACCEL, SIGMA_GYRO, SIGMA_BARO, CA, ACCEL_THRESHOLD, SIGMA_GPS);
+        auto begin = std::chrono::steady_clock::now();
+        for (const ImuSample &s : log)
+        {
+            float accel[3] = {s.accel[0] / FLIGHTLOG_GRAVITY, s.accel[1] / FLIGHTLOG_GRAVITY,
+                              s.accel[2] / FLIGHTLOG_GRAVITY};
+            float gyro[3] = {s.gyro[0], s.gyro[1], s.gyro[2]};
+            uint32_t time = s.time * 1000; // us
+            estimator.predict(accel, gyro, time);
+            estimator.updateBaro(s.altitude - pad, time);
+            if (pass == 0)
+            {
+                DetectorInput in;
+                in.time = time;
+                for (int k = 0; k < 3; k++)
+                    in.accel[k] = s.accel[k];
+                in.baroAltitude = s.altitude - pad;
+                in.baroValid = true;
+                in.fused.time = time;
+                in.fused.altitude = estimator.getAltitude();
+                in.fused.velocity = estimator.getVerticalVelocity();
+                in.fused.accel = estimator.getVerticalAcceleration();
+                in.fused.timeToApogee = NAN;
+                in.fused.events = 0;
+                inputs.push_back(in);
+            }
+        }
+        estimator_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    double voter_seconds = 0;
+    uint8_t decisions = 0;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        EventVoter voter(FLIGHT_DETECTORS);
+        auto begin = std::chrono::steady_clock::now();
+        for (const DetectorInput &in : inputs)
+            voter.update(in);
+        voter_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        decisions |= voter.getDecisions();
+    }
+
+    double ticks = static_cast<double>(PASSES) * log.size();
+    std::printf("%s: %zu samples x %d passes\n", path, log.size(), PASSES);
+    std::printf("  AltitudeEstimator predict + updateBaro  %7.1f ns/tick\n", estimator_seconds / ticks * 1e9);
+    std::printf("  EventVoter update (3 detectors + vote)  %7.1f ns/tick, %.0f%% of the estimator\n",
+                voter_seconds / ticks * 1e9, 100 * voter_seconds / estimator_seconds);
+    std::printf("  events declared: %d of %d\n", __builtin_popcount(decisions), FLIGHT_EVENT_COUNT);
+    return 0;
+}
@@ -0,0 +1,222 @@
+/**************************************************************
+ *
+ *                     dlt_bench.cpp
+ *
+ *     Overview: The launch mode packet as the codec in dlt.h builds it,
+ *                  next to the hand-written transform_launchmode and
+ *                  pack_noschema it replaced (condensed below, packing
+ *                  a field at a time with Bitpack_newu as they did):
+ *                  - the fields must land where pack_noschema put them and
+ *                    agree on random in-range readings, to within the one
+ *                    step the reciprocal of a spacing can round a reading
+ *                    across, with none saturated
+ *                  - time per packet for each
+ *
+ *                  Host timings only rank the two. Both share the float
+ *                  transforms, which soft-float dominates on the M0, so
+ *                  the gap there is mostly the packing.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer dlt_bench.cpp -o dlt_bench
+ *     Run:
+ *        ./dlt_bench
+ *
+ **************************************************************/
+
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../../carm-electronics/bitpack.h"
+#include "../../carm-electronics/dlt.h"
+
+static const int PACKETS = 20000;
+static const int PASSES = 50;
+
+static unsigned legacy_dlt(int n_min, float reading, float spacing)
+{
+    return floor((reading - n_min) / spacing);
+}
+
+static unsigned legacy_imu(int16_t counts, float reading, float scale, int n_min, float spacing)
+{
+#if IMU_RAW_COUNTS
+    (void)reading;
+    return serialize_dlt_counts(counts, dlt_count_map(scale, n_min, spacing));
+#else
+    (void)counts;
+    (void)scale;
+    return legacy_dlt(n_min, reading, spacing);
+#endif
+}
+
+static unsigned legacy_micro(float r)
+{
+    return r > 0 ? static_cast<unsigned>(r * 1000000) : r < 0 ? static_cast<unsigned>(r * 1000000 * -1) : 0;
+}
+
+// transform_launchmode, indexed as it was
+static void legacy_transform(const Telemetry &t, unsigned d[27])
+{
+    d[0] = t.curr_state;
+    d[1] = t.gps_num_satellites;
+    d[2] = t.gps_long > 0 ? 1 : 0;
+    d[3] = legacy_micro(t.gps_long);
+    d[4] = t.gps_lat > 0 ? 1 : 0;
+    d[5] = legacy_micro(t.gps_lat);
+    d[6] = legacy_imu(t.gyro_counts.x, t.gyro_x, DLT_GYRO_SCALE, -1440, GYRO_XY_SPACING);
+    d[7] = legacy_dlt(0, t.gps_altitude, ALTITUDE_SPACING);
+    d[8] = legacy_imu(t.accel_counts.x, t.accel_x, DLT_ACCEL_SCALE, 0, ACCEL_XY_SPACING);
+    d[9] = legacy_imu(t.gyro_counts.y, t.gyro_y, DLT_GYRO_SCALE, -1440, GYRO_XY_SPACING);
+    d[10] = t.timestamp;
+    d[11] = legacy_imu(t.gyro_counts.z, t.gyro_z, DLT_GYRO_SCALE, -360, GYRO_Z_SPACING);
+    d[12] = legacy_dlt(0, t.altitude, ALTITUDE_SPACING);
+    d[13] = t.gps_antenna_status;
+    d[14] = legacy_dlt(-15, t.external_temp, EXT_TEMP_SPACING);
+    d[15] = legacy_imu(t.accel_counts.y, t.accel_y, DLT_ACCEL_SCALE, 0, ACCEL_XY_SPACING);
+    d[16] = legacy_dlt(0, t.temperature_avbay, INT_TEMP_SPACING);
+    d[17] = legacy_dlt(0, t.temperature_engbay, INT_TEMP_SPACING);
+    d[18] = legacy_imu(t.accel_counts.z, t.accel_z, DLT_ACCEL_SCALE, -30, ACCEL_Z_SPACING);
+    d[19] = legacy_imu(t.mag_counts.x, t.mag_x, DLT_MAG_SCALE, -5, MAG_FORCE_SPACING);
+    d[20] = legacy_imu(t.mag_counts.y, t.mag_y, DLT_MAG_SCALE, -5, MAG_FORCE_SPACING);
+    d[21] = legacy_imu(t.mag_counts.z, t.mag_z, DLT_MAG_SCALE, -5, MAG_FORCE_SPACING);
+    d[22] = t.failures;
+    d[23] = legacy_dlt(0, t.gps_speed, GPS_SPEED_SPACING);
+    d[24] = legacy_dlt(-50, t.vert_velo, VERT_VELO_SPACING);
+    d[25] = t.gps_quality;
+    d[26] = t.gps_fix;
+}
+
+// pack_noschema: {width, index into the transform above}, a word per row
+static const unsigned LEGACY_WORDS[5][7][2] = {
+    {{4, 0}, {3, 1}, {1, 2}, {28, 3}, {1, 4}, {27, 5}},
+    {{25, 10}, {20, 6}, {10, 22}, {9, 15}},
+    {{20, 9}, {17, 11}, {15, 7}, {10, 23}, {2, 13}},
+    {{11, 21}, {15, 12}, {15, 24}, {11, 14}, {11, 16}, {1, 26}},
+    {{11, 17}, {11, 18}, {11, 20}, {9, 8}, {11, 19}, {2, 25}},
+};
+
+static void legacy_pack(const unsigned d[27], uint64_t words[5])
+{
+    for (int w = 0; w < 5; w++)
+    {
+        words[w] = 0;
+        unsigned bit_count = 64;
+        for (int f = 0; f < 7 && LEGACY_WORDS[w][f][0]; f++)
+        {
+            bit_count -= LEGACY_WORDS[w][f][0];
+            words[w] = Bitpack_newu(words[w], LEGACY_WORDS[w][f][0], bit_count, d[LEGACY_WORDS[w][f][1]]);
+        }
+    }
+}
+
+// uniform over the in-range readings of every field
+static Telemetry random_telemetry(std::mt19937 &rng)
+{
+    auto uniform = [&rng](float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(rng); };
+    auto integer = [&rng](uint32_t hi) { return std::uniform_int_distribution<uint32_t>(0, hi)(rng); };
+    auto counts = [&](float lo, float hi, float scale) { return static_cast<int16_t>(uniform(lo, hi) / scale); };
+    Telemetry t;
+    t.curr_state = integer(15);
+    t.timestamp = integer((1 << 25) - 1);
+    t.failures = integer(1023);
+    t.gps_fix = integer(1);
+    t.gps_quality = integer(3);
+    t.gps_num_satellites = integer(7);
+    t.gps_antenna_status = integer(3);
+    t.gps_lat = uniform(-90, 90);
+    t.gps_long = uniform(-180, 180);
+    t.gps_speed = uniform(0, 70);
+    t.gps_altitude = uniform(0, 3275);
+    t.external_temp = uniform(-15, 125);
+    t.temperature_engbay = uniform(0, 127);
+    t.temperature_avbay = uniform(0, 127);
+    t.altitude = uniform(0, 3275);
+    t.vert_velo = uniform(-50, 350);
+    t.accel_counts = {counts(0, 19, DLT_ACCEL_SCALE), counts(0, 19, DLT_ACCEL_SCALE),
+                      counts(-30, 39, DLT_ACCEL_SCALE)};
+    t.gyro_counts = {counts(-8.7, 8.7, DLT_GYRO_SCALE), counts(-8.7, 8.7, DLT_GYRO_SCALE),
+                     counts(-8.7, 8.7, DLT_GYRO_SCALE)};
+    t.mag_counts = {counts(-5, 5, DLT_MAG_SCALE), counts(-5, 5, DLT_MAG_SCALE), counts(-5, 5, DLT_MAG_SCALE)};
+    t.accel_x = t.accel_counts.x * DLT_ACCEL_SCALE;
+    t.accel_y = t.accel_counts.y * DLT_ACCEL_SCALE;
+    t.accel_z = t.accel_counts.z * DLT_ACCEL_SCALE;
+    t.gyro_x = t.gyro_counts.x * DLT_GYRO_SCALE;
+    t.gyro_y = t.gyro_counts.y * DLT_GYRO_SCALE;
+    t.gyro_z = t.gyro_counts.z * DLT_GYRO_SCALE;
+    t.mag_x = t.mag_counts.x * DLT_MAG_SCALE;
+    t.mag_y = t.mag_counts.y * DLT_MAG_SCALE;
+    t.mag_z = t.mag_counts.z * DLT_MAG_SCALE;
+    return t;
+}
+
+int main()
+{
+    std::mt19937 rng(40);
+    std::vector<Telemetry> readings;
+    for (int k = 0; k < PACKETS; k++)
+    {
+        readings.push_back(random_telemetry(rng));
+    }
+
+    // the layouts must match bit for bit; the values may differ by one step
+    // where the reciprocal of a spacing rounds a reading across a step
+    int off_by_one = 0, mismatches = 0, saturated = 0;
+    for (const Telemetry &t : readings)
+    {
+        unsigned d[27];
+        uint32_t values[NoSchemaPacket::COUNT], legacy_values[NoSchemaPacket::COUNT];
+        uint64_t legacy[5];
+        legacy_transform(t, d);
+        legacy_pack(d, legacy);
+        dlt_unpack<NoSchemaPacket>(legacy, legacy_values);
+        saturated += dlt_transform<NoSchemaPacket>(t, values) != 0;
+        for (unsigned i = 0; i < NoSchemaPacket::COUNT; i++)
+        {
+            long difference = labs(static_cast<long>(values[i]) - static_cast<long>(legacy_values[i]));
+            off_by_one += difference == 1;
+            mismatches += difference > 1;
+        }
+    }
+    std::printf("%d packets against transform_launchmode + pack_noschema: %d fields one step off, %d further, "
+                "%d saturated\n",
+                PACKETS, off_by_one, mismatches, saturated);
+
+    uint64_t sink = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        for (const Telemetry &t : readings)
+        {
+            unsigned d[27];
+            uint64_t legacy[5];
+            legacy_transform(t, d);
+            legacy_pack(d, legacy);
+            sink += legacy[pass % 5];
+        }
+    }
+    double legacy_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    begin = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        for (const Telemetry &t : readings)
+        {
+            uint32_t values[NoSchemaPacket::COUNT];
+            uint64_t words[DltLayout<NoSchemaPacket>::WORDS];
+            dlt_transform<NoSchemaPacket>(t, values);
+            dlt_pack<NoSchemaPacket>(values, words);
+            sink += words[pass % 5];
+        }
+    }
+    double codec_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    double packets = static_cast<double>(PASSES) * PACKETS;
+    std::printf("  hand-written transform + Bitpack_newu  %7.1f ns/packet\n", legacy_seconds / packets * 1e9);
+    std::printf("  dlt_transform + dlt_pack               %7.1f ns/packet\n", codec_seconds / packets * 1e9);
+    std::printf("  (checksum %llu)\n", static_cast<unsigned long long>(sink));
+    return mismatches != 0 || saturated != 0;
+}
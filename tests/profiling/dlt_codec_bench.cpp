@@ -0,0 +1,272 @@
+/**************************************************************
+ *
+ *                     dlt_codec_bench.cpp
+ *
+ *     Overview: The time per packet of each step of the codecs, for every
+ *                  schema: dlt_transform, dlt_pack, dlt_unpack, dlt_write,
+ *                  dlt_read and dlt_untransform, and the delta frames'
+ *                  encode and decode (dltdelta.h), over the same random
+ *                  readings. Every step is timed once a round, for a few
+ *                  rounds, and keeps its best time: a machine slower for a
+ *                  few seconds (frequency scaling, a busy neighbour) then
+ *                  slows one round of every step rather than every round
+ *                  of a few.
+ *
+ *                  To keep a change to the codecs from slowing them
+ *                  unnoticed, save the timings before it and check against
+ *                  them after, on the same machine and build:
+ *                     ./dlt_codec_bench --save before.txt
+ *                     (the change, rebuilt)
+ *                     ./dlt_codec_bench --check before.txt
+ *                  --check exits 1 if any step is more than 15% slower, or
+ *                  the percentage given after the file. Steps are compared
+ *                  by their time over that of a fixed reference loop timed
+ *                  alongside them, which takes out the speed of the machine
+ *                  on the day.
+ *
+ *                  Host timings only; on the M0 the float transforms are
+ *                  soft-float and dominate.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer dlt_codec_bench.cpp -o dlt_codec_bench
+ *     Run:
+ *        ./dlt_codec_bench [--save file | --check file [percent]]
+ *
+ **************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../carm-electronics/dltdelta.h"
+
+static const int PACKETS = 4096;
+static const int PASSES = 20; // over the packets a step is timed, long enough to time
+static const int ROUNDS = 25;
+
+// results the compiler cannot drop
+static volatile uint64_t sink;
+
+struct Step
+{
+    std::string name;
+    std::function<void()> run; // one pass over the packets
+    double best;
+};
+
+static double time_passes(const std::function<void()> &run)
+{
+    auto begin = std::chrono::steady_clock::now();
+    for (int p = 0; p < PASSES; p++)
+        run();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - begin;
+    return elapsed.count() / PASSES / PACKETS;
+}
+
+// the reference: float and integer work over an array, nothing of the codecs
+static std::vector<float> reference_data(PACKETS * 8, 1.5f);
+
+static void reference_pass()
+{
+    uint32_t h = 49;
+    for (size_t k = 0; k < reference_data.size(); k++)
+    {
+        h = h * 1664525 + 1013904223;
+        reference_data[k] = reference_data[k] * 0.999f + (h >> 24);
+    }
+    sink += h;
+}
+
+// a flight's worth of readings, each within or near its range
+static std::vector<Telemetry> readings()
+{
+    std::mt19937 rng(49);
+    std::uniform_real_distribution<float> unit(0, 1);
+    std::vector<Telemetry> out(PACKETS);
+    for (int k = 0; k < PACKETS; k++)
+    {
+        Telemetry &t = out[k];
+        t = Telemetry();
+        t.curr_state = 4;
+        t.timestamp = 50 * k;
+        t.failures = rng() & 0x3FF;
+        t.gps_fix = 1;
+        t.gps_quality = 2;
+        t.gps_num_satellites = 7;
+        t.gps_antenna_status = 2;
+        t.gps_lat = 42.4f + unit(rng) * 1e-3f;
+        t.gps_long = -71.1f + unit(rng) * 1e-3f;
+        t.gps_speed = 70 * unit(rng);
+        t.gps_altitude = 3000 * unit(rng);
+        t.external_temp = 30 * unit(rng);
+        t.temperature_engbay = 60 * unit(rng);
+        t.temperature_avbay = 60 * unit(rng);
+        t.altitude = 3000 * unit(rng);
+        t.vert_velo = 300 * unit(rng) - 40;
+        RawAxes *axes[3] = {&t.accel_counts, &t.gyro_counts, &t.mag_counts};
+        for (RawAxes *a : axes)
+        {
+            a->x = rng() % 4000;
+            a->y = rng() % 4000;
+            a->z = rng() % 4000;
+        }
+        t.accel_x = t.accel_counts.x * DLT_ACCEL_SCALE;
+        t.accel_y = t.accel_counts.y * DLT_ACCEL_SCALE;
+        t.accel_z = t.accel_counts.z * DLT_ACCEL_SCALE;
+        t.gyro_x = t.gyro_counts.x * DLT_GYRO_SCALE;
+        t.gyro_y = t.gyro_counts.y * DLT_GYRO_SCALE;
+        t.gyro_z = t.gyro_counts.z * DLT_GYRO_SCALE;
+        t.mag_x = t.mag_counts.x * DLT_MAG_SCALE;
+        t.mag_y = t.mag_counts.y * DLT_MAG_SCALE;
+        t.mag_z = t.mag_counts.z * DLT_MAG_SCALE;
+    }
+    return out;
+}
+
+// what the steps of a packet work on, each step's output the next one's input
+template <typename Packet>
+struct Buffers
+{
+    static const unsigned WORDS = DltLayout<Packet>::WORDS, BYTES = DltLayout<Packet>::BYTES;
+    static const unsigned FRAME = DltDeltaLayout<Packet>::MAX_BYTES;
+
+    std::vector<uint32_t> values = std::vector<uint32_t>(PACKETS * Packet::COUNT);
+    std::vector<uint32_t> decoded = std::vector<uint32_t>(PACKETS * Packet::COUNT);
+    std::vector<uint64_t> words = std::vector<uint64_t>(PACKETS * WORDS);
+    std::vector<uint8_t> bytes = std::vector<uint8_t>(PACKETS * BYTES);
+    std::vector<Telemetry> out = std::vector<Telemetry>(PACKETS);
+    // a frame a packet, a keyframe every TELEMETRY_KEYFRAME_PERIOD
+    std::vector<uint8_t> frames = std::vector<uint8_t>(PACKETS * FRAME);
+    std::vector<size_t> sizes = std::vector<size_t>(PACKETS);
+};
+
+template <typename Packet>
+static void add_steps(const char *name, const std::vector<Telemetry> &in, std::vector<Step> &steps)
+{
+    typedef Buffers<Packet> B;
+    std::shared_ptr<B> b = std::make_shared<B>();
+    std::string prefix = std::string(name) + " ";
+    auto add = [&](const char *step, std::function<void()> run) {
+        run(); // the inputs of the next step
+        steps.push_back(Step{prefix + step, run, 1e30});
+    };
+
+    add("transform", [b, &in] {
+        for (int k = 0; k < PACKETS; k++)
+            sink += dlt_transform<Packet>(in[k], &b->values[k * Packet::COUNT]);
+    });
+    add("pack", [b] {
+        for (int k = 0; k < PACKETS; k++)
+            dlt_pack<Packet>(&b->values[k * Packet::COUNT], &b->words[k * B::WORDS]);
+        sink += b->words[PACKETS * B::WORDS - 1];
+    });
+    add("unpack", [b] {
+        for (int k = 0; k < PACKETS; k++)
+            dlt_unpack<Packet>(&b->words[k * B::WORDS], &b->decoded[k * Packet::COUNT]);
+        sink += b->decoded[PACKETS * Packet::COUNT - 1];
+    });
+    add("write", [b] {
+        for (int k = 0; k < PACKETS; k++)
+            dlt_write<Packet>(&b->values[k * Packet::COUNT], &b->bytes[k * B::BYTES]);
+        sink += b->bytes[PACKETS * B::BYTES - 1];
+    });
+    add("read", [b] {
+        for (int k = 0; k < PACKETS; k++)
+            dlt_read<Packet>(&b->bytes[k * B::BYTES], B::BYTES, &b->decoded[k * Packet::COUNT]);
+        sink += b->decoded[PACKETS * Packet::COUNT - 1];
+    });
+    add("untransform", [b] {
+        for (int k = 0; k < PACKETS; k++)
+            dlt_untransform<Packet>(&b->decoded[k * Packet::COUNT], b->out[k]);
+        sink += b->out[PACKETS - 1].curr_state;
+    });
+    add("delta encode", [b] {
+        DltDeltaEncoder<> encoder;
+        for (int k = 0; k < PACKETS; k++)
+            b->sizes[k] = encoder.encode<Packet>(&b->values[k * Packet::COUNT], &b->frames[k * B::FRAME]);
+        sink += b->sizes[PACKETS - 1];
+    });
+    add("delta decode", [b] {
+        DltDeltaDecoder decoder;
+        uint32_t values[DLT_MAX_COUNT];
+        for (int k = 0; k < PACKETS; k++)
+            sink += static_cast<uint8_t>(decoder.decode(&b->frames[k * B::FRAME], b->sizes[k], values));
+    });
+}
+
+static bool load(const char *path, std::map<std::string, double> &baseline)
+{
+    FILE *in = std::fopen(path, "r");
+    if (in == nullptr)
+        return false;
+    char line[128];
+    while (std::fgets(line, sizeof(line), in) != nullptr)
+    {
+        char *tab = std::strchr(line, '\t');
+        if (tab != nullptr)
+            baseline[std::string(line, tab)] = std::atof(tab + 1);
+    }
+    std::fclose(in);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    const char *save = argc >= 3 && std::strcmp(argv[1], "--save") == 0 ? argv[2] : nullptr;
+    const char *check = argc >= 3 && std::strcmp(argv[1], "--check") == 0 ? argv[2] : nullptr;
+    double allowed = argc >= 4 ? std::atof(argv[3]) : 15;
+    std::map<std::string, double> baseline;
+    if (check != nullptr && !load(check, baseline))
+    {
+        std::perror(check);
+        return 2;
+    }
+
+    std::vector<Telemetry> in = readings();
+    std::vector<Step> steps;
+    add_steps<PowerOnPacket>("power_on", in, steps);
+    add_steps<LaunchReadyPacket>("launch_ready", in, steps);
+    add_steps<LaunchModePacket>("launch_mode", in, steps);
+    add_steps<RecoveryPacket>("recovery", in, steps);
+    add_steps<NoSchemaPacket>("no_schema", in, steps);
+
+    Step reference{"reference", reference_pass, 1e30};
+    for (int r = 0; r < ROUNDS; r++)
+    {
+        reference.best = std::min(reference.best, time_passes(reference.run));
+        for (Step &step : steps)
+            step.best = std::min(step.best, time_passes(step.run));
+    }
+
+    int slower = 0;
+    FILE *out = save != nullptr ? std::fopen(save, "w") : nullptr;
+    std::printf("  %-26s %8.1f ns/packet\n", "(reference)", reference.best);
+    for (const Step &step : steps)
+    {
+        double relative = step.best / reference.best;
+        std::printf("  %-26s %8.1f ns/packet", step.name.c_str(), step.best);
+        auto before = baseline.find(step.name);
+        if (before != baseline.end())
+        {
+            double change = 100 * (relative / before->second - 1);
+            bool regressed = change > allowed;
+            slower += regressed;
+            std::printf("  %+6.1f%%%s", change, regressed ? "  SLOWER" : "");
+        }
+        std::printf("\n");
+        if (out != nullptr)
+            std::fprintf(out, "%s\t%.6f\n", step.name.c_str(), relative);
+    }
+    if (out != nullptr)
+        std::fclose(out);
+    if (check != nullptr)
+        std::printf("%d of %zu steps more than %.0f%% slower\n", slower, steps.size(), allowed);
+    return slower > 0 ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+/**************************************************************
+ *
+ *                     dltbatch_bench.cpp
+ *
+ *     Overview: An archive of launch mode frames, as dlt_pack words and
+ *                  as dlt_write bytes, decoded to the readings of every
+ *                  field
+ *                  - a frame at a time, dlt_unpack or dlt_read then
+ *                    dlt_untransform
+ *                  - by dlt_decode_batch (dltbatch.h) to columns, on one
+ *                    thread and on every core
+ *
+ *                  in M frames and MB of archive a second. Build it both
+ *                  ways to compare the AVX2 kernels with the portable ones.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -pthread -I../../carm-electronics/flight-computer dltbatch_bench.cpp -o dltbatch_bench
+ *        g++ -O2 -std=c++11 -pthread -mavx2 -I../../carm-electronics/flight-computer dltbatch_bench.cpp -o dltbatch_bench_avx2
+ *     Run:
+ *        ./dltbatch_bench && ./dltbatch_bench_avx2
+ *
+ **************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../../carm-electronics/ground-decoder/dltbatch.h"
+
+typedef LaunchModePacket Packet;
+
+static const size_t FRAMES = 2000000;
+static const int RUNS = 5;
+
+template <typename Run>
+static double best_seconds(Run run)
+{
+    double best = 1e9;
+    for (int r = 0; r < RUNS; r++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        best = elapsed.count() < best ? elapsed.count() : best;
+    }
+    return best;
+}
+
+static void report(const char *name, double seconds, size_t bytes)
+{
+    std::printf("  %-26s %6.1f M frames/s, %6.0f MB/s\n", name, FRAMES / seconds / 1e6, bytes / seconds / 1e6);
+}
+
+// the archive in each layout, decoded a frame at a time and by the batch
+static void bench(DltFrameLayout layout, const std::vector<uint32_t> &values)
+{
+    bool words = layout == DltFrameLayout::WORDS;
+    size_t stride = words ? DltLayout<Packet>::WORDS * 8 : DltLayout<Packet>::BYTES;
+    std::vector<uint8_t> archive(FRAMES * stride);
+    for (size_t k = 0; k < FRAMES; k++)
+    {
+        if (words)
+        {
+            uint64_t packed[DltLayout<Packet>::WORDS];
+            dlt_pack<Packet>(&values[k * Packet::COUNT], packed);
+            memcpy(&archive[k * stride], packed, stride);
+        }
+        else
+        {
+            dlt_write<Packet>(&values[k * Packet::COUNT], &archive[k * stride]);
+        }
+    }
+    std::printf("%s, %zu bytes a frame:\n", words ? "dlt_pack words" : "dlt_write bytes", stride);
+
+    double sum = 0;
+    std::vector<Telemetry> telemetry(FRAMES);
+    double scalar_s = best_seconds([&] {
+        for (size_t k = 0; k < FRAMES; k++)
+        {
+            uint32_t frame[Packet::COUNT];
+            if (words)
+            {
+                uint64_t packed[DltLayout<Packet>::WORDS];
+                memcpy(packed, &archive[k * stride], stride);
+                dlt_unpack<Packet>(packed, frame);
+            }
+            else
+            {
+                dlt_read<Packet>(&archive[k * stride], stride, frame);
+            }
+            dlt_untransform<Packet>(frame, telemetry[k]);
+        }
+        sum += telemetry[FRAMES - 1].altitude;
+    });
+    report("a frame at a time:", scalar_s, archive.size());
+
+    std::vector<std::vector<uint32_t>> columns(Packet::COUNT, std::vector<uint32_t>(FRAMES));
+    std::vector<std::vector<float>> readings(Packet::COUNT, std::vector<float>(FRAMES));
+    uint32_t *column_ptrs[Packet::COUNT];
+    float *reading_ptrs[Packet::COUNT];
+    for (uint8_t i = 0; i < Packet::COUNT; i++)
+    {
+        column_ptrs[i] = columns[i].data();
+        reading_ptrs[i] = readings[i].data();
+    }
+    unsigned cores = std::thread::hardware_concurrency();
+    cores = cores == 0 ? 1 : cores;
+    for (unsigned threads : {1u, cores})
+    {
+        double batch_s = best_seconds([&] {
+            dlt_decode_batch<Packet>(archive.data(), stride, FRAMES, layout, column_ptrs, reading_ptrs, threads);
+            sum += readings[0][FRAMES - 1];
+        });
+        char name[32];
+        std::snprintf(name, sizeof(name), "batch, %u thread%s:", threads, threads == 1 ? "" : "s");
+        report(name, batch_s, archive.size());
+    }
+    std::printf("  (checksum %.0f)\n", sum);
+}
+
+int main()
+{
+#if defined(__AVX2__)
+    std::printf("AVX2 kernels, %zu frames\n", FRAMES);
+#elif defined(__SSE2__)
+    std::printf("SSE2 kernels, %zu frames\n", FRAMES);
+#else
+    std::printf("portable kernels, %zu frames\n", FRAMES);
+#endif
+    std::mt19937 rng(48);
+    std::vector<uint32_t> values(FRAMES * Packet::COUNT);
+    for (size_t k = 0; k < FRAMES; k++)
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+            values[k * Packet::COUNT + i] = rng() & Bitpack_mask(Packet::fields[i].width);
+
+    bench(DltFrameLayout::WORDS, values);
+    bench(DltFrameLayout::BYTES, values);
+    return 0;
+}
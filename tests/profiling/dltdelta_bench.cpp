@@ -0,0 +1,255 @@
+/**************************************************************
+ *
+ *                     dltdelta_bench.cpp
+ *
+ *     Overview: The launch mode packet over a simulated flight at 20 Hz,
+ *                  sent as keyframes and delta frames (dltdelta.h) against
+ *                  every frame sent whole (dlt_write):
+ *                  - bytes and airtime per frame in each phase, and the
+ *                    frames per second the radio could carry at full duty
+ *                  - the same with several frames to a LoRa packet
+ *                  - with frames lost at random, the share of those
+ *                    received that decode, the rest stale until the next
+ *                    keyframe
+ *                  - the packet picked by flight state as the flight
+ *                    computer does, launch ready on the pad and launch
+ *                    mode after
+ *                  - every channel in every frame against each at its
+ *                    rate (DLT_CHANNEL_RATES): the flight channel's rate
+ *                    in the same airtime
+ *
+ *                  The flight is a rough one: a 3 s boost at 10 g, a
+ *                  coast to apogee, a drogue descent at 25 m/s and a main
+ *                  at 6 m/s, with sensor noise of a few steps, the GPS
+ *                  updating once a second.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer dltdelta_bench.cpp -o dltdelta_bench
+ *     Run:
+ *        ./dltdelta_bench
+ *
+ **************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../../carm-electronics/dltdelta.h"
+
+typedef NoSchemaPacket Packet;
+typedef DltDeltaLayout<Packet> Layout;
+
+static const int RATE_HZ = 20;
+
+// RadioHead's RH_RF95 default modem config, as in bitstream_bench.cpp
+static double airtime_ms(unsigned payload)
+{
+    const double sf = 7, symbol_ms = (1 << 7) / 125.0;
+    double bits = 8.0 * (payload + 4) - 4 * sf + 28 + 16;
+    double symbols = 8 + 4.25 + 8 + (bits > 0 ? std::ceil(bits / (4 * sf)) * 5 : 0);
+    return symbols * symbol_ms;
+}
+
+struct Phase
+{
+    const char *name;
+    int frames;
+};
+
+static std::vector<Telemetry> simulate(std::vector<Phase> &phases)
+{
+    std::mt19937 rng(44);
+    std::normal_distribution<float> noise(0, 1);
+    std::vector<Telemetry> flight;
+    float altitude = 0, velocity = 0, lat = 42.406812f, lon = -71.116153f;
+    const float dt = 1.0f / RATE_HZ;
+    Telemetry gps = {};
+    phases = {{"pad", 10 * RATE_HZ}, {"boost", 3 * RATE_HZ}, {"coast", 0}, {"drogue", 0}, {"main", 0}};
+    for (int k = 0;; k++)
+    {
+        float t = k * dt, accel;
+        int phase;
+        if (k < phases[0].frames)
+            phase = 0, accel = 0;
+        else if (k < phases[0].frames + phases[1].frames)
+            phase = 1, accel = 98;
+        else if (velocity > 0 && (phases[3].frames == 0))
+            phase = 2, accel = -9.8f;
+        else if (altitude > 300)
+            phase = 3, accel = 0, velocity = -25;
+        else if (altitude > 0)
+            phase = 4, accel = 0, velocity = -6;
+        else
+            break;
+        phases[phase].frames += phase >= 2;
+        velocity += accel * dt;
+        altitude += velocity * dt;
+        lat += 2e-6f * (phase > 0);
+        lon -= 1e-6f * (phase > 0);
+
+        Telemetry s = {};
+        s.curr_state = phase + 1;
+        s.timestamp = static_cast<uint32_t>(t * 1000);
+        s.altitude = altitude + 0.3f * noise(rng);
+        s.vert_velo = velocity + 0.05f * noise(rng);
+        s.external_temp = 20 - altitude * 0.0065f + 0.1f * noise(rng);
+        s.temperature_engbay = 30 + 0.05f * noise(rng);
+        s.temperature_avbay = 28 + 0.05f * noise(rng);
+        s.accel_z = accel + 9.8f + 0.2f * noise(rng);
+        s.accel_x = 5 + 0.2f * noise(rng);
+        s.accel_y = 5 + 0.2f * noise(rng);
+        s.gyro_x = 0.5f * noise(rng);
+        s.gyro_y = 0.5f * noise(rng);
+        s.gyro_z = 2 * (phase == 1 || phase == 2) + 0.1f * noise(rng);
+        s.mag_x = 0.2f + 0.05f * noise(rng);
+        s.mag_y = -0.3f + 0.05f * noise(rng);
+        s.mag_z = 0.4f + 0.05f * noise(rng);
+        s.accel_counts = {static_cast<int16_t>(s.accel_x / DLT_ACCEL_SCALE),
+                          static_cast<int16_t>(s.accel_y / DLT_ACCEL_SCALE),
+                          static_cast<int16_t>(s.accel_z / DLT_ACCEL_SCALE)};
+        s.gyro_counts = {static_cast<int16_t>(s.gyro_x / DLT_GYRO_SCALE), static_cast<int16_t>(s.gyro_y / DLT_GYRO_SCALE),
+                         static_cast<int16_t>(s.gyro_z / DLT_GYRO_SCALE)};
+        s.mag_counts = {static_cast<int16_t>(s.mag_x / DLT_MAG_SCALE), static_cast<int16_t>(s.mag_y / DLT_MAG_SCALE),
+                        static_cast<int16_t>(s.mag_z / DLT_MAG_SCALE)};
+        if (k % RATE_HZ == 0)
+        {
+            gps.gps_lat = lat;
+            gps.gps_long = lon;
+            gps.gps_altitude = altitude;
+            gps.gps_speed = std::fabs(velocity) > 70 ? 70 : std::fabs(velocity);
+        }
+        s.gps_lat = gps.gps_lat;
+        s.gps_long = gps.gps_long;
+        s.gps_altitude = gps.gps_altitude;
+        s.gps_speed = gps.gps_speed;
+        s.gps_fix = 1;
+        s.gps_quality = 2;
+        s.gps_num_satellites = 7;
+        s.gps_antenna_status = 2;
+        flight.push_back(s);
+    }
+    return flight;
+}
+
+static std::vector<std::vector<uint8_t>> encode(const std::vector<Telemetry> &flight, DltDeltaEncoder<> &encoder)
+{
+    std::vector<std::vector<uint8_t>> frames;
+    for (const Telemetry &t : flight)
+    {
+        uint32_t values[Packet::COUNT];
+        uint8_t bytes[Layout::MAX_BYTES];
+        dlt_transform<Packet>(t, values);
+        size_t size = encoder.encode<Packet>(values, bytes);
+        frames.push_back(std::vector<uint8_t>(bytes, bytes + size));
+    }
+    return frames;
+}
+
+// airtime of the frames sent per_packet to a LoRa packet
+static double packets_ms(const std::vector<std::vector<uint8_t>> &frames, size_t per_packet)
+{
+    double ms = 0;
+    for (size_t k = 0; k < frames.size(); k += per_packet)
+    {
+        size_t bytes = 0;
+        for (size_t j = k; j < k + per_packet && j < frames.size(); j++)
+            bytes += frames[j].size();
+        ms += airtime_ms(bytes);
+    }
+    return ms;
+}
+
+int main()
+{
+    std::vector<Phase> phases;
+    std::vector<Telemetry> flight = simulate(phases);
+
+    DltDeltaEncoder<> encoder;
+    std::vector<std::vector<uint8_t>> frames = encode(flight, encoder);
+
+    double whole_ms = airtime_ms(DltLayout<Packet>::BYTES);
+    std::printf("launch mode packet, %zu frames at %d Hz; whole: %u bytes, %.1f ms, %.0f frames/s\n", flight.size(),
+                RATE_HZ, DltLayout<Packet>::BYTES, whole_ms, 1000 / whole_ms);
+    size_t first = 0;
+    double total_bytes = 0, total_ms = 0;
+    for (const Phase &phase : phases)
+    {
+        double bytes = 0, ms = 0;
+        for (size_t k = first; k < first + phase.frames; k++)
+        {
+            bytes += frames[k].size();
+            ms += airtime_ms(frames[k].size());
+        }
+        std::printf("  %-7s %5d frames  key+delta %5.1f bytes %5.1f ms  %5.0f frames/s\n", phase.name, phase.frames,
+                    bytes / phase.frames, ms / phase.frames, 1000 * phase.frames / ms);
+        total_bytes += bytes;
+        total_ms += ms;
+        first += phase.frames;
+    }
+    std::printf("  %-7s %5zu frames  key+delta %5.1f bytes %5.1f ms  %5.0f frames/s\n", "flight", frames.size(),
+                total_bytes / frames.size(), total_ms / frames.size(), 1000 * frames.size() / total_ms);
+
+    for (size_t per_packet : {1, 2, 4, 8})
+    {
+        double ms = packets_ms(frames, per_packet);
+        std::printf("  %zu frames to a packet: %5.1f ms a frame, %4.0f frames/s (whole: %4.0f frames/s)\n", per_packet,
+                    ms / frames.size(), 1000 * frames.size() / ms,
+                    1000 * per_packet / airtime_ms(per_packet * DltLayout<Packet>::BYTES));
+    }
+
+    DltDeltaEncoder<> by_state;
+    double state_bytes = 0, state_ms = 0;
+    for (size_t k = 0; k < flight.size(); k++)
+    {
+        uint32_t values[DLT_MAX_COUNT];
+        uint8_t bytes[DLT_MAX_FRAME_BYTES];
+        size_t size;
+        if (k < static_cast<size_t>(phases[0].frames))
+        {
+            dlt_transform<LaunchReadyPacket>(flight[k], values);
+            size = by_state.encode<LaunchReadyPacket>(values, bytes);
+        }
+        else
+        {
+            dlt_transform<LaunchModePacket>(flight[k], values);
+            size = by_state.encode<LaunchModePacket>(values, bytes);
+        }
+        state_bytes += size;
+        state_ms += airtime_ms(size);
+    }
+    std::printf("  by state:  %5.1f bytes %5.1f ms a frame, %4.0f frames/s\n", state_bytes / flight.size(),
+                state_ms / flight.size(), 1000 * flight.size() / state_ms);
+
+    const DltChannelRate every_frame[DLT_CHANNELS] = {{1, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 0}};
+    DltDeltaEncoder<> every_encoder(0, every_frame);
+    std::vector<std::vector<uint8_t>> every = encode(flight, every_encoder);
+    double every_bytes = 0;
+    for (const std::vector<uint8_t> &frame : every)
+        every_bytes += frame.size();
+    double every_ms = packets_ms(every, TELEMETRY_FRAMES_PER_PACKET);
+    double rated_ms = packets_ms(frames, TELEMETRY_FRAMES_PER_PACKET);
+    std::printf("  %d frames to a packet, every channel in every frame: %5.1f bytes a frame, flight channel %4.0f Hz\n",
+                TELEMETRY_FRAMES_PER_PACKET, every_bytes / every.size(), 1000 * every.size() / every_ms);
+    std::printf("  %d frames to a packet, each channel at its rate:     %5.1f bytes a frame, flight channel %4.0f Hz\n",
+                TELEMETRY_FRAMES_PER_PACKET, total_bytes / frames.size(), 1000 * frames.size() / rated_ms);
+
+    for (double loss : {0.01, 0.1, 0.3})
+    {
+        std::mt19937 rng(45);
+        std::bernoulli_distribution lost(loss);
+        DltDeltaDecoder decoder;
+        int received = 0, decoded = 0;
+        for (const std::vector<uint8_t> &frame : frames)
+        {
+            if (lost(rng))
+                continue;
+            uint32_t values[DLT_MAX_COUNT];
+            received++;
+            decoded += decoder.decode(frame.data(), frame.size(), values) == DltDecoded::VALUES;
+        }
+        std::printf("  %2.0f%% lost: %5.1f%% of the frames received decode, %u counted lost\n", loss * 100,
+                    100.0 * decoded / received, decoder.lost());
+    }
+    return 0;
+}
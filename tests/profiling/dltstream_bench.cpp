@@ -0,0 +1,134 @@
+/**************************************************************
+ *
+ *                     dltstream_bench.cpp
+ *
+ *     Overview: How fast the ground decoder goes through a log: a flight
+ *                  of launch mode frames, a keyframe every 20, four to a
+ *                  packet, as the ground station logs them (dltstream.h),
+ *                  decoded
+ *                  - by DltStream to a record a frame
+ *                  - through the C interface (dltdecode.h) to rows of
+ *                    doubles, as the CLI and the Python binding read them
+ *
+ *                  in MB of log a second. The log is written out as
+ *                  dltstream_bench.log for timing the CLI on.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer dltstream_bench.cpp ../../carm-electronics/ground-decoder/dltdecode.cpp -o dltstream_bench
+ *     Run:
+ *        ./dltstream_bench
+ *
+ **************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../../carm-electronics/dltstream.h"
+#include "../../carm-electronics/ground-decoder/dltdecode.h"
+
+typedef LaunchModePacket Packet;
+
+static const int FRAMES = 1000000;
+static const int FRAMES_PER_PACKET = 4;
+static const int RUNS = 5;
+
+static std::vector<uint8_t> flight_log()
+{
+    std::mt19937 rng(47);
+    std::normal_distribution<float> noise(0, 1);
+    DltDeltaEncoder<> encoder;
+    std::vector<uint8_t> log, packet;
+    Telemetry t = {};
+    t.curr_state = 4;
+    t.gps_lat = 42.4f;
+    t.gps_long = -71.1f;
+    for (int k = 0; k < FRAMES; k++)
+    {
+        t.timestamp = 50 * k;
+        t.altitude = 1000 + 500 * std::sin(k * 1e-4f) + 0.3f * noise(rng);
+        t.vert_velo = 30 + 0.05f * noise(rng);
+        t.external_temp = 15 + 0.1f * noise(rng);
+        t.accel_z = 9.8f + 0.2f * noise(rng);
+        t.gyro_x = 0.5f * noise(rng);
+        t.gyro_y = 0.5f * noise(rng);
+        t.gyro_z = 0.1f * noise(rng);
+        uint32_t values[Packet::COUNT];
+        uint8_t bytes[DltDeltaLayout<Packet>::MAX_BYTES];
+        dlt_transform<Packet>(t, values);
+        size_t size = encoder.encode<Packet>(values, bytes);
+        packet.insert(packet.end(), bytes, bytes + size);
+        if ((k + 1) % FRAMES_PER_PACKET == 0)
+        {
+            uint8_t header[2];
+            log.insert(log.end(), header, header + dlt_log_header(packet.size(), header));
+            log.insert(log.end(), packet.begin(), packet.end());
+            packet.clear();
+        }
+    }
+    return log;
+}
+
+struct Count
+{
+    uint64_t frames = 0;
+    double sum = 0;
+    void operator()(const DltRecord &record)
+    {
+        frames++;
+        sum += record.telemetry.altitude;
+    }
+};
+
+template <typename Run>
+static double best_seconds(Run run)
+{
+    double best = 1e9;
+    for (int r = 0; r < RUNS; r++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        best = elapsed.count() < best ? elapsed.count() : best;
+    }
+    return best;
+}
+
+int main()
+{
+    std::vector<uint8_t> log = flight_log();
+    double mb = log.size() / 1e6;
+    std::printf("%d frames, %.1f MB of log, %.1f bytes a frame\n", FRAMES, mb, (double)log.size() / FRAMES);
+
+    Count count;
+    double stream_s = best_seconds([&] {
+        DltStream stream;
+        stream.push(log.data(), log.size(), count);
+    });
+    std::printf("  DltStream to records:   %6.0f MB/s, %5.1f M frames/s\n", mb / stream_s, FRAMES / stream_s / 1e6);
+
+    std::vector<dlt_row> rows(4096);
+    uint64_t read = 0;
+    double rows_s = best_seconds([&] {
+        dlt_decoder *decoder = dlt_decoder_new();
+        for (size_t k = 0; k < log.size(); k += 1 << 16)
+        {
+            dlt_decoder_push(decoder, log.data() + k, std::min<size_t>(1 << 16, log.size() - k));
+            size_t n;
+            while ((n = dlt_decoder_read(decoder, rows.data(), rows.size())) > 0)
+                read += n;
+        }
+        dlt_decoder_free(decoder);
+    });
+    std::printf("  dltdecode.h to rows:    %6.0f MB/s, %5.1f M frames/s\n", mb / rows_s, FRAMES / rows_s / 1e6);
+    std::printf("  (checksum %.0f, %llu)\n", count.sum, (unsigned long long)read);
+
+    FILE *out = std::fopen("dltstream_bench.log", "wb");
+    if (out != nullptr)
+    {
+        std::fwrite(log.data(), 1, log.size(), out);
+        std::fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,261 @@
+/**************************************************************
+ *
+ *                     fec_bench.cpp
+ *
+ *     Overview: A channel simulator for the telemetry downlink: a flight's
+ *                  launch mode frames, four to a packet as the flight
+ *                  computer sends them, through a channel that flips each
+ *                  bit on the air independently at a given bit error rate,
+ *                  to a ground station decoding as ground_station.ino does.
+ *                  For each rate and Reed-Solomon parity (fec.h):
+ *                  - the share of the samples sent that the ground decodes
+ *                    to the values sent
+ *                  - those samples per second of airtime, the measure that
+ *                    pays for the parity's bytes
+ *                  - samples decoded to the wrong values, and of those the
+ *                    ones in a packet corrected to the wrong codeword; the
+ *                    rest would be deltas taken for those of an older
+ *                    keyframe with the same 5-bit sequence number, after a
+ *                    run of lost packets. A sample is a frame, right if
+ *                    every field it carries is
+ *
+ *                  Without parity a packet goes under the radio's CRC and a
+ *                  bit in error anywhere, the RadioHead header included,
+ *                  loses it. With parity the header is not checked
+ *                  (promiscuous) and the packet is lost only with more
+ *                  bytes in error than the parity corrects. Deltas after a
+ *                  lost keyframe are lost too, until the keyframe the
+ *                  ground station asks for; the request is taken to
+ *                  arrive. The LoRa PHY header is left out, its own CRC
+ *                  loses the packet either way.
+ *
+ *                  Independent bit errors are the hard case for a code
+ *                  correcting bytes: a burst within a byte costs one
+ *                  correction.
+ *
+ *                  Also the host time to correct a packet at the most
+ *                  errors its parity corrects.
+ *
+ *     Build (from this directory):
+ *        g++ -O2 -std=c++11 -I../../carm-electronics/flight-computer fec_bench.cpp -o fec_bench
+ *     Run:
+ *        ./fec_bench
+ *
+ **************************************************************/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../../carm-electronics/dltdelta.h"
+#include "../../carm-electronics/fec.h"
+
+typedef LaunchModePacket Packet;
+
+static const int RATE_HZ = 20;
+static const int FRAMES = 60 * RATE_HZ;
+static const int FLIGHTS = 10;
+static const int FRAMES_PER_PACKET = 4;  // TELEMETRY_FRAMES_PER_PACKET
+static const size_t MAX_MESSAGE_LEN = 251; // RH_RF95_MAX_MESSAGE_LEN
+static const size_t RADIOHEAD_HEADER = 4;
+
+// RadioHead's RH_RF95 default modem config, as in bitstream_bench.cpp, the
+// 16-bit payload CRC only when it is sent
+static double airtime_ms(unsigned payload, bool crc)
+{
+    const double sf = 7, symbol_ms = (1 << 7) / 125.0;
+    double bits = 8.0 * (payload + RADIOHEAD_HEADER) - 4 * sf + 28 + (crc ? 16 : 0);
+    double symbols = 8 + 4.25 + 8 + (bits > 0 ? std::ceil(bits / (4 * sf)) * 5 : 0);
+    return symbols * symbol_ms;
+}
+
+// a minute of flight at RATE_HZ: climbing, the IMU noisy by a few steps
+static std::vector<Telemetry> simulate(std::mt19937 &rng)
+{
+    std::normal_distribution<float> noise(0, 1);
+    std::vector<Telemetry> flight(FRAMES);
+    for (int k = 0; k < FRAMES; k++)
+    {
+        Telemetry &s = flight[k];
+        s = Telemetry();
+        float t = float(k) / RATE_HZ;
+        s.curr_state = 4;
+        s.timestamp = static_cast<uint32_t>(t * 1000);
+        s.altitude = 150 * t - 2 * t * t + 0.3f * noise(rng);
+        s.vert_velo = 150 - 4 * t + 0.05f * noise(rng);
+        s.external_temp = 20 - s.altitude * 0.0065f + 0.1f * noise(rng);
+        s.temperature_engbay = 30 + 0.05f * noise(rng);
+        s.temperature_avbay = 28 + 0.05f * noise(rng);
+        s.accel_counts = {static_cast<int16_t>(300 + 20 * noise(rng)), static_cast<int16_t>(300 + 20 * noise(rng)),
+                          static_cast<int16_t>(2000 + 40 * noise(rng))};
+        s.gyro_counts = {static_cast<int16_t>(30 * noise(rng)), static_cast<int16_t>(30 * noise(rng)),
+                         static_cast<int16_t>(120 + 10 * noise(rng))};
+        s.mag_counts = {static_cast<int16_t>(1200 + 30 * noise(rng)), static_cast<int16_t>(-1800 + 30 * noise(rng)),
+                        static_cast<int16_t>(2400 + 30 * noise(rng))};
+        int second = k / RATE_HZ;
+        s.gps_lat = 42.406812f + 2e-5f * second;
+        s.gps_long = -71.116153f - 1e-5f * second;
+        s.gps_altitude = 140.0f * second;
+        s.gps_speed = 70;
+        s.gps_fix = 1;
+        s.gps_quality = 2;
+        s.gps_num_satellites = 7;
+        s.gps_antenna_status = 2;
+    }
+    return flight;
+}
+
+struct Result
+{
+    uint64_t sent = 0, good = 0, wrong = 0, miscorrected = 0;
+    double airtime_ms = 0;
+};
+
+// flips each bit of bytes[size] at the rate; returns whether any was
+static bool flip(uint8_t bytes[], size_t size, double ber, std::mt19937 &rng)
+{
+    if (ber <= 0)
+        return false;
+    std::geometric_distribution<long> gap(ber);
+    bool flipped = false;
+    for (size_t bit = gap(rng); bit < 8 * size; bit += 1 + gap(rng))
+    {
+        bytes[bit / 8] ^= 1 << (bit % 8);
+        flipped = true;
+    }
+    return flipped;
+}
+
+static Result run(const std::vector<std::vector<Telemetry>> &flights, uint8_t parity, double ber, std::mt19937 &rng)
+{
+    Result result;
+    FecEncoder fec;
+    for (const std::vector<Telemetry> &flight : flights)
+    {
+        DltDeltaEncoder<> encoder;
+        DltDeltaDecoder decoder;
+        for (size_t first = 0; first < flight.size(); first += FRAMES_PER_PACKET)
+        {
+            // the packet, and the values of each frame in it
+            uint8_t air[RADIOHEAD_HEADER + MAX_MESSAGE_LEN] = {};
+            uint8_t *packet = air + RADIOHEAD_HEADER;
+            std::vector<std::vector<uint32_t>> sent;
+            size_t size = 0;
+            for (size_t k = first; k < first + FRAMES_PER_PACKET && k < flight.size(); k++)
+            {
+                sent.push_back(std::vector<uint32_t>(Packet::COUNT));
+                dlt_transform<Packet>(flight[k], sent.back().data());
+                size += encoder.encode<Packet>(sent.back().data(), packet + size);
+            }
+            size = fec.encode(packet, size, MAX_MESSAGE_LEN, parity);
+            result.sent += sent.size();
+            result.airtime_ms += airtime_ms(size, parity == 0);
+
+            // the channel, then the radio and the ground station
+            bool flipped = flip(air, RADIOHEAD_HEADER + size, ber, rng);
+            if (parity == 0 && flipped)
+                continue;
+            int corrected = fec_decode(packet, size);
+            if (corrected < 0)
+                continue;
+            size_t offset = 0, used, frame = 0;
+            uint32_t values[DLT_MAX_COUNT];
+            DltDecoded decoded;
+            bool stale = false;
+            while (offset < size && (decoded = decoder.decode(packet + offset, size - offset, values, used)) !=
+                                        DltDecoded::MALFORMED)
+            {
+                // a stale delta's size is unknown, the rest of the packet with it
+                if (decoded == DltDecoded::STALE)
+                {
+                    stale = true;
+                    break;
+                }
+                offset += used;
+                if (decoded == DltDecoded::VALUES && frame < sent.size())
+                {
+                    // the fields the frame carries, the decoder holds the rest
+                    bool same = true;
+                    for (uint8_t i = 0; i < Packet::COUNT; i++)
+                        same &= !(decoder.fresh() >> i & 1) || values[i] == sent[frame][i];
+                    result.good += same;
+                    result.wrong += !same;
+                    result.miscorrected += !same && corrected > 0;
+                }
+                frame++;
+            }
+            if (stale)
+                encoder.requestKeyframe();
+        }
+    }
+    return result;
+}
+
+// the host time to correct a packet of the launch mode size with parity / 2 bytes in error
+static double correct_us(uint8_t parity, std::mt19937 &rng)
+{
+    const int PACKETS = 2000;
+    FecEncoder fec;
+    uint8_t clean[MAX_MESSAGE_LEN];
+    for (uint8_t &b : clean)
+        b = 0x80 | (rng() & 0x7F);
+    size_t coded = fec.encode(clean, 60, sizeof(clean), parity);
+    std::vector<std::vector<uint8_t>> packets(PACKETS, std::vector<uint8_t>(clean, clean + coded));
+    for (std::vector<uint8_t> &p : packets)
+        for (int e = 0; e < parity / 2; e++)
+            p[FEC_MARKER_COPIES + rng() % (coded - FEC_MARKER_COPIES)] ^= 1 + rng() % 255;
+    auto begin = std::chrono::steady_clock::now();
+    int failed = 0;
+    for (std::vector<uint8_t> &p : packets)
+    {
+        size_t size = p.size();
+        failed += fec_decode(p.data(), size) < 0;
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - begin;
+    if (failed > 0)
+        std::printf("  (%d of %d packets not corrected)\n", failed, PACKETS);
+    return elapsed.count() / PACKETS;
+}
+
+int main()
+{
+    std::mt19937 rng(50);
+    std::vector<std::vector<Telemetry>> flights;
+    for (int f = 0; f < FLIGHTS; f++)
+        flights.push_back(simulate(rng));
+
+    const uint8_t parities[] = {0, 8, 16, 32};
+    const double bers[] = {0, 1e-5, 1e-4, 3e-4, 1e-3, 2e-3, 5e-3, 1e-2};
+    std::printf("launch mode frames, %d to a packet, %d s of flight at %d Hz\n", FRAMES_PER_PACKET,
+                FLIGHTS * FRAMES / RATE_HZ, RATE_HZ);
+    std::printf("  %-8s", "BER");
+    for (uint8_t parity : parities)
+        std::printf("  %s%-2u   received  samples/s", parity == 0 ? "CRC " : "RS ", parity);
+    std::printf("\n");
+    Result total[sizeof(parities)];
+    for (double ber : bers)
+    {
+        std::printf("  %-8.0e", ber);
+        for (size_t p = 0; p < sizeof(parities); p++)
+        {
+            Result r = run(flights, parities[p], ber, rng);
+            total[p].wrong += r.wrong;
+            total[p].miscorrected += r.miscorrected;
+            std::printf("        %7.2f%%  %9.1f", 100.0 * r.good / r.sent, 1000 * r.good / r.airtime_ms);
+        }
+        std::printf("\n");
+    }
+    std::printf("  samples decoded wrong (miscorrected), over every rate:");
+    for (size_t p = 0; p < sizeof(parities); p++)
+        std::printf("  %s%u %llu (%llu)", parities[p] == 0 ? "CRC " : "RS ", parities[p],
+                    static_cast<unsigned long long>(total[p].wrong),
+                    static_cast<unsigned long long>(total[p].miscorrected));
+    std::printf("\n");
+
+    std::printf("host time to correct a 60-byte packet at the most errors:\n");
+    for (uint8_t parity : {8, 16, 32})
+        std::printf("  RS %-2u %6.2f us\n", parity, correct_us(parity, rng));
+    return 0;
+}
@@ -0,0 +1,49 @@
+/**************************************************************
+ *
+ *                     flightclock_vs_micros.ino
+ *
+ *     Overview: Uses Profiler library to check what the 64-bit
+ *                FlightClock (flight-computer/flightclock.h) costs on top of
+ *                the micros() call it extends, since every sample, transition
+ *                and pyro tick now reads it
+ *
+ *                The sketch builds the clock from its source directly, the
+ *                Arduino IDE only compiles the files next to the sketch
+ *
+ **************************************************************/
+
+#include <Profiler.h>
+#include "../../carm-electronics/flight-computer/flightclock.cpp"
+
+void prof_micros()
+{
+    profiler_t profiler;
+    for (int i = 0; i < 100000000; i++)
+    {
+        volatile unsigned micro = micros();
+    }
+}
+
+void prof_flightclock()
+{
+    profiler_t profiler;
+    for (int i = 0; i < 100000000; i++)
+    {
+        volatile uint64_t micro = flight_clock.now();
+    }
+}
+
+void setup()
+{
+    Serial.begin(115200);
+    while (!Serial)
+        ;
+
+    Serial.println("Performing micros profiling...");
+    prof_micros();
+
+    Serial.println("Performing FlightClock profiling...");
+    prof_flightclock();
+}
+
+void loop() {}
@@ -1,29 +1,348 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
-#include <iostream>
+#include <cfloat>
+#include <cmath>
+#include <inttypes.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
 using namespace std;
 
-const float EXT_TEMP_SPACING = 0.0683927699072;
-const float INT_TEMP_SPACING = 0.0620420127015;
-const float ALTITUDE_SPACING = 0.0999481185339;
-const float VERT_VELO_SPACING = 0.0122074037904;
-const float ACCEL_Z_SPACING = 0.0635075720567;
-const float ACCEL_XY_SPACING = 0.0489236790607;
-const float MAG_FORCE_SPACING = 0.0195694716243;
-const float GYRO_XY_SPACING = 0.0027465846506;
-const float GYRO_Z_SPACING = 0.00549320597234;
-const float GPS_SPEED_SPACING = 0.0999481185339;
+// g++ -std=c++11 -I../../carm-electronics/flight-computer DLT_test.cpp
+#include "../../carm-electronics/dlt.h"
 
-unsigned int serialize_dlt(unsigned int bit_count, int n_min, int n_max, float reading, float m_spacing)
+// Every field of every packet is swept across its range, its edges and past
+// them, each reading through dlt_transform, dlt_pack and dlt_unpack,
+// dlt_write and dlt_read, and dlt_untransform. A sweep counts its failures
+// and checks once, the first failure in the message, so the results file
+// stays readable.
+
+// the points of a sweep over a range of steps: every step of a narrow field,
+// evenly spaced ones of a wide one
+static const uint32_t SWEEP_POINTS = 4096;
+
+struct Failures
+{
+    unsigned count = 0;
+    string first;
+
+    void add(const DltField &f, uint8_t i, double in, double out, const char *what)
+    {
+        if (count++ == 0)
+        {
+            ostringstream message;
+            message.precision(9);
+            message << "field " << int(i) << " (width " << int(f.width) << "), " << what << ": in " << in
+                    << ", out " << out;
+            first = message.str();
+        }
+    }
+};
+
+// the same member of Telemetry, a SIGN field and its MICRO field share one
+bool same_member(const DltField &a, const DltField &b)
+{
+    return a.kind == DltKind::RAW || b.kind == DltKind::RAW ? a.value == b.value
+           : a.kind == DltKind::IMU && b.kind == DltKind::IMU
+               ? a.counts == b.counts && a.axis == b.axis
+               : a.reading == b.reading;
+}
+
+// t through the packet and back; values in DLT space, the saturation mask
+// and what the ground decodes, with the fields other than i checked
+// untouched against base
+template <typename Packet>
+uint32_t round_trip(const Telemetry &t, uint8_t i, const uint32_t base[], Telemetry &out, uint32_t values[],
+                    Failures &failures)
+{
+    const DltField &f = Packet::fields[i];
+    uint32_t saturated = dlt_transform<Packet>(t, values);
+
+    uint64_t words[DltLayout<Packet>::WORDS];
+    uint8_t bytes[DltLayout<Packet>::BYTES] = {};
+    uint32_t unpacked[Packet::COUNT], read[Packet::COUNT];
+    dlt_pack<Packet>(values, words);
+    dlt_unpack<Packet>(words, unpacked);
+    dlt_write<Packet>(values, bytes);
+    dlt_read<Packet>(bytes, sizeof(bytes), read);
+    for (uint8_t j = 0; j < Packet::COUNT; j++)
+    {
+        if (values[j] > Bitpack_mask(Packet::fields[j].width))
+            failures.add(f, j, values[j], 0, "wider than its field");
+        if (unpacked[j] != values[j])
+            failures.add(f, j, values[j], unpacked[j], "dlt_unpack");
+        if (read[j] != values[j])
+            failures.add(f, j, values[j], read[j], "dlt_read");
+        if (!same_member(Packet::fields[j], f) && values[j] != base[j])
+            failures.add(f, j, base[j], values[j], "a neighbour changed");
+    }
+    out = Telemetry();
+    dlt_untransform<Packet>(unpacked, out);
+    return saturated;
+}
+
+// the smallest and largest reading a LINEAR or IMU field decodes to
+float lowest(const DltField &f)
+{
+    return deserialize_dlt(0, f.n_min, f.spacing);
+}
+
+float highest(const DltField &f)
+{
+    return deserialize_dlt(f.quantizer.max, f.n_min, f.spacing);
+}
+
+// a decoded reading within one step below in, in clamped to the field's
+// range, allowing for the rounding of a float the size of the range
+bool within_step(const DltField &f, float in, float out)
+{
+    float clamped = in < lowest(f) ? lowest(f) : in > highest(f) ? highest(f) : in;
+    float slack = 1e-3f * f.spacing + 4 * FLT_EPSILON * (fabsf(lowest(f)) + fabsf(highest(f)));
+    return clamped - out >= -slack && clamped - out <= f.spacing + slack;
+}
+
+// saturation is checked half a step away from either end, where rounding
+// cannot decide it
+bool clearly_inside(const DltField &f, float in)
+{
+    return in >= lowest(f) + f.spacing / 2 && in <= highest(f) + f.spacing / 2;
+}
+
+bool clearly_outside(const DltField &f, float in)
+{
+    return !(in >= lowest(f) - f.spacing / 2 && in <= highest(f) + 1.5f * f.spacing);
+}
+
+template <typename Packet>
+void sweep_raw(uint8_t i, const Telemetry &base_t, const uint32_t base[], Failures &failures)
+{
+    const DltField &f = Packet::fields[i];
+    uint32_t max = f.quantizer.max;
+    vector<uint64_t> ins = {0, 1, max / 2, max - 1, max, uint64_t(max) + 1, UINT32_MAX};
+    uint32_t stride = max / SWEEP_POINTS + 1;
+    for (uint64_t v = 0; v <= max; v += stride)
+        ins.push_back(v);
+
+    for (uint64_t v : ins)
+    {
+        if (v > UINT32_MAX)
+            continue;
+        Telemetry t = base_t, out;
+        uint32_t values[Packet::COUNT];
+        t.*f.value = v;
+        bool saturated = round_trip<Packet>(t, i, base, out, values, failures) >> i & 1;
+        if (saturated != (v > max))
+            failures.add(f, i, v, saturated, "saturation");
+        if (out.*f.value != (v > max ? max : v))
+            failures.add(f, i, v, out.*f.value, "decoded");
+    }
+}
+
+template <typename Packet>
+void check_linear(uint8_t i, const Telemetry &t, float in, const uint32_t base[], Failures &failures)
+{
+    const DltField &f = Packet::fields[i];
+    Telemetry out;
+    uint32_t values[Packet::COUNT];
+    bool saturated = round_trip<Packet>(t, i, base, out, values, failures) >> i & 1;
+    if (std::isnan(in))
+    {
+        if (!saturated || values[i] != 0)
+            failures.add(f, i, in, values[i], "NaN");
+        return;
+    }
+    if ((clearly_inside(f, in) && saturated) || (clearly_outside(f, in) && !saturated))
+        failures.add(f, i, in, saturated, "saturation");
+    if (!within_step(f, in, out.*f.reading))
+        failures.add(f, i, in, out.*f.reading, "decoded");
+}
+
+// the edges of a reading's range, past them, and the middle of its steps
+vector<float> linear_readings(const DltField &f)
 {
-    unsigned int serialized_data = floor((reading - n_min) / m_spacing);
-    return serialized_data;
+    vector<float> ins = {lowest(f), highest(f), float(f.n_min), float(f.n_max), lowest(f) - f.spacing,
+                         lowest(f) - f.spacing / 4, highest(f) + f.spacing * 0.999f, highest(f) + 2 * f.spacing,
+                         -1e30f, 1e30f, -INFINITY, INFINITY, NAN, 0, -0.0f};
+    uint32_t stride = f.quantizer.max / SWEEP_POINTS + 1;
+    for (uint32_t step = 0; step <= f.quantizer.max; step += stride)
+    {
+        ins.push_back(deserialize_dlt(step, f.n_min, f.spacing));
+        ins.push_back(f.n_min + (step + 0.5f) * f.spacing);
+    }
+    return ins;
+}
+
+template <typename Packet>
+void sweep_linear(uint8_t i, const Telemetry &base_t, const uint32_t base[], Failures &failures)
+{
+    const DltField &f = Packet::fields[i];
+    for (float in : linear_readings(f))
+    {
+        Telemetry t = base_t;
+        t.*f.reading = in;
+        check_linear<Packet>(i, t, in, base, failures);
+    }
+}
+
+// with IMU_RAW_COUNTS the counts are transformed, the reading only compared
+template <typename Packet>
+void sweep_imu(uint8_t i, const Telemetry &base_t, const uint32_t base[], Failures &failures)
+{
+    const DltField &f = Packet::fields[i];
+#if IMU_RAW_COUNTS
+    vector<int32_t> counts = {INT16_MIN, -1, 0, 1, INT16_MAX};
+    for (int32_t c = INT16_MIN; c <= INT16_MAX; c += 65536 / SWEEP_POINTS)
+        counts.push_back(c);
+    // about the ends of the range
+    for (float end : {lowest(f), highest(f), highest(f) + f.spacing})
+    {
+        long c = lroundf(end / f.count_scale);
+        for (long d = c - 2; d <= c + 2; d++)
+            if (d >= INT16_MIN && d <= INT16_MAX)
+                counts.push_back(d);
+    }
+    for (int32_t c : counts)
+    {
+        Telemetry t = base_t;
+        (t.*f.counts).*f.axis = c;
+        t.*f.reading = c * f.count_scale;
+        check_linear<Packet>(i, t, t.*f.reading, base, failures);
+    }
+#else
+    sweep_linear<Packet>(i, base_t, base, failures);
+#endif
+}
+
+// a SIGN field and the MICRO field after it, the one reading
+template <typename Packet>
+void sweep_micro(uint8_t i, const Telemetry &base_t, const uint32_t base[], Failures &failures)
+{
+    const DltField &f = Packet::fields[i];
+    vector<float> ins = {0, -0.0f, 1e-6f, -1e-6f, 4e-7f, float(f.n_max), -float(f.n_max), f.n_max + 1.0f,
+                         -f.n_max - 1.0f, 1e30f, -INFINITY, NAN};
+    for (uint32_t k = 0; k <= SWEEP_POINTS; k++)
+    {
+        float magnitude = f.n_max * float(k) / SWEEP_POINTS;
+        ins.push_back(magnitude);
+        ins.push_back(-magnitude);
+    }
+
+    for (float in : ins)
+    {
+        Telemetry t = base_t, out;
+        uint32_t values[Packet::COUNT];
+        t.*f.reading = in;
+        bool saturated = round_trip<Packet>(t, i, base, out, values, failures) >> i & 1;
+        float magnitude = std::isnan(in) ? 0 : fabsf(in) > f.n_max ? f.n_max : fabsf(in);
+        if (std::isnan(in) || fabsf(in) > f.n_max + 1e-4f)
+        {
+            if (!saturated)
+                failures.add(f, i, in, saturated, "saturation");
+        }
+        else if (saturated && fabsf(in) < f.n_max - 1e-4f)
+        {
+            failures.add(f, i, in, saturated, "saturation");
+        }
+        float decoded = out.*f.reading;
+        if (fabsf(fabsf(decoded) - magnitude) > 1e-6f + 4 * FLT_EPSILON * magnitude)
+            failures.add(f, i, in, decoded, "decoded");
+        if (values[i] != 0 && (decoded > 0) != (in > 0))
+            failures.add(f, i, in, decoded, "sign");
+    }
 }
 
-float deserialize_dlt(unsigned int serialized, int n_min, float m_spacing)
+// a reading in the middle of its range for every field of the packet
+template <typename Packet>
+Telemetry middle()
 {
-    float deserialized_data = (static_cast<float>(serialized * m_spacing) + n_min);
-    return deserialized_data;
+    Telemetry t = {};
+    for (uint8_t i = 0; i < Packet::COUNT; i++)
+    {
+        const DltField &f = Packet::fields[i];
+        switch (f.kind)
+        {
+        case DltKind::RAW:
+            t.*f.value = f.quantizer.max / 2;
+            break;
+        case DltKind::IMU:
+            (t.*f.counts).*f.axis = (lowest(f) + highest(f)) / 2 / f.count_scale;
+            t.*f.reading = (t.*f.counts).*f.axis * f.count_scale;
+            break;
+        case DltKind::LINEAR:
+            t.*f.reading = (lowest(f) + highest(f)) / 2;
+            break;
+        case DltKind::SIGN:
+        case DltKind::MICRO:
+            t.*f.reading = -f.n_max / 3.0f;
+            break;
+        }
+    }
+    return t;
+}
+
+template <typename Packet>
+void sweep_packet()
+{
+    Telemetry base_t = middle<Packet>();
+    uint32_t base[Packet::COUNT];
+    CHECK(dlt_transform<Packet>(base_t, base) == 0);
+    for (uint8_t i = 0; i < Packet::COUNT; i++)
+    {
+        Failures failures;
+        switch (Packet::fields[i].kind)
+        {
+        case DltKind::RAW:
+            sweep_raw<Packet>(i, base_t, base, failures);
+            break;
+        case DltKind::LINEAR:
+            sweep_linear<Packet>(i, base_t, base, failures);
+            break;
+        case DltKind::IMU:
+            sweep_imu<Packet>(i, base_t, base, failures);
+            break;
+        case DltKind::SIGN:
+            break;
+        case DltKind::MICRO:
+            sweep_micro<Packet>(i, base_t, base, failures);
+            break;
+        }
+        CHECK_MESSAGE(failures.count == 0, "schema ", int(Packet::SCHEMA), ": ", failures.first);
+    }
+}
+
+// values anywhere within their widths, the fields packed and streamed
+// independently of one another
+template <typename Packet>
+void check_bit_patterns()
+{
+    mt19937 rng(static_cast<uint32_t>(Packet::SCHEMA) + 49);
+    Failures failures;
+    for (int k = 0; k < 2000; k++)
+    {
+        uint32_t values[Packet::COUNT], unpacked[Packet::COUNT], read[Packet::COUNT];
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+        {
+            uint32_t mask = Bitpack_mask(Packet::fields[i].width);
+            // all zeros, all ones, alternating, then random
+            values[i] = k == 0 ? 0 : k == 1 ? mask : k == 2 ? 0x55555555 & mask : k == 3 ? 0xAAAAAAAA & mask : rng() & mask;
+        }
+        uint64_t words[DltLayout<Packet>::WORDS];
+        uint8_t bytes[DltLayout<Packet>::BYTES];
+        memset(bytes, k & 1 ? 0xFF : 0, sizeof(bytes)); // write must not depend on what was there
+        dlt_pack<Packet>(values, words);
+        dlt_unpack<Packet>(words, unpacked);
+        dlt_write<Packet>(values, bytes);
+        dlt_read<Packet>(bytes, sizeof(bytes), read);
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+        {
+            if (unpacked[i] != values[i])
+                failures.add(Packet::fields[i], i, values[i], unpacked[i], "dlt_unpack");
+            if (read[i] != values[i])
+                failures.add(Packet::fields[i], i, values[i], read[i], "dlt_read");
+        }
+    }
+    CHECK_MESSAGE(failures.count == 0, "schema ", int(Packet::SCHEMA), ": ", failures.first);
 }
 
 TEST_CASE("Intro")
@@ -34,60 +353,62 @@ TEST_CASE("Intro")
 
 TEST_CASE("Testing Discrete Lossy Transform with the ranges of different values")
 {
+    const DltQuantizer ext_temp = PowerOnPacket::fields[1].quantizer;
+    bool saturated;
+
     SUBCASE("Serialization with external temperature")
     {
-        unsigned int min_val = serialize_dlt(11, -15, 125, -15.0, EXT_TEMP_SPACING);
-        unsigned int max_val = serialize_dlt(11, -15, 125, 125.0, EXT_TEMP_SPACING);
-        unsigned int neg_val = serialize_dlt(11, -15, 125, -5.0, EXT_TEMP_SPACING);
-        unsigned int neg_val_w_decimal = serialize_dlt(11, -15, 125, -6.529249272520528522, EXT_TEMP_SPACING);
-        unsigned int pos_val_w_decimal = serialize_dlt(11, -15, 125, 31.9418419481819818198, EXT_TEMP_SPACING);
-        unsigned int just_below_min_range = serialize_dlt(11, -15, 125, -15.0001, EXT_TEMP_SPACING);
-        unsigned int below_min_range = serialize_dlt(11, -15, 125, -20.0, EXT_TEMP_SPACING);
-        unsigned int just_above_max_range = serialize_dlt(11, -15, 125, 125.1, EXT_TEMP_SPACING);
-        unsigned int above_max_range = serialize_dlt(11, -15, 125, 150.0, EXT_TEMP_SPACING);
-        unsigned int normal_case = serialize_dlt(11, -15, 125, 25.5, EXT_TEMP_SPACING);
-
-        CHECK(min_val == 0);
-        CHECK(max_val == 2047);
-        CHECK(neg_val == 146);
-        CHECK(neg_val_w_decimal == 123);
-        CHECK(pos_val_w_decimal == 686);
-        CHECK(just_below_min_range == -1);
-        CHECK(below_min_range == -74);
-        CHECK(just_above_max_range == 2048);
-        CHECK(above_max_range == 2412);
-        CHECK(normal_case == 592);
+        CHECK(quantize_dlt(-15.0, ext_temp, saturated) == 0);
+        CHECK(quantize_dlt(125.0, ext_temp, saturated) == 2047);
+        CHECK(quantize_dlt(-5.0, ext_temp, saturated) == 146);
+        CHECK(quantize_dlt(-6.529249272520528522, ext_temp, saturated) == 123);
+        CHECK(quantize_dlt(31.9418419481819818198, ext_temp, saturated) == 686);
+        CHECK(quantize_dlt(25.5, ext_temp, saturated) == 592);
+        CHECK_FALSE(saturated);
+        // outside the range, clamped to its ends
+        CHECK(quantize_dlt(-15.0001, ext_temp, saturated) == 0);
+        CHECK(saturated);
+        CHECK(quantize_dlt(-20.0, ext_temp, saturated) == 0);
+        CHECK(saturated);
+        CHECK(quantize_dlt(125.1, ext_temp, saturated) == 2047);
+        CHECK(saturated);
+        CHECK(quantize_dlt(150.0, ext_temp, saturated) == 2047);
+        CHECK(saturated);
     }
     SUBCASE("Deserialization with external temperature")
     {
-        float deserial_min_val = deserialize_dlt(serialize_dlt(11, -15, 125, -15.0, EXT_TEMP_SPACING), -15, EXT_TEMP_SPACING);
-        float deserial_max_val = deserialize_dlt(serialize_dlt(11, -15, 125, 125.0, EXT_TEMP_SPACING), -15, EXT_TEMP_SPACING);
-        float deserial_neg_val = deserialize_dlt(serialize_dlt(11, -15, 125, -5.0, EXT_TEMP_SPACING), -15, EXT_TEMP_SPACING);
-        float deserial_neg_val_w_decimal = deserialize_dlt(serialize_dlt(11, -15, 125, -6.529249272520528522, EXT_TEMP_SPACING), -15, EXT_TEMP_SPACING);
-        float deserial_pos_val_w_decimal = deserialize_dlt(serialize_dlt(11, -15, 125, 31.9418419481819818198, EXT_TEMP_SPACING), -15, EXT_TEMP_SPACING);
-        float deserial_just_below_min_range = deserialize_dlt(serialize_dlt(11, -15, 125, -15.0001, EXT_TEMP_SPACING), -15, EXT_TEMP_SPACING);
-        float deserial_below_min_range = deserialize_dlt(serialize_dlt(11, -15, 125, -20.0, EXT_TEMP_SPACING), -15, EXT_TEMP_SPACING);
-        float deserial_just_above_max_range = deserialize_dlt(serialize_dlt(11, -15, 125, 125.1, EXT_TEMP_SPACING), -15, EXT_TEMP_SPACING);
-        float deserial_above_max_range = deserialize_dlt(serialize_dlt(11, -15, 125, 150.0, EXT_TEMP_SPACING), -15, EXT_TEMP_SPACING);
-        float deserial_normal_case = deserialize_dlt(serialize_dlt(11, -15, 125, 25.5, EXT_TEMP_SPACING), -15, EXT_TEMP_SPACING);
-
-        CHECK(deserial_min_val == -15);
-        CHECK(deserial_max_val == 125);
-        CHECK(deserial_neg_val >= -5.02);
-        CHECK(deserial_neg_val <= -5.00);
-        CHECK(deserial_neg_val_w_decimal >= -6.588);
-        CHECK(deserial_neg_val_w_decimal <= -6.580);
-        CHECK(deserial_pos_val_w_decimal >= 31.91);
-        CHECK(deserial_pos_val_w_decimal <= 31.92);
-        CHECK(deserial_just_below_min_range >= -15.07);
-        CHECK(deserial_just_below_min_range <= -15.0); // I expect this to fail
-        CHECK(deserial_below_min_range >= -20.7);
-        CHECK(deserial_below_min_range >= -20);
-        CHECK(deserial_just_above_max_range >= 125.0);
-        CHECK(deserial_just_above_max_range >= 125.07);
-        CHECK(deserial_above_max_range >= 149.9);
-        CHECK(deserial_above_max_range <= 149.97);
-        CHECK(deserial_normal_case >= 25.0);
-        CHECK(deserial_normal_case <= 25.7);
+        auto round_trip = [&](float reading) {
+            return deserialize_dlt(quantize_dlt(reading, ext_temp, saturated), -15, EXT_TEMP_SPACING);
+        };
+        CHECK(round_trip(-15.0) == -15);
+        CHECK(round_trip(125.0) == doctest::Approx(125).epsilon(1e-3));
+        CHECK(round_trip(-5.0) >= -5.02);
+        CHECK(round_trip(-5.0) <= -5.00);
+        CHECK(round_trip(-6.529249272520528522) >= -6.588);
+        CHECK(round_trip(-6.529249272520528522) <= -6.580);
+        CHECK(round_trip(31.9418419481819818198) >= 31.91);
+        CHECK(round_trip(31.9418419481819818198) <= 31.92);
+        CHECK(round_trip(25.5) >= 25.0);
+        CHECK(round_trip(25.5) <= 25.7);
+        CHECK(round_trip(-20.0) == -15);
+        CHECK(round_trip(150.0) == doctest::Approx(125).epsilon(1e-3));
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("every field of every packet round trips across its range, within one step")
+{
+    sweep_packet<PowerOnPacket>();
+    sweep_packet<LaunchReadyPacket>();
+    sweep_packet<LaunchModePacket>();
+    sweep_packet<RecoveryPacket>();
+    sweep_packet<NoSchemaPacket>();
+}
+
+TEST_CASE("any values within their widths pack and stream back exactly")
+{
+    check_bit_patterns<PowerOnPacket>();
+    check_bit_patterns<LaunchReadyPacket>();
+    check_bit_patterns<LaunchModePacket>();
+    check_bit_patterns<RecoveryPacket>();
+    check_bit_patterns<NoSchemaPacket>();
+}
@@ -2,32 +2,12 @@
 #include "doctest.h"
 #include <iostream>
 #include <inttypes.h>
+#include <random>
 using namespace std;
 
-#include "../../carm-electronics/flight-computer/bitpack.c"
-
-const float EXT_TEMP_SPACING = 0.0683927699072;
-const float INT_TEMP_SPACING = 0.0620420127015;
-const float ALTITUDE_SPACING = 0.0999481185339;
-const float VERT_VELO_SPACING = 0.0122074037904;
-const float ACCEL_Z_SPACING = 0.0635075720567;
-const float ACCEL_XY_SPACING = 0.0489236790607;
-const float MAG_FORCE_SPACING = 0.0195694716243;
-const float GYRO_XY_SPACING = 0.0027465846506;
-const float GYRO_Z_SPACING = 0.00549320597234;
-const float GPS_SPEED_SPACING = 0.0999481185339;
-
-unsigned int serialize_dlt(unsigned int bit_count, int n_min, int n_max, float reading, float m_spacing)
-{
-    unsigned int serialized_data = floor((reading - n_min) / m_spacing);
-    return serialized_data;
-}
-
-float deserialize_dlt(unsigned int serialized, int n_min, float m_spacing)
-{
-    float deserialized_data = (static_cast<float>(serialized * m_spacing) + n_min);
-    return deserialized_data;
-}
+// g++ -std=c++11 -I../../carm-electronics/flight-computer bitpack_test.cpp
+#include "../../carm-electronics/bitpack.h"
+#include "../../carm-electronics/dlt.h"
 
 // Note: this bitpacking library was extensively tested prior to its inclusion to this project,
 //          so this type of testing will be a bit lax, especially since we will be working with
@@ -36,7 +16,6 @@ TEST_CASE("General bitpacking tests; ensuring exact values are retrieved as they
 {
     uint64_t test_word = 0;
 
-    uint64_t test = 22;
     uint64_t bitpacked_word = Bitpack_newu(test_word, 5, 0, 22);
     unsigned int basic_test = Bitpack_getu(bitpacked_word, 5, 0);
 
@@ -47,48 +26,73 @@ TEST_CASE("Testing bitpacking with DLT values")
 {
     SUBCASE("Packing and unpacking serialized data; we use possible values obtained from external temperature's range")
     {
-        uint64_t test_word1 = 0;
-        uint64_t test_word2 = 0;
-        uint64_t test_word3 = 0;
-        uint64_t test_word4 = 0;
-        uint64_t test_word5 = 0;
-        uint64_t test_word6 = 0;
-        uint64_t test_word7 = 0;
-        uint64_t test_word8 = 0;
-        uint64_t test_word9 = 0;
-        uint64_t test_word10 = 0;
+        const DltQuantizer ext_temp = PowerOnPacket::fields[1].quantizer;
+        bool saturated;
+        auto pack_unpack = [&](float reading) {
+            return Bitpack_getu(Bitpack_newu(0, 14, 4, quantize_dlt(reading, ext_temp, saturated)), 14, 4);
+        };
 
-        unsigned int min_val = serialize_dlt(11, -15, 125, -15.0, EXT_TEMP_SPACING);
-        unsigned int max_val = serialize_dlt(11, -15, 125, 125.0, EXT_TEMP_SPACING);
-        unsigned int neg_val = serialize_dlt(11, -15, 125, -5.0, EXT_TEMP_SPACING);
-        unsigned int neg_val_w_decimal = serialize_dlt(11, -15, 125, -6.529249272520528522, EXT_TEMP_SPACING);
-        unsigned int pos_val_w_decimal = serialize_dlt(11, -15, 125, 31.9418419481819818198, EXT_TEMP_SPACING);
-        unsigned int just_below_min_range = serialize_dlt(11, -15, 125, -15.0001, EXT_TEMP_SPACING);
-        unsigned int below_min_range = serialize_dlt(11, -15, 125, -20.0, EXT_TEMP_SPACING);
-        unsigned int just_above_max_range = serialize_dlt(11, -15, 125, 125.1, EXT_TEMP_SPACING);
-        unsigned int above_max_range = serialize_dlt(11, -15, 125, 150.0, EXT_TEMP_SPACING);
-        unsigned int normal_case = serialize_dlt(11, -15, 125, 25.5, EXT_TEMP_SPACING);
+        CHECK(pack_unpack(-15.0) == 0);
+        CHECK(pack_unpack(125.0) == 2047);
+        CHECK(pack_unpack(-5.0) == 146);
+        CHECK(pack_unpack(-6.529249272520528522) == 123);
+        CHECK(pack_unpack(31.9418419481819818198) == 686);
+        CHECK(pack_unpack(25.5) == 592);
+        // readings outside the range are clamped before they are packed
+        CHECK(pack_unpack(-15.0001) == 0);
+        CHECK(pack_unpack(-20.0) == 0);
+        CHECK(pack_unpack(125.1) == 2047);
+        CHECK(pack_unpack(150.0) == 2047);
+    }
+}
 
-        unsigned int unpacked_min_val = Bitpack_getu(Bitpack_newu(test_word1, 14, 4, min_val), 14, 4);
-        unsigned int unpacked_max_val = Bitpack_getu(Bitpack_newu(test_word2, 14, 4, max_val), 14, 4);
-        unsigned int unpacked_neg_val = Bitpack_getu(Bitpack_newu(test_word3, 14, 4, neg_val), 14, 4);
-        unsigned int unpacked_neg_val_w_decimal = Bitpack_getu(Bitpack_newu(test_word4, 14, 4, neg_val_w_decimal), 14, 4);
-        unsigned int unpacked_pos_val_w_decimal = Bitpack_getu(Bitpack_newu(test_word5, 14, 4, pos_val_w_decimal), 14, 4);
-        unsigned int unpacked_just_below_min_range = Bitpack_getu(Bitpack_newu(test_word6, 14, 4, just_below_min_range), 14, 4);
-        unsigned int unpacked_below_min_range = Bitpack_getu(Bitpack_newu(test_word7, 14, 4, below_min_range), 14, 4);
-        unsigned int unpacked_just_above_max_range = Bitpack_getu(Bitpack_newu(test_word8, 14, 4, just_above_max_range), 14, 4);
-        unsigned int unpacked_above_max_range = Bitpack_getu(Bitpack_newu(test_word9, 14, 4, above_max_range), 14, 4);
-        unsigned int unpacked_normal_case = Bitpack_getu(Bitpack_newu(test_word10, 14, 4, normal_case), 14, 4);
+// Every field of a word, every width and lsb that fit, with random values
+// and random bits around them. Failures are counted, checked once a case.
+TEST_CASE("a field packs and extracts exactly, leaving the rest of the word alone")
+{
+    mt19937_64 rng(49);
+    unsigned failures = 0, first_width = 0, first_lsb = 0;
+    for (unsigned width = 0; width <= 64; width++)
+    {
+        for (unsigned lsb = 0; lsb + width <= 64; lsb++)
+        {
+            for (int k = 0; k < 20; k++)
+            {
+                uint64_t word = rng();
+                uint64_t value = k == 0 ? 0 : k == 1 ? Bitpack_mask(width) : rng() & Bitpack_mask(width);
+                uint64_t packed = Bitpack_newu(word, width, lsb, value);
+                uint64_t field = Bitpack_mask(width) << (lsb & 63);
+                bool ok = Bitpack_getu(packed, width, lsb) == value && (packed & ~field) == (word & ~field) &&
+                          Bitpack_fitsu(value, width);
+                // the same bits as a signed field
+                int64_t signed_value = Bitpack_gets(packed, width, lsb);
+                ok = ok && Bitpack_fitss(signed_value, width) && Bitpack_news(word, width, lsb, signed_value) == packed;
+                // a value one bit too wide does not fit
+                ok = ok && (width == 64 || !Bitpack_fitsu(Bitpack_mask(width) + 1, width));
+                if (!ok && failures++ == 0)
+                {
+                    first_width = width;
+                    first_lsb = lsb;
+                }
+            }
+        }
+    }
+    CHECK_MESSAGE(failures == 0, "first at width ", first_width, ", lsb ", first_lsb);
+}
 
-        CHECK(unpacked_min_val == 0);
-        CHECK(unpacked_max_val == 2047);
-        CHECK(unpacked_neg_val == 146);
-        CHECK(unpacked_neg_val_w_decimal == 123);
-        CHECK(unpacked_pos_val_w_decimal == 686);
-        CHECK(unpacked_just_below_min_range == -1); // this should fail
-        CHECK(unpacked_below_min_range == -74);     // this should fail
-        CHECK(unpacked_just_above_max_range == 2048);
-        CHECK(unpacked_above_max_range == 2412);
-        CHECK(unpacked_normal_case == 592);
+TEST_CASE("signed fields fit from -2^(width - 1) to 2^(width - 1) - 1")
+{
+    unsigned failures = 0;
+    for (unsigned width = 1; width < 64; width++)
+    {
+        int64_t low = -(int64_t(1) << (width - 1)), high = (int64_t(1) << (width - 1)) - 1;
+        failures += !Bitpack_fitss(low, width) + !Bitpack_fitss(high, width);
+        failures += Bitpack_fitss(low - 1, width) + Bitpack_fitss(high + 1, width);
+        failures += Bitpack_gets(Bitpack_news(0, width, 64 - width, low), width, 64 - width) != low;
+        failures += Bitpack_gets(Bitpack_news(~0ULL, width, 0, high), width, 0) != high;
     }
-}
\ No newline at end of file
+    CHECK(failures == 0);
+    CHECK(Bitpack_fitss(INT64_MIN, 64));
+    CHECK(Bitpack_fitss(0, 0));
+    CHECK_FALSE(Bitpack_fitss(-1, 0));
+}
@@ -0,0 +1,143 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <inttypes.h>
+#include <random>
+using namespace std;
+
+// g++ -std=c++11 -I../../carm-electronics/flight-computer bitstream_test.cpp
+#include "../../carm-electronics/bitstream.h"
+#include "../../carm-electronics/dlt.h"
+
+TEST_CASE("fields are written back to back, most significant bit first")
+{
+    uint8_t bytes[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+    BitWriter out(bytes);
+    out.write(0x5, 3);   // 101
+    out.write(0x1FF, 9); // 1 1111 1111
+    out.write(0x0, 2);
+    CHECK(out.bits() == 14);
+    CHECK(out.finish() == 2);
+    CHECK(bytes[0] == 0xBF);
+    CHECK(bytes[1] == 0xF0);
+    CHECK(bytes[2] == 0xFF); // untouched past the frame
+
+    BitReader in(bytes, 2);
+    CHECK(in.read(3) == 0x5);
+    CHECK(in.read(9) == 0x1FF);
+    CHECK(in.read(2) == 0);
+    CHECK_FALSE(in.overrun());
+}
+
+TEST_CASE("a value is masked to its width")
+{
+    uint8_t bytes[2];
+    BitWriter out(bytes);
+    out.write(0xFF, 4);
+    out.write(0x0, 4);
+    out.finish();
+    CHECK(bytes[0] == 0xF0);
+}
+
+TEST_CASE("byte-aligned runs and odd fields mix")
+{
+    uint8_t run[5] = {1, 2, 3, 4, 5};
+    uint8_t bytes[16];
+    BitWriter out(bytes);
+    out.write(0xABCD, 16);
+    out.writeBytes(run, 5);
+    out.write(0x1, 1);
+    out.writeBytes(run, 2);
+    out.write(0xDEADBEEF, 32);
+    size_t size = out.finish();
+    CHECK(size == 2 + 5 + 7);
+
+    uint8_t back[5];
+    BitReader in(bytes, size);
+    CHECK(in.read(16) == 0xABCD);
+    in.readBytes(back, 5);
+    CHECK(back[4] == 5);
+    CHECK(in.read(1) == 1);
+    in.readBytes(back, 2);
+    CHECK(back[0] == 1);
+    CHECK(back[1] == 2);
+    CHECK(in.read(32) == 0xDEADBEEF);
+    CHECK_FALSE(in.overrun());
+    CHECK(in.read(8) == 0);
+    CHECK(in.overrun());
+}
+
+TEST_CASE("random widths round trip")
+{
+    mt19937 rng(7);
+    uint8_t bytes[4 * 200 + 1];
+    uint32_t values[200];
+    uint8_t widths[200];
+    BitWriter out(bytes);
+    for (int k = 0; k < 200; k++)
+    {
+        widths[k] = 1 + rng() % 32;
+        values[k] = rng() & ((1ULL << widths[k]) - 1);
+        out.write(values[k], widths[k]);
+    }
+    size_t size = out.finish();
+    BitReader in(bytes, size);
+    for (int k = 0; k < 200; k++)
+    {
+        CHECK(in.read(widths[k]) == values[k]);
+    }
+    CHECK_FALSE(in.overrun());
+}
+
+TEST_CASE("a packet streams into the bytes its fields need, as BitWriter would")
+{
+    CHECK(DltLayout<PowerOnPacket>::BYTES == 7);
+    CHECK(DltLayout<LaunchReadyPacket>::BYTES == 36);
+    CHECK(DltLayout<NoSchemaPacket>::BYTES == 39);
+
+    mt19937 rng(41);
+    uint32_t values[NoSchemaPacket::COUNT], decoded[NoSchemaPacket::COUNT];
+    uint8_t bytes[DltLayout<NoSchemaPacket>::BYTES], expected[DltLayout<NoSchemaPacket>::BYTES];
+    for (int frame = 0; frame < 100; frame++)
+    {
+        BitWriter out(expected);
+        for (uint8_t i = 0; i < NoSchemaPacket::COUNT; i++)
+        {
+            values[i] = rng();
+            out.write(values[i], NoSchemaPacket::fields[i].width);
+        }
+        CHECK(out.finish() == DltLayout<NoSchemaPacket>::BYTES);
+        CHECK(dlt_write<NoSchemaPacket>(values, bytes) == DltLayout<NoSchemaPacket>::BYTES);
+        for (unsigned b = 0; b < DltLayout<NoSchemaPacket>::BYTES; b++)
+        {
+            CHECK(bytes[b] == expected[b]);
+        }
+
+        REQUIRE(dlt_read<NoSchemaPacket>(bytes, sizeof(bytes), decoded));
+        for (uint8_t i = 0; i < NoSchemaPacket::COUNT; i++)
+        {
+            CHECK(decoded[i] == (values[i] & ((1ULL << NoSchemaPacket::fields[i].width) - 1)));
+        }
+    }
+    CHECK_FALSE(dlt_read<NoSchemaPacket>(bytes, sizeof(bytes) - 1, decoded));
+}
+
+TEST_CASE("zeros counts the zero bits before a one, up to a limit, and leaves the one")
+{
+    uint8_t bytes[4];
+    BitWriter out(bytes);
+    out.write(1, 4);  // 3 zeros
+    out.write(1, 13); // 12 zeros, across two bytes
+    out.write(0, 15); // more zeros than the limit
+    size_t size = out.finish();
+
+    BitReader in(bytes, size);
+    CHECK(in.zeros(16) == 3);
+    CHECK(in.read(1) == 1);
+    CHECK(in.zeros(5) == 5);
+    CHECK(in.zeros(16) == 7);
+    CHECK(in.read(1) == 1);
+    CHECK(in.zeros(10) == 10);
+    CHECK_FALSE(in.overrun());
+    CHECK(in.zeros(10) == 10); // five past the end
+    CHECK(in.overrun());
+}
@@ -0,0 +1,149 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <cmath>
+#include <inttypes.h>
+using namespace std;
+
+#include "../../carm-electronics/flight-computer/detectors.h"
+
+const DetectorConfig CONFIG = {
+    20,          // launch accel
+    5,           // launch velocity
+    20,          // baro launch altitude
+    0.05,        // apogee lead
+    213.36,      // main altitude
+    4 * 9.80665, // accel limit
+    3,           // confirm ticks
+    {1, 1, 1},
+    0.6,         // quorum
+    30,          // fused divergence
+    3,           // baro noise
+    0.25,        // clipped confidence
+};
+
+const float G = 9.80665;
+
+// a tick with the rocket standing on x, every source agreeing, time in ms
+DetectorInput tick(uint32_t time, float accel, float velocity, float altitude)
+{
+    DetectorInput in;
+    in.time = time * 1000ULL;
+    in.accel[0] = accel + G;
+    in.accel[1] = 0;
+    in.accel[2] = 0;
+    in.baroAltitude = altitude;
+    in.baroValid = true;
+    in.fused.time = in.time;
+    in.fused.altitude = altitude;
+    in.fused.velocity = velocity;
+    in.fused.accel = accel;
+    in.fused.timeToApogee = NAN;
+    in.fused.events = 0;
+    return in;
+}
+
+// constant acceleration from the pad, 50 ms ticks, returns the next time
+uint32_t fly(EventVoter &voter, uint32_t from, uint32_t to, float accel, float &velocity, float &altitude,
+             bool baroValid = true)
+{
+    uint32_t t = from;
+    for (; t < to; t += 50)
+    {
+        velocity += accel * 0.05f;
+        altitude += velocity * 0.05f;
+        DetectorInput in = tick(t, accel, velocity, altitude);
+        in.baroValid = baroValid;
+        voter.update(in);
+    }
+    return t;
+}
+
+TEST_CASE("the baro line recovers the climb rate")
+{
+    EventVoter voter(CONFIG);
+    for (uint32_t k = 0; k < 20; k++)
+        voter.update(tick(k * 25, 0, 0, 100 + 40 * k * 0.025f));
+    CHECK(voter.getBaroVelocity() == doctest::Approx(40).epsilon(1e-3));
+    CHECK(voter.getConfidence(Detector::BARO, FlightEvent::APOGEE) == doctest::Approx(1));
+    CHECK(voter.getConfidence(Detector::BARO, FlightEvent::BURNOUT) == 0);
+    CHECK(voter.getConfidence(Detector::IMU, FlightEvent::MAIN) == 0);
+}
+
+TEST_CASE("a whole flight is declared event by event, two detectors out of three")
+{
+    EventVoter voter(CONFIG);
+    float v = 0, h = 0;
+    uint32_t t = fly(voter, 0, 1000, 0, v, h);
+    CHECK(voter.getDecisions() == 0);
+    t = fly(voter, t, 3000, 60, v, h);
+    CHECK(voter.decided(FlightEvent::LAUNCH));
+    // fused and imu see it three ticks after passing 5 m/s, the barometer
+    // only once 20 m up
+    CHECK(voter.decidedAt(FlightEvent::LAUNCH) == 1150000);
+    CHECK(voter.firedAt(Detector::IMU, FlightEvent::LAUNCH) == 1150000);
+    CHECK(voter.firedAt(Detector::BARO, FlightEvent::LAUNCH) > 1150000);
+    t = fly(voter, t, 4000, -15, v, h);
+    CHECK(voter.decided(FlightEvent::BURNOUT));
+    t = fly(voter, t, 40000, -G, v, h);
+    CHECK(voter.decided(FlightEvent::APOGEE));
+    CHECK(voter.decided(FlightEvent::MAIN));
+    CHECK(voter.getVotes() == 0x7DF); // every detector, every event it judges
+}
+
+TEST_CASE("an invalid barometer drops out of the vote")
+{
+    EventVoter voter(CONFIG);
+    float v = 0, h = 0;
+    uint32_t t = fly(voter, 0, 1000, 0, v, h);
+    t = fly(voter, t, 3000, 60, v, h, false);
+    CHECK(voter.getConfidence(Detector::BARO, FlightEvent::LAUNCH) == 0);
+    CHECK(voter.decided(FlightEvent::LAUNCH));
+    CHECK_FALSE(voter.hasFired(Detector::BARO, FlightEvent::LAUNCH));
+}
+
+TEST_CASE("one detector alone is outvoted, a diverged filter loses its say")
+{
+    EventVoter voter(CONFIG);
+    // fused alone claims a launch on the pad
+    for (uint32_t t = 0; t < 1000; t += 50)
+    {
+        DetectorInput in = tick(t, 0, 0, 0);
+        in.fused.accel = 50;
+        in.fused.velocity = 20;
+        voter.update(in);
+    }
+    CHECK(voter.hasFired(Detector::FUSED, FlightEvent::LAUNCH));
+    CHECK_FALSE(voter.decided(FlightEvent::LAUNCH));
+
+    // a filter 200 m off the barometer is barely trusted
+    EventVoter diverged(CONFIG);
+    for (uint32_t t = 0; t < 5000; t += 50)
+    {
+        DetectorInput in = tick(t, 0, 0, 0);
+        in.fused.altitude = 200;
+        diverged.update(in);
+    }
+    CHECK(diverged.getConfidence(Detector::FUSED, FlightEvent::APOGEE) < 0.1);
+}
+
+TEST_CASE("the imu projects on the pad vertical, whatever the mounting")
+{
+    EventVoter voter(CONFIG);
+    // standing on -y, as in the test-flight2 log
+    for (uint32_t t = 0; t < 1000; t += 50)
+    {
+        DetectorInput in = tick(t, 0, 0, 0);
+        in.accel[0] = 0;
+        in.accel[1] = -G;
+        voter.update(in);
+    }
+    for (uint32_t t = 1000; t < 1500; t += 50)
+    {
+        DetectorInput in = tick(t, 30, 0, 0);
+        in.accel[0] = 0;
+        in.accel[1] = -(G + 30);
+        voter.update(in);
+    }
+    CHECK(voter.hasFired(Detector::IMU, FlightEvent::LAUNCH));
+    CHECK(voter.getImuVelocity() == doctest::Approx(30 * 0.5).epsilon(0.01));
+}
@@ -0,0 +1,231 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <cmath>
+#include <inttypes.h>
+using namespace std;
+
+// g++ -std=c++11 -I../../carm-electronics/flight-computer dlt_codec_test.cpp
+#include "../../carm-electronics/dlt.h"
+
+// a reading in the middle of every range, the IMU counts behind the IMU readings
+Telemetry sample()
+{
+    Telemetry t;
+    t.curr_state = 5;
+    t.timestamp = 123456;
+    t.failures = 0x2A5;
+    t.gps_fix = 1;
+    t.gps_quality = 2;
+    t.gps_num_satellites = 6;
+    t.gps_antenna_status = 3;
+    t.gps_lat = 42.406812;
+    t.gps_long = -71.116153;
+    t.gps_speed = 33.3;
+    t.gps_altitude = 1234.5;
+    t.external_temp = 21.7;
+    t.temperature_engbay = 35.2;
+    t.temperature_avbay = 28.9;
+    t.altitude = 1500.25;
+    t.vert_velo = -12.5;
+    t.accel_counts = {1000, 2000, -3000};
+    t.gyro_counts = {-500, 700, 1200};
+    t.mag_counts = {150, -250, 300};
+    t.accel_x = t.accel_counts.x * DLT_ACCEL_SCALE;
+    t.accel_y = t.accel_counts.y * DLT_ACCEL_SCALE;
+    t.accel_z = t.accel_counts.z * DLT_ACCEL_SCALE;
+    t.gyro_x = t.gyro_counts.x * DLT_GYRO_SCALE;
+    t.gyro_y = t.gyro_counts.y * DLT_GYRO_SCALE;
+    t.gyro_z = t.gyro_counts.z * DLT_GYRO_SCALE;
+    t.mag_x = t.mag_counts.x * DLT_MAG_SCALE;
+    t.mag_y = t.mag_counts.y * DLT_MAG_SCALE;
+    t.mag_z = t.mag_counts.z * DLT_MAG_SCALE;
+    return t;
+}
+
+template <typename Packet>
+Telemetry round_trip(const Telemetry &in)
+{
+    uint32_t values[Packet::COUNT], decoded[Packet::COUNT];
+    uint64_t words[DltLayout<Packet>::WORDS];
+    CHECK(dlt_transform<Packet>(in, values) == 0);
+    dlt_pack<Packet>(values, words);
+    dlt_unpack<Packet>(words, decoded);
+    for (uint8_t i = 0; i < Packet::COUNT; i++)
+    {
+        CHECK(decoded[i] == values[i]);
+    }
+    Telemetry out = {};
+    dlt_untransform<Packet>(decoded, out);
+    return out;
+}
+
+// every field of the packet decodes within one step of the reading
+template <typename Packet>
+void check_fields(const Telemetry &in, const Telemetry &out)
+{
+    for (uint8_t i = 0; i < Packet::COUNT; i++)
+    {
+        const DltField &f = Packet::fields[i];
+        switch (f.kind)
+        {
+        case DltKind::RAW:
+            CHECK(out.*f.value == in.*f.value);
+            break;
+        case DltKind::LINEAR:
+        case DltKind::IMU:
+            CHECK(in.*f.reading - out.*f.reading >= -1e-3f);
+            CHECK(in.*f.reading - out.*f.reading <= f.spacing * 1.001f);
+            break;
+        case DltKind::SIGN:
+        case DltKind::MICRO:
+            CHECK(out.*f.reading == doctest::Approx(in.*f.reading).epsilon(1e-6));
+            break;
+        }
+    }
+}
+
+TEST_CASE("fields are laid out most significant bit first, none straddling two words")
+{
+    CHECK(DltLayout<PowerOnPacket>::WORDS == 1);
+    CHECK(DltLayout<LaunchReadyPacket>::WORDS == 5);
+    CHECK(DltLayout<LaunchModePacket>::WORDS == 5);
+    CHECK(DltLayout<RecoveryPacket>::WORDS == 2);
+    CHECK(DltLayout<NoSchemaPacket>::WORDS == 5);
+    // the GPS coordinates fill the first word, the timestamp opens the second
+    CHECK(dlt_start<NoSchemaPacket>(6) == 64);
+    CHECK(dlt_start<NoSchemaPacket>(10) == 128);
+    CHECK(DltLayout<NoSchemaPacket>::BITS == 4 * 64 + 55);
+
+    Telemetry t = {};
+    t.curr_state = 0xA;
+    uint32_t values[PowerOnPacket::COUNT];
+    uint64_t words[1];
+    dlt_transform<PowerOnPacket>(t, values);
+    dlt_pack<PowerOnPacket>(values, words);
+    CHECK((words[0] >> 60) == 0xA);
+}
+
+TEST_CASE("every packet round trips")
+{
+    Telemetry in = sample();
+    check_fields<PowerOnPacket>(in, round_trip<PowerOnPacket>(in));
+    check_fields<LaunchReadyPacket>(in, round_trip<LaunchReadyPacket>(in));
+    check_fields<LaunchModePacket>(in, round_trip<LaunchModePacket>(in));
+    check_fields<RecoveryPacket>(in, round_trip<RecoveryPacket>(in));
+    check_fields<NoSchemaPacket>(in, round_trip<NoSchemaPacket>(in));
+}
+
+TEST_CASE("the failure flags of a power on packet decode")
+{
+    Telemetry in = sample();
+    CHECK(round_trip<PowerOnPacket>(in).failures == 0x2A5);
+}
+
+TEST_CASE("GPS coordinates decode to degrees with their sign")
+{
+    Telemetry in = sample();
+    Telemetry out = round_trip<RecoveryPacket>(in);
+    CHECK(out.gps_lat == doctest::Approx(42.406812));
+    CHECK(out.gps_long == doctest::Approx(-71.116153));
+
+    in.gps_lat = -33.8688;
+    in.gps_long = 151.2093;
+    out = round_trip<RecoveryPacket>(in);
+    CHECK(out.gps_lat == doctest::Approx(-33.8688));
+    CHECK(out.gps_long == doctest::Approx(151.2093));
+}
+
+// the index of the field of Packet that reads member, not its sign
+template <typename Packet>
+uint8_t field_of(float Telemetry::*member)
+{
+    uint8_t i = 0;
+    while (i < Packet::COUNT && (Packet::fields[i].reading != member || Packet::fields[i].kind == DltKind::SIGN))
+        i++;
+    return i;
+}
+
+template <typename Packet>
+uint8_t field_of_value(uint32_t Telemetry::*member)
+{
+    uint8_t i = 0;
+    while (i < Packet::COUNT && Packet::fields[i].value != member)
+        i++;
+    return i;
+}
+
+TEST_CASE("a value too wide for its field is masked, its neighbours are untouched")
+{
+    uint32_t values[NoSchemaPacket::COUNT], wide[NoSchemaPacket::COUNT];
+    dlt_transform<NoSchemaPacket>(sample(), values);
+    for (uint8_t i = 0; i < NoSchemaPacket::COUNT; i++)
+    {
+        wide[i] = values[i] | ~static_cast<uint32_t>(Bitpack_mask(NoSchemaPacket::fields[i].width));
+    }
+    uint64_t words[DltLayout<NoSchemaPacket>::WORDS], expected[DltLayout<NoSchemaPacket>::WORDS];
+    dlt_pack<NoSchemaPacket>(wide, words);
+    dlt_pack<NoSchemaPacket>(values, expected);
+    for (unsigned w = 0; w < DltLayout<NoSchemaPacket>::WORDS; w++)
+    {
+        CHECK(words[w] == expected[w]);
+    }
+}
+
+TEST_CASE("a reading outside its range is clamped and flagged")
+{
+    const uint8_t failures = field_of_value<NoSchemaPacket>(&Telemetry::failures);
+    const uint8_t temp = field_of<NoSchemaPacket>(&Telemetry::external_temp);
+    const uint8_t velo = field_of<NoSchemaPacket>(&Telemetry::vert_velo);
+    const uint8_t lat = field_of<NoSchemaPacket>(&Telemetry::gps_lat);
+    uint32_t values[NoSchemaPacket::COUNT];
+
+    Telemetry t = sample();
+    t.failures = 0x7FF; // 11 bits into 10
+    t.external_temp = -40;
+    t.vert_velo = 1e9f;
+    t.gps_lat = -1000; // degrees of latitude go to 90
+    CHECK(dlt_transform<NoSchemaPacket>(t, values) ==
+          (1u << failures | 1u << temp | 1u << velo | 1u << lat));
+    CHECK(values[failures] == 0x3FF);
+    CHECK(values[temp] == 0);
+    CHECK(values[velo] == NoSchemaPacket::fields[velo].quantizer.max);
+    CHECK(values[velo] == (1u << NoSchemaPacket::fields[velo].width) - 1);
+    CHECK(values[lat] == 90000000);
+
+    t = sample();
+    t.altitude = NAN;
+    CHECK(dlt_transform<NoSchemaPacket>(t, values) == 1u << field_of<NoSchemaPacket>(&Telemetry::altitude));
+    CHECK(values[field_of<NoSchemaPacket>(&Telemetry::altitude)] == 0);
+}
+
+TEST_CASE("the ends of a range are not saturated")
+{
+    DltQuantizer q = dlt_quantizer(-15, 1 / EXT_TEMP_SPACING, dlt_max(11, 140 / (double)EXT_TEMP_SPACING));
+    bool saturated;
+    CHECK(quantize_dlt(-15, q, saturated) == 0);
+    CHECK_FALSE(saturated);
+    CHECK(quantize_dlt(124.9f, q, saturated) == static_cast<uint32_t>(139.9 / EXT_TEMP_SPACING));
+    CHECK_FALSE(saturated);
+    CHECK(quantize_dlt(-15.1f, q, saturated) == 0);
+    CHECK(saturated);
+    CHECK(quantize_dlt(1e6f, q, saturated) == q.max);
+    CHECK(saturated);
+}
+
+TEST_CASE("a batch quantizes as one reading at a time")
+{
+    const DltQuantizer q[4] = {
+        dlt_quantizer(0, 1 / ALTITUDE_SPACING, dlt_max(15, 3275 / (double)ALTITUDE_SPACING)),
+        dlt_quantizer(-50, 1 / VERT_VELO_SPACING, dlt_max(15, 400 / (double)VERT_VELO_SPACING)),
+        dlt_quantizer(0, 1 / ALTITUDE_SPACING, dlt_max(15, 3275 / (double)ALTITUDE_SPACING)),
+        dlt_quantizer(-15, 1 / EXT_TEMP_SPACING, dlt_max(11, 140 / (double)EXT_TEMP_SPACING)),
+    };
+    const float readings[4] = {1500.25f, -60, 4000, 21.7f};
+    uint32_t values[4];
+    CHECK(quantize_dlt(readings, q, values, 4) == 0x6);
+    for (int i = 0; i < 4; i++)
+    {
+        bool saturated;
+        CHECK(values[i] == quantize_dlt(readings[i], q[i], saturated));
+    }
+}
@@ -0,0 +1,104 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <inttypes.h>
+#include <random>
+#include <vector>
+using namespace std;
+
+// g++ -std=c++11 -pthread -I../../carm-electronics/flight-computer dltbatch_test.cpp
+// and again with -mavx2 for the AVX2 kernels
+#include "../../carm-electronics/ground-decoder/dltbatch.h"
+
+typedef NoSchemaPacket Packet;
+
+// count frames of random values, each field within its width
+vector<vector<uint32_t>> random_frames(size_t count, uint32_t seed)
+{
+    mt19937 rng(seed);
+    vector<vector<uint32_t>> frames(count, vector<uint32_t>(Packet::COUNT));
+    for (vector<uint32_t> &values : frames)
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+            values[i] = rng() & Bitpack_mask(Packet::fields[i].width);
+    return frames;
+}
+
+// the frames through dlt_decode_batch, checked against a frame at a time
+void check_batch(const vector<vector<uint32_t>> &frames, DltFrameLayout layout, unsigned threads)
+{
+    size_t count = frames.size();
+    size_t stride = layout == DltFrameLayout::WORDS ? DltLayout<Packet>::WORDS * 8 : DltLayout<Packet>::BYTES;
+    vector<uint8_t> archive(count * stride);
+    for (size_t k = 0; k < count; k++)
+    {
+        if (layout == DltFrameLayout::WORDS)
+        {
+            uint64_t words[DltLayout<Packet>::WORDS];
+            dlt_pack<Packet>(frames[k].data(), words);
+            memcpy(&archive[k * stride], words, stride);
+        }
+        else
+        {
+            memset(&archive[k * stride], 0, stride);
+            dlt_write<Packet>(frames[k].data(), &archive[k * stride]);
+        }
+    }
+
+    vector<vector<uint32_t>> columns(Packet::COUNT, vector<uint32_t>(count));
+    vector<vector<float>> readings(Packet::COUNT, vector<float>(count));
+    uint32_t *column_ptrs[Packet::COUNT];
+    float *reading_ptrs[Packet::COUNT];
+    for (uint8_t i = 0; i < Packet::COUNT; i++)
+    {
+        column_ptrs[i] = columns[i].data();
+        DltKind kind = Packet::fields[i].kind;
+        reading_ptrs[i] = kind == DltKind::RAW || kind == DltKind::SIGN ? nullptr : readings[i].data();
+    }
+    dlt_decode_batch<Packet>(archive.data(), stride, count, layout, column_ptrs, reading_ptrs, threads);
+
+    for (size_t k = 0; k < count; k++)
+    {
+        Telemetry t = {};
+        dlt_untransform<Packet>(frames[k].data(), t);
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+        {
+            const DltField &f = Packet::fields[i];
+            CHECK(columns[i][k] == frames[k][i]);
+            if (reading_ptrs[i] != nullptr)
+                CHECK(readings[i][k] == doctest::Approx(t.*f.reading).epsilon(1e-6));
+        }
+    }
+}
+
+TEST_CASE("the columns of packed words are the fields of each frame")
+{
+    for (size_t count : {0, 1, 3, 4, 5, 33, 1000})
+        check_batch(random_frames(count, 48 + count), DltFrameLayout::WORDS, 1);
+}
+
+TEST_CASE("the columns of streamed frames, the last field of the last frame within the archive")
+{
+    for (size_t count : {1, 2, 7, 8, 9, 1001})
+        check_batch(random_frames(count, 480 + count), DltFrameLayout::BYTES, 1);
+}
+
+TEST_CASE("frames split among threads decode the same")
+{
+    vector<vector<uint32_t>> frames = random_frames(1003, 4800);
+    for (unsigned threads : {2, 3, 8})
+    {
+        check_batch(frames, DltFrameLayout::WORDS, threads);
+        check_batch(frames, DltFrameLayout::BYTES, threads);
+    }
+    check_batch(random_frames(2, 4801), DltFrameLayout::BYTES, 4); // more threads than frames
+}
+
+TEST_CASE("dequantizing a column is deserialize_dlt of each value")
+{
+    vector<uint32_t> values(37);
+    vector<float> readings(values.size());
+    for (size_t k = 0; k < values.size(); k++)
+        values[k] = k * 1234;
+    dlt_dequantize(values.data(), values.size(), -50, VERT_VELO_SPACING, readings.data());
+    for (size_t k = 0; k < values.size(); k++)
+        CHECK(readings[k] == deserialize_dlt(values[k], -50, VERT_VELO_SPACING));
+}
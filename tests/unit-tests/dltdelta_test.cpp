@@ -0,0 +1,378 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <inttypes.h>
+#include <random>
+#include <vector>
+using namespace std;
+
+// g++ -std=c++11 -I../../carm-electronics/flight-computer dltdelta_test.cpp
+#include "../../carm-electronics/dltdelta.h"
+
+typedef NoSchemaPacket Packet;
+typedef DltDeltaLayout<Packet> Layout;
+
+// every channel in every frame, so that a frame holds all its values
+const DltChannelRate EVERY_FRAME[DLT_CHANNELS] = {{1, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 0}, {1, 0}};
+
+struct Frame
+{
+    vector<uint32_t> values;
+    vector<uint8_t> bytes;
+};
+
+// frames of values drifting up a step or none from frame to frame, the
+// fields of delta order 6 or more, the rest fixed
+vector<Frame> drifting(int count, uint32_t seed)
+{
+    mt19937 rng(seed);
+    vector<uint32_t> values(Packet::COUNT);
+    for (uint8_t i = 0; i < Packet::COUNT; i++)
+        values[i] = rng() & Bitpack_mask(Packet::fields[i].width) & 0x3FF;
+    vector<Frame> frames;
+    for (int k = 0; k < count; k++)
+    {
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+            if (Packet::fields[i].delta >= 6)
+                values[i] = (values[i] + rng() % 2) & Bitpack_mask(Packet::fields[i].width);
+        frames.push_back(Frame{values, {}});
+    }
+    return frames;
+}
+
+void encode(vector<Frame> &frames, DltDeltaEncoder<> &encoder)
+{
+    for (Frame &frame : frames)
+    {
+        uint8_t bytes[Layout::MAX_BYTES];
+        size_t size = encoder.encode<Packet>(frame.values.data(), bytes);
+        frame.bytes.assign(bytes, bytes + size);
+    }
+}
+
+TEST_CASE("every frame kind has the top bit set")
+{
+    CHECK(dlt_frame_header(DltFrameKind::KEY, 31) >= 0x80);
+    CHECK(dlt_frame_header(DltFrameKind::DELTA, 0) >= 0x80);
+    uint8_t request[1];
+    CHECK(dlt_request_keyframe(request) == 1);
+    CHECK(request[0] >= 0x80);
+    CHECK(dlt_is_request(request, 1));
+}
+
+TEST_CASE("an unchanged frame is a bit and the delta order of each field")
+{
+    CHECK(Layout::KEY_BYTES == 41);
+    CHECK(Layout::MIN_DELTA_BYTES == 18);
+    vector<Frame> frames = drifting(1, 8);
+    frames.push_back(frames[0]);
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    encode(frames, encoder);
+    CHECK(frames[1].bytes.size() == Layout::MIN_DELTA_BYTES);
+}
+
+TEST_CASE("the first frame is a keyframe, the rest of its period deltas")
+{
+    vector<Frame> frames = drifting(45, 1);
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    encode(frames, encoder);
+    for (size_t k = 0; k < frames.size(); k++)
+    {
+        uint8_t kind = frames[k].bytes[0] >> DLT_SEQUENCE_BITS;
+        CHECK((frames[k].bytes[0] & DLT_SEQUENCE_MASK) == k % 32);
+        if (k % 20 == 0)
+        {
+            CHECK(kind == static_cast<uint8_t>(DltFrameKind::KEY));
+            CHECK(frames[k].bytes.size() == Layout::KEY_BYTES);
+        }
+        else
+        {
+            CHECK(kind == static_cast<uint8_t>(DltFrameKind::DELTA));
+            CHECK(frames[k].bytes.size() >= Layout::MIN_DELTA_BYTES);
+            CHECK(frames[k].bytes.size() < Layout::KEY_BYTES);
+        }
+    }
+}
+
+TEST_CASE("frames decode to the values they were encoded from")
+{
+    vector<Frame> frames = drifting(100, 2);
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    encode(frames, encoder);
+    DltDeltaDecoder decoder;
+    for (const Frame &frame : frames)
+    {
+        uint32_t values[DLT_MAX_COUNT];
+        REQUIRE(decoder.decode(frame.bytes.data(), frame.bytes.size(), values) == DltDecoded::VALUES);
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+            CHECK(values[i] == frame.values[i]);
+    }
+    CHECK(decoder.lost() == 0);
+}
+
+TEST_CASE("a change too wide for its delta is sent whole")
+{
+    uint8_t timestamp = 0;
+    while (Packet::fields[timestamp].value != &Telemetry::timestamp)
+        timestamp++;
+    vector<Frame> frames = drifting(3, 3);
+    frames[1].values[timestamp] = Bitpack_mask(25);
+    frames[2].values[0] = (frames[0].values[0] + 1) & Bitpack_mask(4); // the state, no delta bits
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    encode(frames, encoder);
+    DltDeltaDecoder decoder;
+    for (size_t k = 0; k < frames.size(); k++)
+    {
+        uint32_t values[DLT_MAX_COUNT];
+        REQUIRE(decoder.decode(frames[k].bytes.data(), frames[k].bytes.size(), values) == DltDecoded::VALUES);
+        CHECK((frames[k].bytes[0] >> DLT_SEQUENCE_BITS ==
+               static_cast<uint8_t>(k == 0 ? DltFrameKind::KEY : DltFrameKind::DELTA)));
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+            CHECK(values[i] == frames[k].values[i]);
+    }
+}
+
+TEST_CASE("a delta frame larger than a keyframe is sent as a keyframe")
+{
+    vector<Frame> frames = drifting(2, 4);
+    for (uint8_t i = 0; i < Packet::COUNT; i++)
+        frames[1].values[i] = ~frames[0].values[i] & Bitpack_mask(Packet::fields[i].width);
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    encode(frames, encoder);
+    CHECK((frames[1].bytes[0] >> DLT_SEQUENCE_BITS == static_cast<uint8_t>(DltFrameKind::KEY)));
+    CHECK(frames[1].bytes.size() == Layout::KEY_BYTES);
+    CHECK(Layout::MAX_BYTES >= Layout::KEY_BYTES);
+}
+
+TEST_CASE("deltas after a lost keyframe are stale until the next one")
+{
+    vector<Frame> frames = drifting(45, 5);
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    encode(frames, encoder);
+    DltDeltaDecoder decoder;
+    uint32_t values[DLT_MAX_COUNT];
+    for (int k = 0; k < 45; k++)
+    {
+        if (k == 20 || k == 25)
+            continue; // the second keyframe and a delta are lost
+        DltDecoded decoded = decoder.decode(frames[k].bytes.data(), frames[k].bytes.size(), values);
+        CHECK(decoded == (k > 20 && k < 40 ? DltDecoded::STALE : DltDecoded::VALUES));
+    }
+    CHECK(decoder.lost() == 2);
+    for (uint8_t i = 0; i < Packet::COUNT; i++)
+        CHECK(values[i] == frames[44].values[i]);
+}
+
+TEST_CASE("a request makes the next frame a keyframe")
+{
+    vector<Frame> frames = drifting(5, 6);
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    uint8_t bytes[Layout::MAX_BYTES];
+    encoder.encode<Packet>(frames[0].values.data(), bytes);
+    encoder.encode<Packet>(frames[1].values.data(), bytes);
+    CHECK((bytes[0] >> DLT_SEQUENCE_BITS == static_cast<uint8_t>(DltFrameKind::DELTA)));
+    encoder.requestKeyframe();
+    encoder.encode<Packet>(frames[2].values.data(), bytes);
+    CHECK((bytes[0] >> DLT_SEQUENCE_BITS == static_cast<uint8_t>(DltFrameKind::KEY)));
+    encoder.encode<Packet>(frames[3].values.data(), bytes);
+    CHECK((bytes[0] >> DLT_SEQUENCE_BITS == static_cast<uint8_t>(DltFrameKind::DELTA)));
+}
+
+TEST_CASE("truncated frames and APRS text are not decoded")
+{
+    vector<Frame> frames = drifting(2, 7);
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    encode(frames, encoder);
+    DltDeltaDecoder decoder;
+    uint32_t values[DLT_MAX_COUNT];
+    CHECK(decoder.decode(frames[0].bytes.data(), frames[0].bytes.size() - 1, values) == DltDecoded::MALFORMED);
+    CHECK(decoder.decode(frames[0].bytes.data(), frames[0].bytes.size(), values) == DltDecoded::VALUES);
+    CHECK(decoder.decode(frames[1].bytes.data(), 3, values) == DltDecoded::MALFORMED);
+
+    const char aprs[] = "KC1ABC>APRS,WIDE1-1:!4224.40N/07106.97W>";
+    CHECK(decoder.decode(reinterpret_cast<const uint8_t *>(aprs), sizeof(aprs), values) == DltDecoded::MALFORMED);
+    uint8_t request[1];
+    dlt_request_keyframe(request);
+    CHECK(decoder.decode(request, 1, values) == DltDecoded::REQUEST);
+}
+
+TEST_CASE("frames sent back to back in one packet decode one after another")
+{
+    vector<Frame> frames = drifting(8, 9);
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    encode(frames, encoder);
+    vector<uint8_t> packet;
+    for (const Frame &frame : frames)
+        packet.insert(packet.end(), frame.bytes.begin(), frame.bytes.end());
+
+    DltDeltaDecoder decoder;
+    size_t offset = 0;
+    for (const Frame &frame : frames)
+    {
+        uint32_t values[DLT_MAX_COUNT];
+        size_t used = 0;
+        REQUIRE(decoder.decode(&packet[offset], packet.size() - offset, values, used) == DltDecoded::VALUES);
+        CHECK(used == frame.bytes.size());
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+            CHECK(values[i] == frame.values[i]);
+        offset += used;
+    }
+    CHECK(offset == packet.size());
+}
+
+TEST_CASE("random values of any size round trip")
+{
+    mt19937 rng(10);
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    DltDeltaDecoder decoder;
+    vector<uint32_t> values(Packet::COUNT, 0);
+    for (int k = 0; k < 2000; k++)
+    {
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+        {
+            uint32_t step = rng() >> (rng() % 32);
+            values[i] = (rng() % 2 ? values[i] + step : values[i] - step) & Bitpack_mask(Packet::fields[i].width);
+        }
+        uint8_t bytes[Layout::MAX_BYTES];
+        uint32_t decoded[DLT_MAX_COUNT];
+        size_t size = encoder.encode<Packet>(values.data(), bytes);
+        REQUIRE(size <= Layout::MAX_BYTES);
+        REQUIRE(decoder.decode(bytes, size, decoded) == DltDecoded::VALUES);
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+            CHECK(decoded[i] == values[i]);
+    }
+}
+
+TEST_CASE("a keyframe is tagged with its schema, a change of schema sends one")
+{
+    CHECK(DltDeltaLayout<PowerOnPacket>::KEY_BYTES == 9);
+    CHECK(DLT_MAX_FRAME_BYTES >= Layout::MAX_BYTES);
+
+    Telemetry t = {};
+    t.curr_state = 1;
+    t.failures = 0x155;
+    uint32_t power_on[PowerOnPacket::COUNT], recovery[RecoveryPacket::COUNT], decoded[DLT_MAX_COUNT];
+    uint8_t bytes[DLT_MAX_FRAME_BYTES];
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    DltDeltaDecoder decoder;
+
+    dlt_transform<PowerOnPacket>(t, power_on);
+    size_t size = encoder.encode<PowerOnPacket>(power_on, bytes);
+    CHECK(size == 9);
+    CHECK(bytes[1] == static_cast<uint8_t>(DltSchema::POWER_ON));
+    REQUIRE(decoder.decode(bytes, size, decoded) == DltDecoded::VALUES);
+    CHECK(decoder.schema() == DltSchema::POWER_ON);
+
+    size = encoder.encode<PowerOnPacket>(power_on, bytes);
+    CHECK(size == DltDeltaLayout<PowerOnPacket>::MIN_DELTA_BYTES);
+    REQUIRE(decoder.decode(bytes, size, decoded) == DltDecoded::VALUES);
+    for (uint8_t i = 0; i < PowerOnPacket::COUNT; i++)
+        CHECK(decoded[i] == power_on[i]);
+
+    t.curr_state = 9;
+    t.gps_lat = 42.5f;
+    dlt_transform<RecoveryPacket>(t, recovery);
+    size = encoder.encode<RecoveryPacket>(recovery, bytes);
+    CHECK((bytes[0] >> DLT_SEQUENCE_BITS == static_cast<uint8_t>(DltFrameKind::KEY)));
+    CHECK(bytes[1] == static_cast<uint8_t>(DltSchema::RECOVERY));
+    REQUIRE(decoder.decode(bytes, size, decoded) == DltDecoded::VALUES);
+    CHECK(decoder.schema() == DltSchema::RECOVERY);
+    recovery[0] = 8;
+    size = encoder.encode<RecoveryPacket>(recovery, bytes);
+    REQUIRE(decoder.decode(bytes, size, decoded) == DltDecoded::VALUES);
+    for (uint8_t i = 0; i < RecoveryPacket::COUNT; i++)
+        CHECK(decoded[i] == recovery[i]);
+    Telemetry out = {};
+    dlt_untransform<RecoveryPacket>(decoded, out);
+    CHECK(out.gps_lat == doctest::Approx(42.5));
+
+    encoder.requestKeyframe();
+    size = encoder.encode<RecoveryPacket>(recovery, bytes);
+    bytes[1] = 0x7F; // no such schema
+    CHECK(decoder.decode(bytes, size, decoded) == DltDecoded::MALFORMED);
+}
+
+TEST_CASE("deltas of a schema whose keyframe was lost end the packet")
+{
+    Telemetry t = {};
+    t.curr_state = 2;
+    uint32_t ready[LaunchReadyPacket::COUNT], launch[LaunchModePacket::COUNT], decoded[DLT_MAX_COUNT];
+    uint8_t bytes[DLT_MAX_FRAME_BYTES];
+    DltDeltaEncoder<> encoder(0, EVERY_FRAME);
+    DltDeltaDecoder decoder;
+
+    dlt_transform<LaunchReadyPacket>(t, ready);
+    size_t size = encoder.encode<LaunchReadyPacket>(ready, bytes);
+    REQUIRE(decoder.decode(bytes, size, decoded) == DltDecoded::VALUES);
+
+    // the launch mode keyframe is lost, its deltas arrive four to a packet
+    t.curr_state = 4;
+    dlt_transform<LaunchModePacket>(t, launch);
+    encoder.encode<LaunchModePacket>(launch, bytes);
+    vector<uint8_t> packet;
+    for (int k = 0; k < 4; k++)
+    {
+        t.timestamp += 50;
+        dlt_transform<LaunchModePacket>(t, launch);
+        size = encoder.encode<LaunchModePacket>(launch, bytes);
+        REQUIRE((bytes[0] >> DLT_SEQUENCE_BITS == static_cast<uint8_t>(DltFrameKind::DELTA)));
+        packet.insert(packet.end(), bytes, bytes + size);
+    }
+
+    size_t used = 0;
+    CHECK(decoder.decode(packet.data(), packet.size(), decoded, used) == DltDecoded::STALE);
+    CHECK(used == packet.size());
+    CHECK(decoder.schema() == DltSchema::LAUNCH_READY);
+
+    // the keyframe asked for ends it
+    encoder.requestKeyframe();
+    size = encoder.encode<LaunchModePacket>(launch, bytes);
+    REQUIRE(decoder.decode(bytes, size, decoded) == DltDecoded::VALUES);
+    CHECK(decoder.schema() == DltSchema::LAUNCH_MODE);
+    for (uint8_t i = 0; i < LaunchModePacket::COUNT; i++)
+        CHECK(decoded[i] == launch[i]);
+}
+
+TEST_CASE("a channel is sent every period frames, the decoder holds it between")
+{
+    vector<Frame> frames = drifting(20, 5);
+    DltDeltaEncoder<> encoder;
+    encode(frames, encoder);
+    vector<Frame> every = frames;
+    DltDeltaEncoder<> every_encoder(0, EVERY_FRAME);
+    encode(every, every_encoder);
+    DltDeltaDecoder decoder;
+    for (size_t k = 0; k < frames.size(); k++)
+    {
+        uint32_t values[DLT_MAX_COUNT];
+        REQUIRE(decoder.decode(frames[k].bytes.data(), frames[k].bytes.size(), values) == DltDecoded::VALUES);
+        CHECK(frames[k].bytes.size() <= every[k].bytes.size());
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+        {
+            uint8_t period = DLT_CHANNEL_RATES[static_cast<uint8_t>(Packet::fields[i].channel)].period;
+            size_t sent = k - k % period;
+            CHECK((decoder.fresh() >> i & 1) == (sent == k));
+            CHECK(values[i] == frames[sent].values[i]);
+        }
+    }
+    CHECK(frames[1].bytes.size() < every[1].bytes.size());
+}
+
+TEST_CASE("a frame over its budget carries the most urgent channel alone")
+{
+    vector<Frame> frames = drifting(10, 6);
+    DltDeltaEncoder<> encoder(1, EVERY_FRAME);
+    encode(frames, encoder);
+    DltDeltaDecoder decoder;
+    for (size_t k = 0; k < frames.size(); k++)
+    {
+        uint32_t values[DLT_MAX_COUNT];
+        REQUIRE(decoder.decode(frames[k].bytes.data(), frames[k].bytes.size(), values) == DltDecoded::VALUES);
+        for (uint8_t i = 0; i < Packet::COUNT; i++)
+        {
+            // EVERY_FRAME ties every channel, the first in DltChannel goes
+            bool flight = k == 0 || Packet::fields[i].channel == DltChannel::FLIGHT;
+            CHECK((decoder.fresh() >> i & 1) == flight);
+            CHECK(values[i] == frames[flight ? k : 0].values[i]);
+        }
+    }
+}
@@ -0,0 +1,190 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <cstring>
+#include <inttypes.h>
+#include <random>
+#include <vector>
+using namespace std;
+
+// g++ -std=c++11 -I../../carm-electronics/flight-computer dltstream_test.cpp
+#include "../../carm-electronics/dltstream.h"
+
+typedef LaunchModePacket Packet;
+
+struct Collect
+{
+    vector<DltRecord> records;
+    void operator()(const DltRecord &record)
+    {
+        records.push_back(record);
+    }
+};
+
+// frames of a launch mode packet, a few steps apart, frames_per_packet to a
+// log record; expected gets the readings each frame decodes to
+vector<uint8_t> flight_log(int frames, int frames_per_packet, vector<Telemetry> &expected)
+{
+    mt19937 rng(47);
+    DltDeltaEncoder<> encoder;
+    DltDeltaDecoder reference;
+    vector<uint8_t> log, packet;
+    uint32_t values[Packet::COUNT];
+    Telemetry t = {};
+    t.curr_state = 4;
+    t.gps_lat = 42.4f;
+    t.gps_long = -71.1f;
+    for (int k = 0; k < frames; k++)
+    {
+        t.timestamp = 50 * k;
+        t.altitude = 10 + k * 0.7f;
+        t.vert_velo = 30 + (rng() % 100) * 0.01f;
+        t.gyro_z = (rng() % 100) * 0.1f;
+        dlt_transform<Packet>(t, values);
+        uint8_t bytes[DltDeltaLayout<Packet>::MAX_BYTES];
+        size_t size = encoder.encode<Packet>(values, bytes);
+        packet.insert(packet.end(), bytes, bytes + size);
+
+        uint32_t decoded[DLT_MAX_COUNT];
+        REQUIRE(reference.decode(bytes, size, decoded) == DltDecoded::VALUES);
+        Telemetry out = expected.empty() ? Telemetry{} : expected.back();
+        dlt_untransform<Packet>(decoded, out);
+        expected.push_back(out);
+
+        if ((k + 1) % frames_per_packet == 0 || k + 1 == frames)
+        {
+            uint8_t header[2];
+            log.insert(log.end(), header, header + dlt_log_header(packet.size(), header));
+            log.insert(log.end(), packet.begin(), packet.end());
+            packet.clear();
+        }
+    }
+    return log;
+}
+
+void check_records(const vector<DltRecord> &records, const vector<Telemetry> &expected)
+{
+    REQUIRE(records.size() == expected.size());
+    for (size_t k = 0; k < records.size(); k++)
+    {
+        CHECK(records[k].schema == DltSchema::LAUNCH_MODE);
+        for (uint8_t c = 0; c < DLT_COLUMN_COUNT; c++)
+            if (records[k].columns >> c & 1)
+                CHECK(dlt_column_value(records[k].telemetry, c) == dlt_column_value(expected[k], c));
+    }
+}
+
+TEST_CASE("every column is a Telemetry quantity, every field has a column")
+{
+    for (uint8_t c = 0; c < DLT_COLUMN_COUNT; c++)
+        CHECK(((DLT_COLUMNS[c].value == nullptr) != (DLT_COLUMNS[c].reading == nullptr)));
+    for (uint8_t s = 0; s < DLT_SCHEMAS; s++)
+    {
+        uint8_t count;
+        const DltField *fields = dlt_fields(static_cast<DltSchema>(s), count);
+        for (uint8_t i = 0; i < count; i++)
+            CHECK(dlt_column_of(fields[i]) < DLT_COLUMN_COUNT);
+    }
+    CHECK(strcmp(DLT_COLUMNS[dlt_column_of(PowerOnPacket::fields[1])].name, "external_temp") == 0);
+}
+
+TEST_CASE("a log decodes the same pushed whole or a few bytes at a time")
+{
+    vector<Telemetry> expected;
+    vector<uint8_t> log = flight_log(200, 4, expected);
+
+    DltStream whole;
+    Collect all;
+    whole.push(log.data(), log.size(), all);
+    check_records(all.records, expected);
+    CHECK(whole.stats().packets == 50);
+    CHECK(whole.stats().frames == 200);
+    CHECK(whole.stats().skipped == 0);
+    CHECK(whole.stats().malformed == 0);
+    CHECK(whole.lost() == 0);
+
+    mt19937 rng(1);
+    DltStream pieces;
+    Collect some;
+    for (size_t k = 0; k < log.size();)
+    {
+        size_t size = min<size_t>(1 + rng() % 7, log.size() - k);
+        pieces.push(log.data() + k, size, some);
+        k += size;
+    }
+    check_records(some.records, expected);
+    CHECK(pieces.stats().bytes == log.size());
+}
+
+TEST_CASE("the columns a packet carries, and those fresh in a frame")
+{
+    vector<Telemetry> expected;
+    vector<uint8_t> log = flight_log(2, 1, expected);
+    DltStream stream;
+    Collect out;
+    stream.push(log.data(), log.size(), out);
+    REQUIRE(out.records.size() == 2);
+    uint32_t altitude = 1UL << 14, external_temp = 1UL << 11;
+    CHECK(strcmp(DLT_COLUMNS[14].name, "altitude") == 0);
+    CHECK(strcmp(DLT_COLUMNS[11].name, "external_temp") == 0);
+    CHECK((out.records[0].columns & altitude));
+    CHECK(out.records[0].fresh == out.records[0].columns);
+    // the second frame is a delta, the temperatures wait for their period
+    CHECK((out.records[1].fresh & altitude));
+    CHECK(!(out.records[1].fresh & external_temp));
+    CHECK((out.records[1].columns & external_temp));
+}
+
+TEST_CASE("bytes outside a record are skipped, packets that are not telemetry passed over")
+{
+    vector<Telemetry> expected;
+    vector<uint8_t> frames = flight_log(8, 4, expected);
+    const char banner[] = "LoRa radio init OK!\r\n";
+    const char aprs[] = "KC1TUF>APRS:!4224.40N/07106.97W";
+    vector<uint8_t> log(banner, banner + strlen(banner));
+    log.push_back(DLT_LOG_SYNC); // a sync byte with no length after it
+    log.push_back(0);
+    log.push_back(DLT_LOG_SYNC);
+    log.push_back(strlen(aprs));
+    log.insert(log.end(), aprs, aprs + strlen(aprs));
+    log.insert(log.end(), frames.begin(), frames.end());
+
+    for (size_t piece : {log.size(), size_t(1), size_t(3)})
+    {
+        DltStream stream;
+        Collect out;
+        for (size_t k = 0; k < log.size(); k += piece)
+            stream.push(log.data() + k, min(piece, log.size() - k), out);
+        check_records(out.records, expected);
+        CHECK(stream.stats().skipped == strlen(banner) + 2);
+        CHECK(stream.stats().packets == 3);
+        CHECK(stream.stats().malformed == 1);
+    }
+}
+
+TEST_CASE("a packet is skipped from a delta against a lost keyframe on")
+{
+    vector<Telemetry> expected;
+    vector<uint8_t> log = flight_log(8, 4, expected);
+    // the first record, the keyframe's, is lost
+    size_t first = 2 + log[1];
+    DltStream stream;
+    Collect out;
+    stream.push(log.data() + first, log.size() - first, out);
+    CHECK(out.records.empty());
+    CHECK(stream.stats().packets == 1);
+    CHECK(stream.stats().stale == 1);
+    CHECK(stream.stats().skipped == log.size() - first - 2);
+    CHECK(stream.stats().malformed == 0);
+}
+
+TEST_CASE("a record cut off by the end of the log is held, not decoded")
+{
+    vector<Telemetry> expected;
+    vector<uint8_t> log = flight_log(8, 4, expected);
+    DltStream stream;
+    Collect out;
+    stream.push(log.data(), log.size() - 1, out);
+    CHECK(out.records.size() == 4);
+    stream.push(log.data() + log.size() - 1, 1, out);
+    check_records(out.records, expected);
+}
@@ -0,0 +1,219 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <inttypes.h>
+#include <random>
+#include <vector>
+using namespace std;
+
+// g++ -std=c++11 -I../../carm-electronics/flight-computer fec_test.cpp
+#include "../../carm-electronics/fec.h"
+#include "../../carm-electronics/dltdelta.h"
+
+static const size_t CAPACITY = 251; // RH_RF95_MAX_MESSAGE_LEN
+
+vector<uint8_t> random_packet(size_t size, mt19937 &rng)
+{
+    vector<uint8_t> packet(size);
+    for (uint8_t &b : packet)
+        b = rng();
+    // a frame header, as the flight computer's packets open with
+    packet[0] = 0x80 | (rng() & 0x3F);
+    return packet;
+}
+
+// the packet coded in a buffer of CAPACITY bytes
+vector<uint8_t> coded(const vector<uint8_t> &packet, uint8_t parity)
+{
+    FecEncoder encoder;
+    vector<uint8_t> buffer(CAPACITY);
+    copy(packet.begin(), packet.end(), buffer.begin());
+    buffer.resize(encoder.encode(buffer.data(), packet.size(), CAPACITY, parity));
+    return buffer;
+}
+
+// count bytes of the buffer changed to other values, at distinct positions
+void corrupt(vector<uint8_t> &buffer, unsigned count, mt19937 &rng)
+{
+    vector<size_t> positions(buffer.size());
+    for (size_t k = 0; k < positions.size(); k++)
+        positions[k] = k;
+    shuffle(positions.begin(), positions.end(), rng);
+    for (unsigned k = 0; k < count; k++)
+        buffer[positions[k]] ^= 1 + rng() % 255;
+}
+
+TEST_CASE("GF(2^8) multiplies and divides as the field does")
+{
+    const Gf256 &gf = gf256();
+    unsigned failures = 0;
+    for (unsigned a = 0; a < 256; a++)
+    {
+        for (unsigned b = 1; b < 256; b++)
+        {
+            // carry-less product reduced by x^8 + x^4 + x^3 + x^2 + 1
+            unsigned product = 0;
+            for (unsigned bit = 0; bit < 8; bit++)
+                if (b & (1 << bit))
+                    product ^= a << bit;
+            for (int bit = 15; bit >= 8; bit--)
+                if (product & (1 << bit))
+                    product ^= 0x11D << (bit - 8);
+            failures += gf.mul(a, b) != product;
+            failures += gf.div(gf.mul(a, b), b) != a;
+        }
+    }
+    CHECK(failures == 0);
+}
+
+TEST_CASE("a coded packet is the marker three times, the packet, then its parity")
+{
+    mt19937 rng(49);
+    vector<uint8_t> packet = random_packet(60, rng);
+    vector<uint8_t> buffer = coded(packet, 16);
+    REQUIRE(buffer.size() == fec_overhead(16) + packet.size());
+    CHECK(buffer[0] == 0xE8);
+    CHECK(buffer[1] == 0xE8);
+    CHECK(buffer[2] == 0xE8);
+    CHECK(equal(packet.begin(), packet.end(), buffer.begin() + FEC_MARKER_COPIES));
+
+    // no parity leaves the packet plain
+    CHECK(coded(packet, 0) == packet);
+    // odd parity is rounded down
+    CHECK(coded(packet, 9).size() == fec_overhead(8) + packet.size());
+}
+
+TEST_CASE("the parity is cut to what fits the buffer")
+{
+    mt19937 rng(49);
+    vector<uint8_t> packet = random_packet(CAPACITY - 3 - 5, rng);
+    vector<uint8_t> buffer = coded(packet, 32);
+    CHECK(buffer.size() == packet.size() + fec_overhead(4));
+    size_t size = buffer.size();
+    CHECK(fec_decode(buffer.data(), size) == 0);
+    CHECK(size == packet.size());
+
+    // nothing fits
+    packet = random_packet(CAPACITY - 3, rng);
+    CHECK(coded(packet, 32) == packet);
+}
+
+TEST_CASE("up to parity / 2 bytes in error anywhere are corrected, at every parity")
+{
+    mt19937 rng(49);
+    unsigned failures = 0, first_parity = 0, first_errors = 0;
+    for (uint8_t parity = 2; parity <= FEC_MAX_PARITY; parity += 2)
+    {
+        for (size_t size : {size_t(1), size_t(17), size_t(60), CAPACITY - 3 - parity})
+        {
+            for (int k = 0; k < 20; k++)
+            {
+                vector<uint8_t> packet = random_packet(size, rng);
+                vector<uint8_t> buffer = coded(packet, parity);
+                // the codeword's share, and one of the marker copies
+                unsigned errors = k == 0 ? 0 : rng() % (parity / 2 + 1);
+                vector<uint8_t> codeword(buffer.begin() + FEC_MARKER_COPIES, buffer.end());
+                corrupt(codeword, errors, rng);
+                copy(codeword.begin(), codeword.end(), buffer.begin() + FEC_MARKER_COPIES);
+                unsigned markers = k % 2;
+                if (markers)
+                    buffer[rng() % FEC_MARKER_COPIES] ^= 1 + rng() % 255;
+
+                size_t received = buffer.size();
+                int corrected = fec_decode(buffer.data(), received);
+                bool ok = corrected == int(errors + markers) && received == size &&
+                          equal(packet.begin(), packet.end(), buffer.begin());
+                if (!ok && failures++ == 0)
+                {
+                    first_parity = parity;
+                    first_errors = errors;
+                }
+            }
+        }
+    }
+    CHECK_MESSAGE(failures == 0, "first at parity ", first_parity, ", ", first_errors, " errors");
+}
+
+TEST_CASE("more bytes in error than the parity corrects are almost always reported, never overrun")
+{
+    mt19937 rng(49);
+    unsigned reported = 0, runs = 0, overruns = 0;
+    for (uint8_t parity : {4, 8, 16, 32})
+    {
+        for (int k = 0; k < 500; k++)
+        {
+            vector<uint8_t> packet = random_packet(80, rng);
+            vector<uint8_t> buffer = coded(packet, parity);
+            size_t sent = buffer.size();
+            vector<uint8_t> codeword(buffer.begin() + FEC_MARKER_COPIES, buffer.end());
+            corrupt(codeword, parity / 2 + 1 + rng() % parity, rng);
+            copy(codeword.begin(), codeword.end(), buffer.begin() + FEC_MARKER_COPIES);
+            size_t received = sent;
+            int corrected = fec_decode(buffer.data(), received);
+            runs++;
+            reported += corrected < 0;
+            overruns += corrected < 0 ? received != sent : received != packet.size();
+        }
+    }
+    CHECK(overruns == 0);
+    CHECK(reported > runs * 95 / 100);
+}
+
+TEST_CASE("plain packets pass through untouched")
+{
+    mt19937 rng(49);
+    vector<vector<uint8_t>> plain;
+    plain.push_back(vector<uint8_t>({}));
+    uint8_t request[1];
+    plain.push_back(vector<uint8_t>(request, request + dlt_request_keyframe(request)));
+
+    // a flight's frames, four to a packet
+    DltDeltaEncoder<> encoder;
+    Telemetry t = {};
+    vector<uint8_t> packet;
+    for (int k = 0; k < 400; k++)
+    {
+        t.curr_state = 4;
+        t.timestamp = 50 * k;
+        t.altitude = 100 + 3 * k + rng() % 7;
+        t.gyro_counts.x = rng() % 4000;
+        t.accel_counts.y = rng() % 4000;
+        uint32_t values[LaunchModePacket::COUNT];
+        uint8_t frame[DltDeltaLayout<LaunchModePacket>::MAX_BYTES];
+        dlt_transform<LaunchModePacket>(t, values);
+        packet.insert(packet.end(), frame, frame + encoder.encode<LaunchModePacket>(values, frame));
+        if (k % 4 == 3)
+        {
+            plain.push_back(packet);
+            packet.clear();
+        }
+    }
+    const char aprs[] = "KC1XYZ-11>APRS:!4224.00N/07106.00WO";
+    plain.push_back(vector<uint8_t>(aprs, aprs + sizeof(aprs) - 1));
+
+    unsigned changed = 0;
+    for (const vector<uint8_t> &p : plain)
+    {
+        vector<uint8_t> buffer(p);
+        size_t size = buffer.size();
+        changed += fec_decode(buffer.data(), size) != 0 || size != p.size() || buffer != p;
+    }
+    CHECK(changed == 0);
+}
+
+TEST_CASE("the first marker copy in error is voted out")
+{
+    mt19937 rng(49);
+    vector<uint8_t> packet = random_packet(40, rng);
+    unsigned failures = 0;
+    for (unsigned value = 0; value < 256; value++)
+    {
+        vector<uint8_t> buffer = coded(packet, 8);
+        if (value == buffer[0])
+            continue;
+        buffer[0] = value;
+        size_t size = buffer.size();
+        failures += fec_decode(buffer.data(), size) != 1 || size != packet.size() ||
+                    !equal(packet.begin(), packet.end(), buffer.begin());
+    }
+    CHECK(failures == 0);
+}
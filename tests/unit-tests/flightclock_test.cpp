@@ -0,0 +1,64 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <inttypes.h>
+#include <random>
+using namespace std;
+
+#include "../../carm-electronics/flight-computer/flightclock.h"
+
+// mock micros(), set by the test
+uint32_t mock_micros;
+
+uint32_t read_mock()
+{
+    return mock_micros;
+}
+
+TEST_CASE("the clock follows the source until it wraps")
+{
+    mock_micros = 1234;
+    FlightClock clock(read_mock);
+    CHECK(clock.now() == 1234);
+    mock_micros = UINT32_MAX;
+    CHECK(clock.now() == UINT32_MAX);
+    CHECK(FlightClock::toMillis(clock.now()) == UINT32_MAX / 1000);
+}
+
+TEST_CASE("every wrap of the source adds 2^32 us")
+{
+    const uint64_t WRAP = 1ULL << 32;
+    mock_micros = UINT32_MAX - 10;
+    FlightClock clock(read_mock);
+    CHECK(clock.now() == UINT32_MAX - 10);
+    mock_micros = 5;
+    CHECK(clock.now() == WRAP + 5);
+    // the same reading twice is not a wrap
+    CHECK(clock.now() == WRAP + 5);
+    mock_micros = UINT32_MAX;
+    CHECK(clock.now() == WRAP + UINT32_MAX);
+    mock_micros = 0;
+    CHECK(clock.now() == 2 * WRAP);
+    // and in ms
+    CHECK(FlightClock::toMillis(clock.now()) == 2 * WRAP / 1000);
+}
+
+TEST_CASE("read at irregular intervals over hours, the clock never goes backwards")
+{
+    mt19937 rng(3);
+    // up to 20 minutes between reads, well under the 71.6 minute wrap
+    uniform_int_distribution<uint32_t> step(0, 1200000000);
+    uint64_t truth = 0;
+    mock_micros = 0;
+    FlightClock clock(read_mock);
+    uint64_t last = clock.now();
+    for (int k = 0; k < 10000; k++)
+    {
+        truth += step(rng);
+        mock_micros = static_cast<uint32_t>(truth);
+        uint64_t now = clock.now();
+        INFO("read ", k);
+        REQUIRE(now >= last);
+        REQUIRE(now == truth);
+        last = now;
+    }
+}
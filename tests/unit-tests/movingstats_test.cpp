@@ -0,0 +1,140 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <cmath>
+#include <cstdlib>
+#include <inttypes.h>
+using namespace std;
+
+#include "../../carm-electronics/flight-computer/movingstats.h"
+
+// brute force statistics over the last n values of a stream
+struct WindowReference
+{
+    double mean, variance, min, max;
+};
+
+WindowReference reference_stats(const float *stream, int end, int n)
+{
+    int start = end - n < 0 ? 0 : end - n;
+    int count = end - start;
+    WindowReference r = {0, 0, stream[start], stream[start]};
+    for (int i = start; i < end; i++)
+    {
+        r.mean += stream[i];
+        r.min = stream[i] < r.min ? stream[i] : r.min;
+        r.max = stream[i] > r.max ? stream[i] : r.max;
+    }
+    r.mean /= count;
+    for (int i = start; i < end; i++)
+    {
+        r.variance += (stream[i] - r.mean) * (stream[i] - r.mean);
+    }
+    r.variance /= count;
+    return r;
+}
+
+TEST_CASE("Empty and partially filled windows")
+{
+    MovingStats<float, 4> window;
+    CHECK(window.empty());
+    CHECK(window.mean() == 0);
+    CHECK(window.variance() == 0);
+    CHECK(window.maxAbs() == 0);
+
+    window.push(3);
+    CHECK(window.size() == 1);
+    CHECK(window.mean() == doctest::Approx(3));
+    CHECK(window.variance() == doctest::Approx(0));
+    CHECK(window.min() == 3);
+    CHECK(window.max() == 3);
+
+    window.push(-5);
+    CHECK(window.size() == 2);
+    CHECK(!window.full());
+    CHECK(window.mean() == doctest::Approx(-1));
+    CHECK(window.variance() == doctest::Approx(16));
+    CHECK(window.min() == -5);
+    CHECK(window.max() == 3);
+    CHECK(window.maxAbs() == 5);
+    CHECK(window.last() == -5);
+}
+
+TEST_CASE("Oldest samples leave the window")
+{
+    MovingStats<float, 3> window;
+    float stream[] = {10, 1, 2, 3, -20, 4, 5, 6};
+    float expected_max[] = {10, 10, 10, 3, 3, 4, 5, 6};
+    float expected_min[] = {10, 1, 1, 1, -20, -20, -20, 4};
+    for (int i = 0; i < 8; i++)
+    {
+        window.push(stream[i]);
+        CHECK(window.max() == expected_max[i]);
+        CHECK(window.min() == expected_min[i]);
+    }
+    CHECK(window.full());
+    CHECK(window.mean() == doctest::Approx(5));
+    CHECK(window.maxAbs() == 6);
+
+    window.clear();
+    CHECK(window.empty());
+    window.push(7);
+    CHECK(window.min() == 7);
+    CHECK(window.max() == 7);
+}
+
+TEST_CASE("Matches brute force statistics on a random stream")
+{
+    const int STREAM_LENGTH = 5000;
+    static float stream[STREAM_LENGTH];
+    srand(1);
+    for (int i = 0; i < STREAM_LENGTH; i++)
+    {
+        // offset signal, like a raw barometer altitude with noise
+        stream[i] = 1500.0f + (rand() % 2001 - 1000) / 1000.0f;
+    }
+
+    SUBCASE("window of 12, the ZUPT window")
+    {
+        MovingStats<float, 12> window;
+        for (int i = 0; i < STREAM_LENGTH; i++)
+        {
+            window.push(stream[i]);
+            WindowReference r = reference_stats(stream, i + 1, 12);
+            REQUIRE(window.min() == (float)r.min);
+            REQUIRE(window.max() == (float)r.max);
+            REQUIRE(window.mean() == doctest::Approx(r.mean).epsilon(1e-5));
+            REQUIRE(window.variance() == doctest::Approx(r.variance).epsilon(1e-2));
+        }
+    }
+
+    SUBCASE("window of 100, the barometer zeroing window")
+    {
+        MovingStats<float, 100> window;
+        for (int i = 0; i < STREAM_LENGTH; i++)
+        {
+            window.push(stream[i]);
+            WindowReference r = reference_stats(stream, i + 1, 100);
+            REQUIRE(window.min() == (float)r.min);
+            REQUIRE(window.max() == (float)r.max);
+            REQUIRE(window.mean() == doctest::Approx(r.mean).epsilon(1e-5));
+            REQUIRE(window.variance() == doctest::Approx(r.variance).epsilon(1e-2));
+        }
+    }
+}
+
+TEST_CASE("Monotonic streams keep the deques consistent")
+{
+    MovingStats<int, 5> window;
+    for (int i = 0; i < 50; i++)
+    {
+        window.push(i);
+        CHECK(window.max() == i);
+        CHECK(window.min() == (i < 4 ? 0 : i - 4));
+    }
+    for (int i = 50; i > 0; i--)
+    {
+        window.push(i);
+    }
+    CHECK(window.max() == 5);
+    CHECK(window.min() == 1);
+}
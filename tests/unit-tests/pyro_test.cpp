@@ -0,0 +1,245 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <inttypes.h>
+#include <random>
+#include <vector>
+using namespace std;
+
+#include "../../carm-electronics/flight-computer/pyro.h"
+
+// mock pins: an e-match on each that burns through once it has been driven
+// high for burn us in one pulse
+const uint8_t PINS = 32;
+const uint64_t NEVER = UINT64_MAX;
+
+struct MockPin
+{
+    bool output;
+    bool high;
+    bool intact;
+    uint64_t burn;
+    uint64_t highSince;
+};
+
+struct Pulse
+{
+    uint8_t pin;
+    uint64_t start;
+    uint64_t end;
+};
+
+MockPin pins[PINS];
+vector<Pulse> pulses;
+uint64_t mock_now;
+bool glitch; // driven high while still an input, or switched to output while high
+
+void reset_pins()
+{
+    for (MockPin &p : pins)
+        p = MockPin{false, false, true, NEVER, 0};
+    pulses.clear();
+    mock_now = 0;
+    glitch = false;
+}
+
+void mock_set_output(uint8_t pin, bool output)
+{
+    if (output && pins[pin].high)
+        glitch = true;
+    pins[pin].output = output;
+}
+
+void mock_write(uint8_t pin, bool high)
+{
+    MockPin &p = pins[pin];
+    if (high && !p.output)
+        glitch = true;
+    if (high && !p.high)
+        p.highSince = mock_now;
+    if (!high && p.high)
+    {
+        pulses.push_back(Pulse{pin, p.highSince, mock_now});
+        if (p.burn != NEVER && mock_now - p.highSince >= p.burn)
+            p.intact = false;
+    }
+    p.high = high;
+}
+
+bool mock_read(uint8_t pin)
+{
+    return !pins[pin].output && pins[pin].intact;
+}
+
+const PyroGpio MOCK_GPIO = {mock_set_output, mock_write, mock_read};
+const uint32_t SENSE_DELAY = 20;
+
+void run_until(PyroScheduler &pyro, uint64_t end, uint64_t step = 1)
+{
+    for (; mock_now < end; mock_now += step)
+        pyro.tick(mock_now);
+    pyro.tick(mock_now);
+}
+
+TEST_CASE("a pulse starts on time and holds for exactly its hold with 1 us ticks")
+{
+    reset_pins();
+    pins[16].burn = 100;
+    PyroScheduler pyro(MOCK_GPIO, SENSE_DELAY);
+    uint8_t drogue = pyro.addChannel(16);
+    CHECK(pyro.hasContinuity(drogue));
+    CHECK(pyro.schedule(drogue, PyroAction{1000, 500, 0, 0}));
+    run_until(pyro, 999);
+    CHECK(pyro.getStatus(drogue) == PyroStatus::SCHEDULED);
+    CHECK(pulses.empty());
+    run_until(pyro, 1000);
+    CHECK(pyro.getStatus(drogue) == PyroStatus::FIRING);
+    CHECK(pins[16].output);
+    CHECK(pins[16].high);
+    run_until(pyro, 2000);
+    REQUIRE(pulses.size() == 1);
+    CHECK(pulses[0].start == 1000);
+    CHECK(pulses[0].end == 1500);
+    CHECK_FALSE(pins[16].output);
+    CHECK(pyro.getStatus(drogue) == PyroStatus::FIRED);
+    CHECK(pyro.getAttempts(drogue) == 1);
+    CHECK(pyro.getFiredAt(drogue) == 1000);
+    CHECK_FALSE(pyro.hasContinuity(drogue));
+    CHECK_FALSE(pyro.busy());
+    CHECK_FALSE(glitch);
+}
+
+TEST_CASE("with an irregular loop a pulse is late and long by at most one tick")
+{
+    mt19937 rng(7);
+    uniform_int_distribution<uint32_t> step(1, 40);
+    for (int trial = 0; trial < 200; trial++)
+    {
+        reset_pins();
+        pins[15].burn = 50;
+        PyroScheduler pyro(MOCK_GPIO, SENSE_DELAY);
+        uint8_t main = pyro.addChannel(15);
+        uint64_t at = 500 + trial;
+        pyro.schedule(main, PyroAction{at, 500, 0, 0});
+        uint64_t longest = 0;
+        while (mock_now < 3000)
+        {
+            uint64_t s = step(rng);
+            longest = max(longest, s);
+            mock_now += s;
+            pyro.tick(mock_now);
+        }
+        INFO("trial ", trial);
+        REQUIRE(pulses.size() == 1);
+        CHECK(pulses[0].start >= at);
+        CHECK(pulses[0].start - at < longest);
+        CHECK(pulses[0].end - pulses[0].start >= 500);
+        CHECK(pulses[0].end - pulses[0].start < 500 + longest);
+        CHECK(pyro.getStatus(main) == PyroStatus::FIRED);
+    }
+}
+
+TEST_CASE("an e-match that still conducts is fired again, then the channel fails")
+{
+    reset_pins();
+    PyroScheduler pyro(MOCK_GPIO, SENSE_DELAY);
+    uint8_t drogue = pyro.addChannel(16);
+    pyro.schedule(drogue, PyroAction{0, 500, 2, 1000});
+    run_until(pyro, 10000);
+    REQUIRE(pulses.size() == 3);
+    // each retry starts retryInterval after the continuity reading
+    CHECK(pulses[0].start == 0);
+    CHECK(pulses[1].start == 500 + SENSE_DELAY + 1000);
+    CHECK(pulses[2].start == pulses[1].end + SENSE_DELAY + 1000);
+    for (const Pulse &p : pulses)
+        CHECK(p.end - p.start == 500);
+    CHECK(pyro.getAttempts(drogue) == 3);
+    CHECK(pyro.getStatus(drogue) == PyroStatus::FAILED);
+    CHECK(pyro.hasContinuity(drogue));
+    CHECK_FALSE(glitch);
+}
+
+TEST_CASE("retries stop once the e-match burns")
+{
+    reset_pins();
+    PyroScheduler pyro(MOCK_GPIO, SENSE_DELAY);
+    uint8_t main = pyro.addChannel(15);
+    pyro.schedule(main, PyroAction{100, 300, 5, 200});
+    // the first pulse ends at 400 and leaves it intact, it burns on the second
+    run_until(pyro, 450);
+    CHECK(pyro.getStatus(main) == PyroStatus::RETRY_WAIT);
+    pins[15].burn = 300;
+    run_until(pyro, 5000);
+    CHECK(pulses.size() == 2);
+    CHECK(pyro.getAttempts(main) == 2);
+    CHECK(pyro.getStatus(main) == PyroStatus::FIRED);
+    CHECK(pyro.getFiredAt(main) == pulses[1].start);
+}
+
+TEST_CASE("channels run independently and the loop is never blocked")
+{
+    reset_pins();
+    pins[15].burn = 10;
+    pins[16].burn = 10;
+    PyroScheduler pyro(MOCK_GPIO, SENSE_DELAY);
+    uint8_t drogue = pyro.addChannel(16);
+    uint8_t main = pyro.addChannel(15);
+    pyro.schedule(drogue, PyroAction{100, 500, 0, 0});
+    pyro.schedule(main, PyroAction{300, 200, 0, 0});
+    int ticks = 0;
+    for (mock_now = 0; mock_now <= 1000; mock_now++, ticks++)
+        pyro.tick(mock_now);
+    // one tick per us all along, both pulses overlapping
+    CHECK(ticks == 1001);
+    REQUIRE(pulses.size() == 2);
+    CHECK(pulses[0].pin == 15);
+    CHECK(pulses[0].start == 300);
+    CHECK(pulses[0].end == 500);
+    CHECK(pulses[1].pin == 16);
+    CHECK(pulses[1].start == 100);
+    CHECK(pulses[1].end == 600);
+    CHECK(pyro.getStatus(drogue) == PyroStatus::FIRED);
+    CHECK(pyro.getStatus(main) == PyroStatus::FIRED);
+}
+
+TEST_CASE("cancel pulls a firing pin low at once, a firing channel cannot be rescheduled")
+{
+    reset_pins();
+    PyroScheduler pyro(MOCK_GPIO, SENSE_DELAY);
+    uint8_t drogue = pyro.addChannel(16);
+    CHECK_FALSE(pyro.schedule(7, PyroAction{0, 500, 0, 0}));
+    pyro.schedule(drogue, PyroAction{0, 500, 0, 0});
+    run_until(pyro, 100);
+    CHECK_FALSE(pyro.schedule(drogue, PyroAction{200, 500, 0, 0}));
+    pyro.cancel(drogue);
+    CHECK_FALSE(pins[16].high);
+    CHECK_FALSE(pins[16].output);
+    CHECK(pyro.getStatus(drogue) == PyroStatus::IDLE);
+    run_until(pyro, 1000);
+    CHECK(pulses.size() == 1);
+    CHECK(pulses[0].end == 100);
+}
+
+TEST_CASE("actions straddle the point where micros() wraps")
+{
+    const uint64_t WRAP = 1ULL << 32;
+    reset_pins();
+    pins[16].burn = 100;
+    PyroScheduler pyro(MOCK_GPIO, SENSE_DELAY);
+    uint8_t drogue = pyro.addChannel(16);
+    mock_now = WRAP - 1000;
+    pyro.schedule(drogue, PyroAction{WRAP - 200, 500, 0, 0});
+    run_until(pyro, WRAP + 1000);
+    REQUIRE(pulses.size() == 1);
+    CHECK(pulses[0].start == WRAP - 200);
+    CHECK(pulses[0].end == WRAP + 300);
+    CHECK(pyro.getStatus(drogue) == PyroStatus::FIRED);
+}
+
+TEST_CASE("no more than MAX_CHANNELS channels")
+{
+    reset_pins();
+    PyroScheduler pyro(MOCK_GPIO, SENSE_DELAY);
+    for (uint8_t c = 0; c < PyroScheduler::MAX_CHANNELS; c++)
+        CHECK(pyro.addChannel(c) == c);
+    CHECK(pyro.addChannel(20) == PyroScheduler::NO_CHANNEL);
+}
@@ -0,0 +1,133 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <cmath>
+#include <cstdlib>
+#include <inttypes.h>
+#include <string>
+using namespace std;
+
+#include "../../carm-electronics/flight-computer/rawimu.h"
+
+// DLT fields of the IMU readings, as in dlt.h
+struct Field
+{
+    const char *name;
+    int n_min;
+    float spacing;
+};
+
+const Field ACCEL_XY = {"accel xy", 0, 0.0489236790607f};
+const Field ACCEL_Z = {"accel z", -30, 0.0635075720567f};
+const Field MAG = {"mag", -5, 0.0195694716243f};
+const Field GYRO_XY = {"gyro xy", -1440, 0.0027465846506f};
+const Field GYRO_Z = {"gyro z", -360, 0.00549320597234f};
+
+// the driver's float readings, operation for operation
+float driver_accel(int16_t counts, int range)
+{
+    float mg_lsb = range == 2 ? 0.061f : range == 4 ? 0.122f : range == 8 ? 0.244f : 0.732f;
+    float reading = counts * mg_lsb;
+    reading /= 1000;
+    reading *= 9.80665f;
+    return reading;
+}
+
+float driver_gyro(int16_t counts, int range)
+{
+    float dps_digit = range == 245 ? 0.00875f : range == 500 ? 0.0175f : 0.07f;
+    return counts * dps_digit * 0.017453293f;
+}
+
+float driver_mag(int16_t counts, int range)
+{
+    float lsb_per_gauss = range == 4 ? 6842 : range == 8 ? 3421 : range == 12 ? 2281 : 1711;
+    float gauss = (float)counts / lsb_per_gauss;
+    return gauss * 100;
+}
+
+// floor((reading - n_min) / spacing) on the float reading, negatives go to 0
+// as they do on the M0
+unsigned int float_dlt(float reading, const Field &field)
+{
+    float serialized = floor((reading - field.n_min) / field.spacing);
+    return serialized < 0 ? 0 : (unsigned int)serialized;
+}
+
+struct Comparison
+{
+    int exact;
+    int max_difference;
+};
+
+template <typename Driver>
+Comparison compare_all_counts(Driver driver, int range, float unit_per_count, const Field &field)
+{
+    DltCountMap map = dlt_count_map(unit_per_count, field.n_min, field.spacing);
+    Comparison c = {0, 0};
+    for (int counts = INT16_MIN; counts <= INT16_MAX; counts++)
+    {
+        long expected = float_dlt(driver((int16_t)counts, range), field);
+        long actual = serialize_dlt_counts((int16_t)counts, map);
+        c.exact += expected == actual;
+        c.max_difference = max(c.max_difference, (int)labs(expected - actual));
+    }
+    return c;
+}
+
+TEST_CASE("count scales match the driver")
+{
+    for (int range : {2, 4, 8, 16})
+        CHECK(accel_count_scale(range) * 1000 == doctest::Approx(driver_accel(1000, range)).epsilon(1e-6));
+    for (int range : {245, 500, 2000})
+        CHECK(gyro_count_scale(range) * 1000 == doctest::Approx(driver_gyro(1000, range)).epsilon(1e-6));
+    for (int range : {4, 8, 12, 16})
+        CHECK(mag_count_scale(range) * 1000 == doctest::Approx(driver_mag(1000, range)).epsilon(1e-6));
+}
+
+TEST_CASE("integer DLT matches the float path within one step for every count")
+{
+    SUBCASE("accelerometer")
+    {
+        for (int range : {2, 4, 8, 16})
+            for (const Field &field : {ACCEL_XY, ACCEL_Z})
+            {
+                Comparison c = compare_all_counts(driver_accel, range, accel_count_scale(range), field);
+                INFO(std::string(field.name), " +-", range, "g: ", c.exact, " of 65536 exact");
+                CHECK(c.max_difference <= 1);
+                CHECK(c.exact > 65536 * 0.99);
+            }
+    }
+    SUBCASE("gyroscope")
+    {
+        for (int range : {245, 500, 2000})
+            for (const Field &field : {GYRO_XY, GYRO_Z})
+            {
+                Comparison c = compare_all_counts(driver_gyro, range, gyro_count_scale(range), field);
+                INFO(std::string(field.name), " +-", range, "dps: ", c.exact, " of 65536 exact");
+                CHECK(c.max_difference <= 1);
+                // reading + 1440 only keeps a 25th of a step in a float, the
+                // float path is the one off here
+                CHECK(c.exact > 65536 * 0.97);
+            }
+    }
+    SUBCASE("magnetometer")
+    {
+        for (int range : {4, 8, 12, 16})
+        {
+            Comparison c = compare_all_counts(driver_mag, range, mag_count_scale(range), MAG);
+            INFO(std::string(MAG.name), " +-", range, "gauss: ", c.exact, " of 65536 exact");
+            CHECK(c.max_difference <= 1);
+            CHECK(c.exact > 65536 * 0.99);
+        }
+    }
+}
+
+TEST_CASE("readings below the range encode as 0")
+{
+    DltCountMap map = dlt_count_map(accel_count_scale(4), ACCEL_XY.n_min, ACCEL_XY.spacing);
+    CHECK(serialize_dlt_counts(-1, map) == 0);
+    CHECK(serialize_dlt_counts(INT16_MIN, map) == 0);
+    CHECK(serialize_dlt_counts(0, map) == 0);
+    // 1 g is 8196 counts at +-4 g, 200 steps of 0.0489 m/s^2
+    CHECK(serialize_dlt_counts(8196, map) == 200);
+}
@@ -0,0 +1,154 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include <cmath>
+#include <inttypes.h>
+using namespace std;
+
+#include "../../carm-electronics/flight-computer/transitions.h"
+
+enum
+{
+    IDLE = 0,
+    ARMED,
+    FLYING,
+    DONE
+};
+
+static bool positive(const FlightEstimates &e)
+{
+    return e.velocity > 0;
+}
+
+static bool high(const FlightEstimates &e)
+{
+    return e.altitude > 100;
+}
+
+// time in ms, the table runs on us
+FlightEstimates at(uint32_t time, float velocity, float altitude = 0)
+{
+    FlightEstimates e;
+    e.time = time * 1000ULL;
+    e.altitude = altitude;
+    e.velocity = velocity;
+    e.accel = 0;
+    e.timeToApogee = NAN;
+    return e;
+}
+
+TEST_CASE("guards fire on n of the last m ticks")
+{
+    const TransitionRule rules[] = {{IDLE, FLYING, positive, 3, 5, 0, 0, 0}};
+    TransitionTable table(rules, 1, IDLE);
+    const float velocities[] = {1, -1, 1, -1, -1, -1, -1, -1, 1, 1};
+    for (int k = 0; k < 10; k++)
+    {
+        INFO("tick ", k);
+        CHECK(table.tick(at(k * 50, velocities[k])) == -1);
+    }
+    // -1, -1, 1, 1 and now 1: three of the last five
+    CHECK(table.tick(at(500, 1)) == 0);
+    CHECK(table.getState() == FLYING);
+    // pending since the tick at 400 ms, the window was empty at 350 ms
+    CHECK(table.getStats(0).pendingTicks == 3);
+    CHECK(table.getStats(0).firedAt == 500000);
+    CHECK(table.getStats(0).fired == 1);
+}
+
+TEST_CASE("only the rules of the current state are evaluated, in table order")
+{
+    // listed out of state order on purpose
+    const TransitionRule rules[] = {
+        {FLYING, DONE, high, 1, 1, 0, 0, 0},
+        {IDLE, ARMED, positive, 1, 1, 0, 0, 0},
+        {IDLE, FLYING, positive, 1, 1, 0, 0, 0},
+    };
+    TransitionTable table(rules, 3, IDLE);
+    CHECK(table.tick(at(0, 0, 500)) == -1);
+    CHECK(table.tick(at(50, 1)) == 1);
+    CHECK(table.getState() == ARMED);
+    // no rule leaves ARMED
+    CHECK(table.tick(at(100, 1, 500)) == -1);
+    table.setState(FLYING, 150000);
+    CHECK(table.tick(at(200, 1, 500)) == 0);
+    CHECK(table.getState() == DONE);
+}
+
+TEST_CASE("minimum dwell and lockout hold a firing guard back")
+{
+    const TransitionRule rules[] = {
+        {IDLE, ARMED, positive, 1, 1, 0, 0, 0},
+        // 200 ms in ARMED, and 1 s after IDLE was entered
+        {ARMED, FLYING, positive, 1, 1, 200000, IDLE, 1000000},
+    };
+    TransitionTable table(rules, 2, IDLE);
+    CHECK(table.tick(at(0, 1)) == 0);
+    CHECK(table.tick(at(100, 1)) == -1); // dwell
+    CHECK(table.tick(at(300, 1)) == -1); // lockout
+    CHECK(table.tick(at(950, 1)) == -1);
+    CHECK(table.tick(at(1000, 1)) == 1);
+    CHECK(table.getStats(1).pendingTicks == 4);
+}
+
+TEST_CASE("entering a state starts its rules from an empty window")
+{
+    const TransitionRule rules[] = {
+        {IDLE, ARMED, positive, 1, 1, 0, 0, 0},
+        {ARMED, FLYING, positive, 2, 2, 0, 0, 0},
+    };
+    TransitionTable table(rules, 2, ARMED);
+    CHECK(table.tick(at(0, 1)) == -1);
+    table.setState(IDLE, 50000);
+    CHECK(table.tick(at(100, 1)) == 0);
+    // the tick before the reset does not count towards two of two
+    CHECK(table.tick(at(150, 1)) == -1);
+    CHECK(table.tick(at(200, 1)) == 1);
+}
+
+TEST_CASE("windows as long as 32 ticks")
+{
+    const TransitionRule rules[] = {{IDLE, DONE, positive, 32, 32, 0, 0, 0}};
+    TransitionTable table(rules, 1, IDLE);
+    for (int k = 0; k < 31; k++)
+        CHECK(table.tick(at(k, 1)) == -1);
+    CHECK(table.tick(at(31, 1)) == 0);
+}
+
+TEST_CASE("rules out of range are checked when the table is built")
+{
+    const uint8_t OUT = TransitionTable::MAX_STATES;
+    const TransitionRule rules[] = {
+        {OUT, IDLE, positive, 1, 1, 0, 0, 0},      // source out of range: never evaluated
+        {IDLE, OUT, positive, 1, 1, 0, 0, 0},      // target out of range
+        {IDLE, ARMED, high, 1, 1, 0, OUT, 1000},   // lockout state out of range
+        {IDLE, FLYING, positive, 1, 0, 0, 0, 0},   // m of 0 taken as 1
+        {FLYING, DONE, positive, 2, 40, 0, 0, 0},  // m past 32 taken as 32
+    };
+    TransitionTable table(rules, 5, IDLE);
+    CHECK(table.tick(at(0, -1, 200)) == -1);
+    CHECK(table.tick(at(50, 1, 200)) == 3);
+    CHECK(table.getState() == FLYING);
+    CHECK(table.tick(at(100, 1)) == -1);
+    CHECK(table.tick(at(150, 1)) == 4);
+
+    // forced to a state out of range, the table stays where it was
+    table.setState(OUT, 200000);
+    CHECK(table.getState() == DONE);
+}
+
+TEST_CASE("a rule without a guard is left out, n is taken within 1 to m")
+{
+    const TransitionRule rules[] = {
+        {IDLE, ARMED, nullptr, 1, 1, 0, 0, 0},    // no guard: never evaluated
+        {IDLE, FLYING, positive, 0, 3, 0, 0, 0},  // n of 0 taken as 1
+        {FLYING, DONE, positive, 5, 3, 0, 0, 0},  // n past m taken as m
+    };
+    TransitionTable table(rules, 3, IDLE);
+    CHECK(table.tick(at(0, -1)) == -1);
+    CHECK(table.tick(at(50, 1)) == 1);
+    CHECK(table.getState() == FLYING);
+    CHECK(table.tick(at(100, 1)) == -1);
+    CHECK(table.tick(at(150, 1)) == -1);
+    CHECK(table.tick(at(200, 1)) == 2);
+    CHECK(table.getState() == DONE);
+}